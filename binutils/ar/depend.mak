@@ -0,0 +1 @@
+ar.o: ar.c ../include/ar.h ../include/a.out.h
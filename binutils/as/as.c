@@ -9,8 +9,11 @@
 #include <stdarg.h>
 #include <ctype.h>
 #include <unistd.h>
+#include <setjmp.h>
+#include <pthread.h>
 
 #include "../include/a.out.h"
+#include "../peep/peep.h"
 
 
 /**************************************************************/
@@ -148,27 +151,6 @@ int debugCode = 0;
 int debugFixup = 0;
 int debugModule = 0;
 
-char codeName[L_tmpnam];
-char dataName[L_tmpnam];
-char *outName = NULL;
-char *inName = NULL;
-
-FILE *codeFile = NULL;
-FILE *dataFile = NULL;
-FILE *outFile = NULL;
-FILE *inFile = NULL;
-
-char line[LINE_SIZE];
-char *lineptr;
-int lineno;
-
-int token;
-int tokenvalNumber;
-char tokenvalString[LINE_SIZE];
-
-int allowSyn = 1;
-int currSeg = SEGMENT_CODE;
-unsigned int segPtr[4] = { 0, 0, 0, 0 };
 char *segName[4] = { "ABS", "CODE", "DATA", "BSS" };
 char *methodName[5] = { "H16", "L16", "R16", "R26", "W32" };
 
@@ -180,6 +162,7 @@ typedef struct fixup {
   int value;			/* known part of value */
   int base;			/* segment which this ref is relative to */
 				/* valid only when used for relocation */
+  int relax;			/* starts a sequence the linker may shorten */
   struct fixup *next;		/* next fixup */
 } Fixup;
 
@@ -191,50 +174,143 @@ typedef struct symbol {
   int value;			/* the symbol's value */
   Fixup *fixups;		/* list of locations to fix */
   struct symbol *globref;	/* set if this local refers to a global */
-  struct symbol *left;		/* left son in binary search tree */
-  struct symbol *right;		/* right son in binary search tree */
+  unsigned int hash;		/* hash value of the symbol's name */
+  struct symbol *next;		/* next symbol in order of creation */
   int skip;			/* this symbol is not defined here nor is */
 				/* it used here: don't write to object file */
 } Symbol;
 
 
+typedef struct block {
+  struct block *next;		/* next block in arena */
+  unsigned int size;		/* usable size of this block */
+  unsigned int used;		/* bytes already allocated in this block */
+  double data[1];		/* start of allocatable space */
+} Block;
+
+
+typedef struct {
+  Block *first;			/* first block in arena */
+  Block *curr;			/* block which is currently allocated from */
+} Arena;
+
+
+typedef struct {
+  char **names;			/* open addressing table of names */
+  unsigned int *hashes;		/* hash values of names */
+  unsigned int size;		/* number of slots, power of 2 */
+  unsigned int count;		/* number of occupied slots */
+} NameTable;
+
+
+typedef struct {
+  Symbol **slots;		/* open addressing table of symbols */
+  unsigned int size;		/* number of slots, power of 2 */
+  unsigned int count;		/* number of symbols in table */
+  Symbol *first;		/* symbols in order of creation */
+  Symbol **last;		/* where to link the next symbol */
+  Arena *arena;			/* where the symbols are allocated */
+} SymbolTable;
+
+
+typedef struct {
+  unsigned char *data;		/* contents of segment */
+  unsigned int size;		/* number of bytes in segment */
+  unsigned int capacity;	/* number of bytes allocated */
+} Buffer;
+
+
+/*
+ * All state of a single assembly run lives in a job, so that
+ * several jobs can be executed concurrently. The job being
+ * executed by the current thread is accessed through 'job'.
+ */
+
+typedef struct {
+  char *outName;		/* name of object file */
+  char **inNames;		/* names of source files */
+  int numInNames;		/* number of source files */
+  char *inName;			/* name of current source file */
+  FILE *outFile;		/* object file */
+  FILE *inFile;			/* current source file */
+  Buffer codeBuf;		/* contents of code segment */
+  Buffer dataBuf;		/* contents of data segment */
+  char line[LINE_SIZE];		/* current source line */
+  char *lineptr;		/* scan position in current line */
+  int lineno;			/* number of current line */
+  int token;			/* current token */
+  int tokenvalNumber;		/* value of number token */
+  char tokenvalString[LINE_SIZE];	/* value of string token */
+  int allowSyn;			/* synthetic instructions allowed */
+  int noRelax;			/* code layout must not be changed by ld */
+  int currSeg;			/* current segment */
+  unsigned int segPtr[4];	/* location counters of segments */
+  Fixup *fixupList;		/* fixups to be written as relocations */
+  Arena permArena;		/* names, fixups, global symbols */
+  Arena localArena;		/* local symbols of current module */
+  NameTable nameTable;		/* interned symbol names */
+  SymbolTable globalTable;	/* global symbols */
+  SymbolTable localTable;	/* local symbols of current module */
+  int numSymbols;		/* number of global symbols written */
+  Symbol **sortedGlobals;	/* global symbols, sorted by name */
+  ExecHeader execHeader;	/* header of object file */
+  int fileOffset;		/* offsets and sizes in object file */
+  int dataSize;
+  int stringSize;
+  int nsyms;
+  int nrels;
+  unsigned int peepStats[PEEP_NUM_RULES];	/* peephole rule counts */
+  int failed;			/* job terminated with an error */
+  jmp_buf errorExit;		/* where to go on errors */
+} Job;
+
+
+static __thread Job *job = NULL;
+
+
 /**************************************************************/
 
 
+static pthread_mutex_t errorLock = PTHREAD_MUTEX_INITIALIZER;
+static int multiJob = 0;
+static int optimize = 0;		/* run the peephole optimizer */
+static int showPeepStats = 0;		/* report what it did */
+
+
+void closeFiles(void) {
+  if (job->outFile != NULL) {
+    fclose(job->outFile);
+    job->outFile = NULL;
+  }
+  if (job->inFile != NULL) {
+    fclose(job->inFile);
+    job->inFile = NULL;
+  }
+}
+
+
 void error(char *fmt, ...) {
   va_list ap;
 
+  pthread_mutex_lock(&errorLock);
   va_start(ap, fmt);
   fprintf(stderr, "Error: ");
+  if (multiJob && job != NULL && job->inName != NULL) {
+    fprintf(stderr, "%s: ", job->inName);
+  }
   vfprintf(stderr, fmt, ap);
   fprintf(stderr, "\n");
   va_end(ap);
-  if (codeFile != NULL) {
-    fclose(codeFile);
-    codeFile = NULL;
-  }
-  if (dataFile != NULL) {
-    fclose(dataFile);
-    dataFile = NULL;
-  }
-  if (outFile != NULL) {
-    fclose(outFile);
-    outFile = NULL;
+  pthread_mutex_unlock(&errorLock);
+  if (job == NULL) {
+    exit(1);
   }
-  if (inFile != NULL) {
-    fclose(inFile);
-    inFile = NULL;
+  closeFiles();
+  if (job->outName != NULL) {
+    unlink(job->outName);
   }
-  if (codeName != NULL) {
-    unlink(codeName);
-  }
-  if (dataName != NULL) {
-    unlink(dataName);
-  }
-  if (outName != NULL) {
-    unlink(outName);
-  }
-  exit(1);
+  job->failed = 1;
+  longjmp(job->errorExit, 1);
 }
 
 
@@ -257,47 +333,119 @@ void freeMemory(void *p) {
 /**************************************************************/
 
 
+#define ARENA_BLOCK	(64 * 1024)	/* size of an arena block */
+#define ARENA_ALIGN	8		/* alignment of arena allocations */
+
+
+static Block *newBlock(unsigned int size) {
+  Block *b;
+
+  if (size < ARENA_BLOCK) {
+    size = ARENA_BLOCK;
+  }
+  b = allocateMemory(sizeof(Block) - sizeof(b->data) + size);
+  b->next = NULL;
+  b->size = size;
+  b->used = 0;
+  return b;
+}
+
+
+void *arenaAlloc(Arena *a, unsigned int size) {
+  Block *b;
+  Block *n;
+  void *p;
+
+  size = (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+  if (a->curr == NULL) {
+    a->first = newBlock(size);
+    a->curr = a->first;
+  }
+  b = a->curr;
+  while (b->size - b->used < size) {
+    /* try the next block, which may be left over from a reset */
+    if (b->next == NULL || b->next->size < size) {
+      n = newBlock(size);
+      n->next = b->next;
+      b->next = n;
+    }
+    b = b->next;
+    b->used = 0;
+    a->curr = b;
+  }
+  p = (char *) b->data + b->used;
+  b->used += size;
+  return p;
+}
+
+
+void arenaFree(Arena *a) {
+  Block *b;
+
+  while (a->first != NULL) {
+    b = a->first;
+    a->first = b->next;
+    freeMemory(b);
+  }
+  a->curr = NULL;
+}
+
+
+void arenaReset(Arena *a) {
+  /* keep all blocks for reuse, but make them empty */
+  a->curr = a->first;
+  if (a->curr != NULL) {
+    a->curr->used = 0;
+  }
+}
+
+
+/**************************************************************/
+
+
 int getNextToken(void) {
   char *p;
   int base;
   int digit;
 
-  while (*lineptr == ' ' || *lineptr == '\t') {
-    lineptr++;
+  while (*job->lineptr == ' ' || *job->lineptr == '\t') {
+    job->lineptr++;
   }
-  if (*lineptr == '\n' || *lineptr == '\0' || *lineptr == ';') {
+  if (*job->lineptr == '\n' || *job->lineptr == '\0' || *job->lineptr == ';') {
     return TOK_EOL;
   }
-  if (isalpha((int) *lineptr) || *lineptr == '_' || *lineptr == '.') {
-    p = tokenvalString;
-    while (isalnum((int) *lineptr) || *lineptr == '_' || *lineptr == '.') {
-      *p++ = *lineptr++;
+  if (isalpha((int) *job->lineptr) ||
+      *job->lineptr == '_' || *job->lineptr == '.') {
+    p = job->tokenvalString;
+    while (isalnum((int) *job->lineptr) ||
+           *job->lineptr == '_' || *job->lineptr == '.') {
+      *p++ = *job->lineptr++;
     }
     *p = '\0';
-    if (*lineptr == ':') {
-      lineptr++;
+    if (*job->lineptr == ':') {
+      job->lineptr++;
       return TOK_LABEL;
     } else {
       return TOK_IDENT;
     }
   }
-  if (isdigit((int) *lineptr)) {
+  if (isdigit((int) *job->lineptr)) {
     base = 10;
-    tokenvalNumber = 0;
-    if (*lineptr == '0') {
-      lineptr++;
-      if (*lineptr == 'x' || *lineptr == 'X') {
+    job->tokenvalNumber = 0;
+    if (*job->lineptr == '0') {
+      job->lineptr++;
+      if (*job->lineptr == 'x' || *job->lineptr == 'X') {
         base = 16;
-        lineptr++;
+        job->lineptr++;
       } else
-      if (isdigit((int) *lineptr)) {
+      if (isdigit((int) *job->lineptr)) {
         base = 8;
       } else {
         return TOK_NUMBER;
       }
     }
-    while (isxdigit((int) *lineptr)) {
-      digit = *lineptr++ - '0';
+    while (isxdigit((int) *job->lineptr)) {
+      digit = *job->lineptr++ - '0';
       if (digit >= 'A' - '0') {
         if (digit >= 'a' - '0') {
           digit += '0' - 'a' + 10;
@@ -306,143 +454,145 @@ int getNextToken(void) {
         }
       }
       if (digit >= base) {
-        error("illegal digit value %d in line %d", digit, lineno);
+        error("illegal digit value %d in line %d", digit, job->lineno);
       }
-      tokenvalNumber *= base;
-      tokenvalNumber += digit;
+      job->tokenvalNumber *= base;
+      job->tokenvalNumber += digit;
     }
     return TOK_NUMBER;
   }
-  if (*lineptr == '\'') {
-    lineptr++;
-    if (!isprint((int) *lineptr)) {
-      error("cannot quote character 0x%02X in line %d", *lineptr, lineno);
+  if (*job->lineptr == '\'') {
+    job->lineptr++;
+    if (!isprint((int) *job->lineptr)) {
+      error("cannot quote character 0x%02X in line %d",
+            *job->lineptr, job->lineno);
     }
-    tokenvalNumber = *lineptr;
-    lineptr++;
-    if (*lineptr != '\'') {
-      error("unbalanced quote in line %d", lineno);
+    job->tokenvalNumber = *job->lineptr;
+    job->lineptr++;
+    if (*job->lineptr != '\'') {
+      error("unbalanced quote in line %d", job->lineno);
     }
-    lineptr++;
+    job->lineptr++;
     return TOK_NUMBER;
   }
-  if (*lineptr == '\"') {
-    lineptr++;
-    p = tokenvalString;
+  if (*job->lineptr == '\"') {
+    job->lineptr++;
+    p = job->tokenvalString;
     while (1) {
-      if (*lineptr == '\n' || *lineptr == '\0') {
-        error("unterminated string constant in line %d", lineno);
+      if (*job->lineptr == '\n' || *job->lineptr == '\0') {
+        error("unterminated string constant in line %d", job->lineno);
       }
-      if (!isprint((int) *lineptr)) {
+      if (!isprint((int) *job->lineptr)) {
         error("string contains illegal character 0x%02X in line %d",
-              *lineptr, lineno);
+              *job->lineptr, job->lineno);
       }
-      if (*lineptr == '\"') {
+      if (*job->lineptr == '\"') {
         break;
       }
-      *p++ = *lineptr++;
+      *p++ = *job->lineptr++;
     }
-    lineptr++;
+    job->lineptr++;
     *p = '\0';
     return TOK_STRING;
   }
-  if (*lineptr == '$') {
-    lineptr++;
-    if (!isdigit((int) *lineptr)) {
-      error("register number expected after '$' in line %d", lineno);
+  if (*job->lineptr == '$') {
+    job->lineptr++;
+    if (!isdigit((int) *job->lineptr)) {
+      error("register number expected after '$' in line %d", job->lineno);
     }
-    tokenvalNumber = 0;
-    while (isdigit((int) *lineptr)) {
-      digit = *lineptr++ - '0';
-      tokenvalNumber *= 10;
-      tokenvalNumber += digit;
+    job->tokenvalNumber = 0;
+    while (isdigit((int) *job->lineptr)) {
+      digit = *job->lineptr++ - '0';
+      job->tokenvalNumber *= 10;
+      job->tokenvalNumber += digit;
     }
-    if (tokenvalNumber < 0 || tokenvalNumber >= NUM_REGS) {
-      error("illegal register number %d in line %d", tokenvalNumber, lineno);
+    if (job->tokenvalNumber < 0 || job->tokenvalNumber >= NUM_REGS) {
+      error("illegal register number %d in line %d",
+            job->tokenvalNumber, job->lineno);
     }
     return TOK_REGISTER;
   }
-  if (*lineptr == '+') {
-    lineptr++;
+  if (*job->lineptr == '+') {
+    job->lineptr++;
     return TOK_PLUS;
   }
-  if (*lineptr == '-') {
-    lineptr++;
+  if (*job->lineptr == '-') {
+    job->lineptr++;
     return TOK_MINUS;
   }
-  if (*lineptr == '*') {
-    lineptr++;
+  if (*job->lineptr == '*') {
+    job->lineptr++;
     return TOK_STAR;
   }
-  if (*lineptr == '/') {
-    lineptr++;
+  if (*job->lineptr == '/') {
+    job->lineptr++;
     return TOK_SLASH;
   }
-  if (*lineptr == '%') {
-    lineptr++;
+  if (*job->lineptr == '%') {
+    job->lineptr++;
     return TOK_PERCENT;
   }
-  if (*lineptr == '<' && *(lineptr + 1) == '<') {
-    lineptr += 2;
+  if (*job->lineptr == '<' && *(job->lineptr + 1) == '<') {
+    job->lineptr += 2;
     return TOK_LSHIFT;
   }
-  if (*lineptr == '>' && *(lineptr + 1) == '>') {
-    lineptr += 2;
+  if (*job->lineptr == '>' && *(job->lineptr + 1) == '>') {
+    job->lineptr += 2;
     return TOK_RSHIFT;
   }
-  if (*lineptr == '(') {
-    lineptr++;
+  if (*job->lineptr == '(') {
+    job->lineptr++;
     return TOK_LPAREN;
   }
-  if (*lineptr == ')') {
-    lineptr++;
+  if (*job->lineptr == ')') {
+    job->lineptr++;
     return TOK_RPAREN;
   }
-  if (*lineptr == ',') {
-    lineptr++;
+  if (*job->lineptr == ',') {
+    job->lineptr++;
     return TOK_COMMA;
   }
-  if (*lineptr == '~') {
-    lineptr++;
+  if (*job->lineptr == '~') {
+    job->lineptr++;
     return TOK_TILDE;
   }
-  if (*lineptr == '&') {
-    lineptr++;
+  if (*job->lineptr == '&') {
+    job->lineptr++;
     return TOK_AMPER;
   }
-  if (*lineptr == '|') {
-    lineptr++;
+  if (*job->lineptr == '|') {
+    job->lineptr++;
     return TOK_BAR;
   }
-  if (*lineptr == '^') {
-    lineptr++;
+  if (*job->lineptr == '^') {
+    job->lineptr++;
     return TOK_CARET;
   }
-  error("illegal character 0x%02X in line %d", *lineptr, lineno);
+  error("illegal character 0x%02X in line %d", *job->lineptr, job->lineno);
   return 0;
 }
 
 
 void showToken(void) {
   printf("DEBUG: ");
-  switch (token) {
+  switch (job->token) {
     case TOK_EOL:
       printf("token = TOK_EOL\n");
       break;
     case TOK_LABEL:
-      printf("token = TOK_LABEL, value = %s\n", tokenvalString);
+      printf("token = TOK_LABEL, value = %s\n", job->tokenvalString);
       break;
     case TOK_IDENT:
-      printf("token = TOK_IDENT, value = %s\n", tokenvalString);
+      printf("token = TOK_IDENT, value = %s\n", job->tokenvalString);
       break;
     case TOK_STRING:
-      printf("token = TOK_STRING, value = %s\n", tokenvalString);
+      printf("token = TOK_STRING, value = %s\n", job->tokenvalString);
       break;
     case TOK_NUMBER:
-      printf("token = TOK_NUMBER, value = 0x%x\n", tokenvalNumber);
+      printf("token = TOK_NUMBER, value = 0x%x\n", job->tokenvalNumber);
       break;
     case TOK_REGISTER:
-      printf("token = TOK_REGISTER, value = %d\n", tokenvalNumber);
+      printf("token = TOK_REGISTER, value = %d\n", job->tokenvalNumber);
       break;
     case TOK_PLUS:
       printf("token = TOK_PLUS\n");
@@ -487,13 +637,13 @@ void showToken(void) {
       printf("token = TOK_CARET\n");
       break;
     default:
-      error("illegal token %d in showToken()", token);
+      error("illegal token %d in showToken()", job->token);
   }
 }
 
 
 void getToken(void) {
-  token = getNextToken();
+  job->token = getNextToken();
   if (debugToken) {
     showToken();
   }
@@ -525,9 +675,9 @@ static char *tok2str[] = {
 
 
 void expect(int expected) {
-  if (token != expected) {
+  if (job->token != expected) {
     error("'%s' expected, got '%s' in line %d",
-          tok2str[expected], tok2str[token], lineno);
+          tok2str[expected], tok2str[job->token], job->lineno);
   }
 }
 
@@ -535,25 +685,23 @@ void expect(int expected) {
 /**************************************************************/
 
 
-Fixup *fixupList = NULL;
-
-
 Fixup *newFixup(int segment, unsigned int offset, int method, int value) {
   Fixup *f;
 
-  f = allocateMemory(sizeof(Fixup));
+  f = arenaAlloc(&job->permArena, sizeof(Fixup));
   f->segment = segment;
   f->offset = offset;
   f->method = method;
   f->value = value;
   f->base = 0;
+  f->relax = 0;
   f->next = NULL;
   return f;
 }
 
 
-void addFixup(Symbol *s,
-              int segment, unsigned int offset, int method, int value) {
+Fixup *addFixup(Symbol *s,
+                int segment, unsigned int offset, int method, int value) {
   Fixup *f;
 
   if (debugFixup) {
@@ -563,14 +711,110 @@ void addFixup(Symbol *s,
   f = newFixup(segment, offset, method, value);
   f->next = s->fixups;
   s->fixups = f;
+  return f;
+}
+
+
+void addRelaxFixup(Symbol *s, int value) {
+  Fixup *f;
+
+  /* the synthetic sequence starting here may be shortened by ld */
+  f = addFixup(s, job->currSeg, job->segPtr[job->currSeg],
+               RELOC_H16, value);
+  f->relax = (job->currSeg == SEGMENT_CODE);
 }
 
 
 /**************************************************************/
 
 
-Symbol *globalTable = NULL;
-Symbol *localTable = NULL;
+#define INIT_TABLE_SIZE	256	/* initial size of hash tables, power of 2 */
+
+
+unsigned int hashName(char *name) {
+  unsigned int h;
+
+  /* FNV-1a */
+  h = 2166136261u;
+  while (*name != '\0') {
+    h ^= (unsigned char) *name++;
+    h *= 16777619u;
+  }
+  return h;
+}
+
+
+/*
+ * All symbol names are interned: equal names share the same
+ * string, so symbol tables can compare names by pointer.
+ */
+
+
+static void growNameTable(void) {
+  NameTable *nt;
+  char **oldNames;
+  unsigned int *oldHashes;
+  unsigned int oldSize;
+  unsigned int i, j;
+
+  nt = &job->nameTable;
+  oldNames = nt->names;
+  oldHashes = nt->hashes;
+  oldSize = nt->size;
+  nt->size = oldSize == 0 ? INIT_TABLE_SIZE : 2 * oldSize;
+  nt->names = allocateMemory(nt->size * sizeof(char *));
+  nt->hashes = allocateMemory(nt->size * sizeof(unsigned int));
+  for (j = 0; j < nt->size; j++) {
+    nt->names[j] = NULL;
+  }
+  for (i = 0; i < oldSize; i++) {
+    if (oldNames[i] == NULL) {
+      continue;
+    }
+    j = oldHashes[i] & (nt->size - 1);
+    while (nt->names[j] != NULL) {
+      j = (j + 1) & (nt->size - 1);
+    }
+    nt->names[j] = oldNames[i];
+    nt->hashes[j] = oldHashes[i];
+  }
+  if (oldSize != 0) {
+    freeMemory(oldNames);
+    freeMemory(oldHashes);
+  }
+}
+
+
+char *internName(char *name, unsigned int *hashp) {
+  NameTable *nt;
+  unsigned int h;
+  unsigned int i;
+  char *p;
+
+  nt = &job->nameTable;
+  if (4 * (nt->count + 1) > 3 * nt->size) {
+    growNameTable();
+  }
+  h = hashName(name);
+  i = h & (nt->size - 1);
+  while (nt->names[i] != NULL) {
+    if (nt->hashes[i] == h && strcmp(nt->names[i], name) == 0) {
+      *hashp = h;
+      return nt->names[i];
+    }
+    i = (i + 1) & (nt->size - 1);
+  }
+  p = arenaAlloc(&job->permArena, strlen(name) + 1);
+  strcpy(p, name);
+  nt->names[i] = p;
+  nt->hashes[i] = h;
+  nt->count++;
+  *hashp = h;
+  return p;
+}
+
+
+/**************************************************************/
 
 
 Symbol *deref(Symbol *s) {
@@ -582,64 +826,87 @@ Symbol *deref(Symbol *s) {
 }
 
 
-Symbol *newSymbol(char *name) {
+Symbol *newSymbol(char *name, unsigned int hash, Arena *arena) {
   Symbol *p;
 
-  p = allocateMemory(sizeof(Symbol));
-  p->name = allocateMemory(strlen(name) + 1);
-  strcpy(p->name, name);
+  p = arenaAlloc(arena, sizeof(Symbol));
+  p->name = name;
   p->status = STATUS_UNKNOWN;
   p->segment = 0;
   p->value = 0;
   p->fixups = NULL;
   p->globref = NULL;
-  p->left = NULL;
-  p->right = NULL;
+  p->hash = hash;
+  p->next = NULL;
   return p;
 }
 
 
+static void growSymbolTable(SymbolTable *t) {
+  Symbol *s;
+  unsigned int i;
+
+  if (t->slots != NULL) {
+    freeMemory(t->slots);
+  }
+  t->size = t->size == 0 ? INIT_TABLE_SIZE : 2 * t->size;
+  t->slots = allocateMemory(t->size * sizeof(Symbol *));
+  for (i = 0; i < t->size; i++) {
+    t->slots[i] = NULL;
+  }
+  for (s = t->first; s != NULL; s = s->next) {
+    i = s->hash & (t->size - 1);
+    while (t->slots[i] != NULL) {
+      i = (i + 1) & (t->size - 1);
+    }
+    t->slots[i] = s;
+  }
+}
+
+
+static void clearSymbolTable(SymbolTable *t) {
+  unsigned int i;
+
+  for (i = 0; i < t->size; i++) {
+    t->slots[i] = NULL;
+  }
+  t->count = 0;
+  t->first = NULL;
+  t->last = &t->first;
+}
+
+
 Symbol *lookupEnter(char *name, int whichTable) {
-  Symbol *p, *q, *r;
-  int cmp;
+  SymbolTable *t;
+  unsigned int hash;
+  unsigned int i;
+  Symbol *s;
 
   if (whichTable == GLOBAL_TABLE) {
-    p = globalTable;
+    t = &job->globalTable;
   } else {
-    p = localTable;
+    t = &job->localTable;
   }
-  if (p == NULL) {
-    r = newSymbol(name);
-    if (whichTable == GLOBAL_TABLE) {
-      globalTable = r;
-    } else {
-      localTable = r;
-    }
-    return r;
+  if (t->last == NULL) {
+    t->last = &t->first;
   }
-  while (1) {
-    q = p;
-    cmp = strcmp(name, q->name);
-    if (cmp == 0) {
-      return q;
-    }
-    if (cmp < 0) {
-      p = q->left;
-    } else {
-      p = q->right;
-    }
-    if (p == NULL) {
-      r = newSymbol(name);
-      if (cmp < 0) {
-        q->left = r;
-      } else {
-        q->right = r;
-      }
-      return r;
+  if (4 * (t->count + 1) > 3 * t->size) {
+    growSymbolTable(t);
+  }
+  name = internName(name, &hash);
+  i = hash & (t->size - 1);
+  while ((s = t->slots[i]) != NULL) {
+    if (s->name == name) {
+      return s;
     }
+    i = (i + 1) & (t->size - 1);
   }
-  /* never reached */
-  return NULL;
+  s = newSymbol(name, hash, t->arena);
+  t->slots[i] = s;
+  t->count++;
+  *t->last = s;
+  t->last = &s->next;
+  return s;
 }
 
 
@@ -672,46 +939,54 @@ static void linkSymbol(Symbol *s) {
       f->value += s->value;
       f->base = s->segment;
       /* transfer the record to the fixup list */
-      f->next = fixupList;
-      fixupList = f;
+      f->next = job->fixupList;
+      job->fixupList = f;
     }
   }
 }
 
 
-static void linkTree(Symbol *s) {
-  if (s == NULL) {
-    return;
+void linkLocals(void) {
+  Symbol *s;
+
+  for (s = job->localTable.first; s != NULL; s = s->next) {
+    linkSymbol(s);
   }
-  linkTree(s->left);
-  linkSymbol(s);
-  linkTree(s->right);
-  freeMemory(s->name);
-  freeMemory(s);
+  clearSymbolTable(&job->localTable);
+  arenaReset(&job->localArena);
 }
 
 
-void linkLocals(void) {
-  linkTree(localTable);
-  localTable = NULL;
-  fseek(codeFile, 0, SEEK_END);
-  fseek(dataFile, 0, SEEK_END);
+/**************************************************************/
+
+
+static int cmpSymbol(const void *sym1, const void *sym2) {
+  return strcmp((*(Symbol **) sym1)->name, (*(Symbol **) sym2)->name);
 }
 
 
-/**************************************************************/
+void sortGlobals(void) {
+  Symbol *s;
+  unsigned int i;
 
+  /* the object file lists global symbols sorted by name */
+  job->sortedGlobals =
+    allocateMemory((job->globalTable.count + 1) * sizeof(Symbol *));
+  i = 0;
+  for (s = job->globalTable.first; s != NULL; s = s->next) {
+    job->sortedGlobals[i++] = s;
+  }
+  qsort(job->sortedGlobals, job->globalTable.count,
+        sizeof(Symbol *), cmpSymbol);
+}
 
-static int numSymbols;
 
+void walkGlobals(void (*fp)(Symbol *sp)) {
+  unsigned int i;
 
-void walkTree(Symbol *s, void (*fp)(Symbol *sp)) {
-  if (s == NULL) {
-    return;
+  for (i = 0; i < job->globalTable.count; i++) {
+    (*fp)(job->sortedGlobals[i]);
   }
-  walkTree(s->left, fp);
-  (*fp)(s);
-  walkTree(s->right, fp);
 }
 
 
@@ -733,45 +1008,62 @@ void transferFixupsForSymbol(Symbol *s) {
     f = s->fixups;
     s->fixups = f->next;
     /* use the 'base' component to store the current symbol number */
-    f->base = MSB | numSymbols;
+    f->base = MSB | job->numSymbols;
     /* transfer the record to the fixup list */
-    f->next = fixupList;
-    fixupList = f;
+    f->next = job->fixupList;
+    job->fixupList = f;
   }
-  numSymbols++;
+  job->numSymbols++;
 }
 
 
 void transferFixups(void) {
-  numSymbols = 0;
-  walkTree(globalTable, transferFixupsForSymbol);
+  job->numSymbols = 0;
+  sortGlobals();
+  walkGlobals(transferFixupsForSymbol);
 }
 
 
 /**************************************************************/
 
 
+void putByte(Buffer *b, unsigned int byte) {
+  unsigned char *p;
+
+  if (b->size == b->capacity) {
+    b->capacity = b->capacity == 0 ? 4096 : 2 * b->capacity;
+    p = allocateMemory(b->capacity);
+    if (b->size != 0) {
+      memcpy(p, b->data, b->size);
+      freeMemory(b->data);
+    }
+    b->data = p;
+  }
+  b->data[b->size++] = byte;
+}
+
+
 void emitByte(unsigned int byte) {
   byte &= 0x000000FF;
   if (debugCode) {
     printf("DEBUG: byte @ segment = %s, offset = %08X",
-           segName[currSeg], segPtr[currSeg]);
+           segName[job->currSeg], job->segPtr[job->currSeg]);
     printf(", value = %02X\n", byte);
   }
-  switch (currSeg) {
+  switch (job->currSeg) {
     case SEGMENT_ABS:
       error("illegal segment in emitByte()");
       break;
     case SEGMENT_CODE:
-      fputc(byte, codeFile);
+      putByte(&job->codeBuf, byte);
       break;
     case SEGMENT_DATA:
-      fputc(byte, dataFile);
+      putByte(&job->dataBuf, byte);
       break;
     case SEGMENT_BSS:
       break;
   }
-  segPtr[currSeg] += 1;
+  job->segPtr[job->currSeg] += 1;
 }
 
 
@@ -779,57 +1071,57 @@ void emitHalf(unsigned int half) {
   half &= 0x0000FFFF;
   if (debugCode) {
     printf("DEBUG: half @ segment = %s, offset = %08X",
-           segName[currSeg], segPtr[currSeg]);
+           segName[job->currSeg], job->segPtr[job->currSeg]);
     printf(", value = %02X%02X\n",
            (half >> 8) & 0xFF, half & 0xFF);
   }
-  switch (currSeg) {
+  switch (job->currSeg) {
     case SEGMENT_ABS:
       error("illegal segment in emitHalf()");
       break;
     case SEGMENT_CODE:
-      fputc((half >> 8) & 0xFF, codeFile);
-      fputc(half & 0xFF, codeFile);
+      putByte(&job->codeBuf, (half >> 8) & 0xFF);
+      putByte(&job->codeBuf, half & 0xFF);
       break;
     case SEGMENT_DATA:
-      fputc((half >> 8) & 0xFF, dataFile);
-      fputc(half & 0xFF, dataFile);
+      putByte(&job->dataBuf, (half >> 8) & 0xFF);
+      putByte(&job->dataBuf, half & 0xFF);
       break;
     case SEGMENT_BSS:
       break;
   }
-  segPtr[currSeg] += 2;
+  job->segPtr[job->currSeg] += 2;
 }
 
 
 void emitWord(unsigned int word) {
   if (debugCode) {
     printf("DEBUG: word @ segment = %s, offset = %08X",
-           segName[currSeg], segPtr[currSeg]);
+           segName[job->currSeg], job->segPtr[job->currSeg]);
     printf(", value = %02X%02X%02X%02X\n",
            (word >> 24) & 0xFF, (word >> 16) & 0xFF,
            (word >> 8) & 0xFF, word & 0xFF);
   }
-  switch (currSeg) {
+  switch (job->currSeg) {
     case SEGMENT_ABS:
       error("illegal segment in emitWord()");
       break;
     case SEGMENT_CODE:
-      fputc((word >> 24) & 0xFF, codeFile);
-      fputc((word >> 16) & 0xFF, codeFile);
-      fputc((word >> 8) & 0xFF, codeFile);
-      fputc(word & 0xFF, codeFile);
+      putByte(&job->codeBuf, (word >> 24) & 0xFF);
+      putByte(&job->codeBuf, (word >> 16) & 0xFF);
+      putByte(&job->codeBuf, (word >> 8) & 0xFF);
+      putByte(&job->codeBuf, word & 0xFF);
       break;
     case SEGMENT_DATA:
-      fputc((word >> 24) & 0xFF, dataFile);
-      fputc((word >> 16) & 0xFF, dataFile);
-      fputc((word >> 8) & 0xFF, dataFile);
-      fputc(word & 0xFF, dataFile);
+      putByte(&job->dataBuf, (word >> 24) & 0xFF);
+      putByte(&job->dataBuf, (word >> 16) & 0xFF);
+      putByte(&job->dataBuf, (word >> 8) & 0xFF);
+      putByte(&job->dataBuf, word & 0xFF);
       break;
     case SEGMENT_BSS:
       break;
   }
-  segPtr[currSeg] += 4;
+  job->segPtr[job->currSeg] += 4;
 }
 
 
@@ -849,13 +1141,13 @@ Value parsePrimaryExpression(void) {
   Value v;
   Symbol *s;
 
-  if (token == TOK_NUMBER) {
-    v.con = tokenvalNumber;
+  if (job->token == TOK_NUMBER) {
+    v.con = job->tokenvalNumber;
     v.sym = NULL;
     getToken();
   } else
-  if (token == TOK_IDENT) {
-    s = deref(lookupEnter(tokenvalString, LOCAL_TABLE));
+  if (job->token == TOK_IDENT) {
+    s = deref(lookupEnter(job->tokenvalString, LOCAL_TABLE));
     if (s->status == STATUS_DEFINED && s->segment == SEGMENT_ABS) {
       v.con = s->value;
       v.sym = NULL;
@@ -865,13 +1157,13 @@ Value parsePrimaryExpression(void) {
     }
     getToken();
   } else
-  if (token == TOK_LPAREN) {
+  if (job->token == TOK_LPAREN) {
     getToken();
     v = parseExpression();
     expect(TOK_RPAREN);
     getToken();
   } else {
-    error("illegal primary expression, line %d", lineno);
+    error("illegal primary expression, line %d", job->lineno);
   }
   return v;
 }
@@ -880,23 +1172,24 @@ Value parsePrimaryExpression(void) {
 Value parseUnaryExpression(void) {
   Value v;
 
-  if (token == TOK_PLUS) {
+  if (job->token == TOK_PLUS) {
     getToken();
     v = parseUnaryExpression();
   } else
-  if (token == TOK_MINUS) {
+  if (job->token == TOK_MINUS) {
     getToken();
     v = parseUnaryExpression();
     if (v.sym != NULL) {
-      error("cannot negate symbol '%s' in line %d", v.sym->name, lineno);
+      error("cannot negate symbol '%s' in line %d", v.sym->name, job->lineno);
     }
     v.con = -v.con;
   } else
-  if (token == TOK_TILDE) {
+  if (job->token == TOK_TILDE) {
     getToken();
     v = parseUnaryExpression();
     if (v.sym != NULL) {
-      error("cannot complement symbol '%s' in line %d", v.sym->name, lineno);
+      error("cannot complement symbol '%s' in line %d",
+            v.sym->name, job->lineno);
     }
     v.con = ~v.con;
   } else {
@@ -910,34 +1203,36 @@ Value parseMultiplicativeExpression(void) {
   Value v1, v2;
 
   v1 = parseUnaryExpression();
-  while (token == TOK_STAR || token == TOK_SLASH || token == TOK_PERCENT) {
-    if (token == TOK_STAR) {
+  while (job->token == TOK_STAR ||
+         job->token == TOK_SLASH ||
+         job->token == TOK_PERCENT) {
+    if (job->token == TOK_STAR) {
       getToken();
       v2 = parseUnaryExpression();
       if (v1.sym != NULL || v2.sym != NULL) {
-        error("multiplication of symbols not supported, line %d", lineno);
+        error("multiplication of symbols not supported, line %d", job->lineno);
       }
       v1.con *= v2.con;
     } else
-    if (token == TOK_SLASH) {
+    if (job->token == TOK_SLASH) {
       getToken();
       v2 = parseUnaryExpression();
       if (v1.sym != NULL || v2.sym != NULL) {
-        error("division of symbols not supported, line %d", lineno);
+        error("division of symbols not supported, line %d", job->lineno);
       }
       if (v2.con == 0) {
-        error("division by zero, line %d", lineno);
+        error("division by zero, line %d", job->lineno);
       }
       v1.con /= v2.con;
     } else
-    if (token == TOK_PERCENT) {
+    if (job->token == TOK_PERCENT) {
       getToken();
       v2 = parseUnaryExpression();
       if (v1.sym != NULL || v2.sym != NULL) {
-        error("division of symbols not supported, line %d", lineno);
+        error("division of symbols not supported, line %d", job->lineno);
       }
       if (v2.con == 0) {
-        error("division by zero, line %d", lineno);
+        error("division by zero, line %d", job->lineno);
       }
       v1.con %= v2.con;
     }
@@ -950,23 +1245,23 @@ Value parseAdditiveExpression(void) {
   Value v1, v2;
 
   v1 = parseMultiplicativeExpression();
-  while (token == TOK_PLUS || token == TOK_MINUS) {
-    if (token == TOK_PLUS) {
+  while (job->token == TOK_PLUS || job->token == TOK_MINUS) {
+    if (job->token == TOK_PLUS) {
       getToken();
       v2 = parseMultiplicativeExpression();
       if (v1.sym != NULL && v2.sym != NULL) {
-        error("addition of symbols not supported, line %d", lineno);
+        error("addition of symbols not supported, line %d", job->lineno);
       }
       if (v2.sym != NULL) {
         v1.sym = v2.sym;
       }
       v1.con += v2.con;
     } else
-    if (token == TOK_MINUS) {
+    if (job->token == TOK_MINUS) {
       getToken();
       v2 = parseMultiplicativeExpression();
       if (v2.sym != NULL) {
-        error("subtraction of symbols not supported, line %d", lineno);
+        error("subtraction of symbols not supported, line %d", job->lineno);
       }
       v1.con -= v2.con;
     }
@@ -979,20 +1274,20 @@ Value parseShiftExpression(void) {
   Value v1, v2;
 
   v1 = parseAdditiveExpression();
-  while (token == TOK_LSHIFT || token == TOK_RSHIFT) {
-    if (token == TOK_LSHIFT) {
+  while (job->token == TOK_LSHIFT || job->token == TOK_RSHIFT) {
+    if (job->token == TOK_LSHIFT) {
       getToken();
       v2 = parseAdditiveExpression();
       if (v1.sym != NULL || v2.sym != NULL) {
-        error("shifting of symbols not supported, line %d", lineno);
+        error("shifting of symbols not supported, line %d", job->lineno);
       }
       v1.con <<= v2.con;
     } else
-    if (token == TOK_RSHIFT) {
+    if (job->token == TOK_RSHIFT) {
       getToken();
       v2 = parseAdditiveExpression();
       if (v1.sym != NULL || v2.sym != NULL) {
-        error("shifting of symbols not supported, line %d", lineno);
+        error("shifting of symbols not supported, line %d", job->lineno);
       }
       v1.con >>= v2.con;
     }
@@ -1005,11 +1300,11 @@ Value parseAndExpression(void) {
   Value v1, v2;
 
   v1 = parseShiftExpression();
-  while (token == TOK_AMPER) {
+  while (job->token == TOK_AMPER) {
     getToken();
     v2 = parseShiftExpression();
     if (v2.sym != NULL) {
-      error("bitwise 'and' of symbols not supported, line %d", lineno);
+      error("bitwise 'and' of symbols not supported, line %d", job->lineno);
     }
     v1.con &= v2.con;
   }
@@ -1021,11 +1316,11 @@ Value parseExclusiveOrExpression(void) {
   Value v1, v2;
 
   v1 = parseAndExpression();
-  while (token == TOK_CARET) {
+  while (job->token == TOK_CARET) {
     getToken();
     v2 = parseAndExpression();
     if (v2.sym != NULL) {
-      error("bitwise 'xor' of symbols not supported, line %d", lineno);
+      error("bitwise 'xor' of symbols not supported, line %d", job->lineno);
     }
     v1.con ^= v2.con;
   }
@@ -1037,11 +1332,11 @@ Value parseInclusiveOrExpression(void) {
   Value v1, v2;
 
   v1 = parseExclusiveOrExpression();
-  while (token == TOK_BAR) {
+  while (job->token == TOK_BAR) {
     getToken();
     v2 = parseExclusiveOrExpression();
     if (v2.sym != NULL) {
-      error("bitwise 'or' of symbols not supported, line %d", lineno);
+      error("bitwise 'or' of symbols not supported, line %d", job->lineno);
     }
     v1.con |= v2.con;
   }
@@ -1061,27 +1356,27 @@ Value parseExpression(void) {
 
 
 void dotSyn(unsigned int code) {
-  allowSyn = 1;
+  job->allowSyn = 1;
 }
 
 
 void dotNosyn(unsigned int code) {
-  allowSyn = 0;
+  job->allowSyn = 0;
 }
 
 
 void dotCode(unsigned int code) {
-  currSeg = SEGMENT_CODE;
+  job->currSeg = SEGMENT_CODE;
 }
 
 
 void dotData(unsigned int code) {
-  currSeg = SEGMENT_DATA;
+  job->currSeg = SEGMENT_DATA;
 }
 
 
 void dotBss(unsigned int code) {
-  currSeg = SEGMENT_BSS;
+  job->currSeg = SEGMENT_BSS;
 }
 
 
@@ -1092,15 +1387,15 @@ void dotExport(unsigned int code) {
 
   while (1) {
     expect(TOK_IDENT);
-    global = lookupEnter(tokenvalString, GLOBAL_TABLE);
+    global = lookupEnter(job->tokenvalString, GLOBAL_TABLE);
     if (global->status != STATUS_UNKNOWN) {
       error("exported symbol '%s' multiply defined in line %d",
-            global->name, lineno);
+            global->name, job->lineno);
     }
-    local = lookupEnter(tokenvalString, LOCAL_TABLE);
+    local = lookupEnter(job->tokenvalString, LOCAL_TABLE);
     if (local->status == STATUS_GLOBREF) {
       error("exported symbol '%s' multiply exported in line %d",
-            local->name, lineno);
+            local->name, job->lineno);
     }
     global->status = local->status;
     global->segment = local->segment;
@@ -1114,7 +1409,7 @@ void dotExport(unsigned int code) {
     local->status = STATUS_GLOBREF;
     local->globref = global;
     getToken();
-    if (token != TOK_COMMA) {
+    if (job->token != TOK_COMMA) {
       break;
     }
     getToken();
@@ -1129,11 +1424,11 @@ void dotImport(unsigned int code) {
 
   while (1) {
     expect(TOK_IDENT);
-    global = lookupEnter(tokenvalString, GLOBAL_TABLE);
-    local = lookupEnter(tokenvalString, LOCAL_TABLE);
+    global = lookupEnter(job->tokenvalString, GLOBAL_TABLE);
+    local = lookupEnter(job->tokenvalString, LOCAL_TABLE);
     if (local->status != STATUS_UNKNOWN) {
       error("imported symbol '%s' multiply defined in line %d",
-            local->name, lineno);
+            local->name, job->lineno);
     }
     while (local->fixups != NULL) {
       f = local->fixups;
@@ -1144,7 +1439,7 @@ void dotImport(unsigned int code) {
     local->status = STATUS_GLOBREF;
     local->globref = global;
     getToken();
-    if (token != TOK_COMMA) {
+    if (job->token != TOK_COMMA) {
       break;
     }
     getToken();
@@ -1170,13 +1465,17 @@ void dotAlign(unsigned int code) {
 
   v = parseExpression();
   if (v.sym != NULL) {
-    error("absolute expression expected in line %d", lineno);
+    error("absolute expression expected in line %d", job->lineno);
   }
   if (countBits(v.con) != 1) {
-    error("argument must be a power of 2 in line %d", lineno);
+    error("argument must be a power of 2 in line %d", job->lineno);
   }
   mask = v.con - 1;
-  while ((segPtr[currSeg] & mask) != 0) {
+  if (job->currSeg == SEGMENT_CODE && v.con > 4) {
+    /* relaxation would destroy this alignment */
+    job->noRelax = 1;
+  }
+  while ((job->segPtr[job->currSeg] & mask) != 0) {
     emitByte(0);
   }
 }
@@ -1188,7 +1487,7 @@ void dotSpace(unsigned int code) {
 
   v = parseExpression();
   if (v.sym != NULL) {
-    error("absolute expression expected in line %d", lineno);
+    error("absolute expression expected in line %d", job->lineno);
   }
   for (i = 0; i < v.con; i++) {
     emitByte(0);
@@ -1201,9 +1500,13 @@ void dotLocate(unsigned int code) {
 
   v = parseExpression();
   if (v.sym != NULL) {
-    error("absolute expression expected in line %d", lineno);
+    error("absolute expression expected in line %d", job->lineno);
   }
-  while (segPtr[currSeg] != v.con) {
+  if (job->currSeg == SEGMENT_CODE) {
+    /* relaxation would move code away from this location */
+    job->noRelax = 1;
+  }
+  while (job->segPtr[job->currSeg] != v.con) {
     emitByte(0);
   }
 }
@@ -1214,8 +1517,8 @@ void dotByte(unsigned int code) {
   char *p;
 
   while (1) {
-    if (token == TOK_STRING) {
-      p = tokenvalString;
+    if (job->token == TOK_STRING) {
+      p = job->tokenvalString;
       while (*p != '\0') {
         emitByte(*p);
         p++;
@@ -1224,11 +1527,11 @@ void dotByte(unsigned int code) {
     } else {
       v = parseExpression();
       if (v.sym != NULL) {
-        error("absolute expression expected in line %d", lineno);
+        error("absolute expression expected in line %d", job->lineno);
       }
       emitByte(v.con);
     }
-    if (token != TOK_COMMA) {
+    if (job->token != TOK_COMMA) {
       break;
     }
     getToken();
@@ -1242,10 +1545,10 @@ void dotHalf(unsigned int code) {
   while (1) {
     v = parseExpression();
     if (v.sym != NULL) {
-      error("absolute expression expected in line %d", lineno);
+      error("absolute expression expected in line %d", job->lineno);
     }
     emitHalf(v.con);
-    if (token != TOK_COMMA) {
+    if (job->token != TOK_COMMA) {
       break;
     }
     getToken();
@@ -1261,10 +1564,11 @@ void dotWord(unsigned int code) {
     if (v.sym == NULL) {
       emitWord(v.con);
     } else {
-      addFixup(v.sym, currSeg, segPtr[currSeg], RELOC_W32, v.con);
+      addFixup(v.sym, job->currSeg, job->segPtr[job->currSeg],
+               RELOC_W32, v.con);
       emitWord(0);
     }
-    if (token != TOK_COMMA) {
+    if (job->token != TOK_COMMA) {
       break;
     }
     getToken();
@@ -1277,10 +1581,10 @@ void dotSet(unsigned int code) {
   Symbol *symbol;
 
   expect(TOK_IDENT);
-  symbol = deref(lookupEnter(tokenvalString, LOCAL_TABLE));
+  symbol = deref(lookupEnter(job->tokenvalString, LOCAL_TABLE));
   if (symbol->status != STATUS_UNKNOWN) {
     error("symbol '%s' multiply defined in line %d",
-          symbol->name, lineno);
+          symbol->name, job->lineno);
   }
   getToken();
   expect(TOK_COMMA);
@@ -1292,7 +1596,7 @@ void dotSet(unsigned int code) {
     symbol->value = v.con;
   } else {
     error("illegal type of symbol '%s' in expression, line %d",
-          v.sym->name, lineno);
+          v.sym->name, job->lineno);
   }
 }
 
@@ -1302,11 +1606,11 @@ void formatN(unsigned int code) {
   unsigned int immed;
 
   /* opcode with no operands */
-  if (token != TOK_EOL) {
+  if (job->token != TOK_EOL) {
     /* in exceptional cases (trap) there may be one constant operand */
     v = parseExpression();
     if (v.sym != NULL) {
-      error("operand must be a constant, line %d", lineno);
+      error("operand must be a constant, line %d", job->lineno);
     }
     immed = v.con;
   } else {
@@ -1322,7 +1626,7 @@ void formatRH(unsigned int code) {
 
   /* opcode with one register and a half operand */
   expect(TOK_REGISTER);
-  reg = tokenvalNumber;
+  reg = job->tokenvalNumber;
   getToken();
   expect(TOK_COMMA);
   getToken();
@@ -1331,7 +1635,8 @@ void formatRH(unsigned int code) {
     emitHalf(code << 10 | reg);
     emitHalf(v.con);
   } else {
-    addFixup(v.sym, currSeg, segPtr[currSeg], RELOC_L16, v.con);
+    addFixup(v.sym, job->currSeg, job->segPtr[job->currSeg],
+             RELOC_L16, v.con);
     emitHalf(code << 10 | reg);
     emitHalf(0);
   }
@@ -1345,7 +1650,7 @@ void formatRHH(unsigned int code) {
   /* opcode with one register and a half operand */
   /* ATTENTION: high order 16 bits encoded in instruction */
   expect(TOK_REGISTER);
-  reg = tokenvalNumber;
+  reg = job->tokenvalNumber;
   getToken();
   expect(TOK_COMMA);
   getToken();
@@ -1354,7 +1659,8 @@ void formatRHH(unsigned int code) {
     emitHalf(code << 10 | reg);
     emitHalf(v.con >> 16);
   } else {
-    addFixup(v.sym, currSeg, segPtr[currSeg], RELOC_H16, v.con);
+    addFixup(v.sym, job->currSeg, job->segPtr[job->currSeg],
+             RELOC_H16, v.con);
     emitHalf(code << 10 | reg);
     emitHalf(0);
   }
@@ -1367,17 +1673,17 @@ void formatRRH(unsigned int code) {
 
   /* opcode with two registers and a half operand */
   expect(TOK_REGISTER);
-  dst = tokenvalNumber;
+  dst = job->tokenvalNumber;
   getToken();
   expect(TOK_COMMA);
   getToken();
   expect(TOK_REGISTER);
-  src = tokenvalNumber;
+  src = job->tokenvalNumber;
   getToken();
   expect(TOK_COMMA);
   getToken();
   v = parseExpression();
-  if (allowSyn) {
+  if (job->allowSyn) {
     if (v.sym == NULL) {
       if ((v.con & 0xFFFF0000) == 0) {
         /* code: op dst,src,con */
@@ -1396,10 +1702,11 @@ void formatRRH(unsigned int code) {
       }
     } else {
       /* code: ldhi $1,con; or $1,$1,con; add $1,$1,src; op dst,$1,0 */
-      addFixup(v.sym, currSeg, segPtr[currSeg], RELOC_H16, v.con);
+      addRelaxFixup(v.sym, v.con);
       emitHalf(OP_LDHI << 10 | AUX_REG);
       emitHalf(0);
-      addFixup(v.sym, currSeg, segPtr[currSeg], RELOC_L16, v.con);
+      addFixup(v.sym, job->currSeg, job->segPtr[job->currSeg],
+               RELOC_L16, v.con);
       emitHalf((OP_OR + 1) << 10 | AUX_REG << 5 | AUX_REG);
       emitHalf(0);
       emitHalf(OP_ADD << 10 | AUX_REG << 5 | src);
@@ -1412,7 +1719,8 @@ void formatRRH(unsigned int code) {
       emitHalf(code << 10 | src << 5 | dst);
       emitHalf(v.con);
     } else {
-      addFixup(v.sym, currSeg, segPtr[currSeg], RELOC_L16, v.con);
+      addFixup(v.sym, job->currSeg, job->segPtr[job->currSeg],
+               RELOC_L16, v.con);
       emitHalf(code << 10 | src << 5 | dst);
       emitHalf(0);
     }
@@ -1426,17 +1734,17 @@ void formatRRS(unsigned int code) {
 
   /* opcode with two registers and a signed half operand */
   expect(TOK_REGISTER);
-  dst = tokenvalNumber;
+  dst = job->tokenvalNumber;
   getToken();
   expect(TOK_COMMA);
   getToken();
   expect(TOK_REGISTER);
-  src = tokenvalNumber;
+  src = job->tokenvalNumber;
   getToken();
   expect(TOK_COMMA);
   getToken();
   v = parseExpression();
-  if (allowSyn) {
+  if (job->allowSyn) {
     if (v.sym == NULL) {
       if ((v.con & 0xFFFF8000) == 0x00000000 ||
           (v.con & 0xFFFF8000) == 0xFFFF8000) {
@@ -1456,10 +1764,11 @@ void formatRRS(unsigned int code) {
       }
     } else {
       /* code: ldhi $1,con; or $1,$1,con; add $1,$1,src; op dst,$1,0 */
-      addFixup(v.sym, currSeg, segPtr[currSeg], RELOC_H16, v.con);
+      addRelaxFixup(v.sym, v.con);
       emitHalf(OP_LDHI << 10 | AUX_REG);
       emitHalf(0);
-      addFixup(v.sym, currSeg, segPtr[currSeg], RELOC_L16, v.con);
+      addFixup(v.sym, job->currSeg, job->segPtr[job->currSeg],
+               RELOC_L16, v.con);
       emitHalf((OP_OR + 1) << 10 | AUX_REG << 5 | AUX_REG);
       emitHalf(0);
       emitHalf(OP_ADD << 10 | AUX_REG << 5 | src);
@@ -1472,7 +1781,8 @@ void formatRRS(unsigned int code) {
       emitHalf(code << 10 | src << 5 | dst);
       emitHalf(v.con);
     } else {
-      addFixup(v.sym, currSeg, segPtr[currSeg], RELOC_L16, v.con);
+      addFixup(v.sym, job->currSeg, job->segPtr[job->currSeg],
+               RELOC_L16, v.con);
       emitHalf(code << 10 | src << 5 | dst);
       emitHalf(0);
     }
@@ -1485,17 +1795,17 @@ void formatRRR(unsigned int code) {
 
   /* opcode with three register operands */
   expect(TOK_REGISTER);
-  dst = tokenvalNumber;
+  dst = job->tokenvalNumber;
   getToken();
   expect(TOK_COMMA);
   getToken();
   expect(TOK_REGISTER);
-  src1 = tokenvalNumber;
+  src1 = job->tokenvalNumber;
   getToken();
   expect(TOK_COMMA);
   getToken();
   expect(TOK_REGISTER);
-  src2 = tokenvalNumber;
+  src2 = job->tokenvalNumber;
   getToken();
   emitHalf(code << 10 | src1 << 5 | src2);
   emitHalf(dst << 11);
@@ -1509,23 +1819,23 @@ void formatRRX(unsigned int code) {
   /* opcode with three register operands
      or two registers and a half operand */
   expect(TOK_REGISTER);
-  dst = tokenvalNumber;
+  dst = job->tokenvalNumber;
   getToken();
   expect(TOK_COMMA);
   getToken();
   expect(TOK_REGISTER);
-  src1 = tokenvalNumber;
+  src1 = job->tokenvalNumber;
   getToken();
   expect(TOK_COMMA);
   getToken();
-  if (token == TOK_REGISTER) {
-    src2 = tokenvalNumber;
+  if (job->token == TOK_REGISTER) {
+    src2 = job->tokenvalNumber;
     getToken();
     emitHalf(code << 10 | src1 << 5 | src2);
     emitHalf(dst << 11);
   } else {
     v = parseExpression();
-    if (allowSyn) {
+    if (job->allowSyn) {
       if (v.sym == NULL) {
         if ((v.con & 0xFFFF0000) == 0) {
           /* code: op dst,src,con */
@@ -1550,10 +1860,11 @@ void formatRRX(unsigned int code) {
         }
       } else {
         /* code: ldhi $1,con; or $1,$1,con; op dst,src,$1 */
-        addFixup(v.sym, currSeg, segPtr[currSeg], RELOC_H16, v.con);
+        addRelaxFixup(v.sym, v.con);
         emitHalf(OP_LDHI << 10 | AUX_REG);
         emitHalf(0);
-        addFixup(v.sym, currSeg, segPtr[currSeg], RELOC_L16, v.con);
+        addFixup(v.sym, job->currSeg, job->segPtr[job->currSeg],
+                 RELOC_L16, v.con);
         emitHalf((OP_OR + 1) << 10 | AUX_REG << 5 | AUX_REG);
         emitHalf(0);
         emitHalf(code << 10 | src1 << 5 | AUX_REG);
@@ -1564,7 +1875,8 @@ void formatRRX(unsigned int code) {
         emitHalf((code + 1) << 10 | src1 << 5 | dst);
         emitHalf(v.con);
       } else {
-        addFixup(v.sym, currSeg, segPtr[currSeg], RELOC_L16, v.con);
+        addFixup(v.sym, job->currSeg, job->segPtr[job->currSeg],
+                 RELOC_L16, v.con);
         emitHalf((code + 1) << 10 | src1 << 5 | dst);
         emitHalf(0);
       }
@@ -1580,23 +1892,23 @@ void formatRRY(unsigned int code) {
   /* opcode with three register operands
      or two registers and a signed half operand */
   expect(TOK_REGISTER);
-  dst = tokenvalNumber;
+  dst = job->tokenvalNumber;
   getToken();
   expect(TOK_COMMA);
   getToken();
   expect(TOK_REGISTER);
-  src1 = tokenvalNumber;
+  src1 = job->tokenvalNumber;
   getToken();
   expect(TOK_COMMA);
   getToken();
-  if (token == TOK_REGISTER) {
-    src2 = tokenvalNumber;
+  if (job->token == TOK_REGISTER) {
+    src2 = job->tokenvalNumber;
     getToken();
     emitHalf(code << 10 | src1 << 5 | src2);
     emitHalf(dst << 11);
   } else {
     v = parseExpression();
-    if (allowSyn) {
+    if (job->allowSyn) {
       if (v.sym == NULL) {
         if ((v.con & 0xFFFF8000) == 0x00000000 ||
             (v.con & 0xFFFF8000) == 0xFFFF8000) {
@@ -1622,10 +1934,11 @@ void formatRRY(unsigned int code) {
         }
       } else {
         /* code: ldhi $1,con; or $1,$1,con; op dst,src,$1 */
-        addFixup(v.sym, currSeg, segPtr[currSeg], RELOC_H16, v.con);
+        addRelaxFixup(v.sym, v.con);
         emitHalf(OP_LDHI << 10 | AUX_REG);
         emitHalf(0);
-        addFixup(v.sym, currSeg, segPtr[currSeg], RELOC_L16, v.con);
+        addFixup(v.sym, job->currSeg, job->segPtr[job->currSeg],
+                 RELOC_L16, v.con);
         emitHalf((OP_OR + 1) << 10 | AUX_REG << 5 | AUX_REG);
         emitHalf(0);
         emitHalf(code << 10 | src1 << 5 | AUX_REG);
@@ -1636,7 +1949,8 @@ void formatRRY(unsigned int code) {
         emitHalf((code + 1) << 10 | src1 << 5 | dst);
         emitHalf(v.con);
       } else {
-        addFixup(v.sym, currSeg, segPtr[currSeg], RELOC_L16, v.con);
+        addFixup(v.sym, job->currSeg, job->segPtr[job->currSeg],
+                 RELOC_L16, v.con);
         emitHalf((code + 1) << 10 | src1 << 5 | dst);
         emitHalf(0);
       }
@@ -1652,20 +1966,21 @@ void formatRRB(unsigned int code) {
 
   /* opcode with two registers and a 16 bit signed offset operand */
   expect(TOK_REGISTER);
-  src1 = tokenvalNumber;
+  src1 = job->tokenvalNumber;
   getToken();
   expect(TOK_COMMA);
   getToken();
   expect(TOK_REGISTER);
-  src2 = tokenvalNumber;
+  src2 = job->tokenvalNumber;
   getToken();
   expect(TOK_COMMA);
   getToken();
   v = parseExpression();
   if (v.sym == NULL) {
-    immed = (v.con - ((signed) segPtr[currSeg] + 4)) / 4;
+    immed = (v.con - ((signed) job->segPtr[job->currSeg] + 4)) / 4;
   } else {
-    addFixup(v.sym, currSeg, segPtr[currSeg], RELOC_R16, v.con);
+    addFixup(v.sym, job->currSeg, job->segPtr[job->currSeg],
+             RELOC_R16, v.con);
     immed = 0;
   }
   emitHalf(code << 10 | src1 << 5 | src2);
@@ -1680,16 +1995,17 @@ void formatJ(unsigned int code) {
 
   /* opcode with no registers and a 26 bit signed offset operand or
      opcode with a single register */
-  if (token == TOK_REGISTER) {
-    target = tokenvalNumber;
+  if (job->token == TOK_REGISTER) {
+    target = job->tokenvalNumber;
     getToken();
     emitWord((code + 1) << 26 | target << 21);
   } else {
     v = parseExpression();
     if (v.sym == NULL) {
-      immed = (v.con - ((signed) segPtr[currSeg] + 4)) / 4;
+      immed = (v.con - ((signed) job->segPtr[job->currSeg] + 4)) / 4;
     } else {
-      addFixup(v.sym, currSeg, segPtr[currSeg], RELOC_R26, v.con);
+      addFixup(v.sym, job->currSeg, job->segPtr[job->currSeg],
+               RELOC_R26, v.con);
       immed = 0;
     }
     emitWord(code << 26 | (immed & 0x03FFFFFF));
@@ -1702,7 +2018,7 @@ void formatJR(unsigned int code) {
 
   /* opcode with one register operand */
   expect(TOK_REGISTER);
-  target = tokenvalNumber;
+  target = job->tokenvalNumber;
   getToken();
   emitWord(code << 26 | target << 21);
 }
@@ -1810,36 +2126,63 @@ Instr instrTable[] = {
 };
 
 
-static int cmpInstr(const void *instr1, const void *instr2) {
-  return strcmp(((Instr *) instr1)->name, ((Instr *) instr2)->name);
+#define NUM_INSTRS	(sizeof(instrTable) / sizeof(instrTable[0]))
+#define INSTR_HASH_SIZE	1024	/* must be a power of 2 */
+
+
+/*
+ * The instruction table is accessed through a perfect hash:
+ * the hash seed is chosen at startup such that no two
+ * instruction names fall into the same slot. A lookup then
+ * needs a single string compare.
+ */
+
+static unsigned int instrSeed;
+static unsigned char instrHash[INSTR_HASH_SIZE];
+
+
+static unsigned int hashInstr(char *name, unsigned int seed) {
+  unsigned int h;
+
+  h = seed;
+  while (*name != '\0') {
+    h ^= (unsigned char) *name++;
+    h *= 16777619u;
+  }
+  return (h ^ (h >> 15)) & (INSTR_HASH_SIZE - 1);
 }
 
 
-void sortInstrTable(void) {
-  qsort(instrTable, sizeof(instrTable)/sizeof(instrTable[0]),
-        sizeof(instrTable[0]), cmpInstr);
+void buildInstrHash(void) {
+  unsigned int seed;
+  unsigned int i, h;
+
+  for (seed = 2166136261u; ; seed++) {
+    memset(instrHash, 0, sizeof(instrHash));
+    for (i = 0; i < NUM_INSTRS; i++) {
+      h = hashInstr(instrTable[i].name, seed);
+      if (instrHash[h] != 0) {
+        break;
+      }
+      /* slot holds index + 1, 0 means empty */
+      instrHash[h] = i + 1;
+    }
+    if (i == NUM_INSTRS) {
+      break;
+    }
+  }
+  instrSeed = seed;
 }
 
 
 Instr *lookupInstr(char *name) {
-  int lo, hi, tst;
-  int res;
-
-  lo = 0;
-  hi = sizeof(instrTable) / sizeof(instrTable[0]) - 1;
-  while (lo <= hi) {
-    tst = (lo + hi) / 2;
-    res = strcmp(instrTable[tst].name, name);
-    if (res == 0) {
-      return &instrTable[tst];
-    }
-    if (res < 0) {
-      lo = tst + 1;
-    } else {
-      hi = tst - 1;
-    }
+  int i;
+
+  i = instrHash[hashInstr(name, instrSeed)];
+  if (i == 0 || strcmp(instrTable[i - 1].name, name) != 0) {
+    return NULL;
   }
-  return NULL;
+  return &instrTable[i - 1];
 }
 
 
@@ -1850,35 +2193,35 @@ void asmModule(void) {
   Symbol *label;
   Instr *instr;
 
-  allowSyn = 1;
-  currSeg = SEGMENT_CODE;
-  lineno = 0;
-  while (fgets(line, LINE_SIZE, inFile) != NULL) {
-    lineno++;
-    lineptr = line;
+  job->allowSyn = 1;
+  job->currSeg = SEGMENT_CODE;
+  job->lineno = 0;
+  while (fgets(job->line, LINE_SIZE, job->inFile) != NULL) {
+    job->lineno++;
+    job->lineptr = job->line;
     getToken();
-    while (token == TOK_LABEL) {
-      label = deref(lookupEnter(tokenvalString, LOCAL_TABLE));
+    while (job->token == TOK_LABEL) {
+      label = deref(lookupEnter(job->tokenvalString, LOCAL_TABLE));
       if (label->status != STATUS_UNKNOWN) {
         error("label '%s' multiply defined in line %d",
-              label->name, lineno);
+              label->name, job->lineno);
       }
       label->status = STATUS_DEFINED;
-      label->segment = currSeg;
-      label->value = segPtr[currSeg];
+      label->segment = job->currSeg;
+      label->value = job->segPtr[job->currSeg];
       getToken();
     }
-    if (token == TOK_IDENT) {
-      instr = lookupInstr(tokenvalString);
+    if (job->token == TOK_IDENT) {
+      instr = lookupInstr(job->tokenvalString);
       if (instr == NULL) {
         error("unknown instruction '%s' in line %d",
-              tokenvalString, lineno);
+              job->tokenvalString, job->lineno);
       }
       getToken();
       (*instr->func)(instr->code);
     }
-    if (token != TOK_EOL) {
-      error("garbage in line %d", lineno);
+    if (job->token != TOK_EOL) {
+      error("garbage in line %d", job->lineno);
     }
   }
 }
@@ -1927,52 +2270,42 @@ void conv4FromNativeToEco(unsigned char *p) {
 #define BSS_NAME	".bss"
 
 
-static ExecHeader execHeader;
-
-static int fileOffset;
-static int dataSize;
-static int stringSize;
-
-static int nsyms;
-static int nrels;
-
-
 static void writeDummyHeader(void) {
-  fwrite(&execHeader, sizeof(ExecHeader), 1, outFile);
+  fwrite(&job->execHeader, sizeof(ExecHeader), 1, job->outFile);
   /* update file offset */
-  fileOffset += sizeof(ExecHeader);
+  job->fileOffset += sizeof(ExecHeader);
 }
 
 
 static void writeRealHeader(void) {
-  rewind(outFile);
-  execHeader.magic = EXEC_MAGIC;
-  execHeader.entry = 0;
-  conv4FromNativeToEco((unsigned char *) &execHeader.magic);
-  conv4FromNativeToEco((unsigned char *) &execHeader.osegs);
-  conv4FromNativeToEco((unsigned char *) &execHeader.nsegs);
-  conv4FromNativeToEco((unsigned char *) &execHeader.osyms);
-  conv4FromNativeToEco((unsigned char *) &execHeader.nsyms);
-  conv4FromNativeToEco((unsigned char *) &execHeader.orels);
-  conv4FromNativeToEco((unsigned char *) &execHeader.nrels);
-  conv4FromNativeToEco((unsigned char *) &execHeader.odata);
-  conv4FromNativeToEco((unsigned char *) &execHeader.sdata);
-  conv4FromNativeToEco((unsigned char *) &execHeader.ostrs);
-  conv4FromNativeToEco((unsigned char *) &execHeader.sstrs);
-  conv4FromNativeToEco((unsigned char *) &execHeader.entry);
-  fwrite(&execHeader, sizeof(ExecHeader), 1, outFile);
-  conv4FromEcoToNative((unsigned char *) &execHeader.magic);
-  conv4FromEcoToNative((unsigned char *) &execHeader.osegs);
-  conv4FromEcoToNative((unsigned char *) &execHeader.nsegs);
-  conv4FromEcoToNative((unsigned char *) &execHeader.osyms);
-  conv4FromEcoToNative((unsigned char *) &execHeader.nsyms);
-  conv4FromEcoToNative((unsigned char *) &execHeader.orels);
-  conv4FromEcoToNative((unsigned char *) &execHeader.nrels);
-  conv4FromEcoToNative((unsigned char *) &execHeader.odata);
-  conv4FromEcoToNative((unsigned char *) &execHeader.sdata);
-  conv4FromEcoToNative((unsigned char *) &execHeader.ostrs);
-  conv4FromEcoToNative((unsigned char *) &execHeader.sstrs);
-  conv4FromEcoToNative((unsigned char *) &execHeader.entry);
+  rewind(job->outFile);
+  job->execHeader.magic = EXEC_MAGIC;
+  job->execHeader.entry = 0;
+  conv4FromNativeToEco((unsigned char *) &job->execHeader.magic);
+  conv4FromNativeToEco((unsigned char *) &job->execHeader.osegs);
+  conv4FromNativeToEco((unsigned char *) &job->execHeader.nsegs);
+  conv4FromNativeToEco((unsigned char *) &job->execHeader.osyms);
+  conv4FromNativeToEco((unsigned char *) &job->execHeader.nsyms);
+  conv4FromNativeToEco((unsigned char *) &job->execHeader.orels);
+  conv4FromNativeToEco((unsigned char *) &job->execHeader.nrels);
+  conv4FromNativeToEco((unsigned char *) &job->execHeader.odata);
+  conv4FromNativeToEco((unsigned char *) &job->execHeader.sdata);
+  conv4FromNativeToEco((unsigned char *) &job->execHeader.ostrs);
+  conv4FromNativeToEco((unsigned char *) &job->execHeader.sstrs);
+  conv4FromNativeToEco((unsigned char *) &job->execHeader.entry);
+  fwrite(&job->execHeader, sizeof(ExecHeader), 1, job->outFile);
+  conv4FromEcoToNative((unsigned char *) &job->execHeader.magic);
+  conv4FromEcoToNative((unsigned char *) &job->execHeader.osegs);
+  conv4FromEcoToNative((unsigned char *) &job->execHeader.nsegs);
+  conv4FromEcoToNative((unsigned char *) &job->execHeader.osyms);
+  conv4FromEcoToNative((unsigned char *) &job->execHeader.nsyms);
+  conv4FromEcoToNative((unsigned char *) &job->execHeader.orels);
+  conv4FromEcoToNative((unsigned char *) &job->execHeader.nrels);
+  conv4FromEcoToNative((unsigned char *) &job->execHeader.odata);
+  conv4FromEcoToNative((unsigned char *) &job->execHeader.sdata);
+  conv4FromEcoToNative((unsigned char *) &job->execHeader.ostrs);
+  conv4FromEcoToNative((unsigned char *) &job->execHeader.sstrs);
+  conv4FromEcoToNative((unsigned char *) &job->execHeader.entry);
 }
 
 
@@ -1982,7 +2315,7 @@ static void writeSegment(SegmentRecord *p) {
   conv4FromNativeToEco((unsigned char *) &p->addr);
   conv4FromNativeToEco((unsigned char *) &p->size);
   conv4FromNativeToEco((unsigned char *) &p->attr);
-  fwrite(p, sizeof(SegmentRecord), 1, outFile);
+  fwrite(p, sizeof(SegmentRecord), 1, job->outFile);
   conv4FromEcoToNative((unsigned char *) &p->name);
   conv4FromEcoToNative((unsigned char *) &p->offs);
   conv4FromEcoToNative((unsigned char *) &p->addr);
@@ -1995,37 +2328,37 @@ static void writeSegmentTable(void) {
   SegmentRecord segment;
 
   /* record file offset */
-  execHeader.osegs = fileOffset;
+  job->execHeader.osegs = job->fileOffset;
   /* write code segment descriptor */
-  segment.name = stringSize;
-  stringSize += strlen(CODE_NAME) + 1;
-  segment.offs = dataSize;
+  segment.name = job->stringSize;
+  job->stringSize += strlen(CODE_NAME) + 1;
+  segment.offs = job->dataSize;
   segment.addr = 0;
-  segment.size = segPtr[SEGMENT_CODE];
+  segment.size = job->segPtr[SEGMENT_CODE];
   segment.attr = SEG_ATTR_A | SEG_ATTR_P | SEG_ATTR_X;
   writeSegment(&segment);
-  dataSize += segment.size;
+  job->dataSize += segment.size;
   /* write data segment descriptor */
-  segment.name = stringSize;
-  stringSize += strlen(DATA_NAME) + 1;
-  segment.offs = dataSize;
+  segment.name = job->stringSize;
+  job->stringSize += strlen(DATA_NAME) + 1;
+  segment.offs = job->dataSize;
   segment.addr = 0;
-  segment.size = segPtr[SEGMENT_DATA];
+  segment.size = job->segPtr[SEGMENT_DATA];
   segment.attr = SEG_ATTR_A | SEG_ATTR_P | SEG_ATTR_W;
   writeSegment(&segment);
-  dataSize += segment.size;
+  job->dataSize += segment.size;
   /* write bss segment descriptor */
-  segment.name = stringSize;
-  stringSize += strlen(BSS_NAME) + 1;
-  segment.offs = dataSize;
+  segment.name = job->stringSize;
+  job->stringSize += strlen(BSS_NAME) + 1;
+  segment.offs = job->dataSize;
   segment.addr = 0;
-  segment.size = segPtr[SEGMENT_BSS];
+  segment.size = job->segPtr[SEGMENT_BSS];
   segment.attr = SEG_ATTR_A | SEG_ATTR_W;
   writeSegment(&segment);
-  dataSize += 0;  /* segment not present */
+  job->dataSize += 0;  /* segment not present */
   /* update file offset */
-  execHeader.nsegs = 3;
-  fileOffset += execHeader.nsegs * sizeof(SegmentRecord);
+  job->execHeader.nsegs = 3;
+  job->fileOffset += job->execHeader.nsegs * sizeof(SegmentRecord);
 }
 
 
@@ -2036,8 +2369,8 @@ static void writeSymbol(Symbol *s) {
     /* this symbol is neither defined here nor referenced here: skip */
     return;
   }
-  symRec.name = stringSize;
-  stringSize += strlen(s->name) + 1;
+  symRec.name = job->stringSize;
+  job->stringSize += strlen(s->name) + 1;
   if (s->status == STATUS_UNKNOWN) {
     symRec.val = 0;
     symRec.seg = -1;
@@ -2052,24 +2385,24 @@ static void writeSymbol(Symbol *s) {
   conv4FromNativeToEco((unsigned char *) &symRec.val);
   conv4FromNativeToEco((unsigned char *) &symRec.seg);
   conv4FromNativeToEco((unsigned char *) &symRec.attr);
-  fwrite(&symRec, sizeof(SymbolRecord), 1, outFile);
+  fwrite(&symRec, sizeof(SymbolRecord), 1, job->outFile);
   conv4FromEcoToNative((unsigned char *) &symRec.name);
   conv4FromEcoToNative((unsigned char *) &symRec.val);
   conv4FromEcoToNative((unsigned char *) &symRec.seg);
   conv4FromEcoToNative((unsigned char *) &symRec.attr);
-  nsyms++;
+  job->nsyms++;
 }
 
 
 static void writeSymbolTable(void) {
   /* record file offset */
-  execHeader.osyms = fileOffset;
+  job->execHeader.osyms = job->fileOffset;
   /* write symbol table */
-  nsyms = 0;
-  walkTree(globalTable, writeSymbol);
+  job->nsyms = 0;
+  walkGlobals(writeSymbol);
   /* update file offset */
-  execHeader.nsyms = nsyms;
-  fileOffset += execHeader.nsyms * sizeof(SymbolRecord);
+  job->execHeader.nsyms = job->nsyms;
+  job->fileOffset += job->execHeader.nsyms * sizeof(SymbolRecord);
 }
 
 
@@ -2078,10 +2411,10 @@ static void writeRelocTable(void) {
   RelocRecord relRec;
 
   /* record file offset */
-  execHeader.orels = fileOffset;
+  job->execHeader.orels = job->fileOffset;
   /* write reloc table */
-  nrels = 0;
-  f = fixupList;
+  job->nrels = 0;
+  f = job->fixupList;
   while (f != NULL) {
     if (f->segment != SEGMENT_CODE && f->segment != SEGMENT_DATA) {
       /* this should never happen */
@@ -2091,6 +2424,9 @@ static void writeRelocTable(void) {
     /* change (.code, .data) from (1, 2) to (0, 1) */
     relRec.seg = f->segment - 1;
     relRec.typ = f->method;
+    if (f->relax && !job->noRelax) {
+      relRec.typ |= RELOC_RLX;
+    }
     /* 'typ' knows if a symbol or a segment is referenced */
     if (f->base & MSB) {
       /* it's a symbol */
@@ -2110,44 +2446,35 @@ static void writeRelocTable(void) {
     conv4FromNativeToEco((unsigned char *) &relRec.typ);
     conv4FromNativeToEco((unsigned char *) &relRec.ref);
     conv4FromNativeToEco((unsigned char *) &relRec.add);
-    fwrite(&relRec, sizeof(RelocRecord), 1, outFile);
+    fwrite(&relRec, sizeof(RelocRecord), 1, job->outFile);
     conv4FromEcoToNative((unsigned char *) &relRec.loc);
     conv4FromEcoToNative((unsigned char *) &relRec.seg);
     conv4FromEcoToNative((unsigned char *) &relRec.typ);
     conv4FromEcoToNative((unsigned char *) &relRec.ref);
     conv4FromEcoToNative((unsigned char *) &relRec.add);
-    nrels++;
+    job->nrels++;
     f = f->next;
   }
   /* update file offset */
-  execHeader.nrels = nrels;
-  fileOffset += execHeader.nrels * sizeof(RelocRecord);
+  job->execHeader.nrels = job->nrels;
+  job->fileOffset += job->execHeader.nrels * sizeof(RelocRecord);
 }
 
 
-static void writeBytes(FILE *file) {
-  int data;
-
-  rewind(file);
-  while (1) {
-    data = fgetc(file);
-    if (data == EOF) {
-      break;
-    }
-    fputc(data, outFile);
-  }
+static void writeBytes(Buffer *b) {
+  fwrite(b->data, 1, b->size, job->outFile);
 }
 
 
 static void writeData(void) {
   /* record file offset */
-  execHeader.odata = fileOffset;
+  job->execHeader.odata = job->fileOffset;
   /* write segment data */
-  writeBytes(codeFile);
-  writeBytes(dataFile);
+  writeBytes(&job->codeBuf);
+  writeBytes(&job->dataBuf);
   /* update file offset */
-  execHeader.sdata = dataSize;
-  fileOffset += execHeader.sdata;
+  job->execHeader.sdata = job->dataSize;
+  job->fileOffset += job->execHeader.sdata;
 }
 
 
@@ -2156,33 +2483,33 @@ static void writeString(Symbol *s) {
     /* this symbol is neither defined here nor referenced here: skip */
     return;
   }
-  fputs(s->name, outFile);
-  fputc('\0', outFile);
+  fputs(s->name, job->outFile);
+  fputc('\0', job->outFile);
 }
 
 
 static void writeStrings(void) {
   /* record file offset */
-  execHeader.ostrs = fileOffset;
+  job->execHeader.ostrs = job->fileOffset;
   /* write segment names */
-  fputs(CODE_NAME, outFile);
-  fputc('\0', outFile);
-  fputs(DATA_NAME, outFile);
-  fputc('\0', outFile);
-  fputs(BSS_NAME, outFile);
-  fputc('\0', outFile);
+  fputs(CODE_NAME, job->outFile);
+  fputc('\0', job->outFile);
+  fputs(DATA_NAME, job->outFile);
+  fputc('\0', job->outFile);
+  fputs(BSS_NAME, job->outFile);
+  fputc('\0', job->outFile);
   /* write symbol names */
-  walkTree(globalTable, writeString);
+  walkGlobals(writeString);
   /* update file offsets */
-  execHeader.sstrs = stringSize;
-  fileOffset += execHeader.sstrs;
+  job->execHeader.sstrs = job->stringSize;
+  job->fileOffset += job->execHeader.sstrs;
 }
 
 
 void writeAll(void) {
-  fileOffset = 0;
-  dataSize = 0;
-  stringSize = 0;
+  job->fileOffset = 0;
+  job->dataSize = 0;
+  job->stringSize = 0;
   writeDummyHeader();
   writeSegmentTable();
   writeSymbolTable();
@@ -2196,10 +2523,258 @@ void writeAll(void) {
 /**************************************************************/
 
 
+void initJob(Job *j, char *outName, char **inNames, int numInNames) {
+  memset(j, 0, sizeof(Job));
+  j->outName = outName;
+  j->inNames = inNames;
+  j->numInNames = numInNames;
+}
+
+
+static void releaseJob(void) {
+  freeMemory(job->codeBuf.data);
+  freeMemory(job->dataBuf.data);
+  freeMemory(job->nameTable.names);
+  freeMemory(job->nameTable.hashes);
+  freeMemory(job->globalTable.slots);
+  freeMemory(job->localTable.slots);
+  freeMemory(job->sortedGlobals);
+  arenaFree(&job->permArena);
+  arenaFree(&job->localArena);
+}
+
+
+/*
+ * Run the peephole optimizer over the current source file.
+ * The assembler then reads the optimized text from a temporary
+ * file, which is numbered in the same way as the original.
+ */
+static void optimizeSource(void) {
+  FILE *tmp;
+
+  tmp = tmpfile();
+  if (tmp == NULL) {
+    error("cannot create temporary file for '%s'", job->inName);
+  }
+  peephole(job->inFile, tmp, job->peepStats);
+  fclose(job->inFile);
+  rewind(tmp);
+  job->inFile = tmp;
+}
+
+
+void runJob(Job *j) {
+  int i;
+
+  job = j;
+  job->globalTable.arena = &job->permArena;
+  job->localTable.arena = &job->localArena;
+  if (setjmp(job->errorExit) == 0) {
+    job->outFile = fopen(job->outName, "wb");
+    if (job->outFile == NULL) {
+      error("cannot open output file '%s'", job->outName);
+    }
+    for (i = 0; i < job->numInNames; i++) {
+      job->inName = job->inNames[i];
+      if (strcmp(job->inName, "-") == 0) {
+        job->inFile = stdin;
+      } else {
+        job->inFile = fopen(job->inName, "rt");
+      }
+      if (job->inFile == NULL) {
+        error("cannot open input file '%s'", job->inName);
+      }
+      if (optimize) {
+        optimizeSource();
+      }
+      if (debugModule) {
+        fprintf(stderr, "Assembling module '%s'...\n", job->inName);
+      }
+      asmModule();
+      if (job->inFile != NULL) {
+        fclose(job->inFile);
+        job->inFile = NULL;
+      }
+      linkLocals();
+    }
+    transferFixups();
+    writeAll();
+    closeFiles();
+  }
+  releaseJob();
+  job = NULL;
+}
+
+
+/**************************************************************/
+
+
+static Job *jobs = NULL;
+static int numJobs = 0;
+static int maxJobs = 0;
+static int nextJob = 0;
+static pthread_mutex_t jobLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+Job *newJob(void) {
+  Job *p;
+
+  if (numJobs == maxJobs) {
+    maxJobs = maxJobs == 0 ? 16 : 2 * maxJobs;
+    p = allocateMemory(maxJobs * sizeof(Job));
+    if (numJobs != 0) {
+      memcpy(p, jobs, numJobs * sizeof(Job));
+      freeMemory(jobs);
+    }
+    jobs = p;
+  }
+  return &jobs[numJobs++];
+}
+
+
+char *copyString(char *str) {
+  char *p;
+
+  p = allocateMemory(strlen(str) + 1);
+  strcpy(p, str);
+  return p;
+}
+
+
+char *objectName(char *srcName) {
+  char *p;
+  int n;
+
+  /* replace a ".s" suffix by ".o", or append ".o" */
+  n = strlen(srcName);
+  if (n > 2 && strcmp(srcName + n - 2, ".s") == 0) {
+    n -= 2;
+  }
+  p = allocateMemory(n + 3);
+  memcpy(p, srcName, n);
+  strcpy(p + n, ".o");
+  return p;
+}
+
+
+void addJob(char *srcName, char *objName) {
+  char **names;
+
+  names = allocateMemory(sizeof(char *));
+  names[0] = srcName;
+  if (objName == NULL) {
+    objName = objectName(srcName);
+  }
+  initJob(newJob(), objName, names, 1);
+}
+
+
+void readResponseFile(char *respName) {
+  FILE *respFile;
+  char buf[LINE_SIZE];
+  char *src, *obj;
+  int lineno;
+
+  respFile = fopen(respName, "rt");
+  if (respFile == NULL) {
+    error("cannot open response file '%s'", respName);
+  }
+  lineno = 0;
+  while (fgets(buf, LINE_SIZE, respFile) != NULL) {
+    lineno++;
+    src = strtok(buf, " \t\r\n");
+    if (src == NULL || *src == '#') {
+      /* empty line or comment */
+      continue;
+    }
+    obj = strtok(NULL, " \t\r\n");
+    if (obj != NULL && strtok(NULL, " \t\r\n") != NULL) {
+      error("garbage in line %d of response file '%s'", lineno, respName);
+    }
+    addJob(copyString(src), obj == NULL ? NULL : copyString(obj));
+  }
+  fclose(respFile);
+}
+
+
+static void *worker(void *arg) {
+  int k;
+
+  while (1) {
+    pthread_mutex_lock(&jobLock);
+    k = nextJob++;
+    pthread_mutex_unlock(&jobLock);
+    if (k >= numJobs) {
+      break;
+    }
+    runJob(&jobs[k]);
+  }
+  return NULL;
+}
+
+
+void runAllJobs(int numThreads) {
+  pthread_t *threads;
+  int i;
+
+  if (numThreads > numJobs) {
+    numThreads = numJobs;
+  }
+  nextJob = 0;
+  if (numThreads <= 1) {
+    worker(NULL);
+    return;
+  }
+  threads = allocateMemory(numThreads * sizeof(pthread_t));
+  for (i = 0; i < numThreads; i++) {
+    if (pthread_create(&threads[i], NULL, worker, NULL) != 0) {
+      error("cannot create worker thread");
+    }
+  }
+  for (i = 0; i < numThreads; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  freeMemory(threads);
+}
+
+
+/**************************************************************/
+
+
+void showPeephole(void) {
+  unsigned int total;
+  int i, k;
+
+  fprintf(stderr, "Peephole optimizer:\n");
+  for (k = 0; k < PEEP_NUM_RULES; k++) {
+    total = 0;
+    for (i = 0; i < numJobs; i++) {
+      total += jobs[i].peepStats[k];
+    }
+    fprintf(stderr, "    %-24s %8u\n", peepRuleName[k], total);
+  }
+}
+
+
 void usage(char *myself) {
   fprintf(stderr, "Usage: %s\n", myself);
   fprintf(stderr, "         [-o objfile]     set object file name\n");
-  fprintf(stderr, "         file             source file name\n");
+  fprintf(stderr, "         [-m]             assemble each source file "
+                  "separately,\n");
+  fprintf(stderr, "                          objfile is srcfile with "
+                  "suffix '.o'\n");
+  fprintf(stderr, "         [-r respfile]    read pairs of source and "
+                  "object file\n");
+  fprintf(stderr, "                          names from respfile "
+                  "(implies -m)\n");
+  fprintf(stderr, "         [-j n]           use n threads with -m "
+                  "(default: #cpus)\n");
+  fprintf(stderr, "         [-O]             run the peephole optimizer "
+                  "over the sources\n");
+  fprintf(stderr, "         [-p]             show what the peephole "
+                  "optimizer did\n");
+  fprintf(stderr, "         file             source file name "
+                  "('-' is stdin)\n");
   fprintf(stderr, "         [files...]       additional source files\n");
   exit(1);
 }
@@ -2208,14 +2783,17 @@ void usage(char *myself) {
 int main(int argc, char *argv[]) {
   int i;
   char *argp;
-
-  sortInstrTable();
-  tmpnam(codeName);
-  tmpnam(dataName);
-  outName = "a.out";
+  char *outName;
+  int numThreads;
+  char *endp;
+  int failed;
+
+  buildInstrHash();
+  outName = NULL;
+  numThreads = sysconf(_SC_NPROCESSORS_ONLN);
   for (i = 1; i < argc; i++) {
     argp = argv[i];
-    if (*argp != '-') {
+    if (*argp != '-' || argp[1] == '\0') {
       break;
     }
     argp++;
@@ -2226,63 +2804,69 @@ int main(int argc, char *argv[]) {
         }
         outName = argv[++i];
         break;
+      case 'm':
+        multiJob = 1;
+        break;
+      case 'r':
+        if (i == argc - 1) {
+          usage(argv[0]);
+        }
+        multiJob = 1;
+        readResponseFile(argv[++i]);
+        break;
+      case 'j':
+        if (i == argc - 1) {
+          usage(argv[0]);
+        }
+        numThreads = strtol(argv[++i], &endp, 0);
+        if (*endp != '\0' || numThreads <= 0) {
+          error("illegal number of threads '%s'", argv[i]);
+        }
+        break;
+      case 'O':
+        optimize = 1;
+        break;
+      case 'p':
+        showPeepStats = 1;
+        break;
       default:
         usage(argv[0]);
     }
   }
-  if (i == argc) {
-    usage(argv[0]);
-  }
-  codeFile = fopen(codeName, "w+b");
-  if (codeFile == NULL) {
-    error("cannot create temporary code file '%s'", codeName);
-  }
-  dataFile = fopen(dataName, "w+b");
-  if (dataFile == NULL) {
-    error("cannot create temporary data file '%s'", dataName);
-  }
-  outFile = fopen(outName, "wb");
-  if (outFile == NULL) {
-    error("cannot open output file '%s'", outName);
-  }
-  do {
-    inName = argv[i];
-    if (*inName == '-') {
+  for (; i < argc; i++) {
+    if (*argv[i] == '-' && argv[i][1] != '\0') {
       usage(argv[0]);
     }
-    inFile = fopen(inName, "rt");
-    if (inFile == NULL) {
-      error("cannot open input file '%s'", inName);
+    if (!multiJob) {
+      break;
     }
-    if (debugModule) {
-      fprintf(stderr, "Assembling module '%s'...\n", inName);
+    addJob(argv[i], NULL);
+  }
+  if (multiJob) {
+    if (outName != NULL) {
+      usage(argv[0]);
     }
-    asmModule();
-    if (inFile != NULL) {
-      fclose(inFile);
-      inFile = NULL;
+  } else {
+    if (i == argc) {
+      usage(argv[0]);
     }
-    linkLocals();
-  } while (++i < argc);
-  transferFixups();
-  writeAll();
-  if (codeFile != NULL) {
-    fclose(codeFile);
-    codeFile = NULL;
+    /* all source files go into a single object file */
+    initJob(newJob(), outName == NULL ? "a.out" : outName,
+            &argv[i], argc - i);
+    numThreads = 1;
   }
-  if (dataFile != NULL) {
-    fclose(dataFile);
-    dataFile = NULL;
-  }
-  if (outFile != NULL) {
-    fclose(outFile);
-    outFile = NULL;
+  if (numJobs == 0) {
+    usage(argv[0]);
   }
-  if (codeName != NULL) {
-    unlink(codeName);
+  runAllJobs(numThreads);
+  failed = 0;
+  for (i = 0; i < numJobs; i++) {
+    if (jobs[i].failed) {
+      failed = 1;
+    }
   }
-  if (dataName != NULL) {
-    unlink(dataName);
+  if (optimize && showPeepStats) {
+    showPeephole();
   }
-  return 0;
+  return failed;
 }
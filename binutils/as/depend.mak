@@ -0,0 +1,2 @@
+as.o: as.c ../include/a.out.h ../peep/peep.h
+peep.o: ../peep/peep.c ../peep/peep.h
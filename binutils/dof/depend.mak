@@ -0,0 +1 @@
+dof.o: dof.c ../include/a.out.h
@@ -354,7 +354,7 @@ void dumpRelocTable(void) {
     printf("        loc  = 0x%08X\n", relocTable[rn].loc);
     printf("        seg  = %d\n", relocTable[rn].seg);
     printf("        typ  = ");
-    switch (relocTable[rn].typ & ~RELOC_SYM) {
+    switch (relocTable[rn].typ & ~(RELOC_SYM | RELOC_RLX)) {
       case RELOC_H16:
         printf("H16");
         break;
@@ -374,6 +374,9 @@ void dumpRelocTable(void) {
         printf("\n");
         error("unknown relocation type 0x%08X", relocTable[rn].typ);
     }
+    if (relocTable[rn].typ & RELOC_RLX) {
+      printf(", relaxable");
+    }
     printf("\n");
     printf("        ref  = %s # %d\n",
            relocTable[rn].typ & RELOC_SYM ? "symbol" : "segment",
@@ -22,6 +22,9 @@
 #define RELOC_R26	3	/* write 26 bits with value relative to PC */
 #define RELOC_W32	4	/* write full 32 bit word with value */
 #define RELOC_SYM	0x100	/* symbol flag, may be added to any RELOC */
+#define RELOC_RLX	0x200	/* relax flag, marks a RELOC_H16 which */
+				/* starts a synthetic instruction sequence */
+				/* that the linker may shorten */
 
 
 typedef struct {
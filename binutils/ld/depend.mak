@@ -0,0 +1,2 @@
+ld.o: ld.c ../include/a.out.h ../include/ar.h script/utils.h \
+ script/readscript.h script/script.h
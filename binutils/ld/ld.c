@@ -35,6 +35,10 @@ int debugSearch = 0;
 int debugModules = 0;
 int debugSegments = 0;
 int debugResolve = 0;
+int debugRelax = 0;
+
+int gcSegments = 0;
+int relaxCode = 0;
 
 
 /**************************************************************/
@@ -80,6 +84,7 @@ typedef struct module {
   struct sym **syms;		/* array of pointers to symbols */
   int nrels;			/* number of relocations */
   RelocRecord *rels;		/* array of relocations */
+  char *keep;			/* segment is kept in output (--gc) */
   struct module *next;		/* next module, order is important */
 } Module;
 
@@ -255,6 +260,7 @@ Module *newModule(char *name) {
   mod->syms = NULL;
   mod->nrels = 0;
   mod->rels = NULL;
+  mod->keep = NULL;
   mod->next = NULL;
   if (firstModule == NULL) {
     firstModule = mod;
@@ -692,6 +698,8 @@ void readObjModule(char *name, unsigned int inOff,
   mod->nrels = hdr.nrels;
   mod->rels = memAlloc(hdr.nrels * sizeof(RelocRecord));
   readObjRelocations(mod, inOff + hdr.orels, inFile, inPath);
+  mod->keep = memAlloc(hdr.nsegs);
+  memset(mod->keep, 1, hdr.nsegs);
 }
 
 
@@ -1092,7 +1100,7 @@ void doOsegStm(ScriptNode *stm) {
  */
 static Module scriptModule = {
   "linker script",
-  NULL, NULL, 0, NULL, 0, NULL, 0, NULL, NULL
+  NULL, NULL, 0, NULL, 0, NULL, 0, NULL, NULL, NULL
 };
 
 
@@ -1150,6 +1158,158 @@ void doStm(ScriptNode *stm) {
 }
 
 
+/**************************************************************/
+
+/*
+ * garbage collection of unreferenced segments
+ */
+
+
+typedef struct {
+  Module *mod;
+  int seg;
+} SegRef;
+
+
+static SegRef *gcStack;
+static int gcStackTop;
+
+
+int isRemoved(Sym *sym) {
+  return sym->mod != NULL &&
+         sym->mod != &scriptModule &&
+         sym->seg != -1 &&
+         !sym->mod->keep[sym->seg];
+}
+
+
+static void markSegment(Module *mod, int seg) {
+  if (mod->keep[seg]) {
+    return;
+  }
+  mod->keep[seg] = 1;
+  gcStack[gcStackTop].mod = mod;
+  gcStack[gcStackTop].seg = seg;
+  gcStackTop++;
+}
+
+
+static void markReferences(Module *mod, int seg) {
+  int i;
+  RelocRecord *rel;
+  Sym *sym;
+
+  for (i = 0; i < mod->nrels; i++) {
+    rel = mod->rels + i;
+    if (rel->seg != seg) {
+      continue;
+    }
+    if (rel->typ & RELOC_SYM) {
+      sym = mod->syms[rel->ref];
+      if (sym->mod != NULL &&
+          sym->mod != &scriptModule &&
+          sym->seg != -1) {
+        markSegment(sym->mod, sym->seg);
+      }
+    } else {
+      markSegment(mod, rel->ref);
+    }
+  }
+}
+
+
+static char *findEntryName(ScriptNode *stm) {
+  char *name;
+
+  while (stm != NULL) {
+    if (stm->u.stmList.head->type == NODE_ENTRYSTM) {
+      return stm->u.stmList.head->u.entryStm.name;
+    }
+    if (stm->u.stmList.head->type == NODE_OSEGSTM) {
+      name = findEntryName(stm->u.stmList.head->u.osegStm.stms);
+      if (name != NULL) {
+        return name;
+      }
+    }
+    stm = stm->u.stmList.tail;
+  }
+  return NULL;
+}
+
+
+void collectGarbage(ScriptNode *script) {
+  char *entryName;
+  Sym *sym;
+  Module *mod;
+  int numSegs;
+  int i;
+  int modRemoved;
+  unsigned int segBytes;
+  unsigned int modBytes;
+  unsigned int totalBytes;
+  SegRef *ref;
+
+  entryName = findEntryName(script);
+  if (entryName == NULL) {
+    warning("no entry symbol in linker script, --gc ignored");
+    return;
+  }
+  sym = lookupSymbol(entryName);
+  if (sym == NULL ||
+      sym->mod == NULL ||
+      sym->mod == &scriptModule ||
+      sym->seg == -1) {
+    warning("entry symbol '%s' is not defined in a segment, --gc ignored",
+            entryName);
+    return;
+  }
+  /* unmark all segments, count them */
+  numSegs = 0;
+  mod = firstModule;
+  while (mod != NULL) {
+    memset(mod->keep, 0, mod->nsegs);
+    numSegs += mod->nsegs;
+    mod = mod->next;
+  }
+  /* mark all segments reachable from the entry symbol */
+  gcStack = memAlloc(numSegs * sizeof(SegRef));
+  gcStackTop = 0;
+  markSegment(sym->mod, sym->seg);
+  while (gcStackTop > 0) {
+    ref = &gcStack[--gcStackTop];
+    markReferences(ref->mod, ref->seg);
+  }
+  memFree(gcStack);
+  /* report what is removed */
+  totalBytes = 0;
+  mod = firstModule;
+  while (mod != NULL) {
+    modRemoved = 1;
+    modBytes = 0;
+    for (i = 0; i < mod->nsegs; i++) {
+      if (mod->keep[i]) {
+        modRemoved = 0;
+        continue;
+      }
+      segBytes = WORD_ALIGN(mod->segs[i].size);
+      modBytes += segBytes;
+      if (segBytes != 0) {
+        fprintf(stderr, "gc: removing segment '%s' of module '%s' "
+                "(%u bytes)\n",
+                mod->strs + mod->segs[i].name, mod->name, segBytes);
+      }
+    }
+    if (modRemoved) {
+      fprintf(stderr, "gc: module '%s' removed completely\n",
+              mod->name);
+    }
+    totalBytes += modBytes;
+    mod = mod->next;
+  }
+  fprintf(stderr, "gc: %u bytes removed\n", totalBytes);
+}
+
+
 /**************************************************************/
 
 
@@ -1184,7 +1344,7 @@ void buildIgrpTbl(ScriptNode *script) {
 }
 
 
-void setRelSegAddrs(void) {
+void setRelSegAddrs(int warn) {
   Module *mod;
   int i;
   char *segName;
@@ -1193,12 +1353,18 @@ void setRelSegAddrs(void) {
   mod = firstModule;
   while (mod != NULL) {
     for (i = 0; i < mod->nsegs; i++) {
+      if (!mod->keep[i]) {
+        /* segment has been removed by garbage collection */
+        continue;
+      }
       segName = mod->strs + mod->segs[i].name;
       igrp = lookupIgrp(segName);
       if (igrp == NULL) {
         /* input segment name does not match any ISEG name in script */
-        warning("discarding segment '%s' from module '%s'",
-                segName, mod->name);
+        if (warn) {
+          warning("discarding segment '%s' from module '%s'",
+                  segName, mod->name);
+        }
       } else {
         /* set segment's relative address in group */
         mod->segs[i].addr = igrp->size;
@@ -1223,6 +1389,9 @@ void setAbsSegAddrs(void) {
   mod = firstModule;
   while (mod != NULL) {
     for (i = 0; i < mod->nsegs; i++) {
+      if (!mod->keep[i]) {
+        continue;
+      }
       segName = mod->strs + mod->segs[i].name;
       igrp = lookupIgrp(segName);
       if (igrp != NULL) {
@@ -1241,7 +1410,7 @@ void allocateStorage(ScriptNode *script) {
   buildIgrpTbl(script);
   /* set group relative addresses of all input segments,
      compute total sizes of all groups */
-  setRelSegAddrs();
+  setRelSegAddrs(1);
   /* set group start and output segment addresses by
      working through the linker script */
   dot = 0;
@@ -1252,6 +1421,390 @@ void allocateStorage(ScriptNode *script) {
 }
 
 
+static void undefineScriptSymbol(Sym *sym, void *arg) {
+  if (sym->mod == &scriptModule) {
+    sym->mod = NULL;
+    sym->seg = -1;
+    sym->val = 0;
+    sym->attr = SYM_ATTR_U;
+  }
+}
+
+
+void reallocateStorage(ScriptNode *script) {
+  Oseg *oseg;
+  Igrp *igrp;
+  Iseg *iseg;
+
+  /* empty all groups */
+  oseg = firstOseg;
+  while (oseg != NULL) {
+    igrp = oseg->firstIgrp;
+    while (igrp != NULL) {
+      while (igrp->firstIseg != NULL) {
+        iseg = igrp->firstIseg;
+        igrp->firstIseg = iseg->next;
+        memFree(iseg);
+      }
+      igrp->lastIseg = NULL;
+      igrp->addr = 0;
+      igrp->size = 0;
+      igrp = igrp->next;
+    }
+    oseg = oseg->next;
+  }
+  /* the script defines its symbols once more */
+  mapOverSymbols(undefineScriptSymbol, NULL);
+  /* then lay out everything as before */
+  setRelSegAddrs(0);
+  dot = 0;
+  entry = NULL;
+  doStm(script);
+  setAbsSegAddrs();
+}
+
+
+/**************************************************************/
+
+/*
+ * relaxation of synthetic instruction sequences
+ *
+ * The assembler expands an instruction with a symbolic 16 bit
+ * operand into one of the sequences
+ *
+ *   ldhi $1,sym; or $1,$1,sym; op dst,src,$1
+ *   ldhi $1,sym; or $1,$1,sym; add $1,$1,src; op dst,$1,0
+ *
+ * and marks the H16 relocation of the ldhi with RELOC_RLX.
+ * If the final value of sym fits into the 16 bit immediate
+ * field of op, the sequence is replaced by a single instruction
+ * and the rest of the segment is moved down. As this may bring
+ * other values into reach, layout and relaxation are repeated
+ * until nothing changes. Values only get smaller in this
+ * process, so a relaxed instruction always stays valid. For
+ * the same reason, negative immediates are never used.
+ */
+
+
+#define OP_ADD		0x00
+#define OP_ORI		0x13
+#define OP_LDHI		0x1F
+#define OP_LDW		0x30
+#define OP_STB		0x37
+#define OP_LDLW		0x3E
+#define OP_STCW		0x3F
+
+#define AUX_REG		1
+
+
+typedef struct {
+  int seg;			/* segment in which bytes are cut out */
+  unsigned int off;		/* offset of first byte cut out */
+  unsigned int size;		/* number of bytes cut out */
+  unsigned int total;		/* bytes cut out in segment up to here */
+} Cut;
+
+
+static Module *relaxMod;
+static Cut *cuts;
+static int numCuts;
+
+
+static int compareRelocs(const void *p1, const void *p2) {
+  RelocRecord *rel1;
+  RelocRecord *rel2;
+
+  rel1 = relaxMod->rels + *(int *) p1;
+  rel2 = relaxMod->rels + *(int *) p2;
+  if (rel1->seg != rel2->seg) {
+    return rel1->seg < rel2->seg ? -1 : 1;
+  }
+  if (rel1->loc != rel2->loc) {
+    return rel1->loc < rel2->loc ? -1 : 1;
+  }
+  return 0;
+}
+
+
+static int compareCuts(const void *p1, const void *p2) {
+  Cut *cut1;
+  Cut *cut2;
+
+  cut1 = (Cut *) p1;
+  cut2 = (Cut *) p2;
+  if (cut1->seg != cut2->seg) {
+    return cut1->seg < cut2->seg ? -1 : 1;
+  }
+  if (cut1->off != cut2->off) {
+    return cut1->off < cut2->off ? -1 : 1;
+  }
+  return 0;
+}
+
+
+static int findReloc(int *order, int seg, unsigned int loc) {
+  int lo, hi, tst;
+  RelocRecord *rel;
+
+  lo = 0;
+  hi = relaxMod->nrels - 1;
+  while (lo <= hi) {
+    tst = (lo + hi) / 2;
+    rel = relaxMod->rels + order[tst];
+    if (rel->seg == seg && rel->loc == loc) {
+      return order[tst];
+    }
+    if (rel->seg < seg || (rel->seg == seg && rel->loc < loc)) {
+      lo = tst + 1;
+    } else {
+      hi = tst - 1;
+    }
+  }
+  return -1;
+}
+
+
+static unsigned int moveDown(int seg, unsigned int off) {
+  int lo, hi, tst;
+  int found;
+
+  /* find the last cut in seg which ends at or before off */
+  found = -1;
+  lo = 0;
+  hi = numCuts - 1;
+  while (lo <= hi) {
+    tst = (lo + hi) / 2;
+    if (cuts[tst].seg < seg ||
+        (cuts[tst].seg == seg && cuts[tst].off + cuts[tst].size <= off)) {
+      if (cuts[tst].seg == seg) {
+        found = tst;
+      }
+      lo = tst + 1;
+    } else {
+      hi = tst - 1;
+    }
+  }
+  if (found < 0) {
+    return off;
+  }
+  return off - cuts[found].total;
+}
+
+
+static unsigned int relaxedInstr(unsigned char *code, unsigned int avail,
+                                 unsigned int value, unsigned int *size) {
+  unsigned int w0, w1, w2, w3;
+  unsigned int op, src, dst;
+  int isSigned;
+
+  if (avail < 12) {
+    return 0;
+  }
+  w0 = read4FromEco(code + 0);
+  w1 = read4FromEco(code + 4);
+  w2 = read4FromEco(code + 8);
+  if ((w0 & 0xFFFF0000) != (OP_LDHI << 26 | AUX_REG << 16) ||
+      (w1 & 0xFFFF0000) != (OP_ORI << 26 | AUX_REG << 21 | AUX_REG << 16)) {
+    return 0;
+  }
+  op = w2 >> 26;
+  if (op == OP_ADD &&
+      ((w2 >> 21) & 0x1F) == AUX_REG &&
+      (w2 & 0xFFFF) == (AUX_REG << 11) &&
+      avail >= 16) {
+    /* ldhi $1,sym; or $1,$1,sym; add $1,$1,src; op dst,$1,0 */
+    w3 = read4FromEco(code + 12);
+    op = w3 >> 26;
+    src = (w2 >> 16) & 0x1F;
+    dst = (w3 >> 16) & 0x1F;
+    if (((w3 >> 21) & 0x1F) != AUX_REG ||
+        (w3 & 0xFFFF) != 0 ||
+        src == AUX_REG ||
+        !((op >= OP_LDW && op <= OP_STB) ||
+          op == OP_LDLW || op == OP_STCW)) {
+      return 0;
+    }
+    /* loads and stores have a signed offset */
+    if (value > 0x7FFF) {
+      return 0;
+    }
+    *size = 12;
+    return op << 26 | src << 21 | dst << 16;
+  }
+  /* ldhi $1,sym; or $1,$1,sym; op dst,src,$1 */
+  src = (w2 >> 21) & 0x1F;
+  dst = (w2 >> 11) & 0x1F;
+  if ((op & 1) != 0 || op > 0x1C ||
+      ((w2 >> 16) & 0x1F) != AUX_REG ||
+      (w2 & 0x07FF) != 0 ||
+      src == AUX_REG) {
+    return 0;
+  }
+  /* add, sub, mul, div and rem have a signed immediate */
+  isSigned = (op == 0x00 || op == 0x02 || op == 0x04 ||
+              op == 0x08 || op == 0x0C);
+  if (value > (isSigned ? 0x7FFF : 0xFFFF)) {
+    return 0;
+  }
+  *size = 8;
+  return (op + 1) << 26 | src << 21 | dst << 16;
+}
+
+
+static unsigned int symbolAddress(Sym *sym) {
+  if (sym->seg == -1) {
+    return sym->val;
+  }
+  return sym->mod->segs[sym->seg].addr + sym->val;
+}
+
+
+unsigned int relaxModule(Module *mod) {
+  int *order;
+  int i, j, k;
+  RelocRecord *rel;
+  SegmentRecord *seg;
+  Sym *sym;
+  unsigned int value;
+  unsigned int instr;
+  unsigned int size;
+  unsigned char *data;
+  unsigned int from, to;
+  unsigned int saved;
+
+  relaxMod = mod;
+  order = memAlloc((mod->nrels + 1) * sizeof(int));
+  for (i = 0; i < mod->nrels; i++) {
+    order[i] = i;
+  }
+  qsort(order, mod->nrels, sizeof(int), compareRelocs);
+  cuts = memAlloc((mod->nrels + 1) * sizeof(Cut));
+  numCuts = 0;
+  /* replace sequences by single instructions */
+  for (i = 0; i < mod->nrels; i++) {
+    rel = mod->rels + i;
+    if ((rel->typ & RELOC_RLX) == 0 || !mod->keep[rel->seg]) {
+      continue;
+    }
+    if (rel->typ & RELOC_SYM) {
+      sym = mod->syms[rel->ref];
+      if ((sym->attr & SYM_ATTR_U) != 0 || isRemoved(sym)) {
+        continue;
+      }
+      value = symbolAddress(sym) + rel->add;
+    } else {
+      value = mod->segs[rel->ref].addr + rel->add;
+    }
+    seg = mod->segs + rel->seg;
+    j = findReloc(order, rel->seg, rel->loc + 4);
+    if (j < 0 ||
+        (mod->rels[j].typ & ~RELOC_SYM) != RELOC_L16 ||
+        (mod->rels[j].typ & RELOC_SYM) != (rel->typ & RELOC_SYM) ||
+        mod->rels[j].ref != rel->ref ||
+        mod->rels[j].add != rel->add) {
+      continue;
+    }
+    instr = relaxedInstr(mod->data + seg->offs + rel->loc,
+                         seg->size - rel->loc, value, &size);
+    if (instr == 0) {
+      continue;
+    }
+    if (debugRelax) {
+      fprintf(stderr,
+              "    %s @ 0x%08X: value 0x%08X, %u bytes removed\n",
+              mod->strs + seg->name, rel->loc, value, size);
+    }
+    write4ToEco(mod->data + seg->offs + rel->loc, instr);
+    rel->typ = (rel->typ & RELOC_SYM) | RELOC_L16;
+    mod->rels[j].typ = -1;
+    cuts[numCuts].seg = rel->seg;
+    cuts[numCuts].off = rel->loc + 4;
+    cuts[numCuts].size = size;
+    numCuts++;
+  }
+  memFree(order);
+  if (numCuts == 0) {
+    memFree(cuts);
+    return 0;
+  }
+  qsort(cuts, numCuts, sizeof(Cut), compareCuts);
+  saved = 0;
+  for (k = 0; k < numCuts; k++) {
+    if (k == 0 || cuts[k].seg != cuts[k - 1].seg) {
+      cuts[k].total = cuts[k].size;
+    } else {
+      cuts[k].total = cuts[k - 1].total + cuts[k].size;
+    }
+    saved += cuts[k].size;
+  }
+  /* squeeze segment data */
+  for (k = 0; k < numCuts; k++) {
+    seg = mod->segs + cuts[k].seg;
+    data = mod->data + seg->offs;
+    from = cuts[k].off + cuts[k].size;
+    if (k + 1 < numCuts && cuts[k + 1].seg == cuts[k].seg) {
+      to = cuts[k + 1].off;
+    } else {
+      to = seg->size;
+    }
+    memmove(data + from - cuts[k].total, data + from, to - from);
+    if (k + 1 == numCuts || cuts[k + 1].seg != cuts[k].seg) {
+      seg->size -= cuts[k].total;
+    }
+  }
+  /* adjust relocations, drop the ones which are gone */
+  j = 0;
+  for (i = 0; i < mod->nrels; i++) {
+    rel = mod->rels + i;
+    if (rel->typ == -1) {
+      continue;
+    }
+    rel->loc = moveDown(rel->seg, rel->loc);
+    if ((rel->typ & RELOC_SYM) == 0) {
+      rel->add = moveDown(rel->ref, rel->add);
+    }
+    mod->rels[j++] = *rel;
+  }
+  mod->nrels = j;
+  /* adjust symbols defined in this module */
+  for (i = 0; i < mod->nsyms; i++) {
+    sym = mod->syms[i];
+    if (sym->mod == mod && sym->seg != -1) {
+      sym->val = moveDown(sym->seg, sym->val);
+    }
+  }
+  memFree(cuts);
+  return saved;
+}
+
+
+void relaxModules(ScriptNode *script) {
+  Module *mod;
+  unsigned int saved;
+  unsigned int total;
+
+  total = 0;
+  do {
+    saved = 0;
+    mod = firstModule;
+    while (mod != NULL) {
+      if (debugRelax) {
+        fprintf(stderr, "relaxing module '%s':\n", mod->name);
+      }
+      saved += relaxModule(mod);
+      mod = mod->next;
+    }
+    if (saved != 0) {
+      reallocateStorage(script);
+    }
+    total += saved;
+  } while (saved != 0);
+  if (debugRelax) {
+    fprintf(stderr, "relaxation removed %u bytes\n", total);
+  }
+}
+
+
 /**************************************************************/
 
 
@@ -1328,6 +1881,9 @@ void writeSymbolTable(FILE *mapFile) {
   for (i = 0; i < numSymbols; i++) {
     sym = iter.symbolTable[i];
     mod = sym->mod;
+    if (isRemoved(sym)) {
+      continue;
+    }
     fprintf(mapFile,
             "%-24s  0x%08X  %-12s  %s\n",
             sym->name,
@@ -1404,6 +1960,10 @@ void relocateModules(void) {
     }
     for (i = 0; i < mod->nrels; i++) {
       rel = mod->rels + i;
+      if (!mod->keep[rel->seg]) {
+        /* segment has been removed by garbage collection */
+        continue;
+      }
       seg = mod->segs + rel->seg;
       loc = mod->data + seg->offs + rel->loc;
       addr = seg->addr + rel->loc;
@@ -1419,7 +1979,7 @@ void relocateModules(void) {
         base = mod->segs[rel->ref].addr;
       }
       value = base + rel->add;
-      switch (rel->typ & ~RELOC_SYM) {
+      switch (rel->typ & ~(RELOC_SYM | RELOC_RLX)) {
         case RELOC_H16:
           method = "H16";
           mask = 0x0000FFFF;
@@ -1474,7 +2034,8 @@ void relocateModules(void) {
         default:
           method = "ILL";
           mask = 0;
-          error("illegal relocation type %d", rel->typ & ~RELOC_SYM);
+          error("illegal relocation type %d",
+                rel->typ & ~(RELOC_SYM | RELOC_RLX));
       }
       data = (data & ~mask) | (value & mask);
       write4ToEco(loc, data);
@@ -1690,6 +2251,10 @@ void usage(char *myself) {
   fprintf(stderr, "         [-s scrfile]     set script file name\n");
   fprintf(stderr, "         [-o objfile]     set output file name\n");
   fprintf(stderr, "         [-m mapfile]     set map file name\n");
+  fprintf(stderr, "         [--gc]           remove segments unreachable\n");
+  fprintf(stderr, "                          from the entry symbol\n");
+  fprintf(stderr, "         [--relax]        shorten synthetic instruction\n");
+  fprintf(stderr, "                          sequences where possible\n");
   fprintf(stderr, "         file             object file name\n");
   fprintf(stderr, "         [file]           additional obj/lib file\n");
   fprintf(stderr, "         [-Ldir]          additional lib directory\n");
@@ -1749,6 +2314,16 @@ int main(int argc, char *argv[]) {
           }
           newDir(argp);
           break;
+        case '-':
+          if (strcmp(argp, "-gc") == 0) {
+            gcSegments = 1;
+          } else
+          if (strcmp(argp, "-relax") == 0) {
+            relaxCode = 1;
+          } else {
+            usage(argv[0]);
+          }
+          break;
         case 'l':
           argp++;
           if (*argp == '\0') {
@@ -1784,7 +2359,13 @@ int main(int argc, char *argv[]) {
     showScript(script);
   }
   readFiles();
+  if (gcSegments) {
+    collectGarbage(script);
+  }
   allocateStorage(script);
+  if (relaxCode) {
+    relaxModules(script);
+  }
   if (debugSegments) {
     showSegments();
   }
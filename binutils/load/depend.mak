@@ -0,0 +1 @@
+load.o: load.c ../include/a.out.h
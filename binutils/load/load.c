@@ -7,6 +7,11 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdarg.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
 
 #include "../include/a.out.h"
 
@@ -52,6 +57,8 @@ unsigned int read4(unsigned char *p) {
 #define LDERR_RSD	9	/* cannot read segment data */
 #define LDERR_WBF	10	/* cannot write binary file */
 #define LDERR_SNO	11	/* segments not ordered, cannot fill gap */
+#define LDERR_WTF	12	/* cannot write text file */
+#define LDERR_MSZ	13	/* image exceeds memory size */
 
 
 typedef struct {
@@ -78,9 +85,358 @@ int segCmp(const void *entry1, const void *entry2) {
 }
 
 
-int loadObj(FILE *inFile, FILE *outFile,
+/**************************************************************/
+
+/*
+ * text output formats
+ *
+ * Each of them produces exactly what the corresponding tool
+ * (bin2exo, bin2mcs, bin2dat) would produce if it were run
+ * on the binary image, but the image is never re-read: the
+ * bytes are streamed into all formats while it is written.
+ */
+
+
+#define FMT_EXO		0	/* Motorola S-records */
+#define FMT_MCS		1	/* Intel hex records */
+#define FMT_DAT		2	/* simulation data */
+
+#define NUM_FORMATS	3
+
+#define WORDS_PER_KB	256	/* for memory size of data files */
+
+
+typedef struct {
+  int format;			/* one of FMT_xxx */
+  char *name;			/* output file name, NULL if unused */
+  FILE *file;			/* output file */
+  int type;			/* S-record type (1, 2, 3) or width */
+  unsigned int startAddr;	/* load address of image */
+  unsigned int loadAddr;	/* load address of current line */
+  unsigned int memSize;		/* memory size in words, or 0 */
+  unsigned int totalWords;	/* number of words written */
+  int numBytes;			/* number of bytes in line buffer */
+  unsigned char lineData[16];	/* line buffer */
+} TextOut;
+
+
+static void exoLine(TextOut *out) {
+  unsigned int chksum;
+  int i;
+
+  chksum = out->type + out->numBytes + 2;
+  fprintf(out->file, "S%d%02X%0*X",
+          out->type, out->numBytes + out->type + 2,
+          2 * (out->type + 1), out->loadAddr);
+  for (i = 0; i <= out->type; i++) {
+    chksum += (out->loadAddr >> (8 * i)) & 0xFF;
+  }
+  for (i = 0; i < out->numBytes; i++) {
+    fprintf(out->file, "%02X", out->lineData[i]);
+    chksum += out->lineData[i];
+  }
+  fprintf(out->file, "%02X\n", 0xFF - (chksum & 0xFF));
+}
+
+
+static void exoEnd(TextOut *out) {
+  unsigned int chksum;
+  int i;
+
+  chksum = out->type + 2;
+  fprintf(out->file, "S%d%02X%0*X",
+          10 - out->type, out->type + 2,
+          2 * (out->type + 1), out->startAddr);
+  for (i = 0; i <= out->type; i++) {
+    chksum += (out->startAddr >> (8 * i)) & 0xFF;
+  }
+  fprintf(out->file, "%02X\n", 0xFF - (chksum & 0xFF));
+}
+
+
+static void mcsSegment(TextOut *out) {
+  unsigned int chksum;
+
+  if ((out->loadAddr & 0xFFFF) != 0) {
+    return;
+  }
+  fprintf(out->file, ":02000004%04X", out->loadAddr >> 16);
+  chksum = 0x02 + 0x04 +
+           ((out->loadAddr >> 24) & 0xFF) +
+           ((out->loadAddr >> 16) & 0xFF);
+  fprintf(out->file, "%02X\n", (-chksum) & 0xFF);
+}
+
+
+static void mcsLine(TextOut *out) {
+  unsigned int chksum;
+  int i;
+
+  mcsSegment(out);
+  fprintf(out->file, ":%02X%04X00", out->numBytes, out->loadAddr & 0xFFFF);
+  chksum = out->numBytes +
+           ((out->loadAddr >> 8) & 0xFF) +
+           ((out->loadAddr >> 0) & 0xFF);
+  for (i = 0; i < out->numBytes; i++) {
+    fprintf(out->file, "%02X", out->lineData[i]);
+    chksum += out->lineData[i];
+  }
+  fprintf(out->file, "%02X\n", (-chksum) & 0xFF);
+}
+
+
+static void mcsEnd(TextOut *out) {
+  /* a full last line is followed by one more segment check */
+  mcsSegment(out);
+  fprintf(out->file, ":00000001FF\n");
+}
+
+
+static void datWord(TextOut *out, unsigned char *data) {
+  switch (out->type) {
+    case 1:
+      fprintf(out->file, "%02X\n%02X\n%02X\n%02X\n",
+              data[0], data[1], data[2], data[3]);
+      break;
+    case 2:
+      fprintf(out->file, "%02X%02X\n%02X%02X\n",
+              data[0], data[1], data[2], data[3]);
+      break;
+    case 4:
+      fprintf(out->file, "%02X%02X%02X%02X\n",
+              data[0], data[1], data[2], data[3]);
+      break;
+  }
+  out->totalWords++;
+}
+
+
+static void datEnd(TextOut *out) {
+  static unsigned char zero[4];
+
+  if (out->memSize == 0) {
+    return;
+  }
+  while (out->totalWords < out->memSize) {
+    datWord(out, zero);
+  }
+}
+
+
+static int lineLength(TextOut *out) {
+  return out->format == FMT_DAT ? 4 : 16;
+}
+
+
+static void flushLine(TextOut *out) {
+  switch (out->format) {
+    case FMT_EXO:
+      exoLine(out);
+      break;
+    case FMT_MCS:
+      mcsLine(out);
+      break;
+    case FMT_DAT:
+      while (out->numBytes < 4) {
+        out->lineData[out->numBytes++] = 0;
+      }
+      datWord(out, out->lineData);
+      break;
+  }
+  out->loadAddr += out->numBytes;
+  out->numBytes = 0;
+}
+
+
+/*
+ * Append size bytes to a text output. A NULL data pointer
+ * stands for that many zero bytes (gaps, cleared segments).
+ */
+static int textPut(TextOut *out, unsigned char *data, unsigned int size) {
+  int len;
+  int n;
+
+  len = lineLength(out);
+  while (size > 0) {
+    n = len - out->numBytes;
+    if (n > size) {
+      n = size;
+    }
+    if (data == NULL) {
+      memset(out->lineData + out->numBytes, 0, n);
+    } else {
+      memcpy(out->lineData + out->numBytes, data, n);
+      data += n;
+    }
+    out->numBytes += n;
+    size -= n;
+    if (out->numBytes == len) {
+      flushLine(out);
+    }
+  }
+  if (out->format == FMT_DAT &&
+      out->memSize != 0 &&
+      out->totalWords > out->memSize) {
+    return LDERR_MSZ;
+  }
+  return ferror(out->file) ? LDERR_WTF : LDERR_NONE;
+}
+
+
+static int textEnd(TextOut *out) {
+  int partial;
+
+  partial = (out->numBytes != 0);
+  if (partial) {
+    flushLine(out);
+  }
+  if (out->format == FMT_DAT &&
+      out->memSize != 0 &&
+      out->totalWords > out->memSize) {
+    return LDERR_MSZ;
+  }
+  switch (out->format) {
+    case FMT_EXO:
+      exoEnd(out);
+      break;
+    case FMT_MCS:
+      if (partial) {
+        fprintf(out->file, ":00000001FF\n");
+      } else {
+        mcsEnd(out);
+      }
+      break;
+    case FMT_DAT:
+      datEnd(out);
+      break;
+  }
+  return ferror(out->file) ? LDERR_WTF : LDERR_NONE;
+}
+
+
+/**************************************************************/
+
+/*
+ * binary image output
+ *
+ * Every piece of the image is written with a single pwrite at
+ * its final file offset, straight from the mapped executable.
+ * Gaps and cleared segments are never written at all: the file
+ * is extended to its final size at the end, which leaves them
+ * as holes that read back as zeros.
+ */
+
+
+typedef struct {
+  int fd;			/* binary file, -1 if unused */
+  unsigned int offs;		/* current offset in image */
+  TextOut *texts;		/* text outputs */
+  int numTexts;			/* number of text outputs */
+} ImageOut;
+
+
+static int imagePut(ImageOut *img, unsigned char *data, unsigned int size) {
+  ssize_t n;
+  unsigned int done;
+  int i;
+  int result;
+
+  if (size == 0) {
+    return LDERR_NONE;
+  }
+  if (img->fd >= 0 && data != NULL) {
+    done = 0;
+    while (done < size) {
+      n = pwrite(img->fd, data + done, size - done, img->offs + done);
+      if (n <= 0) {
+        return LDERR_WBF;
+      }
+      done += n;
+    }
+  }
+  for (i = 0; i < img->numTexts; i++) {
+    result = textPut(&img->texts[i], data, size);
+    if (result != LDERR_NONE) {
+      return result;
+    }
+  }
+  img->offs += size;
+  return LDERR_NONE;
+}
+
+
+static int imageEnd(ImageOut *img) {
+  int i;
+  int result;
+
+  if (img->fd >= 0 && ftruncate(img->fd, img->offs) < 0) {
+    return LDERR_WBF;
+  }
+  for (i = 0; i < img->numTexts; i++) {
+    result = textEnd(&img->texts[i]);
+    if (result != LDERR_NONE) {
+      return result;
+    }
+  }
+  return LDERR_NONE;
+}
+
+
+/**************************************************************/
+
+
+/*
+ * Map the whole executable into memory. If the file cannot be
+ * mapped (e.g., because it is a pipe), it is read instead.
+ */
+static unsigned char *mapObj(int inFd, size_t *sizeP, int *mappedP) {
+  struct stat st;
+  unsigned char *p;
+  size_t size;
+  size_t cap;
+  ssize_t n;
+
+  if (fstat(inFd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+    p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, inFd, 0);
+    if (p != MAP_FAILED) {
+      *sizeP = st.st_size;
+      *mappedP = 1;
+      return p;
+    }
+  }
+  size = 0;
+  cap = 64 * 1024;
+  p = malloc(cap);
+  if (p == NULL) {
+    return NULL;
+  }
+  while (1) {
+    if (size == cap) {
+      cap *= 2;
+      p = realloc(p, cap);
+      if (p == NULL) {
+        return NULL;
+      }
+    }
+    n = read(inFd, p + size, cap - size);
+    if (n < 0) {
+      free(p);
+      return NULL;
+    }
+    if (n == 0) {
+      break;
+    }
+    size += n;
+  }
+  *sizeP = size;
+  *mappedP = 0;
+  return p;
+}
+
+
+int loadObj(unsigned char *obj, size_t objSize, ImageOut *img,
             int sort, int fill, int clear, int verbose) {
-  ExecHeader fileHeader;
+  ExecHeader *fileHeader;
   unsigned int osegs;
   unsigned int nsegs;
   unsigned int odata;
@@ -88,29 +444,27 @@ int loadObj(FILE *inFile, FILE *outFile,
   SegmentInfo *allSegs;
   int numSegs;
   int i;
-  SegmentRecord segRec;
+  SegmentRecord *segRec;
   unsigned int offs;
   unsigned int addr;
   unsigned int size;
   unsigned int attr;
   unsigned char *data;
   unsigned int vaddr;
-  int j;
+  int result;
 
-  /* read and inspect file header */
-  if (fseek(inFile, 0, SEEK_SET) < 0) {
-    return LDERR_SFH;
-  }
-  if (fread(&fileHeader, sizeof(ExecHeader), 1, inFile) != 1) {
+  /* inspect file header */
+  if (objSize < sizeof(ExecHeader)) {
     return LDERR_RFH;
   }
-  if (read4((unsigned char *) &fileHeader.magic) != EXEC_MAGIC) {
+  fileHeader = (ExecHeader *) obj;
+  if (read4((unsigned char *) &fileHeader->magic) != EXEC_MAGIC) {
     return LDERR_WMN;
   }
-  osegs = read4((unsigned char *) &fileHeader.osegs);
-  nsegs = read4((unsigned char *) &fileHeader.nsegs);
-  odata = read4((unsigned char *) &fileHeader.odata);
-  entry = read4((unsigned char *) &fileHeader.entry);
+  osegs = read4((unsigned char *) &fileHeader->osegs);
+  nsegs = read4((unsigned char *) &fileHeader->nsegs);
+  odata = read4((unsigned char *) &fileHeader->odata);
+  entry = read4((unsigned char *) &fileHeader->entry);
   if (verbose) {
     printf("info: entry point      : 0x%08X\n", entry);
     printf("      num segments     : %d\n", nsegs);
@@ -120,26 +474,25 @@ int loadObj(FILE *inFile, FILE *outFile,
   if (nsegs == 0) {
     return LDERR_SEG;
   }
+  if (osegs > objSize ||
+      nsegs > (objSize - osegs) / sizeof(SegmentRecord)) {
+    return LDERR_RSE;
+  }
   allSegs = malloc(nsegs * sizeof(SegmentInfo));
   if (allSegs == NULL) {
     return LDERR_MEM;
   }
-  /* read segments */
+  /* collect segments, data stays in the mapped file */
   numSegs = 0;
   for (i = 0; i < nsegs; i++) {
     if (verbose) {
       printf("processing segment entry %d\n", i);
     }
-    if (fseek(inFile, osegs + i * sizeof(SegmentRecord), SEEK_SET) < 0) {
-      return LDERR_SSE;
-    }
-    if (fread(&segRec, sizeof(SegmentRecord), 1, inFile) != 1) {
-      return LDERR_RSE;
-    }
-    offs = read4((unsigned char *) &segRec.offs);
-    addr = read4((unsigned char *) &segRec.addr);
-    size = read4((unsigned char *) &segRec.size);
-    attr = read4((unsigned char *) &segRec.attr);
+    segRec = (SegmentRecord *) (obj + osegs) + i;
+    offs = read4((unsigned char *) &segRec->offs);
+    addr = read4((unsigned char *) &segRec->addr);
+    size = read4((unsigned char *) &segRec->size);
+    attr = read4((unsigned char *) &segRec->attr);
     if (verbose) {
       printf("    offset  : 0x%08X\n", offs);
       printf("    address : 0x%08X\n", addr);
@@ -147,16 +500,13 @@ int loadObj(FILE *inFile, FILE *outFile,
       printf("    attr    : 0x%08X\n", attr);
     }
     if (attr & SEG_ATTR_P) {
-      data = malloc(size);
-      if (data == NULL) {
-        return LDERR_MEM;
-      }
-      if (fseek(inFile, odata + offs, SEEK_SET) < 0) {
-        return LDERR_SSD;
-      }
-      if (fread(data, 1, size, inFile) != size) {
+      if (odata > objSize ||
+          offs > objSize - odata ||
+          size > objSize - odata - offs) {
+        free(allSegs);
         return LDERR_RSD;
       }
+      data = obj + odata + offs;
       if (verbose) {
         printf("    segment of 0x%08X bytes read, vaddr = 0x%08X\n",
                size, addr);
@@ -175,6 +525,7 @@ int loadObj(FILE *inFile, FILE *outFile,
     qsort(allSegs, numSegs, sizeof(SegmentInfo), segCmp);
   }
   /* write segments */
+  result = LDERR_NONE;
   vaddr = allSegs[0].vaddr;
   for (i = 0; i < numSegs; i++) {
     if (!(allSegs[i].attr & SEG_ATTR_A)) {
@@ -187,36 +538,34 @@ int loadObj(FILE *inFile, FILE *outFile,
       /* fill inter-segment gap */
       if (vaddr > allSegs[i].vaddr) {
         /* segments not ordered, cannot fill gap */
-        return LDERR_SNO;
+        result = LDERR_SNO;
+        break;
       }
-      while (vaddr < allSegs[i].vaddr) {
-        if (fputc(0, outFile) == EOF) {
-          return LDERR_WBF;
-        }
-        vaddr++;
+      result = imagePut(img, NULL, allSegs[i].vaddr - vaddr);
+      if (result != LDERR_NONE) {
+        break;
       }
-    } else {
-      /* do not fill inter-segment gap */
-      vaddr = allSegs[i].vaddr;
     }
+    vaddr = allSegs[i].vaddr;
     size = allSegs[i].size;
     if (allSegs[i].attr & SEG_ATTR_P) {
-      if (fwrite(allSegs[i].data, 1, size, outFile) != size) {
-        return LDERR_WBF;
-      }
+      result = imagePut(img, allSegs[i].data, size);
     } else {
       if (clear) {
         /* clear non-present segment */
-        for (j = 0; j < size; j++) {
-          if (fputc(0, outFile) == EOF) {
-            return LDERR_WBF;
-          }
-        }
+        result = imagePut(img, NULL, size);
       }
     }
+    if (result != LDERR_NONE) {
+      break;
+    }
     vaddr += size;
   }
-  return LDERR_NONE;
+  if (result == LDERR_NONE) {
+    result = imageEnd(img);
+  }
+  free(allSegs);
+  return result;
 }
 
 
@@ -236,31 +585,66 @@ char *loadResult[] = {
   /*  9 */  "cannot read segment data",
   /* 10 */  "cannot write binary file",
   /* 11 */  "segments not ordered, cannot fill gap",
+  /* 12 */  "cannot write text file",
+  /* 13 */  "image exceeds memory size",
 };
 
 int maxResults = sizeof(loadResult) / sizeof(loadResult[0]);
 
 
 void usage(char *myself) {
-  printf("usage: %s [-p] [-v] <object file> <binary file>\n", myself);
+  printf("usage: %s [-p] [-v] [-a <load addr, hex>]\n", myself);
+  printf("       [-S1|-S2|-S3 <S-record file>] [-I <Intel hex file>]\n");
+  printf("       [-dw|-dh|-db <data file> [-k <memory size in KB>]]\n");
+  printf("       <object file> [<binary file>]\n");
   exit(1);
 }
 
 
+static TextOut *addText(TextOut *texts, int *numTextsP,
+                        int format, int type, char *name) {
+  TextOut *out;
+  int i;
+
+  for (i = 0; i < *numTextsP; i++) {
+    if (texts[i].format == format) {
+      error("more than one output file of the same format specified");
+    }
+  }
+  out = &texts[(*numTextsP)++];
+  memset(out, 0, sizeof(TextOut));
+  out->format = format;
+  out->type = type;
+  out->name = name;
+  return out;
+}
+
+
 int main(int argc, char *argv[]) {
   int pack;
   int verbose;
   char *inName;
   char *outName;
   int i;
-  FILE *inFile;
-  FILE *outFile;
+  char *endptr;
+  unsigned int loadAddr;
+  unsigned int memSize;
+  TextOut texts[NUM_FORMATS];
+  int numTexts;
+  ImageOut img;
+  int inFd;
+  unsigned char *obj;
+  size_t objSize;
+  int mapped;
   int result;
 
   pack = 0;
   verbose = 0;
   inName = NULL;
   outName = NULL;
+  loadAddr = 0;
+  memSize = 0;
+  numTexts = 0;
   for (i = 1; i < argc; i++) {
     if (*argv[i] == '-') {
       /* option */
@@ -269,6 +653,34 @@ int main(int argc, char *argv[]) {
       } else
       if (strcmp(argv[i], "-v") == 0) {
         verbose = 1;
+      } else
+      if (strcmp(argv[i], "-a") == 0 && i + 1 < argc) {
+        loadAddr = strtoul(argv[++i], &endptr, 16);
+        if (*endptr != '\0') {
+          error("illegal load address %s", argv[i]);
+        }
+      } else
+      if (strcmp(argv[i], "-k") == 0 && i + 1 < argc) {
+        memSize = strtoul(argv[++i], &endptr, 0);
+        if (*endptr != '\0' || memSize == 0) {
+          error("illegal memory size %s", argv[i]);
+        }
+      } else
+      if (argv[i][1] == 'S' && argv[i][2] >= '1' &&
+          argv[i][2] <= '3' && argv[i][3] == '\0' && i + 1 < argc) {
+        addText(texts, &numTexts, FMT_EXO, argv[i][2] - '0', argv[i + 1]);
+        i++;
+      } else
+      if (strcmp(argv[i], "-I") == 0 && i + 1 < argc) {
+        addText(texts, &numTexts, FMT_MCS, 0, argv[++i]);
+      } else
+      if (argv[i][1] == 'd' && argv[i][2] != '\0' &&
+          strchr("whb", argv[i][2]) != NULL && argv[i][3] == '\0' &&
+          i + 1 < argc) {
+        addText(texts, &numTexts, FMT_DAT,
+                argv[i][2] == 'w' ? 4 : argv[i][2] == 'h' ? 2 : 1,
+                argv[i + 1]);
+        i++;
       } else {
         usage(argv[0]);
       }
@@ -287,25 +699,65 @@ int main(int argc, char *argv[]) {
   if (inName == NULL) {
     error("no object file specified");
   }
-  if (outName == NULL) {
+  if (outName == NULL && numTexts == 0) {
     error("no binary file specified");
   }
-  inFile = fopen(inName, "rb");
-  if (inFile == NULL) {
+  inFd = open(inName, O_RDONLY);
+  if (inFd < 0) {
     error("cannot open object file '%s'", inName);
   }
-  outFile = fopen(outName, "wb");
-  if (outFile == NULL) {
-    error("cannot open binary file '%s'", outName);
+  obj = mapObj(inFd, &objSize, &mapped);
+  if (obj == NULL) {
+    error("cannot read object file '%s'", inName);
+  }
+  img.offs = 0;
+  img.texts = texts;
+  img.numTexts = numTexts;
+  if (outName == NULL) {
+    img.fd = -1;
+  } else {
+    img.fd = open(outName, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (img.fd < 0) {
+      error("cannot open binary file '%s'", outName);
+    }
+  }
+  for (i = 0; i < numTexts; i++) {
+    texts[i].file = fopen(texts[i].name, "wt");
+    if (texts[i].file == NULL) {
+      error("cannot open output file '%s'", texts[i].name);
+    }
+    texts[i].startAddr = loadAddr;
+    texts[i].loadAddr = loadAddr;
+    if (texts[i].format == FMT_EXO &&
+        (loadAddr >> 8 >> (8 * texts[i].type)) != 0) {
+      error("load address too big");
+    }
+    if (texts[i].format == FMT_DAT) {
+      texts[i].memSize = memSize * WORDS_PER_KB;
+      fprintf(texts[i].file, "@0\n");
+    }
   }
-  result = loadObj(inFile, outFile, 0, !pack, !pack, verbose);
+  result = loadObj(obj, objSize, &img, 0, !pack, !pack, verbose);
   if (verbose || result != 0) {
     printf("%s: %s\n",
            result == 0 ? "result" : "error",
            result >= maxResults ? "unknown error number" :
                                   loadResult[result]);
   }
-  fclose(inFile);
-  fclose(outFile);
+  for (i = 0; i < numTexts; i++) {
+    if (fclose(texts[i].file) != 0 && result == 0) {
+      result = LDERR_WTF;
+      printf("error: %s\n", loadResult[result]);
+    }
+  }
+  if (img.fd >= 0) {
+    close(img.fd);
+  }
+  if (mapped) {
+    munmap(obj, objSize);
+  } else {
+    free(obj);
+  }
+  close(inFd);
   return result;
 }
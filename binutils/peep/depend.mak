@@ -0,0 +1,2 @@
+main.o: main.c peep.h
+peep.o: peep.c peep.h
@@ -0,0 +1,126 @@
+/*
+ * main.c -- peephole optimizer for assembler source, standalone
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+#include "peep.h"
+
+
+/**************************************************************/
+
+
+void error(char *fmt, ...) {
+  va_list ap;
+
+  va_start(ap, fmt);
+  fprintf(stderr, "Error: ");
+  vfprintf(stderr, fmt, ap);
+  fprintf(stderr, "\n");
+  va_end(ap);
+  exit(1);
+}
+
+
+void *allocateMemory(unsigned int size) {
+  void *p;
+
+  p = malloc(size);
+  if (p == NULL) {
+    error("out of memory");
+  }
+  return p;
+}
+
+
+void freeMemory(void *p) {
+  free(p);
+}
+
+
+/**************************************************************/
+
+
+void usage(char *myself) {
+  fprintf(stderr, "Usage: %s\n", myself);
+  fprintf(stderr, "         [-o outfile]     set output file name "
+                  "(default: stdout)\n");
+  fprintf(stderr, "         [-s]             show rule statistics\n");
+  fprintf(stderr, "         [file]           source file name "
+                  "(default: stdin)\n");
+  exit(1);
+}
+
+
+int main(int argc, char *argv[]) {
+  int i;
+  char *argp;
+  char *inName;
+  char *outName;
+  int showStats;
+  FILE *inFile;
+  FILE *outFile;
+  unsigned int stats[PEEP_NUM_RULES];
+
+  inName = NULL;
+  outName = NULL;
+  showStats = 0;
+  for (i = 1; i < argc; i++) {
+    argp = argv[i];
+    if (*argp != '-') {
+      if (inName != NULL) {
+        usage(argv[0]);
+      }
+      inName = argp;
+      continue;
+    }
+    argp++;
+    switch (*argp) {
+      case 'o':
+        if (i == argc - 1) {
+          usage(argv[0]);
+        }
+        outName = argv[++i];
+        break;
+      case 's':
+        showStats = 1;
+        break;
+      default:
+        usage(argv[0]);
+    }
+  }
+  if (inName == NULL) {
+    inFile = stdin;
+  } else {
+    inFile = fopen(inName, "rt");
+    if (inFile == NULL) {
+      error("cannot open input file '%s'", inName);
+    }
+  }
+  if (outName == NULL) {
+    outFile = stdout;
+  } else {
+    outFile = fopen(outName, "wt");
+    if (outFile == NULL) {
+      error("cannot open output file '%s'", outName);
+    }
+  }
+  memset(stats, 0, sizeof(stats));
+  peephole(inFile, outFile, stats);
+  if (inFile != stdin) {
+    fclose(inFile);
+  }
+  if (outFile != stdout) {
+    fclose(outFile);
+  }
+  if (showStats) {
+    for (i = 0; i < PEEP_NUM_RULES; i++) {
+      fprintf(stderr, "%-24s %8u\n", peepRuleName[i], stats[i]);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,895 @@
+/*
+ * peep.c -- peephole optimizer for assembler source
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "peep.h"
+
+
+/*
+ * The optimizer reads a whole source file and classifies its
+ * lines. A liveness analysis of the registers over the control
+ * flow graph of the file tells which results are never used.
+ * Then a small set of rules is applied to adjacent instructions
+ * of the basic blocks, alternating with the analysis, until
+ * nothing changes any more. Removed lines are written as empty
+ * lines (keeping their labels), so that line numbers in error
+ * messages of the assembler still refer to the original source.
+ *
+ * Anything which is not understood (directives in the code
+ * segment other than the harmless ones, system instructions,
+ * indirect jumps other than returns) is taken to use all
+ * registers. Calls are taken to use the argument registers and
+ * the stack pointer, and to define nothing. A return keeps the
+ * result registers and the callee-saved registers alive.
+ */
+
+
+#define LINE_SIZE	200	/* initial size, lines may be longer */
+#define MAX_ARGS	3
+#define MAX_ROUNDS	10
+
+#define ALL_REGS	0xFFFFFFFF
+#define CALL_USE	0x200000F0	/* $4..$7, $29 */
+#define RET_LIVE	0xFCFF000C	/* $2, $3, $16..$23, $26..$31 */
+
+#define BIT(r)		((unsigned int) 1 << (r))
+
+#define SEG_CODE	0
+#define SEG_OTHER	1
+
+#define L_NONE		0	/* empty line, comment, directive, data */
+#define L_INSTR		1	/* instruction in the code segment */
+#define L_BARRIER	2	/* not understood, assume the worst */
+
+#define K_ALU		0	/* op rd,rs,rt or op rd,rs,imm */
+#define K_DIV		1	/* the same, but may trap */
+#define K_LDHI		2	/* ldhi rd,imm */
+#define K_LOAD		3	/* op rd,rs,offset */
+#define K_STORE		4	/* op rd,rs,offset */
+#define K_BRANCH	5	/* op rs,rt,label */
+#define K_JUMP		6	/* j label */
+#define K_JR		7	/* jr rs */
+#define K_CALL		8	/* jal label */
+#define K_CALLR		9	/* jalr rs */
+
+
+char *peepRuleName[PEEP_NUM_RULES] = {
+  /* PEEP_JUMP   */  "jumps to next line",
+  /* PEEP_BRANCH */  "branches around jumps",
+  /* PEEP_RELOAD */  "stack slot reloads",
+  /* PEEP_MOVE   */  "moves folded",
+  /* PEEP_NOP    */  "no-op instructions",
+  /* PEEP_DEAD   */  "unused results",
+  /* PEEP_LDHI   */  "ldhi/or pairs",
+};
+
+
+typedef struct {
+  char *name;			/* mnemonic */
+  int kind;			/* kind of instruction */
+  char *inverse;		/* branch on the opposite condition */
+} Mnemonic;
+
+
+static Mnemonic mnemonics[] = {
+  { "add",  K_ALU,    NULL   },
+  { "sub",  K_ALU,    NULL   },
+  { "mul",  K_ALU,    NULL   },
+  { "mulu", K_ALU,    NULL   },
+  { "div",  K_DIV,    NULL   },
+  { "divu", K_DIV,    NULL   },
+  { "rem",  K_DIV,    NULL   },
+  { "remu", K_DIV,    NULL   },
+  { "and",  K_ALU,    NULL   },
+  { "or",   K_ALU,    NULL   },
+  { "xor",  K_ALU,    NULL   },
+  { "xnor", K_ALU,    NULL   },
+  { "sll",  K_ALU,    NULL   },
+  { "slr",  K_ALU,    NULL   },
+  { "sar",  K_ALU,    NULL   },
+  { "ldhi", K_LDHI,   NULL   },
+  { "beq",  K_BRANCH, "bne"  },
+  { "bne",  K_BRANCH, "beq"  },
+  { "ble",  K_BRANCH, "bgt"  },
+  { "bleu", K_BRANCH, "bgtu" },
+  { "blt",  K_BRANCH, "bge"  },
+  { "bltu", K_BRANCH, "bgeu" },
+  { "bge",  K_BRANCH, "blt"  },
+  { "bgeu", K_BRANCH, "bltu" },
+  { "bgt",  K_BRANCH, "ble"  },
+  { "bgtu", K_BRANCH, "bleu" },
+  { "j",    K_JUMP,   NULL   },
+  { "jr",   K_JR,     NULL   },
+  { "jal",  K_CALL,   NULL   },
+  { "jalr", K_CALLR,  NULL   },
+  { "ldw",  K_LOAD,   NULL   },
+  { "ldh",  K_LOAD,   NULL   },
+  { "ldhu", K_LOAD,   NULL   },
+  { "ldb",  K_LOAD,   NULL   },
+  { "ldbu", K_LOAD,   NULL   },
+  { "stw",  K_STORE,  NULL   },
+  { "sth",  K_STORE,  NULL   },
+  { "stb",  K_STORE,  NULL   },
+};
+
+
+#define NUM_MNEMONICS	(sizeof(mnemonics) / sizeof(mnemonics[0]))
+
+
+static char *harmless[] = {
+  ".export", ".import", ".align", ".syn", ".nosyn",
+};
+
+
+#define NUM_HARMLESS	(sizeof(harmless) / sizeof(harmless[0]))
+
+
+static char *regName[32] = {
+  "$0",  "$1",  "$2",  "$3",  "$4",  "$5",  "$6",  "$7",
+  "$8",  "$9",  "$10", "$11", "$12", "$13", "$14", "$15",
+  "$16", "$17", "$18", "$19", "$20", "$21", "$22", "$23",
+  "$24", "$25", "$26", "$27", "$28", "$29", "$30", "$31",
+};
+
+
+typedef struct {
+  char *text;			/* the line as read */
+  char *buf;			/* copy of the line, cut into pieces */
+  int prefix;			/* length of the labels in front */
+  int labelled;			/* a code label is defined here */
+  int type;			/* type of line */
+  Mnemonic *mnem;		/* the instruction, if any */
+  int numArgs;			/* number of its arguments */
+  char *arg[MAX_ARGS];		/* text of the arguments */
+  int reg[MAX_ARGS];		/* register number of argument, or -1 */
+  int target;			/* line of jump target, or -1 */
+  unsigned int use;		/* registers read */
+  unsigned int def;		/* registers written */
+  unsigned int liveIn;		/* registers live before the line */
+  unsigned int liveOut;		/* registers live after the line */
+  int deleted;			/* the line has been removed */
+  int rewritten;		/* the line must be written from pieces */
+  int changed;			/* round of the last change */
+} Line;
+
+
+typedef struct {
+  char **names;			/* open addressing table of labels */
+  int *lines;			/* where the labels are defined */
+  unsigned int size;		/* number of slots, power of 2 */
+  unsigned int count;		/* number of labels */
+} LabelTable;
+
+
+typedef struct {
+  Line *lines;			/* all lines of the source */
+  int numLines;			/* number of lines */
+  int maxLines;			/* number of lines allocated */
+  LabelTable labels;		/* code labels */
+  unsigned int *stats;		/* rule statistics */
+} Source;
+
+
+/**************************************************************/
+
+/* labels */
+
+
+static unsigned int hashLabel(char *name) {
+  unsigned int h;
+
+  h = 5381;
+  while (*name != '\0') {
+    h = (h << 5) + h + (unsigned char) *name++;
+  }
+  return h;
+}
+
+
+static void enterLabel(LabelTable *t, char *name, int line);
+
+
+static void growLabels(LabelTable *t) {
+  LabelTable old;
+  unsigned int i;
+
+  old = *t;
+  t->size = old.size == 0 ? 256 : 2 * old.size;
+  t->count = 0;
+  t->names = allocateMemory(t->size * sizeof(char *));
+  t->lines = allocateMemory(t->size * sizeof(int));
+  for (i = 0; i < t->size; i++) {
+    t->names[i] = NULL;
+  }
+  for (i = 0; i < old.size; i++) {
+    if (old.names[i] != NULL) {
+      enterLabel(t, old.names[i], old.lines[i]);
+    }
+  }
+  if (old.size != 0) {
+    freeMemory(old.names);
+    freeMemory(old.lines);
+  }
+}
+
+
+static void enterLabel(LabelTable *t, char *name, int line) {
+  unsigned int i;
+
+  if (2 * (t->count + 1) > t->size) {
+    growLabels(t);
+  }
+  i = hashLabel(name) & (t->size - 1);
+  while (t->names[i] != NULL) {
+    if (strcmp(t->names[i], name) == 0) {
+      /* multiply defined, let the assembler complain */
+      return;
+    }
+    i = (i + 1) & (t->size - 1);
+  }
+  t->names[i] = name;
+  t->lines[i] = line;
+  t->count++;
+}
+
+
+static int lookupLabel(LabelTable *t, char *name) {
+  unsigned int i;
+
+  if (t->size == 0) {
+    return -1;
+  }
+  i = hashLabel(name) & (t->size - 1);
+  while (t->names[i] != NULL) {
+    if (strcmp(t->names[i], name) == 0) {
+      return t->lines[i];
+    }
+    i = (i + 1) & (t->size - 1);
+  }
+  return -1;
+}
+
+
+/**************************************************************/
+
+/* reading and classifying lines */
+
+
+static int isIdentStart(int c) {
+  return isalpha(c) || c == '_' || c == '.';
+}
+
+
+static int isIdentChar(int c) {
+  return isalnum(c) || c == '_' || c == '.';
+}
+
+
+static char *skipSpace(char *p) {
+  while (*p == ' ' || *p == '\t') {
+    p++;
+  }
+  return p;
+}
+
+
+static int regNumber(char *arg) {
+  int n;
+
+  if (*arg++ != '$' || !isdigit((unsigned char) *arg)) {
+    return -1;
+  }
+  n = 0;
+  while (isdigit((unsigned char) *arg)) {
+    n = n * 10 + (*arg++ - '0');
+    if (n >= 32) {
+      return -1;
+    }
+  }
+  return *arg == '\0' ? n : -1;
+}
+
+
+static int numberValue(char *arg, unsigned int *valp) {
+  char *end;
+
+  if (!isdigit((unsigned char) *arg)) {
+    return 0;
+  }
+  *valp = strtoul(arg, &end, 0);
+  return *end == '\0';
+}
+
+
+static int isZero(Line *lp, int i) {
+  unsigned int val;
+
+  return lp->reg[i] == 0 || (numberValue(lp->arg[i], &val) && val == 0);
+}
+
+
+static Mnemonic *lookupMnemonic(char *name) {
+  int i;
+
+  for (i = 0; i < NUM_MNEMONICS; i++) {
+    if (strcmp(mnemonics[i].name, name) == 0) {
+      return &mnemonics[i];
+    }
+  }
+  return NULL;
+}
+
+
+/*
+ * Check the operands of an instruction and compute the sets
+ * of registers which it reads and writes. Returns 0 if the
+ * operands do not have the expected form.
+ */
+static int setEffects(Line *lp) {
+  int *r;
+  unsigned int use, def;
+
+  r = lp->reg;
+  use = 0;
+  def = 0;
+  switch (lp->mnem->kind) {
+    case K_ALU:
+    case K_DIV:
+      if (lp->numArgs != 3 || r[0] < 0 || r[1] < 0) {
+        return 0;
+      }
+      def = BIT(r[0]);
+      use = BIT(r[1]) | (r[2] >= 0 ? BIT(r[2]) : 0);
+      break;
+    case K_LDHI:
+      if (lp->numArgs != 2 || r[0] < 0 || r[1] >= 0) {
+        return 0;
+      }
+      def = BIT(r[0]);
+      break;
+    case K_LOAD:
+      if (lp->numArgs != 3 || r[0] < 0 || r[1] < 0 || r[2] >= 0) {
+        return 0;
+      }
+      def = BIT(r[0]);
+      use = BIT(r[1]);
+      break;
+    case K_STORE:
+      if (lp->numArgs != 3 || r[0] < 0 || r[1] < 0 || r[2] >= 0) {
+        return 0;
+      }
+      use = BIT(r[0]) | BIT(r[1]);
+      break;
+    case K_BRANCH:
+      if (lp->numArgs != 3 || r[0] < 0 || r[1] < 0 || r[2] >= 0) {
+        return 0;
+      }
+      use = BIT(r[0]) | BIT(r[1]);
+      break;
+    case K_JUMP:
+    case K_CALL:
+      if (lp->numArgs != 1 || r[0] >= 0) {
+        return 0;
+      }
+      use = lp->mnem->kind == K_CALL ? CALL_USE : 0;
+      break;
+    case K_JR:
+    case K_CALLR:
+      if (lp->numArgs != 1 || r[0] < 0) {
+        return 0;
+      }
+      use = BIT(r[0]) | (lp->mnem->kind == K_CALLR ? CALL_USE : 0);
+      break;
+  }
+  /* $0 is neither a value nor a destination */
+  lp->use = use & ~BIT(0);
+  lp->def = def & ~BIT(0);
+  return 1;
+}
+
+
+static void parseInstr(Line *lp, char *p) {
+  char *q;
+  int i;
+
+  q = p;
+  while (isIdentChar((unsigned char) *q)) {
+    q++;
+  }
+  if (*q != '\0') {
+    *q++ = '\0';
+  }
+  lp->mnem = lookupMnemonic(p);
+  if (lp->mnem == NULL) {
+    lp->type = L_BARRIER;
+    return;
+  }
+  p = skipSpace(q);
+  q = strpbrk(p, ";\r\n");
+  if (q != NULL) {
+    *q = '\0';
+  }
+  lp->numArgs = 0;
+  while (*p != '\0') {
+    if (lp->numArgs == MAX_ARGS) {
+      lp->type = L_BARRIER;
+      return;
+    }
+    lp->arg[lp->numArgs++] = p;
+    q = strchr(p, ',');
+    p = q == NULL ? p + strlen(p) : q + 1;
+    if (q != NULL) {
+      *q = '\0';
+    }
+    /* strip trailing white space */
+    q = lp->arg[lp->numArgs - 1] + strlen(lp->arg[lp->numArgs - 1]);
+    while (q > lp->arg[lp->numArgs - 1] && (q[-1] == ' ' || q[-1] == '\t')) {
+      *--q = '\0';
+    }
+    p = skipSpace(p);
+  }
+  for (i = 0; i < MAX_ARGS; i++) {
+    lp->reg[i] = i < lp->numArgs ? regNumber(lp->arg[i]) : -1;
+  }
+  lp->type = setEffects(lp) ? L_INSTR : L_BARRIER;
+}
+
+
+static void parseLine(Source *src, int n, int *segp) {
+  Line *lp;
+  char *p, *q;
+  int i;
+
+  lp = &src->lines[n];
+  lp->buf = allocateMemory(strlen(lp->text) + 1);
+  strcpy(lp->buf, lp->text);
+  p = lp->buf;
+  /* labels */
+  while (1) {
+    p = skipSpace(p);
+    if (!isIdentStart((unsigned char) *p)) {
+      break;
+    }
+    q = p;
+    while (isIdentChar((unsigned char) *q)) {
+      q++;
+    }
+    if (*q != ':') {
+      break;
+    }
+    *q++ = '\0';
+    if (*segp == SEG_CODE) {
+      enterLabel(&src->labels, p, n);
+      lp->labelled = 1;
+    }
+    lp->prefix = q - lp->buf;
+    p = q;
+  }
+  lp->type = L_NONE;
+  if (!isIdentStart((unsigned char) *p)) {
+    /* empty line or comment, garbage is left to the assembler */
+    return;
+  }
+  if (*p != '.') {
+    if (*segp == SEG_CODE) {
+      parseInstr(lp, p);
+    }
+    return;
+  }
+  /* directives */
+  q = p;
+  while (isIdentChar((unsigned char) *q)) {
+    q++;
+  }
+  *q = '\0';
+  if (strcmp(p, ".code") == 0) {
+    *segp = SEG_CODE;
+    return;
+  }
+  if (strcmp(p, ".data") == 0 || strcmp(p, ".bss") == 0) {
+    *segp = SEG_OTHER;
+    return;
+  }
+  if (*segp != SEG_CODE) {
+    return;
+  }
+  for (i = 0; i < NUM_HARMLESS; i++) {
+    if (strcmp(p, harmless[i]) == 0) {
+      return;
+    }
+  }
+  lp->type = L_BARRIER;
+}
+
+
+/*
+ * Read a line of any length, including its newline (if any).
+ * The returned text is allocated; NULL is returned at EOF.
+ */
+static char *readLine(FILE *in) {
+  char *line, *p;
+  int size, len;
+
+  size = LINE_SIZE;
+  line = allocateMemory(size);
+  len = 0;
+  while (fgets(line + len, size - len, in) != NULL) {
+    len += strlen(line + len);
+    if (line[len - 1] == '\n' || len < size - 1) {
+      /* complete line, or last line without a newline */
+      return line;
+    }
+    p = allocateMemory(2 * size);
+    memcpy(p, line, len + 1);
+    freeMemory(line);
+    line = p;
+    size *= 2;
+  }
+  if (len == 0) {
+    freeMemory(line);
+    return NULL;
+  }
+  return line;
+}
+
+
+static void readSource(Source *src, FILE *in) {
+  char *line;
+  Line *lp;
+  int seg;
+  int i;
+
+  seg = SEG_CODE;
+  while ((line = readLine(in)) != NULL) {
+    if (src->numLines == src->maxLines) {
+      src->maxLines = src->maxLines == 0 ? 1024 : 2 * src->maxLines;
+      lp = allocateMemory(src->maxLines * sizeof(Line));
+      if (src->numLines != 0) {
+        memcpy(lp, src->lines, src->numLines * sizeof(Line));
+        freeMemory(src->lines);
+      }
+      src->lines = lp;
+    }
+    lp = &src->lines[src->numLines];
+    memset(lp, 0, sizeof(Line));
+    lp->text = line;
+    lp->target = -1;
+    parseLine(src, src->numLines, &seg);
+    src->numLines++;
+  }
+  for (i = 0; i < src->numLines; i++) {
+    lp = &src->lines[i];
+    if (lp->type == L_INSTR &&
+        (lp->mnem->kind == K_BRANCH || lp->mnem->kind == K_JUMP)) {
+      lp->target = lookupLabel(&src->labels, lp->arg[lp->numArgs - 1]);
+    }
+  }
+}
+
+
+/**************************************************************/
+
+/* liveness analysis */
+
+
+static void computeLiveness(Source *src) {
+  Line *lp;
+  unsigned int next, in, out;
+  int i, changed;
+
+  for (i = 0; i < src->numLines; i++) {
+    src->lines[i].liveIn = 0;
+    src->lines[i].liveOut = 0;
+  }
+  do {
+    changed = 0;
+    for (i = src->numLines - 1; i >= 0; i--) {
+      lp = &src->lines[i];
+      next = i + 1 < src->numLines ? src->lines[i + 1].liveIn : ALL_REGS;
+      if (lp->deleted || lp->type == L_NONE) {
+        in = next;
+        out = next;
+      } else
+      if (lp->type == L_BARRIER) {
+        in = ALL_REGS;
+        out = ALL_REGS;
+      } else {
+        switch (lp->mnem->kind) {
+          case K_JUMP:
+            out = lp->target >= 0 ?
+                    src->lines[lp->target].liveIn : ALL_REGS;
+            break;
+          case K_BRANCH:
+            out = next | (lp->target >= 0 ?
+                            src->lines[lp->target].liveIn : ALL_REGS);
+            break;
+          case K_JR:
+            out = lp->reg[0] == 31 ? RET_LIVE : ALL_REGS;
+            break;
+          default:
+            out = next;
+            break;
+        }
+        in = lp->use | (out & ~lp->def);
+      }
+      if (in != lp->liveIn || out != lp->liveOut) {
+        lp->liveIn = in;
+        lp->liveOut = out;
+        changed = 1;
+      }
+    }
+  } while (changed);
+}
+
+
+/**************************************************************/
+
+/* rules */
+
+
+/*
+ * The next instruction after line n in the same basic block,
+ * or -1 if there is a label or a barrier in between.
+ */
+static int nextInstr(Source *src, int n) {
+  Line *lp;
+  int i;
+
+  for (i = n + 1; i < src->numLines; i++) {
+    lp = &src->lines[i];
+    if (lp->labelled || lp->type == L_BARRIER) {
+      return -1;
+    }
+    if (!lp->deleted && lp->type == L_INSTR) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+
+/*
+ * Does control falling out of line n arrive at line 'target'
+ * without executing an instruction on the way?
+ */
+static int reaches(Source *src, int n, int target) {
+  Line *lp;
+  int i;
+
+  for (i = n + 1; i < src->numLines; i++) {
+    if (i == target) {
+      return 1;
+    }
+    lp = &src->lines[i];
+    if (!lp->deleted && lp->type != L_NONE) {
+      return 0;
+    }
+  }
+  return 0;
+}
+
+
+static int isMoveFrom(Line *lp, int r) {
+  if (strcmp(lp->mnem->name, "add") != 0 &&
+      strcmp(lp->mnem->name, "or") != 0) {
+    return 0;
+  }
+  return (lp->reg[1] == 0 && lp->reg[2] == r) ||
+         (lp->reg[1] == r && isZero(lp, 2));
+}
+
+
+static int isNop(Line *lp) {
+  char *name;
+
+  if (lp->mnem->kind != K_ALU) {
+    return 0;
+  }
+  if (lp->reg[0] == 0) {
+    return 1;
+  }
+  name = lp->mnem->name;
+  if (lp->reg[0] == lp->reg[1] && isZero(lp, 2) &&
+      (strcmp(name, "add") == 0 || strcmp(name, "sub") == 0 ||
+       strcmp(name, "or") == 0 || strcmp(name, "xor") == 0 ||
+       strcmp(name, "sll") == 0 || strcmp(name, "slr") == 0 ||
+       strcmp(name, "sar") == 0)) {
+    return 1;
+  }
+  if (lp->reg[1] == 0 && lp->reg[2] == lp->reg[0] &&
+      (strcmp(name, "add") == 0 || strcmp(name, "or") == 0 ||
+       strcmp(name, "xor") == 0)) {
+    return 1;
+  }
+  return 0;
+}
+
+
+static void deleteLine(Source *src, int n, int rule) {
+  src->lines[n].deleted = 1;
+  src->stats[rule]++;
+}
+
+
+static void setArg(Line *lp, int i, char *arg) {
+  lp->arg[i] = arg;
+  lp->reg[i] = regNumber(arg);
+  lp->rewritten = 1;
+}
+
+
+static int applyRules(Source *src, int round) {
+  Line *lp, *np;
+  int i, j, t, d;
+  unsigned int hi, lo;
+  int count;
+
+  count = 0;
+  for (i = 0; i < src->numLines; i++) {
+    lp = &src->lines[i];
+    if (lp->deleted || lp->type != L_INSTR) {
+      continue;
+    }
+    j = nextInstr(src, i);
+    np = j >= 0 ? &src->lines[j] : NULL;
+    /* jump or branch to the next line */
+    if ((lp->mnem->kind == K_JUMP || lp->mnem->kind == K_BRANCH) &&
+        lp->target >= 0 && reaches(src, i, lp->target)) {
+      deleteLine(src, i, PEEP_JUMP);
+      count++;
+      continue;
+    }
+    /* branch around a jump */
+    if (lp->mnem->kind == K_BRANCH && lp->target >= 0 &&
+        np != NULL && np->mnem->kind == K_JUMP && np->target >= 0 &&
+        reaches(src, j, lp->target)) {
+      lp->mnem = lookupMnemonic(lp->mnem->inverse);
+      setArg(lp, 2, np->arg[0]);
+      lp->target = np->target;
+      lp->changed = round;
+      deleteLine(src, j, PEEP_BRANCH);
+      count++;
+      continue;
+    }
+    /* reload of a stack slot which has just been stored */
+    if (strcmp(lp->mnem->name, "stw") == 0 && lp->reg[1] == 29 &&
+        np != NULL && strcmp(np->mnem->name, "ldw") == 0 &&
+        np->reg[1] == 29 && strcmp(np->arg[2], lp->arg[2]) == 0) {
+      if (np->reg[0] == lp->reg[0]) {
+        deleteLine(src, j, PEEP_RELOAD);
+      } else {
+        np->mnem = lookupMnemonic("add");
+        setArg(np, 1, regName[0]);
+        setArg(np, 2, regName[lp->reg[0]]);
+        setEffects(np);
+        np->changed = round;
+        src->stats[PEEP_RELOAD]++;
+      }
+      count++;
+      continue;
+    }
+    /* instruction without effect */
+    if (isNop(lp)) {
+      deleteLine(src, i, PEEP_NOP);
+      count++;
+      continue;
+    }
+    /* ldhi of a constant which fits into the or following it */
+    if (lp->mnem->kind == K_LDHI &&
+        numberValue(lp->arg[1], &hi) && (hi >> 16) == 0 &&
+        np != NULL && strcmp(np->mnem->name, "or") == 0 &&
+        np->reg[0] == lp->reg[0] && np->reg[1] == lp->reg[0] &&
+        numberValue(np->arg[2], &lo) && lo <= 0xFFFF) {
+      setArg(np, 1, regName[0]);
+      setEffects(np);
+      np->changed = round;
+      deleteLine(src, i, PEEP_LDHI);
+      count++;
+      continue;
+    }
+    /* liveness is only known for lines not changed in this round */
+    if (lp->changed == round || (np != NULL && np->changed == round)) {
+      continue;
+    }
+    /* move from a register which has just been computed */
+    t = lp->reg[0];
+    if ((lp->mnem->kind == K_ALU || lp->mnem->kind == K_DIV ||
+         lp->mnem->kind == K_LDHI || lp->mnem->kind == K_LOAD) &&
+        t > 1 && np != NULL && np->mnem->kind == K_ALU &&
+        isMoveFrom(np, t) && (np->liveOut & BIT(t)) == 0) {
+      d = np->reg[0];
+      if (d > 1 && d != t) {
+        setArg(lp, 0, regName[d]);
+        setEffects(lp);
+        lp->changed = round;
+        deleteLine(src, j, PEEP_MOVE);
+        count++;
+        continue;
+      }
+    }
+    /* result which is never used */
+    if ((lp->mnem->kind == K_ALU || lp->mnem->kind == K_LDHI) &&
+        t > 1 && (lp->liveOut & BIT(t)) == 0) {
+      deleteLine(src, i, PEEP_DEAD);
+      count++;
+      continue;
+    }
+  }
+  return count;
+}
+
+
+/**************************************************************/
+
+/* writing the result */
+
+
+static void writeSource(Source *src, FILE *out) {
+  Line *lp;
+  int i, k;
+
+  for (i = 0; i < src->numLines; i++) {
+    lp = &src->lines[i];
+    if (lp->deleted) {
+      fprintf(out, "%.*s\n", lp->prefix, lp->text);
+    } else
+    if (lp->rewritten) {
+      fprintf(out, "%.*s\t%s\t", lp->prefix, lp->text, lp->mnem->name);
+      for (k = 0; k < lp->numArgs; k++) {
+        fprintf(out, "%s%s", k == 0 ? "" : ",", lp->arg[k]);
+      }
+      fprintf(out, "\n");
+    } else {
+      fputs(lp->text, out);
+    }
+  }
+}
+
+
+static void freeSource(Source *src) {
+  int i;
+
+  for (i = 0; i < src->numLines; i++) {
+    freeMemory(src->lines[i].text);
+    freeMemory(src->lines[i].buf);
+  }
+  if (src->maxLines != 0) {
+    freeMemory(src->lines);
+  }
+  if (src->labels.size != 0) {
+    freeMemory(src->labels.names);
+    freeMemory(src->labels.lines);
+  }
+}
+
+
+/**************************************************************/
+
+
+/*
+ * Copy the source from 'in' to 'out', optimizing it on the
+ * way. The number of applications of each rule is added to
+ * the corresponding element of 'stats'.
+ */
+void peephole(FILE *in, FILE *out, unsigned int *stats) {
+  Source src;
+  int round;
+
+  memset(&src, 0, sizeof(Source));
+  src.stats = stats;
+  readSource(&src, in);
+  for (round = 1; round <= MAX_ROUNDS; round++) {
+    computeLiveness(&src);
+    if (applyRules(&src, round) == 0) {
+      break;
+    }
+  }
+  writeSource(&src, out);
+  freeSource(&src);
+}
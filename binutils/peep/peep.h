@@ -0,0 +1,31 @@
+/*
+ * peep.h -- peephole optimizer for assembler source
+ */
+
+
+#ifndef _PEEP_H_
+#define _PEEP_H_
+
+
+#define PEEP_JUMP	0	/* jumps and branches to the next line */
+#define PEEP_BRANCH	1	/* branches around unconditional jumps */
+#define PEEP_RELOAD	2	/* reloads of a just stored stack slot */
+#define PEEP_MOVE	3	/* moves folded into their source */
+#define PEEP_NOP	4	/* instructions without effect */
+#define PEEP_DEAD	5	/* instructions with unused results */
+#define PEEP_LDHI	6	/* ldhi/or pairs for 16-bit constants */
+#define PEEP_NUM_RULES	7
+
+
+extern char *peepRuleName[PEEP_NUM_RULES];
+
+
+void peephole(FILE *in, FILE *out, unsigned int *stats);
+
+
+/* to be supplied by the program using the optimizer */
+void *allocateMemory(unsigned int size);
+void freeMemory(void *p);
+
+
+#endif /* _PEEP_H_ */
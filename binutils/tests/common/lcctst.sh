@@ -0,0 +1,60 @@
+#
+# lcctst.sh -- common part of the tests which compile the lcc
+#              test programs, run them in the simulator and
+#              compare their outputs (sourced by their runtst,
+#              with BUILD set and the test's directory current)
+#
+
+TST=../../../lcc/tst
+LIBC=../../../lib/libc
+COMMON=../common
+WORK=work
+TIMEOUT=30
+
+PATH=$BUILD/bin:$PATH
+export PATH
+
+mkdir -p $WORK
+failed=0
+
+# the library's stdio, with character I/O taken from runtime.c
+cp $LIBC/stdio/stdio.c $WORK/stdio.c
+sed -e 's/^char getc(void) {/static char serialGetc(void) {/' \
+    -e 's/^void putc(char c) {/static void serialPutc(char c) {/' \
+    $LIBC/stdio/prelimio.c >$WORK/prelimio.c
+
+percent() {
+  awk "BEGIN { printf \"%.1f%%\", ($1 - $2) * 100 / $1 }"
+}
+
+# the standard input of test $1, as data to be linked with it
+input() {
+  {
+    echo "	.data"
+    echo "	.export	input"
+    echo "input:"
+    if [ -s $TST/$1.0 ] ; then
+      od -An -v -tu1 $TST/$1.0 | tr -s ' ' '\n' | grep . | \
+        sed -e 's/^/	.byte	/'
+    fi
+    echo "	.align	4"
+    echo "	.export	inputSize"
+    echo "inputSize:"
+    echo "	.word	`wc -c <$TST/$1.0`"
+  } >$WORK/input.s
+}
+
+# build and run version $2 of test $1 with lcc options $3
+# and simulator options $4, the output without the
+# instruction count goes to $WORK/$1.$2.txt
+run() {
+  rm -f $WORK/$1.$2 $WORK/$1.$2.bin $WORK/$1.$2.out
+  if lcc $3 -Wo-nostdlib -Wl-L$BUILD/lib -o $WORK/$1.$2 \
+       $COMMON/start.s $COMMON/runtime.c $WORK/input.s $WORK/stdio.c \
+       $TST/$1.c -lc >$WORK/$1.$2.log 2>&1 && \
+     load $WORK/$1.$2 $WORK/$1.$2.bin >>$WORK/$1.$2.log 2>&1 ; then
+    timeout $TIMEOUT sim -s 0 -l $WORK/$1.$2.bin -o $WORK/$1.$2.out \
+      $4 >>$WORK/$1.$2.log 2>&1 </dev/null
+  fi
+  grep -v '^@instructions ' $WORK/$1.$2.out >$WORK/$1.$2.txt 2>/dev/null
+}
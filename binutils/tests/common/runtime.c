@@ -0,0 +1,57 @@
+/*
+ * runtime.c -- character I/O and exit for the test programs
+ */
+
+
+#define OUTPUT		((volatile unsigned int *) 0xFF000000)
+#define SHUTDOWN	((volatile unsigned int *) 0xFF100000)
+#define STATS		((volatile unsigned int *) 0xFF200000)
+
+
+extern char input[];		/* standard input of the program */
+extern int inputSize;
+
+static int inputPos = 0;
+
+
+char getc(void) {
+  if (inputPos == inputSize) {
+    return -1;
+  }
+  return input[inputPos++];
+}
+
+
+void putc(char c) {
+  if (c != '\r') {
+    *OUTPUT = c;
+  }
+}
+
+
+/*
+ * Append the number of instructions executed so far to the
+ * output on a line of its own, then stop the simulator.
+ */
+void exit(int status) {
+  unsigned int n;
+  char digits[12];
+  char *p;
+  int i;
+
+  n = *STATS;
+  p = "\n@instructions ";
+  while (*p != '\0') {
+    *OUTPUT = *p++;
+  }
+  i = 0;
+  do {
+    digits[i++] = n % 10 + '0';
+    n /= 10;
+  } while (n != 0);
+  while (i > 0) {
+    *OUTPUT = digits[--i];
+  }
+  *OUTPUT = '\n';
+  *SHUTDOWN = status;
+}
@@ -0,0 +1,17 @@
+;
+; start.s -- startup for the test programs
+;
+
+	.export	_start
+	.import	main
+	.import	exit
+
+	.code
+
+_start:
+	add	$29,$0,0xC0100000
+	jal	main
+	add	$4,$0,$2
+	jal	exit
+_stop:
+	j	_stop
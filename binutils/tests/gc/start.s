@@ -0,0 +1,8 @@
+	.import	f
+	.export	_start
+	.code
+_start:
+	jal	f
+	j	_start
+	.data
+x:	.word	_start
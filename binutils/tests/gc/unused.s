@@ -0,0 +1,6 @@
+	.export	g
+	.code
+g:	add	$2,$0,1
+	jr	$31
+	.data
+	.word	1,2,3
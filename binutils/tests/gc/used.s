@@ -0,0 +1,8 @@
+	.export	f
+	.code
+f:	ldw	$2,$0,v
+	jr	$31
+	.data
+v:	.word	42
+	.bss
+b:	.space	16
@@ -0,0 +1,52 @@
+;
+; rules.s -- a case for each rule of the peephole optimizer,
+;            and some which must be left alone
+;
+
+	.code
+	.export	f
+
+f:
+	; jump to the next line
+	j	L1
+L1:
+	; branch around a jump
+	beq	$4,$0,L2
+	j	L3
+L2:
+	add	$2,$0,1
+L3:
+	; reload of a stack slot
+	stw	$5,$29,8
+	ldw	$8,$29,8
+	add	$2,$2,$8
+	; move folded into the load
+	ldw	$8,$4,0
+	add	$6,$0,$8
+	add	$2,$2,$6
+	; no-op
+	add	$2,$2,0
+	; unused result
+	add	$9,$0,7
+	; ldhi/or pair
+	ldhi	$10,0
+	or	$10,$10,0x1234
+	add	$2,$2,$10
+	; keep: the register is still used after the move
+	ldw	$11,$4,4
+	add	$12,$0,$11
+	add	$2,$2,$11
+	add	$2,$2,$12
+	; keep: not a stack slot
+	stw	$5,$4,8
+	ldw	$13,$4,8
+	add	$2,$2,$13
+	; keep: the result is an argument
+	add	$4,$0,$2
+	jal	g
+	; keep: a loop uses the result
+	add	$14,$0,10
+L4:
+	sub	$14,$14,1
+	bne	$14,$0,L4
+	jr	$31
@@ -0,0 +1,16 @@
+	.data
+	.export	input
+input:
+	.byte	97
+	.byte	61
+	.byte	45
+	.byte	98
+	.byte	43
+	.byte	53
+	.byte	42
+	.byte	99
+	.byte	10
+	.align	4
+	.export	inputSize
+inputSize:
+	.word	9
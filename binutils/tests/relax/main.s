@@ -0,0 +1,48 @@
+	.import	small, tiny, off8, big, sub
+	.export	_start
+	.code
+_start:
+	add	$8,$0,small
+	or	$9,$0,tiny
+	add	$10,$0,data
+	ldw	$11,$10,off8
+	add	$12,$0,big
+	add	$4,$0,1
+	beq	$8,$0,fail
+	sub	$13,$8,0x1234
+	bne	$13,$0,fail
+	add	$4,$0,2
+	sub	$13,$9,0xABCD
+	bne	$13,$0,fail
+	add	$4,$0,3
+	sub	$13,$11,333
+	bne	$13,$0,fail
+	add	$4,$0,4
+	sub	$13,$12,0x12345
+	bne	$13,$0,fail
+	add	$4,$0,5
+	jal	sub
+	sub	$13,$2,0x1234+0xABCD
+	bne	$13,$0,fail
+	add	$4,$0,6
+	add	$5,$0,tab
+	ldw	$5,$5,4
+	jr	$5
+	j	fail
+L1:	j	fail
+L2:	add	$4,$0,small
+	add	$4,$4,tiny
+	ldw	$6,$0,cnt
+	add	$6,$6,1
+	stw	$6,$0,cnt
+	sub	$6,$6,3
+	bne	$6,$0,L2
+	add	$4,$0,0
+fail:	add	$7,$0,0xFF100000
+	stw	$4,$7,0
+	j	fail
+	.data
+data:	.word	111,222,333
+tab:	.word	L1,L2
+	.bss
+cnt:	.space	4
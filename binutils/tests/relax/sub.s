@@ -0,0 +1,6 @@
+	.import	small, tiny
+	.export	sub
+	.code
+sub:	add	$2,$0,small
+	add	$2,$2,tiny
+	jr	$31
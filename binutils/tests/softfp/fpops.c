@@ -0,0 +1,143 @@
+/*
+ * fpops.c -- every floating-point operation in both sizes,
+ *            and a block copy done by memcpy
+ *
+ * The results are printed as bit patterns, so that any
+ * difference to the host's IEEE arithmetic shows.
+ */
+
+#include <stdio.h>
+
+
+#define N	10
+
+float fv[N] = {
+  0.0f, 1.0f, -2.5f, 0.1f, 3.0f, -1.0e-3f,
+  1.5e30f, -7.25e-30f, 1.0e-40f, 123456.789f,
+};
+
+double dv[N] = {
+  0.0, 1.0, -2.5, 0.1, 3.0, -1.0e-3,
+  1.5e300, -7.25e-300, 3.0e-308, 123456.789,
+};
+
+int iv[N] = {
+  0, 1, -1, 7, -100, 12345, -654321, 16777217, 2147483647, -2147483647,
+};
+
+unsigned uv[N] = {
+  0, 1, 2, 255, 65535, 16777217, 2147483647,
+  2147483648u, 3000000001u, 4294967295u,
+};
+
+struct blk {
+  unsigned char c[100];
+} b0, b1, *bdst = &b1, *bsrc = &b0;
+
+
+void pf(float f) {
+  union {
+    float f;
+    unsigned w;
+  } u;
+
+  u.f = f;
+  printf(" %08x", u.w);
+}
+
+
+void pd(double d) {
+  union {
+    double d;
+    unsigned w[2];
+  } u;
+  unsigned one = 1;
+
+  u.d = d;
+  if (*(unsigned char *) &one == 1) {
+    /* little endian host */
+    printf(" %08x%08x", u.w[1], u.w[0]);
+  } else {
+    printf(" %08x%08x", u.w[0], u.w[1]);
+  }
+}
+
+
+int cmpf(float a, float b) {
+  return (a == b) | (a != b) << 1 | (a < b) << 2 |
+         (a <= b) << 3 | (a > b) << 4 | (a >= b) << 5;
+}
+
+
+int cmpd(double a, double b) {
+  return (a == b) | (a != b) << 1 | (a < b) << 2 |
+         (a <= b) << 3 | (a > b) << 4 | (a >= b) << 5;
+}
+
+
+void copy(void) {
+  *bdst = *bsrc;
+}
+
+
+int main(void) {
+  int i, j;
+  unsigned sum;
+  float f, g;
+  double d, e;
+
+  for (i = 0; i < N; i++) {
+    for (j = 0; j < N; j++) {
+      f = fv[i];
+      g = fv[j];
+      printf("f %d %d", i, j);
+      pf(f + g);
+      pf(f - g);
+      pf(f * g);
+      if (g != 0.0f) {
+        pf(f / g);
+      }
+      printf(" %02x\n", cmpf(f, g));
+      d = dv[i];
+      e = dv[j];
+      printf("d %d %d", i, j);
+      pd(d + e);
+      pd(d - e);
+      pd(d * e);
+      if (e != 0.0) {
+        pd(d / e);
+      }
+      printf(" %02x\n", cmpd(d, e));
+    }
+  }
+  for (i = 0; i < N; i++) {
+    printf("c %d", i);
+    f = fv[i];
+    d = dv[i];
+    if (f > -2.0e9f && f < 2.0e9f) {
+      printf(" %d", (int) f);
+    }
+    if (d > -2.0e9 && d < 2.0e9) {
+      printf(" %d", (int) d);
+    }
+    pd(f);
+    if (d > -3.0e38 && d < 3.0e38) {
+      pf(d);
+    }
+    pf(iv[i]);
+    pd(iv[i]);
+    pf(uv[i]);
+    pd(uv[i]);
+    printf("\n");
+  }
+  for (i = 0; i < sizeof(b0.c); i++) {
+    b0.c[i] = i * 7;
+  }
+  copy();
+  sum = 0;
+  for (i = 0; i < sizeof(b1.c); i++) {
+    sum = sum * 3 + b1.c[i];
+  }
+  printf("b %08x\n", sum);
+  return 0;
+}
@@ -0,0 +1,7 @@
+	.data
+	.export	input
+input:
+	.align	4
+	.export	inputSize
+inputSize:
+	.word	0
@@ -0,0 +1,305 @@
+/*
+ * fputest.c -- check the simulator's FPU against TestFloat
+ *
+ * Reads test cases as written by TestFloat's testfloat_gen
+ * from stdin, computes them with the simulator's FPU, and
+ * reports every case which differs in result or flags.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <setjmp.h>
+
+#include "common.h"
+#include "console.h"
+#include "error.h"
+#include "except.h"
+#include "fpu.h"
+
+
+#define IS_NAN(x)	((~(x) & 0x7F800000) == 0 && ((x) & 0x7FFFFF) != 0)
+#define IS_NAND(x)	((~(x) & 0x7FF0000000000000ULL) == 0 && \
+			 ((x) & 0x000FFFFFFFFFFFFFULL) != 0)
+
+#define MAX_REPORTS	20
+
+
+/**************************************************************/
+
+/*
+ * stubs for the simulator functions used by the FPU
+ */
+
+
+void cPrintf(char *fmt, ...) {
+}
+
+
+void error(char *fmt, ...) {
+  va_list ap;
+
+  va_start(ap, fmt);
+  printf("Error: ");
+  vprintf(fmt, ap);
+  printf("\n");
+  va_end(ap);
+  exit(1);
+}
+
+
+void throwException(int exception) {
+  error("exception %d thrown", exception);
+}
+
+
+/**************************************************************/
+
+
+typedef struct {
+  char *name;		/* TestFloat's name of the function */
+  int numArgs;		/* number of operands */
+  int resKind;		/* kind of result, see below */
+  Dword (*func)(Dword x, Dword y);
+} Function;
+
+#define RES_BOOL	0	/* result is a boolean */
+#define RES_F32		1	/* result is single precision */
+#define RES_F64		2	/* result is double precision */
+#define RES_I32		3	/* result is an integer */
+
+
+static Dword add(Dword x, Dword y) {
+  return fpAdd(x, y);
+}
+
+
+static Dword sub(Dword x, Dword y) {
+  return fpSub(x, y);
+}
+
+
+static Dword mul(Dword x, Dword y) {
+  return fpMul(x, y);
+}
+
+
+static Dword div_(Dword x, Dword y) {
+  return fpDiv(x, y);
+}
+
+
+static Dword sqrt_(Dword x, Dword y) {
+  return fpSqrt(x);
+}
+
+
+static Dword itof(Dword x, Dword y) {
+  return fpItoF(x);
+}
+
+
+static Dword ftoi(Dword x, Dword y) {
+  return fpFtoI(x);
+}
+
+
+static Dword ftod(Dword x, Dword y) {
+  return fpFtoD(x);
+}
+
+
+static Dword eq(Dword x, Dword y) {
+  return fpCmp(x, y, false) == FPU_CMP_EQ;
+}
+
+
+static Dword lt(Dword x, Dword y) {
+  return fpCmp(x, y, false) == FPU_CMP_LT;
+}
+
+
+static Dword le(Dword x, Dword y) {
+  return (fpCmp(x, y, false) & (FPU_CMP_LT | FPU_CMP_EQ)) != 0;
+}
+
+
+static Dword lts(Dword x, Dword y) {
+  return fpCmp(x, y, true) == FPU_CMP_LT;
+}
+
+
+static Dword addD(Dword x, Dword y) {
+  return fpAddD(x, y);
+}
+
+
+static Dword subD(Dword x, Dword y) {
+  return fpSubD(x, y);
+}
+
+
+static Dword mulD(Dword x, Dword y) {
+  return fpMulD(x, y);
+}
+
+
+static Dword divD(Dword x, Dword y) {
+  return fpDivD(x, y);
+}
+
+
+static Dword sqrtD(Dword x, Dword y) {
+  return fpSqrtD(x);
+}
+
+
+static Dword itod(Dword x, Dword y) {
+  return fpItoD(x);
+}
+
+
+static Dword dtoi(Dword x, Dword y) {
+  return fpDtoI(x);
+}
+
+
+static Dword dtof(Dword x, Dword y) {
+  return fpDtoF(x);
+}
+
+
+static Dword eqD(Dword x, Dword y) {
+  return fpCmpD(x, y, false) == FPU_CMP_EQ;
+}
+
+
+static Dword ltD(Dword x, Dword y) {
+  return fpCmpD(x, y, false) == FPU_CMP_LT;
+}
+
+
+static Dword leD(Dword x, Dword y) {
+  return (fpCmpD(x, y, false) & (FPU_CMP_LT | FPU_CMP_EQ)) != 0;
+}
+
+
+static Dword ltsD(Dword x, Dword y) {
+  return fpCmpD(x, y, true) == FPU_CMP_LT;
+}
+
+
+static Function functions[] = {
+  { "f32_add",             2, RES_F32,  add   },
+  { "f32_sub",             2, RES_F32,  sub   },
+  { "f32_mul",             2, RES_F32,  mul   },
+  { "f32_div",             2, RES_F32,  div_  },
+  { "f32_sqrt",            1, RES_F32,  sqrt_ },
+  { "i32_to_f32",          1, RES_F32,  itof  },
+  { "f32_to_i32_r_minMag", 1, RES_I32,  ftoi  },
+  { "f32_to_f64",          1, RES_F64,  ftod  },
+  { "f32_eq",              2, RES_BOOL, eq    },
+  { "f32_lt_quiet",        2, RES_BOOL, lt    },
+  { "f32_le_quiet",        2, RES_BOOL, le    },
+  { "f32_lt",              2, RES_BOOL, lts   },
+  { "f64_add",             2, RES_F64,  addD  },
+  { "f64_sub",             2, RES_F64,  subD  },
+  { "f64_mul",             2, RES_F64,  mulD  },
+  { "f64_div",             2, RES_F64,  divD  },
+  { "f64_sqrt",            1, RES_F64,  sqrtD },
+  { "i32_to_f64",          1, RES_F64,  itod  },
+  { "f64_to_i32_r_minMag", 1, RES_I32,  dtoi  },
+  { "f64_to_f32",          1, RES_F32,  dtof  },
+  { "f64_eq",              2, RES_BOOL, eqD   },
+  { "f64_lt_quiet",        2, RES_BOOL, ltD   },
+  { "f64_le_quiet",        2, RES_BOOL, leD   },
+  { "f64_lt",              2, RES_BOOL, ltsD  },
+};
+
+
+static struct {
+  char *name;
+  int mode;
+} roundings[] = {
+  { "near_even", FPU_RND_NEAR },
+  { "minMag",    FPU_RND_ZERO },
+  { "min",       FPU_RND_DOWN },
+  { "max",       FPU_RND_UP   },
+};
+
+
+int main(int argc, char *argv[]) {
+  Function *f;
+  int mode;
+  int i;
+  char line[120];
+  Dword arg[2], expected, expFlags;
+  Dword result, flags;
+  Bool same;
+  int n;
+  long total, errors;
+
+  if (argc != 4 ||
+      (strcmp(argv[1], "host") != 0 && strcmp(argv[1], "soft") != 0)) {
+    printf("usage: %s host|soft <function> <rounding mode>\n", argv[0]);
+    exit(1);
+  }
+  f = NULL;
+  for (i = 0; i < sizeof(functions) / sizeof(functions[0]); i++) {
+    if (strcmp(argv[2], functions[i].name) == 0) {
+      f = &functions[i];
+    }
+  }
+  if (f == NULL) {
+    error("unknown function '%s'", argv[2]);
+  }
+  mode = -1;
+  for (i = 0; i < sizeof(roundings) / sizeof(roundings[0]); i++) {
+    if (strcmp(argv[3], roundings[i].name) == 0) {
+      mode = roundings[i].mode;
+    }
+  }
+  if (mode < 0) {
+    error("unknown rounding mode '%s'", argv[3]);
+  }
+  fpUseHost(strcmp(argv[1], "host") == 0);
+  fpSetRound(mode);
+  total = 0;
+  errors = 0;
+  while (fgets(line, sizeof(line), stdin) != NULL) {
+    arg[1] = 0;
+    if (f->numArgs == 1) {
+      n = sscanf(line, "%llx %llx %llx", &arg[0], &expected, &expFlags);
+    } else {
+      n = sscanf(line, "%llx %llx %llx %llx",
+                 &arg[0], &arg[1], &expected, &expFlags);
+    }
+    if (n != f->numArgs + 2) {
+      error("cannot read test case '%s'", line);
+    }
+    fpSetFlags(0);
+    result = (*f->func)(arg[0], arg[1]);
+    flags = fpGetFlags();
+    total++;
+    same = (result == expected);
+    if (f->resKind == RES_F32) {
+      same |= IS_NAN(result) && IS_NAN(expected);
+    }
+    if (f->resKind == RES_F64) {
+      same |= IS_NAND(result) && IS_NAND(expected);
+    }
+    if (same && flags == expFlags) {
+      continue;
+    }
+    if (errors++ < MAX_REPORTS) {
+      printf("%s %s: %llX %llX -> %llX %02llX, expected %llX %02llX\n",
+             f->name, argv[3], arg[0], arg[1],
+             result, flags, expected, expFlags);
+    }
+  }
+  printf("%s (%s, %s): %ld cases, %ld errors\n",
+         f->name, argv[1], argv[3], total, errors);
+  return errors != 0;
+}
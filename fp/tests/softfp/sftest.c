@@ -0,0 +1,335 @@
+/*
+ * sftest.c -- check the soft-float library against TestFloat
+ *
+ * Reads test cases as written by TestFloat's testfloat_gen
+ * from stdin, computes them with the library functions
+ * (compiled for the host), and reports every case whose
+ * result differs. The library does not record exception
+ * flags, so these are not compared.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "softfp.h"
+
+
+typedef unsigned long long Dword;
+
+#define IS_NAN64(x)	((~(x) & 0x7FF0000000000000ULL) == 0 && \
+			 ((x) & 0x000FFFFFFFFFFFFFULL) != 0)
+
+#define MAX_REPORTS	20
+
+
+/**************************************************************/
+
+/*
+ * the library functions, and a host version of __mulhi
+ */
+
+
+Word __addsf3(Word x, Word y);
+Word __subsf3(Word x, Word y);
+Word __mulsf3(Word x, Word y);
+Word __divsf3(Word x, Word y);
+Word __sqrtsf2(Word x);
+Word __floatsisf(int x);
+int __fixsfsi(Word x);
+int __eqsf2(Word x, Word y);
+int __nesf2(Word x, Word y);
+int __ltsf2(Word x, Word y);
+int __lesf2(Word x, Word y);
+int __gtsf2(Word x, Word y);
+int __gesf2(Word x, Word y);
+
+double __adddf3(Word xh, Word xl, Word yh, Word yl);
+double __subdf3(Word xh, Word xl, Word yh, Word yl);
+double __muldf3(Word xh, Word xl, Word yh, Word yl);
+double __divdf3(Word xh, Word xl, Word yh, Word yl);
+double __sqrtdf2(Word xh, Word xl);
+double __floatsidf(int x);
+int __fixdfsi(Word xh, Word xl);
+double __extendsfdf2(Word x);
+Word __truncdfsf2(Word xh, Word xl);
+int __eqdf2(Word xh, Word xl, Word yh, Word yl);
+int __nedf2(Word xh, Word xl, Word yh, Word yl);
+int __ltdf2(Word xh, Word xl, Word yh, Word yl);
+int __ledf2(Word xh, Word xl, Word yh, Word yl);
+int __gtdf2(Word xh, Word xl, Word yh, Word yl);
+int __gedf2(Word xh, Word xl, Word yh, Word yl);
+
+
+Word __mulhi(Word x, Word y) {
+  return ((Dword) x * y) >> 32;
+}
+
+
+/**************************************************************/
+
+
+#define HI(x)		((Word) ((x) >> 32))
+#define LO(x)		((Word) (x))
+
+
+/*
+ * The library stores the high-order word of a double
+ * first, regardless of the host's byte order.
+ */
+static Dword fromDouble(double d) {
+  Double z;
+
+  z.d = d;
+  return ((Dword) z.w[0] << 32) | z.w[1];
+}
+
+
+typedef struct {
+  char *name;		/* TestFloat's name of the function */
+  int numArgs;		/* number of operands */
+  int resKind;		/* kind of result, see below */
+  Dword (*func)(Dword x, Dword y);
+} Function;
+
+#define RES_BOOL	0	/* result is a boolean */
+#define RES_F32		1	/* result is single precision */
+#define RES_F64		2	/* result is double precision */
+#define RES_I32		3	/* result is an integer */
+
+
+static Dword add(Dword x, Dword y) {
+  return __addsf3(x, y);
+}
+
+
+static Dword sub(Dword x, Dword y) {
+  return __subsf3(x, y);
+}
+
+
+static Dword mul(Dword x, Dword y) {
+  return __mulsf3(x, y);
+}
+
+
+static Dword div_(Dword x, Dword y) {
+  return __divsf3(x, y);
+}
+
+
+static Dword sqrt_(Dword x, Dword y) {
+  return __sqrtsf2(x);
+}
+
+
+static Dword itof(Dword x, Dword y) {
+  return __floatsisf(x);
+}
+
+
+static Dword ftoi(Dword x, Dword y) {
+  return (Word) __fixsfsi(x);
+}
+
+
+static Dword ftod(Dword x, Dword y) {
+  return fromDouble(__extendsfdf2(x));
+}
+
+
+/*
+ * Each relation is also checked with swapped
+ * operands, which exercises the other helpers.
+ */
+static Dword eq(Dword x, Dword y) {
+  int r;
+
+  r = (__eqsf2(x, y) == 0);
+  if ((__nesf2(x, y) != 0) == r) {
+    return 2;
+  }
+  return r;
+}
+
+
+static Dword lt(Dword x, Dword y) {
+  int r;
+
+  r = (__ltsf2(x, y) < 0);
+  if ((__gtsf2(y, x) > 0) != r) {
+    return 2;
+  }
+  return r;
+}
+
+
+static Dword le(Dword x, Dword y) {
+  int r;
+
+  r = (__lesf2(x, y) <= 0);
+  if ((__gesf2(y, x) >= 0) != r) {
+    return 2;
+  }
+  return r;
+}
+
+
+static Dword addD(Dword x, Dword y) {
+  return fromDouble(__adddf3(HI(x), LO(x), HI(y), LO(y)));
+}
+
+
+static Dword subD(Dword x, Dword y) {
+  return fromDouble(__subdf3(HI(x), LO(x), HI(y), LO(y)));
+}
+
+
+static Dword mulD(Dword x, Dword y) {
+  return fromDouble(__muldf3(HI(x), LO(x), HI(y), LO(y)));
+}
+
+
+static Dword divD(Dword x, Dword y) {
+  return fromDouble(__divdf3(HI(x), LO(x), HI(y), LO(y)));
+}
+
+
+static Dword sqrtD(Dword x, Dword y) {
+  return fromDouble(__sqrtdf2(HI(x), LO(x)));
+}
+
+
+static Dword itod(Dword x, Dword y) {
+  return fromDouble(__floatsidf(x));
+}
+
+
+static Dword dtoi(Dword x, Dword y) {
+  return (Word) __fixdfsi(HI(x), LO(x));
+}
+
+
+static Dword dtof(Dword x, Dword y) {
+  return __truncdfsf2(HI(x), LO(x));
+}
+
+
+static Dword eqD(Dword x, Dword y) {
+  int r;
+
+  r = (__eqdf2(HI(x), LO(x), HI(y), LO(y)) == 0);
+  if ((__nedf2(HI(x), LO(x), HI(y), LO(y)) != 0) == r) {
+    return 2;
+  }
+  return r;
+}
+
+
+static Dword ltD(Dword x, Dword y) {
+  int r;
+
+  r = (__ltdf2(HI(x), LO(x), HI(y), LO(y)) < 0);
+  if ((__gtdf2(HI(y), LO(y), HI(x), LO(x)) > 0) != r) {
+    return 2;
+  }
+  return r;
+}
+
+
+static Dword leD(Dword x, Dword y) {
+  int r;
+
+  r = (__ledf2(HI(x), LO(x), HI(y), LO(y)) <= 0);
+  if ((__gedf2(HI(y), LO(y), HI(x), LO(x)) >= 0) != r) {
+    return 2;
+  }
+  return r;
+}
+
+
+static Function functions[] = {
+  { "f32_add",             2, RES_F32,  add   },
+  { "f32_sub",             2, RES_F32,  sub   },
+  { "f32_mul",             2, RES_F32,  mul   },
+  { "f32_div",             2, RES_F32,  div_  },
+  { "f32_sqrt",            1, RES_F32,  sqrt_ },
+  { "i32_to_f32",          1, RES_F32,  itof  },
+  { "f32_to_i32_r_minMag", 1, RES_I32,  ftoi  },
+  { "f32_to_f64",          1, RES_F64,  ftod  },
+  { "f32_eq",              2, RES_BOOL, eq    },
+  { "f32_lt_quiet",        2, RES_BOOL, lt    },
+  { "f32_le_quiet",        2, RES_BOOL, le    },
+  { "f64_add",             2, RES_F64,  addD  },
+  { "f64_sub",             2, RES_F64,  subD  },
+  { "f64_mul",             2, RES_F64,  mulD  },
+  { "f64_div",             2, RES_F64,  divD  },
+  { "f64_sqrt",            1, RES_F64,  sqrtD },
+  { "i32_to_f64",          1, RES_F64,  itod  },
+  { "f64_to_i32_r_minMag", 1, RES_I32,  dtoi  },
+  { "f64_to_f32",          1, RES_F32,  dtof  },
+  { "f64_eq",              2, RES_BOOL, eqD   },
+  { "f64_lt_quiet",        2, RES_BOOL, ltD   },
+  { "f64_le_quiet",        2, RES_BOOL, leD   },
+};
+
+
+int main(int argc, char *argv[]) {
+  Function *f;
+  int i;
+  char line[120];
+  Dword arg[2], expected, expFlags;
+  Dword result;
+  int same;
+  int n;
+  long total, errors;
+
+  if (argc != 2) {
+    printf("usage: %s <function>\n", argv[0]);
+    exit(1);
+  }
+  f = NULL;
+  for (i = 0; i < sizeof(functions) / sizeof(functions[0]); i++) {
+    if (strcmp(argv[1], functions[i].name) == 0) {
+      f = &functions[i];
+    }
+  }
+  if (f == NULL) {
+    printf("Error: unknown function '%s'\n", argv[1]);
+    exit(1);
+  }
+  total = 0;
+  errors = 0;
+  while (fgets(line, sizeof(line), stdin) != NULL) {
+    arg[1] = 0;
+    if (f->numArgs == 1) {
+      n = sscanf(line, "%llx %llx %llx", &arg[0], &expected, &expFlags);
+    } else {
+      n = sscanf(line, "%llx %llx %llx %llx",
+                 &arg[0], &arg[1], &expected, &expFlags);
+    }
+    if (n != f->numArgs + 2) {
+      printf("Error: cannot read test case '%s'\n", line);
+      exit(1);
+    }
+    result = (*f->func)(arg[0], arg[1]);
+    total++;
+    same = (result == expected);
+    if (f->resKind == RES_F32) {
+      same |= IS_NAN((Word) result) && IS_NAN((Word) expected);
+    }
+    if (f->resKind == RES_F64) {
+      same |= IS_NAN64(result) && IS_NAN64(expected);
+    }
+    if (same) {
+      continue;
+    }
+    if (errors++ < MAX_REPORTS) {
+      printf("%s: %llX %llX -> %llX, expected %llX\n",
+             f->name, arg[0], arg[1], result, expected);
+    }
+  }
+  printf("%s: %ld cases, %ld errors\n", f->name, total, errors);
+  return errors != 0;
+}
@@ -59,6 +59,8 @@ process(Tokenrow *trp)
 				if (cursource->ifdepth)
 					error(ERROR,
 					 "Unterminated conditional in #include");
+				else if (cursource->guardstate==2)
+					setguard(cursource);
 				unsetsource();
 				cursource->line += cursource->lineinc;
 				trp->tp = trp->lp;
@@ -69,6 +71,9 @@ process(Tokenrow *trp)
 				error(ERROR, "Unterminated #if/#ifdef/#ifndef");
 			break;
 		}
+		if (cursource->ifdepth==0
+		 && trp->tp->type!=SHARP && trp->tp->type!=NL)
+			cursource->guardstate = -1;	/* text outside #ifndef */
 		if (trp->tp->type==SHARP) {
 			trp->tp += 1;
 			control(trp);
@@ -103,6 +108,22 @@ control(Tokenrow *trp)
 		error(WARNING, "Unknown preprocessor control %t", tp);
 		return;
 	}
+	if ((np->flag&ISKW) && cursource->guardstate>=0) {
+		/* is the whole file inside #ifndef name ... #endif? */
+		if (cursource->ifdepth==0) {
+			if (np->val==KIFNDEF && cursource->guardstate==0
+			 && trp->lp - trp->bp == 4 && (tp+1)->type==NAME) {
+				cursource->guardstate = 1;
+				cursource->guard = lookup(tp+1, 1);
+			} else
+				cursource->guardstate = -1;
+		} else if (cursource->ifdepth==1) {
+			if (np->val==KENDIF)
+				cursource->guardstate = 2;
+			else if (np->val==KELSE || np->val==KELIF)
+				cursource->guardstate = -1;
+		}
+	}
 	if (skipping) {
 		if ((np->flag&ISKW)==0)
 			return;
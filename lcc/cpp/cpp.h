@@ -63,6 +63,9 @@ typedef struct source {
 	uchar	*inl;		/* end of input */
 	FILE*	fd;		/* input source */
 	int	ifdepth;	/* conditional nesting in include */
+	char	*path;		/* name of file as opened */
+	int	guardstate;	/* 0 start, 1 in #ifndef, 2 after #endif, -1 none */
+	struct	nlist *guard;	/* name tested by the #ifndef */
 	struct	source *next;	/* stack for #include */
 } Source;
 
@@ -110,6 +113,8 @@ void	control(Tokenrow *);
 void	dodefine(Tokenrow *);
 void	doadefine(Tokenrow *, int);
 void	doinclude(Tokenrow *);
+void	setguard(Source *);
+int	isguarded(char *);
 void	expand(Tokenrow *, Nlist *);
 void	builtin(Tokenrow *, int);
 int	gatherargs(Tokenrow *, Tokenrow **, int *);
@@ -7,12 +7,67 @@ Includelist	includelist[NINCLUDE];
 
 extern char	*objname;
 
+/*
+ * Files whose text lies wholly inside #ifndef name ... #endif,
+ * with the name that guards them. While the name is defined,
+ * including such a file again has no effect, so it is not
+ * even opened.
+ */
+#define	NGUARD	64
+
+typedef struct guarded {
+	char	*path;
+	Nlist	*guard;
+	struct	guarded *next;
+} Guarded;
+
+static Guarded *guardtab[NGUARD];
+
+static unsigned
+hashpath(char *path)
+{
+	unsigned h = 0;
+
+	while (*path)
+		h = (h<<1) + *path++;
+	return h % NGUARD;
+}
+
+void
+setguard(Source *s)
+{
+	Guarded *gp;
+	unsigned h = hashpath(s->path);
+
+	for (gp = guardtab[h]; gp; gp = gp->next)
+		if (strcmp(gp->path, s->path)==0) {
+			gp->guard = s->guard;
+			return;
+		}
+	gp = new(Guarded);
+	gp->path = s->path;
+	gp->guard = s->guard;
+	gp->next = guardtab[h];
+	guardtab[h] = gp;
+}
+
+int
+isguarded(char *path)
+{
+	Guarded *gp;
+
+	for (gp = guardtab[hashpath(path)]; gp; gp = gp->next)
+		if (strcmp(gp->path, path)==0)
+			return (gp->guard->flag&ISDEFINED) != 0;
+	return 0;
+}
+
 void
 doinclude(Tokenrow *trp)
 {
 	char fname[256], iname[256];
 	Includelist *ip;
-	int angled, len, i;
+	int angled, len, i, guarded;
 	FILE *fd;
 
 	trp->tp += 1;
@@ -46,9 +101,10 @@ doinclude(Tokenrow *trp)
 	if (trp->tp < trp->lp || len==0)
 		goto syntax;
 	fname[len] = '\0';
+	guarded = 0;
 	if (fname[0]=='/') {
-		fd = fopen(fname, "r");
 		strcpy(iname, fname);
+		fd = (guarded = isguarded(iname)) ? NULL : fopen(fname, "r");
 	} else for (fd = NULL,i=NINCLUDE-1; i>=0; i--) {
 		ip = &includelist[i];
 		if (ip->file==NULL || ip->deleted || (angled && ip->always==0))
@@ -58,6 +114,8 @@ doinclude(Tokenrow *trp)
 		strcpy(iname, ip->file);
 		strcat(iname, "/");
 		strcat(iname, fname);
+		if ((guarded = isguarded(iname)) != 0)
+			break;
 		if ((fd = fopen(iname, "r")) != NULL)
 			break;
 	}
@@ -66,6 +124,8 @@ doinclude(Tokenrow *trp)
 		fwrite(iname,1,strlen(iname),stdout);
 		fwrite("\n",1,1,stdout);
 	}
+	if (guarded)
+		return;
 	if (fd != NULL) {
 		if (++incdepth > 10)
 			error(FATAL, "#include too deeply nested");
@@ -548,6 +548,9 @@ setsource(char *name, FILE *fd, char *str)
 	s->lineinc = 0;
 	s->fd = fd;
 	s->filename = name;
+	s->path = name;
+	s->guardstate = 0;
+	s->guard = NULL;
 	s->next = cursource;
 	s->ifdepth = 0;
 	cursource = s;
@@ -37,6 +37,7 @@ char *cpp[] = {
 char *com[] = {
   LCCDIR "rcc",
   "-target=eco32/linux",
+  "",			/* reserved for "-msoft-float" */
   "$1",			/* other options handed through */
   "$2",			/* compiler input file (preprocessed C) */
   "$3",			/* compiler output file (assembler) */
@@ -45,6 +46,7 @@ char *com[] = {
 
 char *as[] = {
   LCCDIR "as",
+  "",			/* reserved for "-O" (set by -Wo-peep) */
   "-o", "$3",		/* assembler output file (object) */
   "$1",			/* other options handed through */
   "$2",			/* assembler input file (assembler) */
@@ -53,12 +55,14 @@ char *as[] = {
 
 char *ld[] = {
   LCCDIR "ld",
+  "",			/* reserved for "-L<soft-float lib dir>" */
   "-L" LCCDIR "../lib",
   "-o", "$3",		/* linker output file (executable) */
   "$1",			/* other options handed through */
   LCCDIR "../lib/crt0.o",
   "$2",			/* linker input files (object) */
   "-lc",
+  "",			/* reserved for "-lsoftfp" */
   "", "",		/* reserved for "-s <ldscript>" */
   "", "",		/* reserved for "-m <ldmap>" */
   0
@@ -73,6 +77,13 @@ extern char *concat(char *, char *);
  *   -Wo-nostdlib	do not use the standard libs and startup files
  *   -Wo-ldscript=...	specify linker script file name
  *   -Wo-ldmap=...	specify linker map file name
+ *   -Wo-msoft-float	compile FP operations into calls of the
+ *			soft-float library, and link with it; the
+ *			libraries in ../lib/soft (a libm which does
+ *			not use the FPU) are searched first
+ *   -Wo-peep		run the compiler output through the
+ *			peephole optimizer of the assembler (-O
+ *			is still ignored, as on the other hosts)
  */
 int option(char *arg) {
   if (strcmp(arg, "-nostdinc") == 0) {
@@ -81,18 +92,31 @@ int option(char *arg) {
   }
   if (strcmp(arg, "-nostdlib") == 0) {
     ld[1] = "";
-    ld[5] = "";
-    ld[7] = "";
+    ld[2] = "";
+    ld[6] = "";
+    ld[8] = "";
     return 1;
   }
   if (strncmp(arg, "-ldscript=", 10) == 0) {
-    ld[8] = "-s";
-    ld[9] = arg + 10;
+    ld[10] = "-s";
+    ld[11] = arg + 10;
     return 1;
   }
   if (strncmp(arg, "-ldmap=", 7) == 0) {
-    ld[10] = "-m";
-    ld[11] = arg + 7;
+    ld[12] = "-m";
+    ld[13] = arg + 7;
+    return 1;
+  }
+  if (strcmp(arg, "-msoft-float") == 0) {
+    com[2] = "-msoft-float";
+    if (*ld[2] != '\0') {
+      ld[1] = "-L" LCCDIR "../lib/soft";
+    }
+    ld[9] = "-lsoftfp";
+    return 1;
+  }
+  if (strcmp(arg, "-peep") == 0) {
+    as[1] = "-O";
     return 1;
   }
   return 0;
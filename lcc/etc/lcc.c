@@ -34,11 +34,16 @@ static char *exists(char *);
 static char *first(char *);
 static int filename(char *, char *);
 static List find(char *, List);
+static int background(char *);
+static void reap(int);
 static void help(void);
 static void initinputs(void);
 static void interrupt(int);
 static void opt(char *);
 static List path2list(const char *);
+static int pipeline(char *, char *);
+static int server(char *, char *);
+static void stopserver(void);
 extern int main(int, char *[]);
 extern char *replace(const char *, int, int);
 static void rm(List);
@@ -58,6 +63,10 @@ static int Eflag;		/* -E specified */
 static int Sflag;		/* -S specified */
 static int cflag;		/* -c specified */
 static int verbose;		/* incremented for each -v */
+static int pipeflag;		/* -pipe specified */
+static int serverflag;		/* -server specified */
+static int jobs = 1;		/* -j n: compile up to n files at once */
+static int running;		/* number of files being compiled */
 static List llist[2];		/* loader files, flags */
 static List alist;		/* assembler flags */
 static List clist;		/* compiler flags */
@@ -120,6 +129,13 @@ int main(int argc, char *argv[]) {
 			if (argv[i+1] && *argv[i+1] != '-')
 				i++;
 			continue;
+		} else if (strncmp(argv[i], "-j", 2) == 0) {
+			char *s = argv[i][2] ? &argv[i][2] : argv[++i];
+			if (s == NULL || (jobs = atoi(s)) <= 0) {
+				error("unrecognized option `%s'", argv[i-1]);
+				exit(8);
+			}
+			continue;
 		} else if (*argv[i] == '-' && argv[i][1] != 'l') {
 			opt(argv[i]);
 			continue;
@@ -154,10 +170,16 @@ int main(int argc, char *argv[]) {
 				if (strcmp(name, argv[i]) != 0
 				|| nf > 1 && suffix(name, suffixes, 3) >= 0)
 					fprintf(stderr, "%s:\n", name);
-				filename(name, 0);
+				if (jobs > 1 && !Eflag && !Sflag
+				&& suffix(name, suffixes, 3) >= 0)
+					background(name);
+				else
+					filename(name, 0);
 			} else
 				error("can't find `%s'", argv[i]);
 		}
+	reap(0);
+	stopserver();
 	if (errcnt == 0 && !Eflag && !Sflag && !cflag && llist[1]) {
 		compose(ld, llist[0], llist[1],
 			append(outfile ? outfile : concat("a", first(suffixes[4])), 0));
@@ -213,11 +235,35 @@ char *basepath(char *name) {
 
 #ifdef WIN32
 #include <process.h>
+
+/* without fork, files are compiled one after the other and without pipes */
+static int background(char *name) {
+	return filename(name, 0);
+}
+
+static void reap(int n) {
+}
+
+static int pipeline(char *name, char *dst) {
+	assert(0);
+	return 100;
+}
+
+static int server(char *src, char *dst) {
+	assert(0);
+	return 100;
+}
+
+static void stopserver(void) {
+}
 #else
 #define _P_WAIT 0
 extern int fork(void);
 extern int wait(int *);
 extern int execv(const char *, char *[]);
+extern int pipe(int *);
+extern int dup2(int, int);
+extern int close(int);
 
 static int _spawnvp(int mode, const char *cmdname, const char *const argv[]) {
 	int pid, n, status;
@@ -243,6 +289,230 @@ static int _spawnvp(int mode, const char *cmdname, const char *const argv[]) {
 	}
 	return (status>>8)&0377;
 }
+
+/* background - compile name into an object file in a child process, return status */
+static int background(char *name) {
+	char *base = basepath(name), *ofile, *ifile = outfile;
+	int status;
+
+	if (cflag && outfile)
+		ofile = outfile;
+	else if (cflag)
+		ofile = concat(base, first(suffixes[3]));
+	else
+		ofile = tempname(first(suffixes[3]));
+	if (!find(ofile, llist[1]))
+		llist[1] = append(ofile, llist[1]);
+	reap(jobs - 1);
+	fflush(stdout);
+	fflush(stderr);
+	switch (fork()) {
+	case -1:
+		break;
+	case 0:	/* the child removes only its own temporary files */
+		rmlist = 0;
+		serverflag = 0;
+		cflag = 1;
+		outfile = ofile;
+		status = filename(name, base);
+		rm(rmlist);
+		exit(status ? EXIT_FAILURE : EXIT_SUCCESS);
+	default:
+		running++;
+		return 0;
+	}
+	cflag++;
+	outfile = ofile;
+	status = filename(name, base);
+	cflag--;
+	outfile = ifile;
+	return status;
+}
+
+/* reap - wait until at most n files are being compiled */
+static void reap(int n) {
+	int status;
+
+	while (running > n) {
+		if (wait(&status) == -1) {
+			running = 0;
+			break;
+		}
+		running--;
+		if (status)
+			errcnt++;
+	}
+}
+
+/* pipeline - run cpp on name, then the compiler and, unless -S, the assembler into dst */
+static int pipeline(char *name, char *dst) {
+	char **cmds[3];
+	int i, n, k, fd[2], in = -1, pids[3], status = 0, s;
+
+	compose(cpp, plist, append(name, 0), 0);
+	cmds[0] = memcpy(alloc(ac*sizeof(char *)), av, ac*sizeof(char *));
+	compose(com, clist, append("-", 0), append(Sflag ? dst : "-", 0));
+	cmds[1] = memcpy(alloc(ac*sizeof(char *)), av, ac*sizeof(char *));
+	n = 2;
+	if (!Sflag) {
+		compose(as, alist, append("-", 0), append(dst, 0));
+		cmds[n++] = memcpy(alloc(ac*sizeof(char *)), av, ac*sizeof(char *));
+	}
+	if (verbose > 0) {
+		for (i = 0; i < n; i++) {
+			fprintf(stderr, i ? " | %s" : "%s", cmds[i][0]);
+			for (k = 1; cmds[i][k] != NULL; k++)
+				fprintf(stderr, " %s", cmds[i][k]);
+		}
+		fprintf(stderr, "\n");
+	}
+	if (verbose > 1)
+		return 0;
+	fflush(stdout);
+	fflush(stderr);
+	for (i = 0; i < n; i++) {
+		if (i < n - 1 && pipe(fd) == -1) {
+			fprintf(stderr, "%s: ", progname);
+			perror("pipe");
+			status = 100;
+			break;
+		}
+		switch (pids[i] = fork()) {
+		case -1:
+			fprintf(stderr, "%s: no more processes\n", progname);
+			status = 100;
+			break;
+		case 0:
+			if (in != -1) {
+				dup2(in, 0);
+				close(in);
+			}
+			if (i < n - 1) {
+				dup2(fd[1], 1);
+				close(fd[0]);
+				close(fd[1]);
+			}
+			execv(cmds[i][0], cmds[i]);
+			fprintf(stderr, "%s: ", progname);
+			perror(cmds[i][0]);
+			fflush(stdout);
+			exit(100);
+		}
+		if (in != -1)
+			close(in);
+		in = -1;
+		if (i < n - 1) {
+			close(fd[1]);
+			in = fd[0];
+		}
+		if (status)
+			break;
+	}
+	if (in != -1)
+		close(in);
+	for (n = i, k = n; k > 0; ) {
+		int pid = wait(&s);
+		if (pid == -1)
+			break;
+		for (i = 0; i < n && pids[i] != pid; i++)
+			;
+		if (i == n) {	/* a file compiled by background */
+			running--;
+			if (s)
+				errcnt++;
+			continue;
+		}
+		k--;
+		if ((s&0177) != 0 && (s&0177) != SIGPIPE) {
+			fprintf(stderr, "%s: fatal error in %s\n", progname, cmds[i][0]);
+			s = 1;
+		}
+		if (s != 0 && status == 0)
+			status = s&0177 ? 1 : (s>>8)&0377;
+	}
+	if (status)
+		remove(dst);
+	return status;
+}
+
+static int serverpid;		/* rcc --server, -1 if not executed */
+static FILE *toserver;		/* requests to the server */
+static FILE *fromserver;	/* exit status of each request */
+
+/* server - compile src into dst by rcc --server, which is started at first use, return status */
+static int server(char *src, char *dst) {
+	char buf[32];
+	int i, to[2], from[2];
+
+	if (serverpid == 0) {
+		compose(com, clist, 0, 0);
+		for (i = 0; av[i] != NULL; i++)
+			;
+		av[i++] = "--server";
+		av[i] = NULL;
+		if (verbose > 0) {
+			fprintf(stderr, "%s", av[0]);
+			for (i = 1; av[i] != NULL; i++)
+				fprintf(stderr, " %s", av[i]);
+			fprintf(stderr, "\n");
+		}
+		serverpid = -1;
+		if (verbose < 2) {
+			if (pipe(to) == -1 || pipe(from) == -1) {
+				fprintf(stderr, "%s: ", progname);
+				perror("pipe");
+				return 100;
+			}
+			fflush(stdout);
+			fflush(stderr);
+			switch (serverpid = fork()) {
+			case -1:
+				fprintf(stderr, "%s: no more processes\n", progname);
+				return 100;
+			case 0:
+				dup2(to[0], 0);
+				dup2(from[1], 1);
+				close(to[0]);
+				close(to[1]);
+				close(from[0]);
+				close(from[1]);
+				execv(av[0], av);
+				fprintf(stderr, "%s: ", progname);
+				perror(av[0]);
+				exit(100);
+			}
+			close(to[0]);
+			close(from[1]);
+			toserver = fdopen(to[1], "w");
+			fromserver = fdopen(from[0], "r");
+			signal(SIGPIPE, SIG_IGN);
+		}
+	}
+	if (verbose > 0)
+		fprintf(stderr, "\t%s %s\n", src, dst);
+	if (serverpid == -1)
+		return 0;
+	fprintf(toserver, "%s\n%s\n", src, dst);
+	fflush(toserver);
+	if (fgets(buf, sizeof buf, fromserver) == NULL) {
+		fprintf(stderr, "%s: fatal error in %s\n", progname, com[0]);
+		return 100;
+	}
+	return atoi(buf);
+}
+
+/* stopserver - let rcc --server terminate, if it was started */
+static void stopserver(void) {
+	int n, status;
+
+	if (serverpid > 0) {
+		fclose(toserver);
+		fclose(fromserver);
+		while ((n = wait(&status)) != serverpid && n != -1)
+			;
+	}
+	serverpid = 0;
+}
 #endif
 
 /* callsys - execute the command described by av[0...], return status */
@@ -304,6 +574,8 @@ char *concat(char *s1, char *s2) {
 
 /* compile - compile src into dst, return status */
 static int compile(char *src, char *dst) {
+	if (serverflag)
+		return server(src, dst);
 	compose(com, clist, append(src, 0), append(dst, 0));
 	return callsys(av);
 }
@@ -401,6 +673,21 @@ static int filename(char *name, char *base) {
 			status = callsys(av);
 			break;
 		}
+		if (pipeflag) {
+			char *dst;
+			if (Sflag)
+				dst = outfile ? outfile : concat(base, first(suffixes[2]));
+			else if (cflag && outfile)
+				dst = outfile;
+			else if (cflag)
+				dst = concat(base, first(suffixes[3]));
+			else
+				dst = tempname(first(suffixes[3]));
+			status = pipeline(name, dst);
+			if (!Sflag && !find(dst, llist[1]))
+				llist[1] = append(dst, llist[1]);
+			break;
+		}
 		if (itemp == NULL)
 			itemp = tempname(first(suffixes[1]));
 		compose(cpp, plist, append(name, 0), append(itemp, 0));
@@ -481,6 +768,7 @@ static void help(void) {
 "-g	produce symbol table information for debuggers\n",
 "-help or -?	print this message on standard error\n",
 "-Idir	add `dir' to the beginning of the list of #include directories\n",	
+"-j n	compile up to `n' files at once\n",
 "-lx	search library `x'\n",
 "-M	emit makefile dependencies; implies -E\n",
 "-N	do not search the standard directories for #include files\n",
@@ -489,7 +777,9 @@ static void help(void) {
 "-o file	leave the output in `file'\n",
 "-P	print ANSI-style declarations for globals on standard error\n",
 "-p -pg	emit profiling code; see prof(1) and gprof(1)\n",
+"-pipe	connect the preprocessor, compiler, and assembler by pipes\n",
 "-S	compile to assembly language\n",
+"-server	run one compiler process for all files\n",
 "-static	specify static libraries (default is dynamic)\n",
 "-dynamic	specify dynamically linked libraries\n",
 "-t -tname	emit function tracing calls to printf or to `name'\n",
@@ -612,7 +902,13 @@ xx(unsigned_int,4)
 		else
 			clist = append(arg, clist);
 		return;
-	case 'p':	/* -p -pg */
+	case 'p':	/* -p -pg -pipe */
+		if (strcmp(arg, "-pipe") == 0) {
+#ifndef WIN32
+			pipeflag++;
+#endif
+			return;
+		}
 		if (option(arg))
 			clist = append(arg, clist);
 		else
@@ -653,6 +949,12 @@ xx(unsigned_int,4)
 		}
 		break;
 	case 's':
+		if (strcmp(arg, "-server") == 0) {
+#ifndef WIN32
+			serverflag++;
+#endif
+			return;
+		}
 		if (strcmp(arg, "-static") == 0) {
 			if (!option(arg))
 				fprintf(stderr, "%s: %s ignored\n", progname, arg);
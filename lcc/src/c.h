@@ -116,6 +116,7 @@ typedef struct interface {
 	Metrics structmetric;
 	unsigned little_endian:1;
 	unsigned mulops_calls:1;
+	unsigned floatops_calls:1;
 	unsigned wants_callb:1;
 	unsigned wants_argb:1;
 	unsigned left_to_right:1;
@@ -490,6 +491,9 @@ extern int gettok(void);
 
 extern void emitcode(void);
 extern void gencode (Symbol[], Symbol[]);
+extern int layoutinit(char *, char *);
+extern void layoutcode(Symbol, int);
+extern void layouttail(Symbol);
 extern void fprint(FILE *f, const char *fmt, ...);
 extern char *stringf(const char *, ...);
 extern void check(Node);
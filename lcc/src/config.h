@@ -24,6 +24,7 @@ typedef struct {
 extern int     askregvar(Symbol, Symbol);
 extern void    blkcopy(int, int, int, int, int, int[]);
 extern unsigned emitasm(Node, int);
+extern void    equate(Node);
 extern int     getregnum(Node);
 extern int     mayrecalc(Node);
 extern int     mkactual(int, int);
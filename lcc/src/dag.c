@@ -5,7 +5,11 @@ static char rcsid[] = "$Id: dag.c,v 1.1 2002/08/28 23:12:42 drh Exp $";
 #define iscall(op) (generic(op) == CALL \
 	|| IR->mulops_calls \
 	&& (generic(op)==DIV||generic(op)==MOD||generic(op)==MUL) \
-	&& ( optype(op)==U  || optype(op)==I))
+	&& ( optype(op)==U  || optype(op)==I) \
+	|| IR->floatops_calls \
+	&& (generic(op)==ADD||generic(op)==SUB||generic(op)==DIV||generic(op)==MUL \
+	||  generic(op)==CVI||generic(op)==CVF) \
+	&& ( optype(op)==F  || generic(op)==CVF))
 static Node forest;
 static struct dag {
 	struct node node;
@@ -268,7 +272,9 @@ Node listnodes(Tree tp, int tlab, int flab) {
 		      	list(newnode(op + opkind(l->op), l, r, findlabel(flab)));
 		      }
 		      if (forest && forest->syms[0])
-		      	forest->syms[0]->ref++; } break;
+		      	forest->syms[0]->ref++;
+		      if (IR->floatops_calls && optype(tp->op) == F)
+		      	cfunc->u.f.ncalls++; } break;
 	case ASGN:  { assert(tlab == 0 && flab == 0);
 		      if (tp->kids[0]->op == FIELD) {
 		      	Tree  x = tp->kids[0]->kids[0];
@@ -319,13 +325,19 @@ Node listnodes(Tree tp, int tlab, int flab) {
 	case LSH:   { assert(tlab == 0 && flab == 0);
 		      l = listnodes(tp->kids[0], 0, 0);
 		      r = listnodes(tp->kids[1], 0, 0);
-		      p = node(op, l, r, NULL); } break;
+		      p = node(op, l, r, NULL);
+		      if (IR->floatops_calls && isfloat(tp->type)
+		      && (generic(op) == ADD || generic(op) == SUB)) {
+		      	list(p);
+		      	cfunc->u.f.ncalls++;
+		      } } break;
 	case DIV: case MUL:
 	case MOD:   { assert(tlab == 0 && flab == 0);
 		      l = listnodes(tp->kids[0], 0, 0);
 		      r = listnodes(tp->kids[1], 0, 0);
 		      p = node(op, l, r, NULL);
-		      if (IR->mulops_calls && isint(tp->type)) {
+		      if (IR->mulops_calls && isint(tp->type)
+		      ||  IR->floatops_calls && isfloat(tp->type)) {
 		      	list(p);
 		      	cfunc->u.f.ncalls++;
 		      } } break;
@@ -337,6 +349,11 @@ Node listnodes(Tree tp, int tlab, int flab) {
 		      assert(optype(tp->kids[0]->op) != optype(tp->op) || tp->kids[0]->type->size != tp->type->size);
 		      l = listnodes(tp->kids[0], 0, 0);
 		      p = node(op, l, NULL, intconst(tp->kids[0]->type->size));
+		      if (IR->floatops_calls
+		      && (generic(op) == CVF || generic(op) == CVI && optype(op) == F)) {
+		      	list(p);
+		      	cfunc->u.f.ncalls++;
+		      }
  } break;
 	case BCOM:
 	case NEG:   { assert(tlab == 0 && flab == 0);
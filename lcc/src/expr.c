@@ -487,7 +487,12 @@ int hascall(Tree p) {
 		return 0;
 	if (generic(p->op) == CALL || (IR->mulops_calls &&
 	  (p->op == DIV+I || p->op == MOD+I || p->op == MUL+I
-	|| p->op == DIV+U || p->op == MOD+U || p->op == MUL+U)))
+	|| p->op == DIV+U || p->op == MOD+U || p->op == MUL+U))
+	|| (IR->floatops_calls &&
+	  (p->op == ADD+F || p->op == SUB+F || p->op == MUL+F || p->op == DIV+F
+	|| p->op == CVI+F || p->op == CVF+F || p->op == CVF+I
+	|| p->op == EQ+F  || p->op == NE+F  || p->op == LT+F
+	|| p->op == LE+F  || p->op == GT+F  || p->op == GE+F)))
 		return 1;
 	return hascall(p->kids[0]) || hascall(p->kids[1]);
 }
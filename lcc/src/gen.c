@@ -375,6 +375,14 @@ void emit(Node p) {
 		p->x.emitted = 1;
 	}
 }
+void equate(Node p) {
+	for (; p; p = p->x.next)
+		if (p->x.equatable) {
+			if (requate(p))
+				p->syms[RX] = p->x.kids[0]->syms[RX];
+			p->x.equatable = 0;
+		}
+}
 static int moveself(Node p) {
 	return p->x.copy
 	&& p->syms[RX]->x.name == p->x.kids[0]->syms[RX]->x.name;
@@ -0,0 +1,534 @@
+/* C compiler: profile-guided block layout
+
+The simulator's branch profile (sim -bp) lists the conditional
+branches executed, one per line:
+
+    address taken not-taken
+
+To relate the addresses to the compiler's branches, a training
+build is compiled with -bpmark, which exports a marker label
+behind every conditional branch, named
+
+    file.function.n
+
+where file is the source file name without directory and suffix
+(made an identifier),
+function is the assembler name of the function, and n counts the
+conditional branches of the function in emission order. The
+linker's map (ld -m) gives the marker addresses; the branch lies
+just before its marker. A later compilation with the same options
+plus -bprof=profile and -bmap=map reads both files back; then
+each function's basic blocks are arranged into chains along their
+most frequent forward edges, and conditions are inverted where
+that lets the frequent successor fall through. The chains that
+start at the entry and end in the epilogue precede it; the other
+chains follow the epilogue, the most frequently executed first.
+
+The blocks are rearranged after register allocation and are
+emitted here instead of by emitcode. Since the flow graph is
+unchanged, so is the allocation. The assembler syntax of labels
+and jumps is that of the eco32 back end, the only user.
+*/
+#include "c.h"
+
+#define HASHSIZE 1021
+
+struct branch {			/* profile data: */
+	struct branch *link;		/* link to next in bucket */
+	char *name;			/* marker name, or 0 */
+	unsigned long addr;		/* address of the branch */
+	unsigned long taken, nottaken;	/* its counts */
+};
+
+enum { FALLS, BRANCHES, JUMPS, COMPUTED };
+
+struct block {			/* basic block: */
+	int first, last;		/* its nodes are nodes[first..last-1] */
+	int forest;			/* first node of the forest of nodes[first] */
+	Symbol label;			/* a label naming it, or 0 */
+	int kind;			/* how it ends: FALLS, BRANCHES, ... */
+	int target;			/* taken successor, or -1 */
+	int fall;			/* fall-through successor, or -1 */
+	int ordinal;			/* branch number, if kind == BRANCHES */
+	int profiled;			/* nonzero if the counts are known */
+	unsigned long taken, nottaken;	/* the counts of its branch */
+	double count;			/* estimated executions */
+	int swtarget;			/* nonzero if a switch table names it */
+	int prev, next;			/* neighbors in its chain, or -1 */
+	int head;			/* first block of its chain */
+	Symbol newlabel;		/* label to be defined before it */
+	int invert;			/* nonzero if its branch is inverted */
+	int drop;			/* nonzero if its jump is omitted */
+	int jump;			/* block to jump to after it, or -1 */
+};
+
+struct edge {			/* candidate fall-through: */
+	int from, to;			/* the blocks */
+	double weight;			/* estimated traversals */
+};
+
+static struct branch *byaddr[HASHSIZE];	/* profile, by address */
+static struct branch *byname[HASHSIZE];	/* markers, by name */
+static int profiled;			/* nonzero if a profile was read */
+
+static Node *nodes;		/* the function's nodes, in emission order */
+static int nnodes;
+static struct block *blocks;	/* its basic blocks */
+static int nblocks;
+static double *hottest;		/* highest count in each chain, by head */
+static int *tail;		/* blocks to emit after the epilogue */
+static int ntail;
+
+/* layoutinit - read the branch profile and the linker's map */
+int layoutinit(char *profile, char *map) {
+	FILE *fp;
+	char line[256], name[256];
+	unsigned long addr, taken, nottaken;
+	struct branch *p;
+	int h;
+
+	if ((fp = fopen(profile, "r")) == NULL)
+		return 0;
+	while (fgets(line, sizeof line, fp) != NULL)
+		if (sscanf(line, "%lx %lu %lu", &addr, &taken, &nottaken) == 3) {
+			NEW0(p, PERM);
+			p->addr = addr;
+			p->taken = taken;
+			p->nottaken = nottaken;
+			h = (addr>>2)%HASHSIZE;
+			p->link = byaddr[h];
+			byaddr[h] = p;
+		}
+	fclose(fp);
+	if ((fp = fopen(map, "r")) == NULL)
+		return 0;
+	while (fgets(line, sizeof line, fp) != NULL)
+		if (sscanf(line, "%255s %lx", name, &addr) == 2
+		&& strchr(name, '.') != NULL) {
+			struct branch *q;
+			NEW0(q, PERM);
+			q->name = string(name);
+			for (p = byaddr[((addr - 4)>>2)%HASHSIZE]; p; p = p->link)
+				if (p->addr == addr - 4) {
+					q->taken = p->taken;
+					q->nottaken = p->nottaken;
+					break;
+				}
+			h = (unsigned long)q->name%HASHSIZE;
+			q->link = byname[h];
+			byname[h] = q;
+		}
+	fclose(fp);
+	profiled = 1;
+	return 1;
+}
+
+/* marker - return the marker name of branch n of function f */
+static char *marker(Symbol f, int n) {
+	static char *tag;
+
+	if (tag == NULL) {
+		char *s = firstfile ? firstfile : "", *t, buf[64];
+		int i = 0;
+		if ((t = strrchr(s, '/')) != NULL)
+			s = t + 1;
+		if (!(*s >= 'a' && *s <= 'z' || *s >= 'A' && *s <= 'Z'))
+			buf[i++] = '_';
+		for (; *s && *s != '.' && i < sizeof buf; s++)
+			if (*s >= 'a' && *s <= 'z' || *s >= 'A' && *s <= 'Z'
+			||  *s >= '0' && *s <= '9')
+				buf[i++] = *s;
+			else
+				buf[i++] = '_';
+		tag = stringn(buf, i);
+	}
+	return stringf("%s.%s.%d", tag, f->x.name, n);
+}
+
+/* findmarker - return the profile data of marker name, or 0 */
+static struct branch *findmarker(char *name) {
+	struct branch *p;
+
+	for (p = byname[(unsigned long)name%HASHSIZE]; p; p = p->link)
+		if (p->name == name)
+			return p;
+	return NULL;
+}
+
+/* iscond - is p a conditional branch? */
+static int iscond(Node p) {
+	switch (generic(p->op)) {
+	case EQ: case NE: case LT: case LE: case GT: case GE:
+		return 1;
+	}
+	return 0;
+}
+
+/* invertible - can p's condition be reversed by changing its op? */
+static int invertible(Node p) {
+	return iscond(p) && (optype(p->op) == I || optype(p->op) == U);
+}
+
+/* inverse - return the op testing the opposite condition of p */
+static int inverse(Node p) {
+	static int ops[] = { EQ, NE, LT, GE, LE, GT };
+	int i;
+
+	for (i = 0; ops[i] != generic(p->op); i++)
+		;
+	return p->op - generic(p->op) + ops[i^1];
+}
+
+/* findblocks - split the function's nodes into basic blocks */
+static void findblocks(Symbol f) {
+	Code cp;
+	Node p;
+	int i, n, lo = 0, hi = -1, *bylabel, ordinal = 0, ended, labels, start;
+	struct branch *q;
+
+	nnodes = 0;
+	for (cp = codehead.next; cp; cp = cp->next)
+		if ((cp->kind == Gen || cp->kind == Jump || cp->kind == Label)
+		&& cp->u.forest) {
+			equate(cp->u.forest);
+			for (p = cp->u.forest; p; p = p->x.next) {
+				if (generic(p->op) == LABEL) {
+					n = p->syms[0]->u.l.label;
+					if (hi < lo)
+						lo = hi = n;
+					else if (n < lo)
+						lo = n;
+					else if (n > hi)
+						hi = n;
+				}
+				nnodes++;
+			}
+		}
+	nodes = newarray(nnodes + 1, sizeof *nodes, FUNC);
+	blocks = newarray(nnodes + 1, sizeof *blocks, FUNC);
+	memset(blocks, 0, (nnodes + 1)*sizeof *blocks);
+	bylabel = newarray(hi - lo + 2, sizeof *bylabel, FUNC);
+	for (i = 0; i < hi - lo + 1; i++)
+		bylabel[i] = -1;
+	nnodes = nblocks = 0;
+	ended = 1;
+	labels = 0;
+	for (cp = codehead.next; cp; cp = cp->next)
+		if ((cp->kind == Gen || cp->kind == Jump || cp->kind == Label)
+		&& cp->u.forest)
+			for (start = nnodes, p = cp->u.forest; p; p = p->x.next) {
+				struct block *b = nblocks > 0 ? &blocks[nblocks - 1] : NULL;
+				if (ended || generic(p->op) == LABEL && !labels) {
+					b = &blocks[nblocks++];
+					b->first = b->last = nnodes;
+					b->forest = start;
+					b->kind = FALLS;
+					ended = 0;
+					labels = 1;
+				}
+				if (generic(p->op) == LABEL) {
+					if (b->label == NULL)
+						b->label = p->syms[0];
+					bylabel[p->syms[0]->u.l.label - lo] = b - blocks;
+				} else
+					labels = 0;
+				nodes[nnodes++] = p;
+				b->last = nnodes;
+				if (iscond(p)) {
+					b->kind = BRANCHES;
+					b->ordinal = ordinal++;
+					b->target = p->syms[0]->u.l.label;
+					ended = 1;
+				} else if (generic(p->op) == JUMP) {
+					if (specific(p->kids[0]->op) == ADDRG+P) {
+						b->kind = JUMPS;
+						b->target = p->kids[0]->syms[0]->u.l.label;
+					} else
+						b->kind = COMPUTED;
+					ended = 1;
+				}
+			}
+	if (nblocks == 0)
+		blocks[nblocks++].kind = FALLS;
+	for (i = 0; i < nblocks; i++) {
+		struct block *b = &blocks[i];
+		b->fall = b->jump = -1;
+		if (b->kind == BRANCHES || b->kind == JUMPS) {
+			n = b->target;
+			b->target = n >= lo && n <= hi ? bylabel[n - lo] : -1;
+			if (b->target < 0)
+				b->kind = COMPUTED;
+		}
+		if (b->kind == FALLS || b->kind == BRANCHES)
+			b->fall = i + 1 < nblocks ? i + 1 : -1;
+		b->prev = b->next = -1;
+		b->head = i;
+		if (b->kind == BRANCHES && profiled
+		&& (q = findmarker(marker(f, b->ordinal))) != NULL) {
+			b->profiled = 1;
+			b->taken = q->taken;
+			b->nottaken = q->nottaken;
+		}
+	}
+	for (cp = codehead.next; cp; cp = cp->next)
+		if (cp->kind == Switch)
+			for (i = 0; i <= cp->u.swtch.size; i++) {
+				Symbol l = i < cp->u.swtch.size ? cp->u.swtch.labels[i]
+					: cp->u.swtch.deflab;
+				while (l->u.l.equatedto)
+					l = l->u.l.equatedto;
+				n = l->u.l.label;
+				if (n >= lo && n <= hi && bylabel[n - lo] >= 0)
+					blocks[bylabel[n - lo]].swtarget = 1;
+			}
+}
+
+/* estimate - estimate the execution counts of the blocks */
+static void estimate(void) {
+	double *in, indirect;
+	int i, pass, ntargets = 0;
+
+	in = newarray(nblocks + 1, sizeof *in, FUNC);
+	for (i = 0; i < nblocks; i++)
+		if (blocks[i].swtarget)
+			ntargets++;
+	for (pass = 0; pass < 8; pass++) {
+		for (i = 0; i < nblocks; i++)
+			in[i] = 0;
+		indirect = 0;
+		for (i = 0; i < nblocks; i++) {
+			struct block *b = &blocks[i];
+			double taken = b->count, fall = b->count;
+			if (b->profiled) {
+				taken = b->taken;
+				fall = b->nottaken;
+			} else if (b->kind == BRANCHES)
+				taken = fall = b->count/2;
+			if (b->kind == COMPUTED)
+				indirect += b->count;
+			if ((b->kind == BRANCHES || b->kind == JUMPS) && b->target >= 0)
+				in[b->target] += taken;
+			if (b->fall >= 0)
+				in[b->fall] += fall;
+		}
+		for (i = 0; i < nblocks; i++) {
+			struct block *b = &blocks[i];
+			if (b->swtarget)
+				in[i] += indirect/ntargets;
+			if (b->profiled)
+				b->count = (double)b->taken + b->nottaken;
+			else if (i == 0 && in[i] < 1)
+				b->count = 1;
+			else
+				b->count = in[i];
+		}
+	}
+}
+
+/* addedge - append a candidate fall-through from block i to block j */
+static int addedge(struct edge *e, int n, int i, int j, double weight) {
+	if (j > i) {
+		e[n].from = i;
+		e[n].to = j;
+		e[n].weight = weight;
+		n++;
+	}
+	return n;
+}
+
+/* heavier - compare edges by decreasing weight, then by position */
+static int heavier(const void *x, const void *y) {
+	const struct edge *a = x, *b = y;
+
+	if (a->weight != b->weight)
+		return a->weight > b->weight ? -1 : 1;
+	if (a->from != b->from)
+		return a->from - b->from;
+	return a->to - b->to;
+}
+
+/* chain - link the blocks into chains along their heaviest edges */
+static void chain(void) {
+	struct edge *e;
+	int i, j, n = 0;
+
+	e = newarray(2*nblocks + 1, sizeof *e, FUNC);
+	for (i = 0; i < nblocks; i++) {
+		struct block *b = &blocks[i];
+		if (b->fall >= 0)
+			n = addedge(e, n, i, b->fall, b->profiled ? (double)b->nottaken
+				: b->kind == BRANCHES ? b->count/2 : b->count);
+		if (b->kind == JUMPS)
+			n = addedge(e, n, i, b->target, b->count);
+		else if (b->kind == BRANCHES && b->target >= 0
+		&& invertible(nodes[b->last - 1]))
+			n = addedge(e, n, i, b->target, b->profiled ? (double)b->taken
+				: b->count/2);
+	}
+	qsort(e, n, sizeof *e, heavier);
+	for (i = 0; i < n; i++) {
+		struct block *from = &blocks[e[i].from], *to = &blocks[e[i].to];
+		if (from->next >= 0 || to->prev >= 0 || e[i].to == 0
+		|| from->head == to->head)
+			continue;
+		from->next = e[i].to;
+		to->prev = e[i].from;
+		for (j = e[i].to; j >= 0; j = blocks[j].next)
+			blocks[j].head = from->head;
+	}
+}
+
+/* hotter - compare chains by decreasing count, then by position */
+static int hotter(const void *x, const void *y) {
+	int a = *(const int *)x, b = *(const int *)y;
+
+	if (hottest[a] != hottest[b])
+		return hottest[a] > hottest[b] ? -1 : 1;
+	return a - b;
+}
+
+/* order - return the block sequence; the first *nfirst precede the epilogue */
+static int *order(int *nfirst) {
+	int *heads, *seq, nheads = 0, i, j, n = 0, exit, last = nblocks - 1;
+
+	hottest = newarray(nblocks + 1, sizeof *hottest, FUNC);
+	for (i = 0; i < nblocks; i++)
+		hottest[i] = 0;
+	for (i = 0; i < nblocks; i++)
+		if (blocks[i].count > hottest[blocks[i].head])
+			hottest[blocks[i].head] = blocks[i].count;
+	exit = blocks[last].kind == FALLS || blocks[last].kind == BRANCHES
+		? blocks[last].head : -1;
+	heads = newarray(nblocks + 1, sizeof *heads, FUNC);
+	for (i = 1; i < nblocks; i++)
+		if (blocks[i].head == i && i != exit)
+			heads[nheads++] = i;
+	qsort(heads, nheads, sizeof *heads, hotter);
+	seq = newarray(nblocks + 1, sizeof *seq, FUNC);
+	for (j = 0; j >= 0; j = blocks[j].next)
+		seq[n++] = j;
+	if (exit > 0)
+		for (j = exit; j >= 0; j = blocks[j].next)
+			seq[n++] = j;
+	*nfirst = n;
+	for (i = 0; i < nheads; i++)
+		for (j = heads[i]; j >= 0; j = blocks[j].next)
+			seq[n++] = j;
+	assert(n == nblocks);
+	return seq;
+}
+
+/* labelof - return a label for block i, making one if necessary */
+static Symbol labelof(int i) {
+	struct block *b = &blocks[i];
+
+	if (b->label == NULL)
+		b->label = b->newlabel = findlabel(genlabel(1));
+	return b->label;
+}
+
+/* connect - decide how each block in seq[0..n-1] reaches its successors */
+static void connect(int *seq, int n, int nfirst) {
+	int i;
+
+	for (i = 0; i < n; i++) {
+		struct block *b = &blocks[seq[i]];
+		int next = i + 1 < n && i + 1 != nfirst ? seq[i + 1] : -1;
+		if (b->kind == JUMPS && b->target == next)
+			b->drop = 1;
+		else if (b->kind == BRANCHES && b->fall != next) {
+			if (b->target == next && b->fall >= 0
+			&& invertible(nodes[b->last - 1]))
+				b->invert = 1;
+			else
+				b->jump = b->fall;
+		} else if (b->kind == FALLS && b->fall != next && b->fall >= 0)
+			b->jump = b->fall;
+		if (b->invert)
+			labelof(b->fall);
+		if (b->jump >= 0)
+			labelof(b->jump);
+	}
+}
+
+/* emitblock - emit block i, followed by a marker if mark is set */
+static void emitblock(Symbol f, int i, int mark) {
+	struct block *b = &blocks[i];
+	int k, n, last = b->last, *pending;
+	Node p;
+
+	if (b->newlabel)
+		print("%s:\n", b->newlabel->x.name);
+	if (b->drop)
+		last--;
+	if (b->invert) {
+		p = nodes[last - 1];
+		p->op = inverse(p);
+		p->syms[0] = blocks[b->fall].label;
+		(*IR->x._label)(p);
+	}
+	for (k = b->first; k < last; k++)
+		nodes[k]->x.next = k + 1 < last ? nodes[k + 1] : NULL;
+	/*
+	 * Common subexpressions may be recalculated from nodes of
+	 * earlier blocks of the same forest; emitasm names such a
+	 * node's register only if it has been emitted already.
+	 */
+	pending = newarray(b->first - b->forest + 1, sizeof *pending, FUNC);
+	for (n = 0, k = b->forest; k < b->first; k++)
+		if (!nodes[k]->x.emitted) {
+			nodes[k]->x.emitted = 1;
+			pending[n++] = k;
+		}
+	if (b->first < last)
+		(*IR->emit)(nodes[b->first]);
+	while (--n >= 0)
+		nodes[pending[n]]->x.emitted = 0;
+	if (mark && b->kind == BRANCHES) {
+		char *name = marker(f, b->ordinal);
+		print("\t.export\t%s\n%s:\n", name, name);
+	}
+	if (b->jump >= 0)
+		print("\tj\t%s\n", blocks[b->jump].label->x.name);
+}
+
+/* layoutcode - emit f's code list, arranged by the profile */
+void layoutcode(Symbol f, int mark) {
+	Code cp;
+	int *seq, i, nfirst;
+
+	ntail = 0;
+	if (errcnt > 0)
+		return;
+	findblocks(f);
+	for (i = 0; i < nblocks && !blocks[i].profiled; i++)
+		;
+	if (mark || i == nblocks) {
+		seq = newarray(nblocks + 1, sizeof *seq, FUNC);
+		for (i = 0; i < nblocks; i++)
+			seq[i] = i;
+		nfirst = nblocks;
+	} else {
+		estimate();
+		chain();
+		seq = order(&nfirst);
+	}
+	connect(seq, nblocks, nfirst);
+	for (i = 0; i < nfirst; i++)
+		emitblock(f, seq[i], mark);
+	tail = seq + nfirst;
+	ntail = nblocks - nfirst;
+	for (cp = codehead.next; cp; cp = cp->next)
+		if (cp->kind == Gen || cp->kind == Jump || cp->kind == Label)
+			cp->u.forest = NULL;
+	emitcode();
+}
+
+/* layouttail - emit the blocks placed after the epilogue */
+void layouttail(Symbol f) {
+	int i;
+
+	for (i = 0; i < ntail; i++)
+		emitblock(f, tail[i], 0);
+	ntail = 0;
+}
@@ -1,4 +1,8 @@
 #include "c.h"
+#ifndef WIN32
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
 
 static char rcsid[] = "$Name: v4_2 $($Id: main.c,v 1.1 2002/08/28 23:12:44 drh Exp $)";
 
@@ -6,6 +10,8 @@ static void typestab(Symbol, void *);
 
 static void stabline(Coordinate *);
 static void stabend(Coordinate *, Symbol, Coordinate **, Symbol *, Symbol *);
+static void startup(int, char *[]);
+static void serve(int, char *[]);
 Interface *IR = NULL;
 
 int Aflag;		/* >= 0 if -A specified */
@@ -47,8 +53,49 @@ int main(int argc, char *argv[]) {
 			fprint(stderr, "\t-target=%s\n", bindings[i].name);
 		exit(EXIT_FAILURE);
 	}
-	init(argc, argv);
-	t = gettok();
+	for (i = 1; i < argc; i++)
+		if (strcmp(argv[i], "--server") == 0)
+			break;
+	if (i < argc) {
+		main_init(argc, argv);
+		serve(argc, argv);
+		init(argc, argv);
+		t = gettok();
+	} else {
+		init(argc, argv);
+		t = gettok();
+		startup(argc, argv);
+	}
+	if (glevel && IR->stabinit)
+		(*IR->stabinit)(firstfile, argc, argv);
+	program();
+	if (events.end)
+		apply(events.end, NULL, NULL);
+	memset(&events, 0, sizeof events);
+	if (glevel || xref) {
+		Symbol symroot = NULL;
+		Coordinate src;
+		foreach(types,       GLOBAL, typestab, &symroot);
+		foreach(identifiers, GLOBAL, typestab, &symroot);
+		src.file = firstfile;
+		src.x = 0;
+		src.y = lineno;
+		if ((glevel > 2 || xref) && IR->stabend)
+			(*IR->stabend)(&src, symroot,
+				ltov(&loci,    PERM),
+				ltov(&symbols, PERM), NULL);
+		else if (IR->stabend)
+			(*IR->stabend)(&src, NULL, NULL, NULL, NULL);
+	}
+	finalize();
+	(*IR->progend)();
+	deallocate(PERM);
+	return errcnt > 0;
+}
+/* startup - set up the back end, process -n and the profiling options */
+static void startup(int argc, char *argv[]) {
+	int i;
+
 	(*IR->progbeg)(argc, argv);
 	for (i = 1; i < argc; i++)
 		if (strcmp(argv[i], "-n") == 0) {
@@ -76,31 +123,6 @@ int main(int argc, char *argv[]) {
 			profInit(argv[i]);
 			traceInit(argv[i]);
 		}
-	if (glevel && IR->stabinit)
-		(*IR->stabinit)(firstfile, argc, argv);
-	program();
-	if (events.end)
-		apply(events.end, NULL, NULL);
-	memset(&events, 0, sizeof events);
-	if (glevel || xref) {
-		Symbol symroot = NULL;
-		Coordinate src;
-		foreach(types,       GLOBAL, typestab, &symroot);
-		foreach(identifiers, GLOBAL, typestab, &symroot);
-		src.file = firstfile;
-		src.x = 0;
-		src.y = lineno;
-		if ((glevel > 2 || xref) && IR->stabend)
-			(*IR->stabend)(&src, symroot,
-				ltov(&loci,    PERM),
-				ltov(&symbols, PERM), NULL);
-		else if (IR->stabend)
-			(*IR->stabend)(&src, NULL, NULL, NULL, NULL);
-	}
-	finalize();
-	(*IR->progend)();
-	deallocate(PERM);
-	return errcnt > 0;
 }
 /* main_init - process program arguments */
 void main_init(int argc, char *argv[]) {
@@ -228,3 +250,83 @@ static void stabend(Coordinate *cp, Symbol p, Coordinate **cpp, Symbol *sp, Symb
 	if (srcfp)
 		fclose(srcfp);
 }
+
+/*
+ * serve - compile requests read from stdin, for --server
+ *
+ * The server processes its options and sets up the back end
+ * once (startup); what progbeg writes is kept and written at
+ * the start of every output file. Each request is two lines,
+ * the names of the input and output files. A copy of the set
+ * up compiler is forked for every request and compiles the
+ * file; the FUNC and STMT arenas and the symbol tables of the
+ * units thus start out clean. The parent answers each request
+ * with a line holding the exit status of the copy. serve
+ * returns only in the copy, which then reads its input.
+ */
+static void serve(int argc, char *argv[]) {
+#ifdef WIN32
+	fprint(stderr, "rcc: --server is not supported\n");
+	exit(EXIT_FAILURE);
+#else
+	char in[1024], out[1024];
+	char *prologue;
+	FILE *tmp;
+	long size;
+	int fd, pid, status;
+
+	fflush(stdout);
+	if ((tmp = tmpfile()) == NULL || (fd = dup(1)) == -1
+	|| dup2(fileno(tmp), 1) == -1) {
+		fprint(stderr, "rcc: can't set up the server\n");
+		exit(EXIT_FAILURE);
+	}
+	startup(argc, argv);
+	fflush(stdout);
+	dup2(fd, 1);
+	close(fd);
+	size = ftell(tmp);
+	prologue = malloc(size + 1);
+	rewind(tmp);
+	if (size < 0 || prologue == NULL
+	|| fread(prologue, 1, size, tmp) != (size_t)size) {
+		fprint(stderr, "rcc: can't set up the server\n");
+		exit(EXIT_FAILURE);
+	}
+	fclose(tmp);
+	/* no read-ahead: the copy's freopen would reposition stdin */
+	setvbuf(stdin, NULL, _IONBF, 0);
+	while (fgets(in, sizeof in, stdin) != NULL
+	&& fgets(out, sizeof out, stdin) != NULL) {
+		in[strcspn(in, "\n")] = '\0';
+		out[strcspn(out, "\n")] = '\0';
+		fflush(stdout);
+		fflush(stderr);
+		switch (pid = fork()) {
+		case 0:
+			if (freopen(in, "r", stdin) == NULL) {
+				fprint(stderr, "rcc: can't read `%s'\n", in);
+				exit(EXIT_FAILURE);
+			}
+			if (freopen(out, "w", stdout) == NULL) {
+				fprint(stderr, "rcc: can't write `%s'\n", out);
+				exit(EXIT_FAILURE);
+			}
+			fwrite(prologue, 1, size, stdout);
+			return;
+		case -1:
+			status = 100;
+			break;
+		default:
+			if (waitpid(pid, &status, 0) == -1 || !WIFEXITED(status))
+				status = 100;
+			else
+				status = WEXITSTATUS(status);
+			break;
+		}
+		fprint(stdout, "%d\n", status);
+		fflush(stdout);
+	}
+	exit(EXIT_SUCCESS);
+#endif
+}
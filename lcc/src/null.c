@@ -42,6 +42,7 @@ Interface nullIR = {
 	0, 4, 0,	/* struct */
 	1,		/* little_endian */
 	0,		/* mulops_calls */
+	0,		/* floatops_calls */
 	0,		/* wants_callb */
 	0,		/* wants_argb */
 	1,		/* left_to_right */
@@ -180,7 +180,7 @@ Symbol constant(Type ty, Value v) {
 			case UNSIGNED: if (equalp(u)) return &p->sym; break;
 			case FLOAT:
 				if (v.d == 0.0) {
-					float z1 = v.d, z2 = p->sym.u.c.v.d;
+					double z1 = v.d, z2 = p->sym.u.c.v.d;
 					char *b1 = (char *)&z1, *b2 = (char *)&z2;
 					if (z1 == z2
 					&& (!little.endian && b1[0] == b2[0]
@@ -447,6 +447,7 @@ Interface symbolicIR = {
 	0, 4, 0,	/* struct */
 	0,		/* little_endian */
 	0,		/* mulops_calls */
+	0,		/* floatops_calls */
 	0,		/* wants_callb */
 	1,		/* wants_argb */
 	1,		/* left_to_right */
@@ -492,6 +493,7 @@ Interface symbolic64IR = {
 	0, 1, 0,	/* struct */
 	1,		/* little_endian */
 	0,		/* mulops_calls */
+	0,		/* floatops_calls */
 	0,		/* wants_callb */
 	1,		/* wants_argb */
 	1,		/* left_to_right */
@@ -75,15 +75,15 @@
 #define FLT_EPSILON	1.192092895508e-7
 #define FLT_MIN		1.175494350822e-38
 
-#define DBL_MANT_DIG	FLT_MANT_DIG
-#define DBL_DIG		FLT_DIG
-#define DBL_MIN_EXP	FLT_MIN_EXP
-#define DBL_MIN_10_EXP	FLT_MIN_10_EXP
-#define DBL_MAX_EXP	FLT_MAX_EXP
-#define DBL_MAX_10_EXP	FLT_MAX_10_EXP
-#define DBL_MAX		FLT_MAX
-#define DBL_EPSILON	FLT_EPSILON
-#define DBL_MIN		FLT_MIN
+#define DBL_MANT_DIG	53
+#define DBL_DIG		15
+#define DBL_MIN_EXP	-1021
+#define DBL_MIN_10_EXP	-307
+#define DBL_MAX_EXP	1024
+#define DBL_MAX_10_EXP	308
+#define DBL_MAX		1.7976931348623157e+308
+#define DBL_EPSILON	2.2204460492503131e-16
+#define DBL_MIN		2.2250738585072014e-308
 
 #define FLT_ROUNDS	1
 
@@ -0,0 +1,23 @@
+/*
+ * arena.h -- allocation arenas
+ */
+
+
+#ifndef _ARENA_H_
+#define _ARENA_H_
+
+
+#ifndef _SIZE_T_DEFINED_
+#define _SIZE_T_DEFINED_
+typedef unsigned long size_t;
+#endif
+
+typedef struct arena Arena;
+
+
+Arena *arenaCreate(size_t size);
+void *arenaAlloc(Arena *a, size_t size);
+void arenaReset(Arena *a);
+
+
+#endif /* _ARENA_H_ */
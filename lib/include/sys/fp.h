@@ -23,5 +23,19 @@ typedef union {
   _FP_Word w;
 } _FP_Union;
 
+/*
+ * double precision: ECO32 is big-endian, so the word with
+ * sign and exponent comes first (override for other hosts)
+ */
+#ifndef _FP_HI
+#define _FP_HI		0
+#define _FP_LO		1
+#endif
+
+typedef union {
+  double d;
+  _FP_Word w[2];
+} _FP_DUnion;
+
 
 #endif /* _FP_H_ */
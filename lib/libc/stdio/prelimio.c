@@ -84,9 +84,6 @@ void putc(char c);
 #define _IOLIB_H_
 
 
-int strlen(char *str);
-void strcpy(char *dst, char *src);
-void memcpy(unsigned char *dst, unsigned char *src, unsigned int cnt);
 char getchar(void);
 void putchar(char c);
 void putString(char *s);
@@ -129,34 +126,7 @@ void putc(char c) {
 
 
 #include "stdarg.h"
-
-
-/**************************************************************/
-
-/* string functions */
-
-
-int strlen(char *str) {
-  int i;
-
-  i = 0;
-  while (*str++ != '\0') {
-    i++;
-  }
-  return i;
-}
-
-
-void strcpy(char *dst, char *src) {
-  while ((*dst++ = *src++) != '\0') ;
-}
-
-
-void memcpy(unsigned char *dst, unsigned char *src, unsigned int cnt) {
-  while (cnt--) {
-    *dst++ = *src++;
-  }
-}
+#include "string.h"
 
 
 /**************************************************************/
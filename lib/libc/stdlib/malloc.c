@@ -5,78 +5,470 @@
 
 #include "stdlib.h"
 #include "sys/syscall.h"
+#include "sys/arena.h"
 
 
-#define MIN_ALLOC	1024	/* minimum number of units to request */
+/*
+ * Every block starts with a header word, which holds the
+ * size of the block (header included, a multiple of 8) and
+ * three flags. Headers live at addresses = 4 mod 8, so that
+ * the user data is aligned on 8 bytes.
+ *
+ * Small requests are served from segregated free lists, one
+ * per size class. Small blocks are carved out of slabs, which
+ * are taken from the large heap and never given back.
+ *
+ * Large requests are served from a doubly linked free list
+ * by best fit. Free large blocks carry their size in their
+ * last word as well (a boundary tag), so that a block being
+ * freed can be coalesced with both of its neighbours. A heap
+ * region ends with a fencepost, a zero-sized in-use header.
+ */
+
+
+#define INUSE		1U	/* this block is in use */
+#define PINUSE		2U	/* the previous block is in use */
+#define SMALL		4U	/* this block belongs to a size class */
+#define FLAGS		7U
+
+#define MIN_BLOCK	16	/* header, two links, footer */
+#define MAX_SMALL	256	/* largest size class */
+#define NCLASSES	15
+#define SLAB_SIZE	4096	/* bytes taken for a slab */
+#define MIN_GROW	16384	/* minimum number of bytes to request */
+#define ARENA_HEAD	((sizeof(Arena) + 7) / 8 * 8)
+
+#define SIZE(b)		((b)->head & ~FLAGS)
+#define NEXT(b)		((Block *) ((char *) (b) + SIZE(b)))
+#define PREV(b)		((Block *) ((char *) (b) - ((unsigned int *) (b))[-1]))
+#define FOOT(b)		(((unsigned int *) NEXT(b))[-1])
+#define DATA(b)		((void *) ((char *) (b) + 4))
+#define BLOCK(p)	((Block *) ((char *) (p) - 4))
+
+
+typedef struct block {
+  unsigned int head;		/* size and flags */
+  struct block *next;		/* next block if on a free list */
+  struct block *prev;		/* previous block if on the large list */
+} Block;
+
+struct arena {
+  Block *small[NCLASSES];	/* free lists of the size classes */
+  Block large;			/* list head of the large free blocks */
+  char *slab;			/* unused part of the current slab */
+  char *slabEnd;
+  char *lo;			/* extent of the last heap region */
+  char *hi;
+  int growable;			/* may ask for more core */
+  struct arena *nextArena;
+};
+
+
+static unsigned int classSize[NCLASSES] = {
+  16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256,
+};
+
+static unsigned char classOf[MAX_SMALL / 8 + 1] = {
+  0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 7, 8, 8, 9, 9, 10,
+  10, 11, 11, 11, 11, 12, 12, 12, 12, 13, 13, 13, 13, 14, 14, 14,
+  14,
+};
+
+
+static Arena mainArena;
+static Arena *arenas;		/* arenas made by arenaCreate */
+
+
+/**************************************************************/
 
+/* large blocks */
 
-typedef long Align;
 
-typedef union header {
-  struct {
-    union header *ptr;		/* next block if on free list */
-    unsigned int size;		/* size of this block in header units */
-  } s;
-  Align x;			/* force alignment */
-} Header;
+static void unlinkBlock(Block *b) {
+  b->prev->next = b->next;
+  b->next->prev = b->prev;
+}
 
 
-static Header base;
-static Header *freep;
+static void insertBlock(Arena *a, Block *b) {
+  b->next = a->large.next;
+  b->prev = &a->large;
+  a->large.next->prev = b;
+  a->large.next = b;
+}
 
 
-static Header *moreCore(unsigned int numUnits) {
-  void *cp;
+/*
+ * Put a block, which is marked in use, back on the large list.
+ */
+static void freeLarge(Arena *a, Block *b) {
+  unsigned int size;
+  Block *n;
 
-  if (numUnits < MIN_ALLOC) {
-    numUnits = MIN_ALLOC;
+  size = SIZE(b);
+  if ((b->head & PINUSE) == 0) {
+    b = PREV(b);
+    unlinkBlock(b);
+    size += SIZE(b);
   }
-  cp = sbrk(numUnits * sizeof(Header));
-  if (cp == (void *) (unsigned int) -1) {
-    /* no space */
-    return NULL;
+  n = (Block *) ((char *) b + size);
+  if ((n->head & INUSE) == 0) {
+    unlinkBlock(n);
+    size += SIZE(n);
+  }
+  b->head = size | PINUSE;
+  FOOT(b) = size;
+  NEXT(b)->head &= ~PINUSE;
+  insertBlock(a, b);
+}
+
+
+/*
+ * Shorten an in-use block to 'need' bytes if the rest
+ * is big enough to become a free block of its own.
+ */
+static void trim(Arena *a, Block *b, unsigned int need) {
+  unsigned int size;
+  Block *r;
+
+  size = SIZE(b);
+  if (size - need < MIN_BLOCK) {
+    return;
   }
-  /* !!!!! */
+  b->head = need | (b->head & FLAGS);
+  r = NEXT(b);
+  r->head = (size - need) | INUSE | PINUSE;
+  freeLarge(a, r);
+}
+
+
+/*
+ * Get at least 'need' more bytes from the system and add
+ * them to the large list. A region which continues the
+ * previous one takes over its fencepost as a header.
+ */
+static int grow(Arena *a, unsigned int need) {
+  unsigned int n;
+  char *p;
+  Block *b;
+
+  if (!a->growable) {
+    return 0;
+  }
+  n = (need + 8 + MIN_GROW - 1) & ~(MIN_GROW - 1U);
+  p = sbrk(n);
+  if (p == (char *) (unsigned int) -1) {
+    return 0;
+  }
+  if (p == a->hi) {
+    b = (Block *) (p - 4);
+    b->head = n | INUSE | (b->head & PINUSE);
+  } else {
+    a->lo = p;
+    b = (Block *) (p + 4);
+    b->head = (n - 8) | INUSE | PINUSE;
+  }
+  a->hi = p + n;
+  ((Block *) (a->hi - 4))->head = INUSE | PINUSE;
+  freeLarge(a, b);
+  return 1;
+}
+
+
+static Block *allocLarge(Arena *a, unsigned int need) {
+  Block *b, *best;
+
+  do {
+    best = NULL;
+    for (b = a->large.next; b != &a->large; b = b->next) {
+      if (SIZE(b) >= need && (best == NULL || SIZE(b) < SIZE(best))) {
+        best = b;
+        if (SIZE(b) == need) {
+          break;
+        }
+      }
+    }
+    if (best != NULL) {
+      unlinkBlock(best);
+      best->head |= INUSE;
+      NEXT(best)->head |= PINUSE;
+      trim(a, best, need);
+      return best;
+    }
+  } while (grow(a, need));
   return NULL;
 }
 
 
+/**************************************************************/
+
+/* small blocks */
+
+
+static Block *allocSmall(Arena *a, int c) {
+  unsigned int size, rest;
+  Block *b, *s;
+
+  b = a->small[c];
+  if (b != NULL) {
+    a->small[c] = b->next;
+    return b;
+  }
+  size = classSize[c];
+  if (a->slab + size > a->slabEnd) {
+    /* keep the tail of the old slab in a smaller class */
+    rest = a->slabEnd - a->slab;
+    if (rest >= MIN_BLOCK) {
+      b = (Block *) a->slab;
+      c = classOf[rest >> 3];
+      while (classSize[c] > rest) {
+        c--;
+      }
+      b->head = classSize[c] | SMALL | INUSE;
+      b->next = a->small[c];
+      a->small[c] = b;
+    }
+    s = allocLarge(a, SLAB_SIZE);
+    if (s == NULL) {
+      return NULL;
+    }
+    a->slab = (char *) DATA(s) + 4;
+    a->slabEnd = (char *) NEXT(s);
+  }
+  b = (Block *) a->slab;
+  a->slab += size;
+  b->head = size | SMALL | INUSE;
+  return b;
+}
+
+
+/**************************************************************/
+
+/* interface */
+
+
+static void initArena(Arena *a) {
+  int c;
+
+  for (c = 0; c < NCLASSES; c++) {
+    a->small[c] = NULL;
+  }
+  a->large.next = &a->large;
+  a->large.prev = &a->large;
+  a->slab = NULL;
+  a->slabEnd = NULL;
+}
+
+
+static Arena *arenaOf(void *p) {
+  Arena *a;
+
+  for (a = arenas; a != NULL; a = a->nextArena) {
+    if ((char *) p > a->lo && (char *) p < a->hi) {
+      return a;
+    }
+  }
+  return &mainArena;
+}
+
+
+static unsigned int blockNeed(size_t size) {
+  unsigned int need;
+
+  need = (size + 4 + 7) & ~7U;
+  return need < MIN_BLOCK ? MIN_BLOCK : need;
+}
+
+
+static void *allocate(Arena *a, size_t size) {
+  unsigned int need;
+  Block *b;
+
+  if (size <= 0 || size > 0x7FFFFFF0) {
+    return NULL;
+  }
+  if (a == &mainArena && a->large.next == NULL) {
+    initArena(a);
+    a->growable = 1;
+  }
+  need = blockNeed(size);
+  if (need <= MAX_SMALL) {
+    b = allocSmall(a, classOf[need >> 3]);
+  } else {
+    b = allocLarge(a, need);
+  }
+  return b == NULL ? NULL : DATA(b);
+}
+
+
+/*
+ * Copy n bytes, n a multiple of 4, between word-aligned areas.
+ */
+static void copyWords(void *dst, void *src, unsigned int n) {
+  unsigned int *d, *s;
+
+  d = dst;
+  s = src;
+  for (n >>= 2; n >= 4; n -= 4) {
+    d[0] = s[0];
+    d[1] = s[1];
+    d[2] = s[2];
+    d[3] = s[3];
+    d += 4;
+    s += 4;
+  }
+  while (n-- != 0) {
+    *d++ = *s++;
+  }
+}
+
+
 void *calloc(size_t nobj, size_t size) {
   size_t s;
   void *p;
-  char *q;
+  unsigned int *q;
 
-  s = nobj * size;
-  if (s <= 0) {
+  if (size != 0 && nobj > (size_t) -1 / size) {
     return NULL;
   }
+  s = nobj * size;
   p = malloc(s);
   if (p == NULL) {
     return NULL;
   }
-  q = (char *) p;
+  /* the block always extends to the next word boundary */
+  q = (unsigned int *) p;
+  for (s = (s + 3) >> 2; s >= 4; s -= 4) {
+    q[0] = 0;
+    q[1] = 0;
+    q[2] = 0;
+    q[3] = 0;
+    q += 4;
+  }
   while (s-- != 0) {
-    *q++ = '\0';
+    *q++ = 0;
   }
   return p;
 }
 
 
 void *malloc(size_t size) {
+  return allocate(&mainArena, size);
+}
+
+
+void *realloc(void *p, size_t size) {
+  Arena *a;
+  Block *b, *n;
+  unsigned int need, have;
+  void *q;
+
+  if (p == NULL) {
+    return malloc(size);
+  }
   if (size <= 0) {
+    free(p);
     return NULL;
   }
-  /* !!!!! */
-  return NULL;
+  if (size > 0x7FFFFFF0) {
+    return NULL;
+  }
+  a = arenaOf(p);
+  b = BLOCK(p);
+  need = blockNeed(size);
+  have = SIZE(b);
+  if (need <= have) {
+    if ((b->head & SMALL) == 0) {
+      trim(a, b, need);
+    }
+    return p;
+  }
+  if ((b->head & SMALL) == 0) {
+    n = NEXT(b);
+    if ((n->head & INUSE) == 0 && have + SIZE(n) >= need) {
+      /* grow into the free neighbour */
+      unlinkBlock(n);
+      b->head += SIZE(n);
+      NEXT(b)->head |= PINUSE;
+      trim(a, b, need);
+      return p;
+    }
+  }
+  q = allocate(a, size);
+  if (q == NULL) {
+    return NULL;
+  }
+  copyWords(q, p, have - 4);
+  free(p);
+  return q;
 }
 
 
-void *realloc(void *p, size_t size) {
-  /* !!!!! */
-  return NULL;
+void free(void *p) {
+  Arena *a;
+  Block *b;
+  int c;
+
+  if (p == NULL) {
+    return;
+  }
+  a = arenaOf(p);
+  b = BLOCK(p);
+  if (b->head & SMALL) {
+    c = classOf[SIZE(b) >> 3];
+    b->next = a->small[c];
+    a->small[c] = b;
+  } else {
+    freeLarge(a, b);
+  }
 }
 
 
-void free(void *p) {
-  /* !!!!! */
+/**************************************************************/
+
+/* arenas */
+
+
+/*
+ * An arena is a fixed region of memory with its own free
+ * lists. Blocks allocated in an arena may be freed and
+ * reallocated as usual; arenaReset frees all of them at once.
+ */
+Arena *arenaCreate(size_t size) {
+  unsigned int n;
+  char *p;
+  Arena *a;
+
+  if (size > 0x7FFFFFF0) {
+    return NULL;
+  }
+  n = ARENA_HEAD + ((size + 7) & ~7U) + 8;
+  p = sbrk(n);
+  if (p == (char *) (unsigned int) -1) {
+    return NULL;
+  }
+  a = (Arena *) p;
+  a->lo = p + ARENA_HEAD;
+  a->hi = p + n;
+  a->growable = 0;
+  a->nextArena = arenas;
+  arenas = a;
+  arenaReset(a);
+  return a;
+}
+
+
+void *arenaAlloc(Arena *a, size_t size) {
+  return allocate(a, size);
+}
+
+
+void arenaReset(Arena *a) {
+  Block *b;
+
+  initArena(a);
+  b = (Block *) (a->lo + 4);
+  b->head = (a->hi - a->lo - 8) | INUSE | PINUSE;
+  ((Block *) (a->hi - 4))->head = INUSE | PINUSE;
+  freeLarge(a, b);
 }
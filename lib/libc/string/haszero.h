@@ -0,0 +1,19 @@
+/*
+ * haszero.h -- zero byte detection in a word
+ */
+
+
+#ifndef _HASZERO_H_
+#define _HASZERO_H_
+
+
+/*
+ * Non-zero iff one of the four bytes of w is zero. A borrow
+ * can only propagate out of a zero byte, so a false hit in a
+ * higher byte is always preceded by a true one in a lower
+ * byte; the result is exact as a truth value.
+ */
+#define HASZERO(w)	(((w) - 0x01010101) & ~(w) & 0x80808080)
+
+
+#endif /* _HASZERO_H_ */
@@ -6,12 +6,38 @@
 #include "string.h"
 
 
+/*
+ * If both areas can be aligned at the same time, words are
+ * compared until they differ; the bytes of the differing
+ * word are then compared one by one.
+ */
 int memcmp(const void *cs, const void *ct, size_t n) {
   unsigned char *dst;
   unsigned char *src;
+  unsigned int *d;
+  unsigned int *s;
 
   dst = (unsigned char *) cs;
   src = (unsigned char *) ct;
+  if (n >= 8 && (((unsigned int) dst ^ (unsigned int) src) & 3) == 0) {
+    while (((unsigned int) dst & 3) != 0) {
+      if (*dst != *src) {
+        return (int) *dst - (int) *src;
+      }
+      dst++;
+      src++;
+      n--;
+    }
+    d = (unsigned int *) dst;
+    s = (unsigned int *) src;
+    while (n >= 4 && *d == *s) {
+      d++;
+      s++;
+      n -= 4;
+    }
+    dst = (unsigned char *) d;
+    src = (unsigned char *) s;
+  }
   while (n-- != 0) {
     if (*dst != *src) {
       return (int) *dst - (int) *src;
@@ -6,12 +6,58 @@
 #include "string.h"
 
 
+/*
+ * Once the destination is word-aligned, the copy proceeds
+ * by words. If the source is not aligned as well, every
+ * destination word is merged from two aligned source words
+ * (the machine is big-endian). Reading whole source words
+ * never touches a word which holds no byte to be copied.
+ */
 void *memcpy(void *s, const void *ct, size_t n) {
   unsigned char *dst;
   unsigned char *src;
+  unsigned int *d;
+  unsigned int *w;
+  unsigned int w0, w1;
+  int sh;
 
   dst = (unsigned char *) s;
   src = (unsigned char *) ct;
+  if (n >= 8) {
+    while (((unsigned int) dst & 3) != 0) {
+      *dst++ = *src++;
+      n--;
+    }
+    d = (unsigned int *) dst;
+    sh = ((unsigned int) src & 3) << 3;
+    w = (unsigned int *) (src - (sh >> 3));
+    if (sh == 0) {
+      while (n >= 16) {
+        d[0] = w[0];
+        d[1] = w[1];
+        d[2] = w[2];
+        d[3] = w[3];
+        d += 4;
+        w += 4;
+        n -= 16;
+      }
+      while (n >= 4) {
+        *d++ = *w++;
+        n -= 4;
+      }
+      src = (unsigned char *) w;
+    } else {
+      w0 = *w++;
+      while (n >= 4) {
+        w1 = *w++;
+        *d++ = (w0 << sh) | (w1 >> (32 - sh));
+        w0 = w1;
+        n -= 4;
+      }
+      src = (unsigned char *) (w - 1) + (sh >> 3);
+    }
+    dst = (unsigned char *) d;
+  }
   while (n-- != 0) {
     *dst++ = *src++;
   }
@@ -0,0 +1,104 @@
+;
+; memcpy.s -- copy memory contents
+;
+
+	.export	memcpy
+
+	.code
+	.align	4
+
+;
+; void *memcpy(void *s, const void *ct, size_t n)
+; s in $4, ct in $5, n in $6. The destination is aligned
+; first; then 16 bytes are copied per iteration. With a
+; misaligned source, each destination word is merged from
+; two aligned source words, shifted by sh = 8 * (ct & 3).
+;
+memcpy:
+	add	$2,$4,$0		; return s
+	add	$8,$0,8
+	bltu	$6,$8,cpy9		; short copies go by bytes
+cpy1:
+	and	$8,$4,3			; align destination
+	beq	$8,$0,cpy2
+	ldbu	$9,$5,0
+	stb	$9,$4,0
+	add	$4,$4,1
+	add	$5,$5,1
+	sub	$6,$6,1
+	j	cpy1
+cpy2:
+	and	$8,$5,3
+	bne	$8,$0,cpy6		; source misaligned
+	add	$8,$0,16
+	bltu	$6,$8,cpy4
+cpy3:
+	ldw	$9,$5,0
+	ldw	$10,$5,4
+	ldw	$11,$5,8
+	ldw	$12,$5,12
+	stw	$9,$4,0
+	stw	$10,$4,4
+	stw	$11,$4,8
+	stw	$12,$4,12
+	add	$4,$4,16
+	add	$5,$5,16
+	sub	$6,$6,16
+	bgeu	$6,$8,cpy3
+cpy4:
+	add	$8,$0,4
+	bltu	$6,$8,cpy9
+cpy5:
+	ldw	$9,$5,0
+	stw	$9,$4,0
+	add	$4,$4,4
+	add	$5,$5,4
+	sub	$6,$6,4
+	bgeu	$6,$8,cpy5
+	j	cpy9
+cpy6:
+	sll	$12,$8,3		; sh
+	add	$13,$0,32
+	sub	$13,$13,$12		; 32 - sh
+	sub	$5,$5,$8		; $5 = aligned word holding w0
+	ldw	$11,$5,0		; w0
+	add	$24,$0,8
+	bltu	$6,$24,cpy8
+cpy7:
+	ldw	$14,$5,4		; w1
+	sll	$9,$11,$12
+	slr	$10,$14,$13
+	or	$9,$9,$10
+	stw	$9,$4,0
+	ldw	$11,$5,8		; w2, the next w0
+	sll	$9,$14,$12
+	slr	$10,$11,$13
+	or	$9,$9,$10
+	stw	$9,$4,4
+	add	$4,$4,8
+	add	$5,$5,8
+	sub	$6,$6,8
+	bgeu	$6,$24,cpy7
+cpy8:
+	add	$24,$0,4
+	bltu	$6,$24,cpy81
+	ldw	$14,$5,4
+	sll	$9,$11,$12
+	slr	$10,$14,$13
+	or	$9,$9,$10
+	stw	$9,$4,0
+	add	$4,$4,4
+	add	$5,$5,4
+	sub	$6,$6,4
+cpy81:
+	add	$5,$5,$8		; back to the byte address
+cpy9:
+	beq	$6,$0,cpy10		; remaining bytes
+	ldbu	$9,$5,0
+	stb	$9,$4,0
+	add	$4,$4,1
+	add	$5,$5,1
+	sub	$6,$6,1
+	j	cpy9
+cpy10:
+	jr	$31
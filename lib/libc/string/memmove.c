@@ -6,24 +6,64 @@
 #include "string.h"
 
 
+/*
+ * Words are copied as in memcpy, in the direction which
+ * never overwrites source bytes that are still to be read.
+ */
 void *memmove(void *s, const void *ct, size_t n) {
   unsigned char *dst;
   unsigned char *src;
+  unsigned int *d;
+  unsigned int *w;
+  unsigned int w0, w1;
+  int sh;
 
-  if (dst < src) {
+  dst = (unsigned char *) s;
+  src = (unsigned char *) ct;
+  if (dst <= src || dst >= src + n) {
     /* direction: up */
-    dst = (unsigned char *) s;
-    src = (unsigned char *) ct;
-    while (n-- != 0) {
-      *dst++ = *src++;
-    }
-  } else {
-    /* direction: down */
-    dst = (unsigned char *) s + n;
-    src = (unsigned char *) ct + n;
-    while (n-- != 0) {
+    return memcpy(s, ct, n);
+  }
+  /* direction: down */
+  dst += n;
+  src += n;
+  if (n >= 8) {
+    while (((unsigned int) dst & 3) != 0) {
       *--dst = *--src;
+      n--;
+    }
+    d = (unsigned int *) dst;
+    sh = ((unsigned int) src & 3) << 3;
+    w = (unsigned int *) (src - (sh >> 3));
+    if (sh == 0) {
+      while (n >= 16) {
+        d -= 4;
+        w -= 4;
+        d[3] = w[3];
+        d[2] = w[2];
+        d[1] = w[1];
+        d[0] = w[0];
+        n -= 16;
+      }
+      while (n >= 4) {
+        *--d = *--w;
+        n -= 4;
+      }
+      src = (unsigned char *) w;
+    } else {
+      w1 = *w;
+      while (n >= 4) {
+        w0 = *--w;
+        *--d = (w0 << sh) | (w1 >> (32 - sh));
+        w1 = w0;
+        n -= 4;
+      }
+      src = (unsigned char *) w + (sh >> 3);
     }
+    dst = (unsigned char *) d;
+  }
+  while (n-- != 0) {
+    *--dst = *--src;
   }
   return s;
 }
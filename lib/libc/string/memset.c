@@ -8,8 +8,33 @@
 
 void *memset(void *s, int c, size_t n) {
   unsigned char *dst;
+  unsigned int *d;
+  unsigned int w;
 
   dst = (unsigned char *) s;
+  if (n >= 8) {
+    while (((unsigned int) dst & 3) != 0) {
+      *dst++ = c;
+      n--;
+    }
+    w = c & 0xFF;
+    w |= w << 8;
+    w |= w << 16;
+    d = (unsigned int *) dst;
+    while (n >= 16) {
+      d[0] = w;
+      d[1] = w;
+      d[2] = w;
+      d[3] = w;
+      d += 4;
+      n -= 16;
+    }
+    while (n >= 4) {
+      *d++ = w;
+      n -= 4;
+    }
+    dst = (unsigned char *) d;
+  }
   while (n-- != 0) {
     *dst++ = c;
   }
@@ -0,0 +1,58 @@
+;
+; memset.s -- set memory contents
+;
+
+	.export	memset
+
+	.code
+	.align	4
+
+;
+; void *memset(void *s, int c, size_t n)
+; s in $4, c in $5, n in $6. The destination is aligned
+; first; then c, replicated into all four bytes of a word,
+; is stored 16 bytes per iteration.
+;
+memset:
+	add	$2,$4,$0		; return s
+	and	$5,$5,0xFF
+	add	$8,$0,8
+	bltu	$6,$8,set5		; short areas go by bytes
+set1:
+	and	$8,$4,3			; align destination
+	beq	$8,$0,set2
+	stb	$5,$4,0
+	add	$4,$4,1
+	sub	$6,$6,1
+	j	set1
+set2:
+	sll	$8,$5,8			; replicate c
+	or	$5,$5,$8
+	sll	$8,$5,16
+	or	$5,$5,$8
+	add	$8,$0,16
+	bltu	$6,$8,set4
+set3:
+	stw	$5,$4,0
+	stw	$5,$4,4
+	stw	$5,$4,8
+	stw	$5,$4,12
+	add	$4,$4,16
+	sub	$6,$6,16
+	bgeu	$6,$8,set3
+set4:
+	add	$8,$0,4
+	bltu	$6,$8,set5
+set41:
+	stw	$5,$4,0
+	add	$4,$4,4
+	sub	$6,$6,4
+	bgeu	$6,$8,set41
+set5:
+	beq	$6,$0,set6		; remaining bytes
+	stb	$5,$4,0
+	add	$4,$4,1
+	sub	$6,$6,1
+	j	set5
+set6:
+	jr	$31
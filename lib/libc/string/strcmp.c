@@ -4,9 +4,31 @@
 
 
 #include "string.h"
+#include "haszero.h"
 
 
 int strcmp(const char *cs, const char *ct) {
+  unsigned int *s;
+  unsigned int *t;
+
+  if ((((unsigned int) cs ^ (unsigned int) ct) & 3) == 0) {
+    while (((unsigned int) cs & 3) != 0) {
+      if (*cs == '\0' || *cs != *ct) {
+        return (int) (unsigned char) *cs - (int) (unsigned char) *ct;
+      }
+      cs++;
+      ct++;
+    }
+    /* skip equal words without a terminator */
+    s = (unsigned int *) cs;
+    t = (unsigned int *) ct;
+    while (*s == *t && !HASZERO(*s)) {
+      s++;
+      t++;
+    }
+    cs = (const char *) s;
+    ct = (const char *) t;
+  }
   while (*cs != '\0' && *cs == *ct) {
     cs++;
     ct++;
@@ -4,12 +4,33 @@
 
 
 #include "string.h"
+#include "haszero.h"
 
 
 char *strcpy(char *s, const char *ct) {
   char *dst;
+  unsigned int *d;
+  unsigned int *t;
+  unsigned int w;
 
   dst = s;
+  if ((((unsigned int) dst ^ (unsigned int) ct) & 3) == 0) {
+    while (((unsigned int) ct & 3) != 0) {
+      if ((*dst++ = *ct++) == '\0') {
+        return s;
+      }
+    }
+    /* copy whole words up to the one holding the terminator */
+    d = (unsigned int *) dst;
+    t = (unsigned int *) ct;
+    w = *t++;
+    while (!HASZERO(w)) {
+      *d++ = w;
+      w = *t++;
+    }
+    dst = (char *) d;
+    ct = (const char *) (t - 1);
+  }
   while ((*dst++ = *ct++) != '\0') ;
   return s;
 }
@@ -4,14 +4,28 @@
 
 
 #include "string.h"
+#include "haszero.h"
 
 
 size_t strlen(const char *cs) {
-  size_t len;
+  const char *p;
+  unsigned int *w;
 
-  len = 0;
-  while (*cs++ != '\0') {
-    len++;
+  p = cs;
+  while (((unsigned int) p & 3) != 0) {
+    if (*p == '\0') {
+      return p - cs;
+    }
+    p++;
   }
-  return len;
+  /* an aligned word never extends past the end of memory */
+  w = (unsigned int *) p;
+  while (!HASZERO(*w)) {
+    w++;
+  }
+  p = (const char *) w;
+  while (*p != '\0') {
+    p++;
+  }
+  return p - cs;
 }
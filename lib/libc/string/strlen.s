@@ -0,0 +1,44 @@
+;
+; strlen.s -- string length
+;
+
+	.export	strlen
+
+	.code
+	.align	4
+
+;
+; size_t strlen(const char *cs)
+; cs in $4. After the first aligned address, whole words
+; are tested for a zero byte: (w - 0x01010101) & ~w &
+; 0x80808080 is non-zero iff one of the bytes of w is zero.
+;
+strlen:
+	add	$2,$4,$0		; p = cs
+len1:
+	and	$8,$2,3			; align p
+	beq	$8,$0,len2
+	ldbu	$9,$2,0
+	beq	$9,$0,len5
+	add	$2,$2,1
+	j	len1
+len2:
+	add	$10,$0,0x01010101
+	add	$11,$0,0x80808080
+	sub	$2,$2,4
+len3:
+	add	$2,$2,4
+	ldw	$9,$2,0
+	sub	$12,$9,$10
+	xnor	$13,$9,$0		; ~w
+	and	$12,$12,$13
+	and	$12,$12,$11
+	beq	$12,$0,len3
+len4:
+	ldbu	$9,$2,0			; find the zero byte
+	beq	$9,$0,len5
+	add	$2,$2,1
+	j	len4
+len5:
+	sub	$2,$2,$4
+	jr	$31
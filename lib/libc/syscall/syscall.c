@@ -6,7 +6,36 @@
 #include "sys/syscall.h"
 
 
+#define STACK_GAP	0x10000	/* bytes kept free below the stack */
+
+
+extern char _ebss[];
+
+
+static char *curBrk;		/* the current break */
+
+
+/*
+ * Move the break by n bytes, n being rounded up to a multiple
+ * of 8, and return the old break. Without an operating system
+ * underneath, the heap starts right after the bss segment and
+ * may grow up to STACK_GAP bytes below the stack pointer.
+ */
 void *sbrk(int n) {
-  /* !!!!! */
-  return 0;
+  char here;
+  char *old;
+
+  if (curBrk == 0) {
+    curBrk = (char *) (((unsigned int) _ebss + 7) & ~7U);
+  }
+  n = (n + 7) & ~7;
+  old = curBrk;
+  if (n > 0 && n > &here - STACK_GAP - curBrk) {
+    return (void *) (unsigned int) -1;
+  }
+  if (n < 0 && -n > curBrk - _ebss) {
+    return (void *) (unsigned int) -1;
+  }
+  curBrk += n;
+  return old;
 }
@@ -4,9 +4,51 @@
 
 
 #include "math.h"
+#include "libm.h"
+
+
+/*
+ * Method, with the polynomial from asin.c:
+ *   |x| < 1/2:   acos(x) = pi/2 - (x + x * p(x^2))
+ *   x >= 1/2:    acos(x) = 2 * asin(s), s = sqrt((1 - x) / 2)
+ *   x <= -1/2:   acos(x) = pi - 2 * asin(s), s = sqrt((1 + x) / 2)
+ */
+
+
+#define PIO2HI		1.5707963267948966
+#define PIO2LO		6.123233995736766e-17
+#define PIHI		3.141592653589793
+#define PILO		1.2246467991473532e-16
 
 
 double acos(double x) {
-  /* !!!!! */
-  return 0.0;
+  _FP_DUnion X, S;
+  double a, w, s, c, z;
+
+  X.d = x;
+  if (ISNAN(X)) {
+    /* NaN */
+    return x + x;
+  }
+  HI(X) &= 0x7FFFFFFF;
+  a = X.d;
+  if (a > 1.0) {
+    return _domain();
+  }
+  if (a < 0.5) {
+    return PIO2HI - (x - (PIO2LO - x * _asinp(x * x)));
+  }
+  if (a == 1.0) {
+    return x > 0.0 ? 0.0 : PIHI + PILO;
+  }
+  w = (1.0 - a) * 0.5;
+  s = sqrt(w);
+  S.d = s;
+  LO(S) = 0;
+  c = (w - S.d * S.d) / (s + S.d);
+  z = c + s * _asinp(w);
+  if (x > 0.0) {
+    return 2.0 * (S.d + z);
+  }
+  return (PIHI - 2.0 * S.d) - (2.0 * z - PILO);
 }
@@ -4,9 +4,68 @@
 
 
 #include "math.h"
+#include "libm.h"
+
+
+/*
+ * Method:
+ *   |x| < 1/2:   asin(x) = x + x * p(x^2)
+ *   |x| >= 1/2:  asin(x) = pi/2 - 2 * asin(s), s = sqrt((1 - |x|) / 2)
+ * p is a polynomial of degree 13 (interpolating at Chebyshev
+ * points on [0, 1/4]). In the second case, s is split into
+ * a high part with 21 bits and a correction, so that pi/2
+ * minus twice the high part is exact.
+ */
+
+
+#define PIO2HI		1.5707963267948966
+#define PIO2LO		6.123233995736766e-17
+
+
+/*
+ * (asin(x) - x) / x, t = x^2 <= 1/4
+ */
+double _asinp(double t) {
+  return t * (0.16666666666666669 + t * (0.07499999999998433 +
+         t * (0.04464285714635543 + t * (0.030381944138531247 +
+         t * (0.02237217294214989 + t * (0.017352392720869973 +
+         t * (0.013971212973552933 + t * (0.011479177415184906 +
+         t * (0.01032281435018578 + t * (0.005457506718640358 +
+         t * (0.01740087944269402 + t * (-0.014851887071247204 +
+         t * 0.028757851367421566))))))))))));
+}
 
 
 double asin(double x) {
-  /* !!!!! */
-  return 0.0;
+  _FP_DUnion X, S;
+  double a, w, s, c, z;
+
+  X.d = x;
+  if (ISNAN(X)) {
+    /* NaN */
+    return x + x;
+  }
+  if (EXPBITS(X) < 1023 - 27) {
+    /* |x| < 2^-27, asin(x) = x */
+    return x;
+  }
+  HI(X) &= 0x7FFFFFFF;
+  a = X.d;
+  if (a > 1.0) {
+    return _domain();
+  }
+  if (a < 0.5) {
+    return x + x * _asinp(x * x);
+  }
+  if (a == 1.0) {
+    z = PIO2HI + PIO2LO;
+  } else {
+    w = (1.0 - a) * 0.5;
+    s = sqrt(w);
+    S.d = s;
+    LO(S) = 0;
+    c = (w - S.d * S.d) / (s + S.d);
+    z = (PIO2HI - 2.0 * S.d) - (2.0 * (c + s * _asinp(w)) - PIO2LO);
+  }
+  return x < 0.0 ? -z : z;
 }
@@ -4,9 +4,140 @@
 
 
 #include "math.h"
+#include "libm.h"
+
+
+/*
+ * Method (table-driven):
+ *   |x| <= 1:  c = j/16 nearest to x,
+ *              atan(x) = atan(c) + atan((x - c) / (1 + x * c))
+ *   |x| > 1:   c = j/16 nearest to 1/x,
+ *              atan(x) = atan(1/c) - atan((1 - c * x) / (x + c))
+ * atan(j/16) and atan(16/j) are tabulated as hi + lo (544
+ * bytes), and the remaining argument u is at most 1/32,
+ * where a short odd polynomial is enough. For x < 3/32, the
+ * polynomial is used directly.
+ */
+
+
+#define PIO2HI		1.5707963267948966
+#define PIO2LO		6.123233995736766e-17
+
+
+static double tab1[34] = {
+  /* atan(j/16): hi, lo */
+  0.0, 0.0,
+  0.06241880999595735, -1.5490756308295046e-18,
+  0.12435499454676144, -3.1253241424539383e-18,
+  0.18534794999569476, 4.180692268843079e-18,
+  0.24497866312686414, 1.0698755618734451e-17,
+  0.3028848683749714, -1.1010827903001369e-17,
+  0.35877067027057225, -2.4623815582638635e-17,
+  0.4124104415973873, -1.587652227770689e-17,
+  0.4636476090008061, 2.2698777452961687e-17,
+  0.5123894603107377, -2.5462781472855804e-17,
+  0.5585993153435624, -5.4556305485916264e-18,
+  0.6022873461349642, 2.950430737228402e-17,
+  0.6435011087932844, 1.5834785051444286e-17,
+  0.6823165548747481, 6.943223671560008e-18,
+  0.7188299996216245, -2.1478388444456983e-17,
+  0.7531512809621944, -2.4256934659182068e-17,
+  0.7853981633974483, 3.061616997868383e-17
+};
+
+static double tab2[34] = {
+  /* atan(16/j): hi, lo */
+  1.5707963267948966, 6.123233995736766e-17,
+  1.5083775167989393, -6.6075234508751206e-18,
+  1.446441332248135, 9.211323971545052e-17,
+  1.3854483767992019, 1.540496457266753e-18,
+  1.3258176636680326, -8.824429373951136e-17,
+  1.2679114584199251, 7.224316786036903e-17,
+  1.2120256565243244, 3.034500430874847e-17,
+  1.1583858851975093, 2.1597711003816724e-17,
+  1.1071487177940904, 9.40447137356638e-17,
+  1.0584068664841588, 8.669512143022346e-17,
+  1.0121970114513341, 6.668797050595929e-17,
+  0.9685089806599324, 3.172803258508363e-17,
+  0.9272952180016122, 4.5397554905923374e-17,
+  0.8884797719201485, 5.428911628580765e-17,
+  0.8519663271732721, -2.831157406069101e-17,
+  0.8176450458327023, -2.553302784596593e-17,
+  0.7853981633974483, 3.061616997868383e-17
+};
+
+
+/*
+ * atan(u) - u, |u| < 3/32
+ */
+static double poly(double u) {
+  double z;
+
+  z = u * u;
+  return u * z * (-1.0 / 3 + z * (1.0 / 5 + z * (-1.0 / 7 +
+         z * (1.0 / 9 + z * (-1.0 / 11 + z * (1.0 / 13 +
+         z * (-1.0 / 15 + z * (1.0 / 17))))))));
+}
+
+
+/*
+ * atan(x), x >= 0 and finite
+ */
+double _atan(double x) {
+  _FP_DUnion X;
+  double c, u, xh, d, e, hi;
+  int j;
+
+  X.d = x;
+  LO(X) = 0;
+  xh = X.d;
+  if (x <= 1.0) {
+    j = (int) (x * 16.0 + 0.5);
+    if (j <= 1) {
+      /* the table would not help here */
+      return x + poly(x);
+    }
+    c = j * (1.0 / 16);
+    /* 1 + x * c = d + e, both parts exact */
+    d = 1.0 + xh * c;
+    e = (x - xh) * c;
+    u = (x - c) / d;
+    u -= u * (e / (d + e));
+    /* u can be half as large as atan(c), so add it exactly */
+    hi = tab1[2 * j] + u;
+    return hi + (((tab1[2 * j] - hi) + u) + (tab1[2 * j + 1] + poly(u)));
+  }
+  if (x >= 32.0) {
+    u = 1.0 / x;
+    return PIO2HI + (PIO2LO - (u + poly(u)));
+  }
+  j = (int) (16.0 / x + 0.5);
+  c = j * (1.0 / 16);
+  /* 1 - c * x, with c * xh exact */
+  u = ((1.0 - c * xh) - c * (x - xh)) / (x + c);
+  return tab2[2 * j] + (tab2[2 * j + 1] - (u + poly(u)));
+}
 
 
 double atan(double x) {
-  /* !!!!! */
-  return 0.0;
+  _FP_DUnion X;
+  double z;
+
+  X.d = x;
+  if (ISNAN(X)) {
+    /* NaN */
+    return x + x;
+  }
+  if (EXPBITS(X) < 1023 - 27) {
+    /* |x| < 2^-27, atan(x) = x */
+    return x;
+  }
+  HI(X) &= 0x7FFFFFFF;
+  if (EXPBITS(X) > 1023 + 60) {
+    /* also covers infinity */
+    z = PIO2HI + PIO2LO;
+  } else {
+    z = _atan(X.d);
+  }
+  return x < 0.0 ? -z : z;
 }
@@ -1,12 +1,70 @@
 /*
- * atan2.c -- arctangent
+ * atan2.c -- arctangent of y/x
  */
 
 
 #include "math.h"
+#include "libm.h"
+
+
+#define PIO2HI		1.5707963267948966
+#define PIO2LO		6.123233995736766e-17
+#define PIHI		3.141592653589793
+#define PILO		1.2246467991473532e-16
+#define PIO4		0.7853981633974483
+#define PI3O4		2.356194490192345
 
 
 double atan2(double y, double x) {
-  /* !!!!! */
-  return 0.0;
+  _FP_DUnion X, Y;
+  double z, q, qh, ql, xh, xl, r;
+  int sx, sy, d;
+
+  X.d = x;
+  Y.d = y;
+  sx = (HI(X) & 0x80000000) != 0;
+  sy = (HI(Y) & 0x80000000) != 0;
+  if (ISNAN(X) || ISNAN(Y)) {
+    return x + y;
+  }
+  if (ISZERO(Y)) {
+    if (sx) {
+      z = PIHI + PILO;
+    } else {
+      return y;
+    }
+  } else
+  if (ISZERO(X) || (EXPBITS(Y) == 0x7FF && EXPBITS(X) != 0x7FF)) {
+    z = PIO2HI + PIO2LO;
+  } else
+  if (EXPBITS(X) == 0x7FF) {
+    if (EXPBITS(Y) == 0x7FF) {
+      z = sx ? PI3O4 : PIO4;
+    } else {
+      z = sx ? PIHI + PILO : 0.0;
+    }
+  } else {
+    /* both finite and non-zero */
+    d = EXPBITS(Y) - EXPBITS(X);
+    HI(X) &= 0x7FFFFFFF;
+    HI(Y) &= 0x7FFFFFFF;
+    if (d > 60) {
+      z = PIO2HI + PIO2LO;
+    } else
+    if (d < -60) {
+      /* atan(q) = q, and q may be subnormal */
+      z = Y.d / X.d;
+    } else {
+      /* q + r = |y / x|, with r from the exact remainder */
+      q = Y.d / X.d;
+      qh = _split(q, &ql);
+      xh = _split(X.d, &xl);
+      r = ((((Y.d - qh * xh) - qh * xl) - ql * xh) - ql * xl) / X.d;
+      z = _atan(q) + r / (1.0 + q * q);
+    }
+    if (sx) {
+      z = PIHI - (z - PILO);
+    }
+  }
+  return sy ? -z : z;
 }
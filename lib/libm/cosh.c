@@ -4,9 +4,66 @@
 
 
 #include "math.h"
+#include "libm.h"
+
+
+/*
+ * Method:
+ *   |x| < ln2/2:     cosh(x) = 1 + t^2 / (2 * (t + 1)),
+ *                    t = exp(|x|) - 1
+ *   |x| < 22:        cosh(x) = (exp(|x|) + 1 / exp(|x|)) / 2,
+ *                    exp(|x|) = t + 1 with extra bits
+ *   |x| < ln(max):   cosh(x) = exp(|x|) / 2
+ *   otherwise        cosh(x) = (exp(|x|/2) / 2) * exp(|x|/2)
+ */
+
+
+#define HALFLN2		0.34657359027997264
+#define LNMAX		709.782712893384
+#define OVFL		710.4758600739439
 
 
 double cosh(double x) {
-  /* !!!!! */
-  return 0.0;
+  _FP_DUnion X;
+  double a, t, lo, s, sl, w;
+
+  X.d = x;
+  if (ISNAN(X)) {
+    /* NaN */
+    return x + x;
+  }
+  HI(X) &= 0x7FFFFFFF;
+  a = X.d;
+  if (EXPBITS(X) == 0x7FF) {
+    return a;
+  }
+  if (a < HALFLN2) {
+    if (EXPBITS(X) < 1023 - 55) {
+      /* cosh(x) = 1 */
+      return 1.0;
+    }
+    t = _expm1(a, &lo);
+    t += lo;
+    w = t + 1.0;
+    return 1.0 + (t * t) / (w + w);
+  }
+  if (a < 22.0) {
+    t = _expm1(a, &lo);
+    /* s + sl = t + 1 */
+    s = t + 1.0;
+    if (t < 1.0) {
+      sl = (1.0 - s) + t;
+    } else {
+      sl = (t - s) + 1.0;
+    }
+    return 0.5 * s + (0.5 * (sl + lo) + 0.5 / s);
+  }
+  if (a < LNMAX) {
+    return 0.5 * exp(a);
+  }
+  if (a <= OVFL) {
+    w = exp(0.5 * a);
+    return (0.5 * w) * w;
+  }
+  return _overflow(0);
 }
@@ -0,0 +1,38 @@
+/*
+ * error.c -- results of domain and range errors
+ */
+
+
+#include "math.h"
+#include "errno.h"
+#include "libm.h"
+
+
+double _domain(void) {
+  _FP_DUnion X;
+
+  errno = EDOM;
+  HI(X) = 0x7FF80000;
+  LO(X) = 0;
+  return X.d;
+}
+
+
+double _overflow(int neg) {
+  _FP_DUnion X;
+
+  errno = ERANGE;
+  HI(X) = neg ? 0xFFF00000 : 0x7FF00000;
+  LO(X) = 0;
+  return X.d;
+}
+
+
+double _underflow(int neg) {
+  _FP_DUnion X;
+
+  errno = ERANGE;
+  HI(X) = neg ? 0x80000000 : 0;
+  LO(X) = 0;
+  return X.d;
+}
@@ -1,12 +1,183 @@
 /*
- * exp.c -- natural exponential function
+ * exp.c -- exponential function
  */
 
 
 #include "math.h"
+#include "libm.h"
+
+
+/*
+ * Method (table-driven, after Tang):
+ *   x = (32 * m + j) * ln2/32 + r, |r| <= ln2/64
+ *   exp(x) = 2^m * 2^(j/32) * exp(r)
+ * 2^(j/32) is tabulated as hi + lo (512 bytes), exp(r) - 1
+ * is a polynomial of degree 6. ln2/32 is split into two
+ * parts, the first of which can be multiplied exactly.
+ */
+
+
+#define INVL32		46.16624130844683
+#define L1		(0.6931471803691238 / 32)
+#define L2		(1.9082149292705877e-10 / 32)
+
+#define OVFL		709.782712893383973096
+#define UNFL		-745.13321910194110842
+
+#define TWOM1000	9.332636185032189e-302
+
+
+static double tab[64] = {
+  /* 2^(j/32): hi, lo */
+  1.0, 0.0,
+  1.0218971486541166, 5.109225028973444e-17,
+  1.0442737824274138, 8.551889705537965e-17,
+  1.0671404006768237, -7.899853966841582e-17,
+  1.0905077326652577, -3.046782079812471e-17,
+  1.1143867425958924, 1.0410278456845571e-16,
+  1.1387886347566916, 8.912812676025408e-17,
+  1.1637248587775775, 3.8292048369240935e-17,
+  1.189207115002721, 3.982015231465646e-17,
+  1.215247359980469, -7.712630692681488e-17,
+  1.241857812073484, 4.658027591836937e-17,
+  1.2690509571917332, 2.667932131342186e-18,
+  1.2968395546510096, 2.5382502794888315e-17,
+  1.3252366431597413, -2.8587312100388614e-17,
+  1.3542555469368927, 7.70094837980299e-17,
+  1.383909881963832, -6.770511658794786e-17,
+  1.4142135623730951, -9.667293313452913e-17,
+  1.4451808069770467, -3.0237581349939873e-17,
+  1.4768261459394993, -3.483994556892796e-17,
+  1.5091644275934228, -1.016455327754295e-16,
+  1.5422108254079407, 7.949834809697621e-17,
+  1.5759808451078865, -1.0136916471278304e-17,
+  1.6104903319492543, 2.4707192569797888e-17,
+  1.645755478153965, -1.0125679913674773e-16,
+  1.681792830507429, 8.199010020581497e-17,
+  1.718619298122478, -1.851380418263111e-17,
+  1.7562521603732995, 2.960140695448873e-17,
+  1.7947090750031072, 1.8227458427912087e-17,
+  1.8340080864093424, 3.283107224245627e-17,
+  1.8741676341103, -6.122763413004143e-17,
+  1.9152065613971474, -1.0619946056195963e-16,
+  1.9571441241754002, 8.960767791036668e-17
+};
+
+
+/*
+ * exp(r) - 1, |r| <= ln2/64
+ */
+static double poly(double r) {
+  return r + r * r * (0.5 + r * (1.0 / 6 + r * (1.0 / 24 +
+         r * (1.0 / 120 + r * (1.0 / 720)))));
+}
+
+
+/*
+ * y * 2^m, where y is normal and not too far from 1
+ */
+static double scale(double y, int m) {
+  _FP_DUnion Y;
+
+  Y.d = y;
+  if (m > -1022 && m < 1023) {
+    HI(Y) += (unsigned) m << 20;
+    return Y.d;
+  }
+  if (m > 0) {
+    /* may overflow */
+    HI(Y) += (unsigned) (m - 1) << 20;
+    return Y.d * 2.0;
+  }
+  /* may be subnormal */
+  HI(Y) += (unsigned) (m + 1000) << 20;
+  return Y.d * TWOM1000;
+}
+
+
+/*
+ * exp(hi + lo), with hi + lo in the range of exp
+ */
+double _exp(double hi, double lo) {
+  double r, t;
+  int n, j;
+
+  n = (int) (hi * INVL32 + (hi < 0 ? -0.5 : 0.5));
+  r = (hi - n * L1) + (lo - n * L2);
+  j = n & 31;
+  t = tab[2 * j];
+  return scale(t + (tab[2 * j + 1] + t * poly(r)), (n - j) / 32);
+}
+
+
+/*
+ * exp(x) - 1 = result + *lo, for |x| < 50
+ * Near 0, the table would lose accuracy by cancellation,
+ * and the Taylor polynomial is used instead. Otherwise,
+ * with exp(x) = 2^m * (t + c), the result is 2^m * (t - 2^-m),
+ * which is exact for m >= -1, or 2^m * t - 1.
+ */
+double _expm1(double x, double *lo) {
+  _FP_DUnion P, U;
+  double r, t, c, hi;
+  int n, j, m;
+
+  if (x > -0.125 && x < 0.125) {
+    *lo = x * x * (0.5 + x * (1.0 / 6 + x * (1.0 / 24 +
+          x * (1.0 / 120 + x * (1.0 / 720 + x * (1.0 / 5040 +
+          x * (1.0 / 40320 + x * (1.0 / 362880 +
+          x * (1.0 / 3628800 + x * (1.0 / 39916800))))))))));
+    return x;
+  }
+  n = (int) (x * INVL32 + (x < 0 ? -0.5 : 0.5));
+  r = (x - n * L1) - n * L2;
+  j = n & 31;
+  m = (n - j) / 32;
+  t = tab[2 * j];
+  c = tab[2 * j + 1] + t * poly(r);
+  /* p = 2^m, u = 2^-m */
+  HI(P) = (unsigned) (1023 + m) << 20;
+  LO(P) = 0;
+  if (m >= -1) {
+    /* t - u is exact */
+    HI(U) = (unsigned) (1023 - m) << 20;
+    LO(U) = 0;
+    t -= U.d;
+    hi = t + c;
+    *lo = (c - (hi - t)) * P.d;
+    return hi * P.d;
+  }
+  t *= P.d;
+  c *= P.d;
+  hi = t - 1.0;
+  c += t - (hi + 1.0);
+  t = hi;
+  hi = t + c;
+  *lo = c - (hi - t);
+  return hi;
+}
 
 
 double exp(double x) {
-  /* !!!!! */
-  return 0.0;
+  _FP_DUnion X;
+
+  X.d = x;
+  if (EXPBITS(X) == 0x7FF) {
+    if ((HI(X) & 0x000FFFFF) != 0 || LO(X) != 0) {
+      /* NaN */
+      return x + x;
+    }
+    /* exp(-inf) = 0, exp(+inf) = inf */
+    return (HI(X) & 0x80000000) ? 0.0 : x;
+  }
+  if (x > OVFL) {
+    return _overflow(0);
+  }
+  if (x < UNFL) {
+    return _underflow(0);
+  }
+  if (EXPBITS(X) < 1023 - 54) {
+    return 1.0 + x;
+  }
+  return _exp(x, 0.0);
 }
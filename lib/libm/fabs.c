@@ -8,9 +8,9 @@
 
 
 double fabs(double x) {
-  _FP_Union X;
+  _FP_DUnion X;
 
-  X.f = x;
-  X.w &= ~0x80000000;
-  return X.f;
+  X.d = x;
+  X.w[_FP_HI] &= ~0x80000000;
+  return X.d;
 }
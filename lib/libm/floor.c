@@ -4,9 +4,55 @@
 
 
 #include "math.h"
+#include "libm.h"
 
 
 double floor(double x) {
-  /* !!!!! */
-  return 0.0;
+  _FP_DUnion X;
+  _FP_Word m, lo;
+  int e;
+
+  X.d = x;
+  e = EXPBITS(X) - 1023;
+  if (e < 0) {
+    /* |x| < 1 */
+    if ((HI(X) & 0x7FFFFFFF) == 0 && LO(X) == 0) {
+      return x;
+    }
+    return (HI(X) & 0x80000000) ? -1.0 : 0.0;
+  }
+  if (e >= 52) {
+    /* integral, infinite, or NaN */
+    return x;
+  }
+  if (e < 20) {
+    m = 0x000FFFFF >> e;
+    if ((HI(X) & m) == 0 && LO(X) == 0) {
+      return x;
+    }
+    if (HI(X) & 0x80000000) {
+      /* round away from zero: add 1 to the integral part */
+      HI(X) += 0x00100000 >> e;
+    }
+    HI(X) &= ~m;
+    LO(X) = 0;
+  } else {
+    m = 0xFFFFFFFF >> (e - 20);
+    if ((LO(X) & m) == 0) {
+      return x;
+    }
+    if (HI(X) & 0x80000000) {
+      if (e == 20) {
+        HI(X) += 1;
+      } else {
+        lo = LO(X) + ((_FP_Word) 1 << (52 - e));
+        if (lo < LO(X)) {
+          HI(X) += 1;
+        }
+        LO(X) = lo;
+      }
+    }
+    LO(X) &= ~m;
+  }
+  return X.d;
 }
@@ -4,9 +4,47 @@
 
 
 #include "math.h"
+#include "libm.h"
+
+
+/*
+ * Method: subtract y, scaled by a power of 2, from x as long
+ * as |x| >= |y|. Each subtraction is exact, and so is the
+ * remainder.
+ */
 
 
 double fmod(double x, double y) {
-  /* !!!!! */
-  return 0.0;
+  _FP_DUnion X, Y;
+  double r, b, t;
+  int er, eb;
+
+  X.d = x;
+  Y.d = y;
+  if (ISNAN(X) || ISNAN(Y)) {
+    /* NaN */
+    return x + y;
+  }
+  if (EXPBITS(X) == 0x7FF ||
+      ((HI(Y) & 0x7FFFFFFF) == 0 && LO(Y) == 0)) {
+    /* x infinite or y zero */
+    return _domain();
+  }
+  HI(X) &= 0x7FFFFFFF;
+  HI(Y) &= 0x7FFFFFFF;
+  r = X.d;
+  b = Y.d;
+  if (r < b) {
+    return x;
+  }
+  frexp(b, &eb);
+  while (r >= b) {
+    frexp(r, &er);
+    t = ldexp(b, er - eb);
+    if (t > r) {
+      t = ldexp(b, er - eb - 1);
+    }
+    r -= t;
+  }
+  return x < 0.0 ? -r : r;
 }
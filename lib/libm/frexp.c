@@ -4,9 +4,30 @@
 
 
 #include "math.h"
+#include "libm.h"
+
+
+#define TWO54		18014398509481984.0
 
 
 double frexp(double x, int *exp) {
-  /* !!!!! */
-  return 0.0;
+  _FP_DUnion X;
+  int k;
+
+  X.d = x;
+  *exp = 0;
+  if (EXPBITS(X) == 0x7FF ||
+      ((HI(X) & 0x7FFFFFFF) == 0 && LO(X) == 0)) {
+    /* zero, infinite, or NaN */
+    return x;
+  }
+  k = 0;
+  if (EXPBITS(X) == 0) {
+    /* subnormal */
+    X.d *= TWO54;
+    k = -54;
+  }
+  *exp = EXPBITS(X) - 1022 + k;
+  HI(X) = (HI(X) & 0x800FFFFF) | (1022 << 20);
+  return X.d;
 }
@@ -0,0 +1,21 @@
+;
+; fsqrt.s -- square root by the FPU
+;
+
+	.export	_fsqrt
+
+	.code
+	.align	4
+
+;
+; double _fsqrt(double x)
+; x arrives in $4/$5, the result is returned in $f0/$f1.
+; The command word for 'sqrt.d $f0,$f2' is stored at the
+; command address of sqrt plus 128 (double precision).
+;
+_fsqrt:
+	stw	$4,$0,-256+4*2		; $f2/$f3 = x
+	stw	$5,$0,-256+4*3
+	add	$8,$0,0*1024+2*32	; dst = 0, src1 = 2
+	stw	$8,$0,-3952		; sqrt.d
+	jr	$31
@@ -4,9 +4,42 @@
 
 
 #include "math.h"
+#include "libm.h"
+
+
+#define TWO54		18014398509481984.0
+#define TWOM54		5.551115123125783e-17
 
 
 double ldexp(double x, int n) {
-  /* !!!!! */
-  return 0.0;
+  _FP_DUnion X;
+  int k, neg;
+
+  X.d = x;
+  if (EXPBITS(X) == 0x7FF ||
+      ((HI(X) & 0x7FFFFFFF) == 0 && LO(X) == 0)) {
+    /* zero, infinite, or NaN */
+    return x;
+  }
+  neg = (HI(X) & 0x80000000) != 0;
+  k = EXPBITS(X);
+  if (k == 0) {
+    /* subnormal */
+    X.d *= TWO54;
+    k = EXPBITS(X) - 54;
+  }
+  if (n > 5000 || k + n > 2046) {
+    return _overflow(neg);
+  }
+  if (n < -5000 || k + n <= -54) {
+    return _underflow(neg);
+  }
+  k += n;
+  if (k > 0) {
+    HI(X) = (HI(X) & 0x800FFFFF) | (k << 20);
+    return X.d;
+  }
+  /* subnormal result, let the multiplication round */
+  HI(X) = (HI(X) & 0x800FFFFF) | ((k + 54) << 20);
+  return X.d * TWOM54;
 }
@@ -0,0 +1,53 @@
+/*
+ * libm.h -- internal definitions of the math library
+ */
+
+
+#ifndef _LIBM_H_
+#define _LIBM_H_
+
+
+#include "sys/fp.h"
+
+
+#define HI(X)		((X).w[_FP_HI])
+#define LO(X)		((X).w[_FP_LO])
+
+#define EXPBITS(X)	((int) ((HI(X) >> 20) & 0x7FF))
+#define ISNAN(X)	(EXPBITS(X) == 0x7FF && \
+			 ((HI(X) & 0x000FFFFF) != 0 || LO(X) != 0))
+#define ISZERO(X)	((HI(X) & 0x7FFFFFFF) == 0 && LO(X) == 0)
+
+
+/* results of errors, with errno set */
+double _domain(void);
+double _overflow(int neg);
+double _underflow(int neg);
+
+/* x = result + *lo, the result with 26 significant bits */
+double _split(double x, double *lo);
+
+/* exp(hi + lo) without range checks */
+double _exp(double hi, double lo);
+
+/* exp(x) - 1 = result + *lo, for |x| < 50 */
+double _expm1(double x, double *lo);
+
+/* log(x) = hi + *lo, for positive finite x */
+double _log(double x, double *lo);
+
+/* x = n * pi/2 + y[0] + y[1], returns n (mod 8) */
+int _rempio2(double x, double *y);
+
+/* sin and cos of y + yy, |y| <= pi/4, as result + *lo */
+double _sin(double y, double yy, double *lo);
+double _cos(double y, double yy, double *lo);
+
+/* arctangent of x >= 0 */
+double _atan(double x);
+
+/* (asin(x) - x) / x, as a function of t = x * x <= 1/4 */
+double _asinp(double t);
+
+
+#endif /* _LIBM_H_ */
@@ -4,9 +4,169 @@
 
 
 #include "math.h"
+#include "libm.h"
+
+
+/*
+ * Method (table-driven, after Tang):
+ *   x = 2^k * m, 3/4 <= m < 3/2
+ *   F = m rounded to 1 + (2t + 1)/128 (or half of it), or 1
+ *   log(x) = k * ln2 + log(F) + log(1 + f/F), f = m - F
+ *   log(1 + f/F) = 2 * atanh(s), s = f / (2F + f), |s| < 1/128
+ * log(F) is tabulated as hi + lo (1 KB), where hi has only
+ * 40 fraction bits, so that k * ln2hi + hi is exact.
+ */
+
+
+#define LN2HI		0.6931471803691238
+#define LN2LO		1.9082149292705877e-10
+
+#define TWO54		18014398509481984.0
+
+
+static double tab[128] = {
+  /* log(F(t)): hi, lo */
+  0.0, 0.0,  /* 0 */
+  0.023167059281149704, 3.8467375384336376e-13,  /* 1 */
+  0.038318864301800204, 3.3639521846526506e-13,  /* 2 */
+  0.05324451451906498, -2.526953648744065e-13,  /* 3 */
+  0.0679506619080712, 4.365522908562953e-13,  /* 4 */
+  0.08244366921098845, 8.614512936087814e-14,  /* 5 */
+  0.09672962645890948, -3.5836667430094137e-13,  /* 6 */
+  0.11081436634049169, -2.0157368416016215e-13,  /* 7 */
+  0.1247034785010328, -7.556920687451337e-14,  /* 8 */
+  0.13840232285929233, -1.7319034406422305e-13,  /* 9 */
+  0.15191604202573217, 1.0980754099855238e-13,  /* 10 */
+  0.16524957289493614, 3.71026439894105e-13,  /* 11 */
+  0.17840765747314435, -3.2605717931058157e-13,  /* 12 */
+  0.1913948530000198, -3.903387893794952e-13,  /* 13 */
+  0.20421554142831155, 3.793381857669022e-13,  /* 14 */
+  0.21687393830052315, 9.120937249914984e-14,  /* 15 */
+  0.22937410106442258, 4.232547002345493e-13,  /* 16 */
+  0.24171993688742077, -2.756039648731729e-13,  /* 17 */
+  0.25391520998073247, 2.309738521758694e-13,  /* 18 */
+  0.265963548496984, 1.5393776174455408e-13,  /* 19 */
+  0.2778684510030871, 3.692037508208009e-13,  /* 20 */
+  0.28963329258294834, 9.43339818951269e-14,  /* 21 */
+  0.3012613305781997, -3.7923164802093147e-14,  /* 22 */
+  0.3127557100042395, -3.426293434828543e-13,  /* 23 */
+  0.32411946865431673, -1.0475750058776541e-13,  /* 24 */
+  0.33535554192076233, 3.7549577257259856e-13,  /* 25 */
+  0.3464667673461008, 1.077574303757264e-13,  /* 26 */
+  0.3574558889222317, -4.2790509060060775e-13,  /* 27 */
+  0.36832556115859916, 1.0849569622967912e-13,  /* 28 */
+  0.37907835293481185, 1.5761203773969435e-13,  /* 29 */
+  0.38971675114044046, -4.152515806343612e-13,  /* 30 */
+  0.40024316412745975, -4.4704265010452445e-13,  /* 31 */
+  -0.28248725557477883, 1.0190482133505088e-13,  /* 32 */
+  -0.2721778859158803, 6.465103064005256e-14,  /* 33 */
+  -0.2619737157419877, 4.1372084016947966e-13,  /* 34 */
+  -0.25187261975497677, -9.331234677945918e-14,  /* 35 */
+  -0.24187253642048745, 7.252318953240293e-16,  /* 36 */
+  -0.2319714654377094, -6.573097737831975e-14,  /* 37 */
+  -0.2221674653410446, -1.0970699320566433e-13,  /* 38 */
+  -0.212458651214547, 3.5358790892055944e-13,  /* 39 */
+  -0.20284319251459237, -1.5909705757137707e-13,  /* 40 */
+  -0.1933193110035063, 1.0320443688698849e-14,  /* 41 */
+  -0.18388527877050365, 3.662836153052554e-13,  /* 42 */
+  -0.17453941635176307, -1.366113598762341e-13,  /* 43 */
+  -0.16528009093872242, -3.805005598833016e-13,  /* 44 */
+  -0.1561057146627718, -2.898664247592974e-13,  /* 45 */
+  -0.14701474296180095, -8.710783796122478e-15,  /* 46 */
+  -0.1380056730195065, 6.278619479555556e-14,  /* 47 */
+  -0.12907704227473005, -4.1229613479684415e-13,  /* 48 */
+  -0.12022742699809896, -6.083738419972574e-14,  /* 49 */
+  -0.11145544092505588, -2.669449344412301e-13,  /* 50 */
+  -0.10275973395800975, 2.40812081672063e-13,  /* 51 */
+  -0.0941389909139616, 9.969653023079706e-14,  /* 52 */
+  -0.08559193033579504, 3.915272575495493e-13,  /* 53 */
+  -0.07711730334449385, 6.255850200176405e-14,  /* 54 */
+  -0.0687138925477484, -3.0340754496095936e-13,  /* 55 */
+  -0.06038051098857977, -3.2770792432999323e-13,  /* 56 */
+  -0.052116001139438595, 4.2457632982457716e-13,  /* 57 */
+  -0.0439192339345027, -3.327911139866607e-13,  /* 58 */
+  -0.03578910785199696, 4.11680377409586e-13,  /* 59 */
+  -0.027724548014703032, -1.518283721542648e-13,  /* 60 */
+  -0.019724505347767263, -1.1326399700142234e-14,  /* 61 */
+  -0.011787955751970003, -7.223757580209288e-14,  /* 62 */
+  0.0, 0.0   /* 63 */
+};
+
+
+/*
+ * log(x) = hi + *lo, for positive finite x
+ */
+double _log(double x, double *lo) {
+  _FP_DUnion X, M, F, S, D;
+  double f, d, dh, dl, s, sh, sl, z, p;
+  double a, b, hi, bb;
+  int k, t;
+
+  X.d = x;
+  k = 0;
+  if (EXPBITS(X) == 0) {
+    /* subnormal */
+    X.d *= TWO54;
+    k = -54;
+  }
+  k += EXPBITS(X) - 1023;
+  t = (HI(X) >> 14) & 63;
+  HI(M) = (HI(X) & 0x000FFFFF) | 0x3FF00000;
+  LO(M) = LO(X);
+  HI(F) = 0x3FF02000 | (t << 14);
+  LO(F) = 0;
+  if (t >= 32) {
+    HI(M) -= 0x00100000;
+    HI(F) -= 0x00100000;
+    k++;
+  }
+  if (t == 0 || t == 63) {
+    F.d = 1.0;
+  }
+  f = M.d - F.d;
+  d = M.d + F.d;
+  s = f / d;
+  /* s = sh + sl, where sh has only 21 significant bits */
+  S.d = s;
+  LO(S) = 0;
+  sh = S.d;
+  D.d = d;
+  LO(D) = 0;
+  dh = D.d;
+  dl = M.d - (dh - F.d);
+  sl = ((f - sh * dh) - sh * dl) / d;
+  z = s * s;
+  p = s * z * (2.0 / 3 + z * (2.0 / 5 + z * (2.0 / 7 +
+      z * (2.0 / 9 + z * (2.0 / 11)))));
+  /* hi + *lo = (a + b) + ... */
+  a = k * LN2HI + tab[2 * t];
+  b = 2.0 * sh;
+  hi = a + b;
+  bb = hi - a;
+  *lo = ((a - (hi - bb)) + (b - bb)) +
+        ((2.0 * sl + p) + (k * LN2LO + tab[2 * t + 1]));
+  return hi;
+}
 
 
 double log(double x) {
-  /* !!!!! */
-  return 0.0;
+  _FP_DUnion X;
+  double lo;
+
+  X.d = x;
+  if (ISNAN(X)) {
+    /* NaN */
+    return x + x;
+  }
+  if ((HI(X) & 0x7FFFFFFF) == 0 && LO(X) == 0) {
+    return _overflow(1);
+  }
+  if (HI(X) & 0x80000000) {
+    return _domain();
+  }
+  if (EXPBITS(X) == 0x7FF) {
+    return x;
+  }
+  x = _log(x, &lo);
+  return x + lo;
 }
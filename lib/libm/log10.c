@@ -4,9 +4,42 @@
 
 
 #include "math.h"
+#include "libm.h"
+
+
+/*
+ * log10(x) = log(x) / ln10, with log(x) = hi + lo taken
+ * from the kernel; 1/ln10 is split so that the product
+ * of the high parts is exact.
+ */
+
+
+#define IVLN10		0.4342944819032518
+#define IVLN10HI	0.4342944622039795
+#define IVLN10LO	1.9699272335463627e-08
 
 
 double log10(double x) {
-  /* !!!!! */
-  return 0.0;
+  _FP_DUnion X, H;
+  double hi, lo;
+
+  X.d = x;
+  if (ISNAN(X)) {
+    /* NaN */
+    return x + x;
+  }
+  if ((HI(X) & 0x7FFFFFFF) == 0 && LO(X) == 0) {
+    return _overflow(1);
+  }
+  if (HI(X) & 0x80000000) {
+    return _domain();
+  }
+  if (EXPBITS(X) == 0x7FF) {
+    return x;
+  }
+  hi = _log(x, &lo);
+  H.d = hi;
+  LO(H) = 0;
+  lo = (hi - H.d) + lo;
+  return H.d * IVLN10HI + (lo * IVLN10 + H.d * IVLN10LO);
 }
@@ -4,9 +4,48 @@
 
 
 #include "math.h"
+#include "libm.h"
 
 
 double modf(double x, double *ip) {
-  /* !!!!! */
-  return 0.0;
+  _FP_DUnion X;
+  _FP_Word m;
+  int e;
+
+  X.d = x;
+  e = EXPBITS(X) - 1023;
+  if (e < 0) {
+    /* |x| < 1, integral part is zero with the sign of x */
+    HI(X) &= 0x80000000;
+    LO(X) = 0;
+    *ip = X.d;
+    return x;
+  }
+  if (e < 20) {
+    m = 0x000FFFFF >> e;
+    if ((HI(X) & m) != 0 || LO(X) != 0) {
+      HI(X) &= ~m;
+      LO(X) = 0;
+      *ip = X.d;
+      return x - X.d;
+    }
+  } else
+  if (e < 52) {
+    m = 0xFFFFFFFF >> (e - 20);
+    if ((LO(X) & m) != 0) {
+      LO(X) &= ~m;
+      *ip = X.d;
+      return x - X.d;
+    }
+  } else
+  if (e == 1024 && ((HI(X) & 0x000FFFFF) != 0 || LO(X) != 0)) {
+    /* NaN */
+    *ip = x;
+    return x;
+  }
+  /* x is integral: fraction is zero with the sign of x */
+  *ip = x;
+  HI(X) &= 0x80000000;
+  LO(X) = 0;
+  return X.d;
 }
@@ -4,9 +4,115 @@
 
 
 #include "math.h"
+#include "errno.h"
+#include "libm.h"
+
+
+/*
+ * Method:
+ *   pow(x, y) = exp(y * log(|x|)), with a sign if x < 0
+ * log(|x|) = hi + lo comes from the logarithm kernel with
+ * extra precision, y * (hi + lo) = ph + pl is formed by
+ * splitting y and hi + lo into halves, and exp(ph + pl) is
+ * done by the exponential kernel.
+ */
+
+
+#define OVFL		709.782712893383973096
+#define UNFL		-745.13321910194110842
+
+
+/*
+ * classify y: 0 = not an integer, 1 = odd, 2 = even
+ */
+static int yclass(_FP_DUnion Y) {
+  int e;
+
+  e = EXPBITS(Y) - 1023;
+  if (e < 0) {
+    return 0;
+  }
+  if (e >= 52) {
+    return e == 52 ? 2 - (LO(Y) & 1) : 2;
+  }
+  if (e > 20) {
+    if (LO(Y) & (0xFFFFFFFF >> (e - 20))) {
+      return 0;
+    }
+    return 2 - ((LO(Y) >> (52 - e)) & 1);
+  }
+  if ((HI(Y) & (0x000FFFFF >> e)) != 0 || LO(Y) != 0) {
+    return 0;
+  }
+  return 2 - ((HI(Y) >> (20 - e)) & 1);
+}
 
 
 double pow(double x, double y) {
-  /* !!!!! */
-  return 0.0;
+  _FP_DUnion X, Y, Y1, T1;
+  double hi, lo, t2, ph, pl, z;
+  int cls, sign, neg;
+
+  X.d = x;
+  Y.d = y;
+  if (ISZERO(Y) || (HI(X) == 0x3FF00000 && LO(X) == 0)) {
+    /* pow(x, 0) = pow(1, y) = 1, even for NaN */
+    return 1.0;
+  }
+  if (ISNAN(X) || ISNAN(Y)) {
+    return x + y;
+  }
+  cls = yclass(Y);
+  sign = (HI(X) & 0x80000000) != 0;
+  neg = sign && cls == 1;
+  HI(X) &= 0x7FFFFFFF;
+  if (EXPBITS(Y) == 0x7FF) {
+    /* y = +-inf */
+    if (X.d == 1.0) {
+      return 1.0;
+    }
+    if ((X.d > 1.0) == ((HI(Y) & 0x80000000) == 0)) {
+      return y * y;
+    }
+    return 0.0;
+  }
+  if (ISZERO(X)) {
+    if (HI(Y) & 0x80000000) {
+      z = _overflow(neg);
+      errno = EDOM;
+      return z;
+    }
+    return neg ? -0.0 : 0.0;
+  }
+  if (EXPBITS(X) == 0x7FF) {
+    /* x = +-inf */
+    if (HI(Y) & 0x80000000) {
+      return neg ? -0.0 : 0.0;
+    }
+    return neg ? -X.d : X.d;
+  }
+  if (sign && cls == 0) {
+    return _domain();
+  }
+  if (X.d == 1.0) {
+    return neg ? -1.0 : 1.0;
+  }
+  hi = _log(X.d, &lo);
+  /* y * (hi + lo) = ph + pl */
+  Y1.d = y;
+  LO(Y1) = 0;
+  T1.d = hi + lo;
+  LO(T1) = 0;
+  t2 = lo - (T1.d - hi);
+  ph = Y1.d * T1.d;
+  pl = (y - Y1.d) * T1.d + y * t2;
+  z = ph + pl;
+  if (z > OVFL) {
+    return _overflow(neg);
+  }
+  if (z < UNFL) {
+    return _underflow(neg);
+  }
+  z = _exp(ph, pl);
+  return neg ? -z : z;
 }
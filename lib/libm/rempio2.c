@@ -0,0 +1,183 @@
+/*
+ * rempio2.c -- argument reduction for the trigonometric functions
+ */
+
+
+#include "math.h"
+#include "libm.h"
+
+
+/*
+ * x = n * pi/2 + y[0] + y[1], |y[0] + y[1]| <= pi/4
+ *
+ * Medium arguments use pi/2 split into pieces of 33 bits
+ * each, which can be multiplied by n exactly (Cody and Waite).
+ * Only when cancellation is detected, more pieces are taken.
+ * Huge arguments are multiplied by 2/pi, which is stored in
+ * chunks of 24 bits; only the chunks that contribute to the
+ * last three integer bits and the fraction are used (Payne
+ * and Hanek).
+ */
+
+
+#define PIO4		0.7853981633974483
+#define INVPIO2		0.6366197723675814
+#define MEDIUM		823549.6645826427	/* 2^19 * pi/2 */
+
+#define PIO2_1		1.5707963267341256	/* first 33 bits */
+#define PIO2_1T		6.077100506506192e-11	/* pi/2 - PIO2_1 */
+#define PIO2_2		6.077100506303966e-11	/* second 33 bits */
+#define PIO2_2T		2.0222662487959506e-21	/* pi/2 - (PIO2_1 + PIO2_2) */
+#define PIO2_3		2.0222662487111665e-21	/* third 33 bits */
+#define PIO2_3T		8.4784276603689e-32	/* pi/2 - (PIO2_1 + ... + PIO2_3) */
+
+#define PIO2HI		1.5707963267948966
+#define PIO2LO		6.123233995736766e-17
+
+#define TWO24		16777216.0
+#define TWOM24		5.9604644775390625e-08
+
+#define NCHUNKS		7
+
+
+/* 2/pi, 24 bits per entry */
+static int ipio2[60] = {
+  0xA2F983, 0x6E4E44, 0x1529FC, 0x2757D1, 0xF534DD, 0xC0DB62,
+  0x95993C, 0x439041, 0xFE5163, 0xABDEBB, 0xC561B7, 0x246E3A,
+  0x424DD2, 0xE00649, 0x2EEA09, 0xD1921C, 0xFE1DEB, 0x1CB129,
+  0xA73EE8, 0x8235F5, 0x2EBB44, 0x84E99C, 0x7026B4, 0x5F7E41,
+  0x3991D6, 0x398353, 0x39F49C, 0x845F8B, 0xBDF928, 0x3B1FF8,
+  0x97FFDE, 0x05980F, 0xEF2F11, 0x8B5A0A, 0x6D1F6D, 0x367ECF,
+  0x27CB09, 0xB74F46, 0x3F669E, 0x5FEA2D, 0x7527BA, 0xC7EBE5,
+  0xF17B3D, 0x0739F7, 0x8A5292, 0xEA6BFB, 0x5FB11F, 0x8D5D08,
+  0x560330, 0x46FC7B, 0x6BABF0, 0xCFBC20, 0x9AF436, 0x1DA9E3,
+  0x91615E, 0xE61B08, 0x659985, 0x5F14A0, 0x68408D, 0xFFD880
+};
+
+
+static double pow2(int e) {
+  _FP_DUnion P;
+
+  HI(P) = (unsigned) (e + 1023) << 20;
+  LO(P) = 0;
+  return P.d;
+}
+
+
+/*
+ * reduction of huge arguments, ax = |x| >= 2^19 * pi/2
+ */
+static int rembig(double ax, double *y) {
+  _FP_DUnion X;
+  double xi[3], f[NCHUNKS];
+  double w, t, hi, lo, s, ah, al, ch, cl, ph, pl;
+  int e, k0, e0, i, j, n;
+
+  X.d = ax;
+  e = EXPBITS(X) - 1023;
+  /* ax = (xi[0] + xi[1] * 2^-24 + xi[2] * 2^-48) * 2^(e - 23) */
+  HI(X) = (HI(X) & 0x000FFFFF) | ((1023 + 23) << 20);
+  xi[0] = (double) (int) X.d;
+  w = (X.d - xi[0]) * TWO24;
+  xi[1] = (double) (int) w;
+  xi[2] = (w - xi[1]) * TWO24;
+  /*
+   * ax * 2/pi = sum f[i] * 2^(e0 - 24 * i), where all terms
+   * left out are multiples of 8, and each f[i] is exact
+   */
+  k0 = e > 49 ? (e - 49 + 23) / 24 : 0;
+  e0 = e - 47 - 24 * k0;
+  for (i = 0; i < NCHUNKS; i++) {
+    s = 0.0;
+    for (j = 0; j < 3 && j <= k0 + i; j++) {
+      s += xi[j] * ipio2[k0 + i - j];
+    }
+    f[i] = s;
+  }
+  /* propagate carries, so that f[1..] are 24-bit chunks */
+  for (i = NCHUNKS - 1; i > 0; i--) {
+    t = (double) (int) (f[i] * TWOM24);
+    f[i] -= t * TWO24;
+    f[i - 1] += t;
+  }
+  /* integer part (mod 8) and fraction */
+  w = f[0] * pow2(e0);
+  w -= 8.0 * floor(w * 0.125);
+  n = (int) w;
+  hi = w - n;
+  w = f[1] * pow2(e0 - 24);
+  t = floor(w);
+  n += (int) t;
+  hi += w - t;
+  if (hi >= 0.5) {
+    n++;
+    hi -= 1.0;
+  }
+  s = 0.0;
+  for (i = NCHUNKS - 1; i > 1; i--) {
+    s += f[i] * pow2(e0 - 24 * i);
+  }
+  t = hi + s;
+  lo = s - (t - hi);
+  hi = t;
+  /* y = (hi + lo) * pi/2 */
+  ah = _split(hi, &al);
+  ch = _split(PIO2HI, &cl);
+  ph = hi * PIO2HI;
+  pl = (((ah * ch - ph) + ah * cl + al * ch) + al * cl) +
+       (hi * PIO2LO + lo * PIO2HI);
+  y[0] = ph + pl;
+  y[1] = pl - (y[0] - ph);
+  return n;
+}
+
+
+int _rempio2(double x, double *y) {
+  _FP_DUnion X, Y;
+  double ax, fn, r, w, t;
+  int n, e;
+
+  X.d = x;
+  HI(X) &= 0x7FFFFFFF;
+  ax = X.d;
+  if (ax <= PIO4) {
+    y[0] = x;
+    y[1] = 0.0;
+    return 0;
+  }
+  if (ax < MEDIUM) {
+    n = (int) (ax * INVPIO2 + 0.5);
+    fn = n;
+    r = ax - fn * PIO2_1;
+    w = fn * PIO2_1T;
+    y[0] = r - w;
+    e = EXPBITS(X);
+    Y.d = y[0];
+    if (e - EXPBITS(Y) > 16) {
+      /* cancellation, take 33 more bits of pi/2 */
+      t = r;
+      w = fn * PIO2_2;
+      r = t - w;
+      w = fn * PIO2_2T - ((t - r) - w);
+      y[0] = r - w;
+      Y.d = y[0];
+      if (e - EXPBITS(Y) > 49) {
+        /* even more cancellation */
+        t = r;
+        w = fn * PIO2_3;
+        r = t - w;
+        w = fn * PIO2_3T - ((t - r) - w);
+        y[0] = r - w;
+      }
+    }
+    y[1] = (r - y[0]) - w;
+  } else {
+    n = rembig(ax, y);
+  }
+  if (x < 0.0) {
+    y[0] = -y[0];
+    y[1] = -y[1];
+    n = -n;
+  }
+  return n;
+}
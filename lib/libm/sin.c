@@ -4,9 +4,33 @@
 
 
 #include "math.h"
+#include "libm.h"
 
 
 double sin(double x) {
-  /* !!!!! */
-  return 0.0;
+  _FP_DUnion X;
+  double y[2];
+  double z, lo;
+  int n;
+
+  X.d = x;
+  if (EXPBITS(X) == 0x7FF) {
+    if ((HI(X) & 0x000FFFFF) != 0 || LO(X) != 0) {
+      /* NaN */
+      return x + x;
+    }
+    return _domain();
+  }
+  if (EXPBITS(X) < 1023 - 27) {
+    /* |x| < 2^-27, sin(x) = x */
+    return x;
+  }
+  n = _rempio2(x, y);
+  if (n & 1) {
+    z = _cos(y[0], y[1], &lo);
+  } else {
+    z = _sin(y[0], y[1], &lo);
+  }
+  z += lo;
+  return (n & 2) ? -z : z;
 }
@@ -0,0 +1,115 @@
+/*
+ * sincos.c -- kernels of sine and cosine
+ */
+
+
+#include "math.h"
+#include "libm.h"
+
+
+/*
+ * Method (table-driven):
+ *   y = a + r, a = j/32, |r| <= 1/64
+ *   sin(y) = sin(a) + (sin(a) * (cos(r) - 1) + cos(a) * sin(r))
+ *   cos(y) = cos(a) + (cos(a) * (cos(r) - 1) - sin(a) * sin(r))
+ * sin(a) and cos(a) are tabulated as hi + lo (832 bytes),
+ * sin(r) - r and cos(r) - 1 are short polynomials. The tail
+ * yy of the reduced argument enters the corrections only.
+ */
+
+
+static double tab[104] = {
+  /* sin(j/32): hi, lo, cos(j/32): hi, lo */
+  0.0, 0.0, 1.0, 0.0,
+  0.03124491398532608, -1.562781562225433e-18, 0.9995117584851364, -3.418806487972947e-17,
+  0.0624593178423802, -2.040259504585711e-18, 0.9980475107000991, 3.3232291674141346e-17,
+  0.09361273123551289, 1.4628632005878733e-18, 0.9956086864580017, 3.312922430932991e-17,
+  0.12467473338522769, -2.925947496057858e-18, 0.992197667229329, 4.754870575189364e-17,
+  0.15561499277355603, 8.886053372342288e-18, 0.9878177838164719, 4.91917302237681e-17,
+  0.18640329676226988, 2.3493796901281573e-18, 0.9824733131012553, -3.919920375420088e-17,
+  0.21700958109501015, 1.1170071073364376e-17, 0.9761694738686353, -7.850690609285027e-18,
+  0.24740395925452294, -7.53102495590706e-18, 0.9689124217106447, 5.071436662403936e-17,
+  0.2775567516463363, 1.7674070262791822e-17, 0.9607092430155619, -2.807827063516729e-17,
+  0.30743851458038085, 1.1004366442765296e-19, 0.9515679480481722, -3.8614834675674123e-17,
+  0.33702006902225307, 1.0312279860787216e-17, 0.9414974631278811, -4.8523830236797095e-18,
+  0.36627252908604757, -9.938814562106524e-18, 0.9305076219123143, 4.488760003328074e-18,
+  0.39516733024093426, -1.9613487871414228e-17, 0.9186091557949183, -4.0564150104514996e-17,
+  0.42367625720393803, -2.331800700068871e-17, 0.9058136834259364, 4.2864666490805214e-17,
+  0.4517714714916838, -8.234073942098903e-18, 0.8921336993669944, 2.3160655211380166e-17,
+  0.479425538604203, -5.103969860556013e-18, 0.8775825618903728, -4.2623149864279997e-17,
+  0.5066114548142574, -3.269413423618168e-17, 0.8621744799348805, 4.4132427578105805e-18,
+  0.5333026735360201, 5.129318115032044e-17, 0.8459244992310679, 1.549506647350329e-17,
+  0.5594731312473669, 1.575565514488728e-17, 0.8288484876093257, 1.1163935406617444e-17,
+  0.5850972729404622, -5.4883972461161805e-17, 0.8109631195052179, -3.091333486122179e-17,
+  0.6101500770757914, -1.479826990758988e-17, 0.7922858596771786, -2.9049779312834576e-17,
+  0.6346070800152693, -3.4568582392624965e-17, 0.7728349461524715, 4.231014921891023e-17,
+  0.6584443999105676, -3.7736386700306717e-17, 0.7526293724180665, -1.2970993013150526e-17,
+  0.6816387600233341, 4.410467313197903e-17, 0.7316888688738209, -1.0475824306512768e-17,
+  0.7041675114545337, -3.94095700584825e-17, 0.7100338835660797, 1.505272211891291e-17
+};
+
+
+/*
+ * sin(y + yy) = result + *lo, |y| <= pi/4
+ * Small arguments, where the table would not help, are
+ * handled by the Taylor polynomial alone.
+ */
+double _sin(double y, double yy, double *lo) {
+  double r, z, sr, cr, s, c;
+  int j, neg;
+
+  neg = 0;
+  if (y < 0.0) {
+    y = -y;
+    yy = -yy;
+    neg = 1;
+  }
+  if (y < 7.5 / 32) {
+    z = y * y;
+    s = y;
+    *lo = yy + y * z * (-1.0 / 6 + z * (1.0 / 120 + z * (-1.0 / 5040 +
+          z * (1.0 / 362880 + z * (-1.0 / 39916800 +
+          z * (1.0 / 6227020800.0))))));
+  } else {
+    j = (int) (y * 32.0 + 0.5);
+    r = y - j * (1.0 / 32);
+    z = r * r;
+    sr = r * z * (-1.0 / 6 + z * (1.0 / 120 + z * (-1.0 / 5040)));
+    cr = z * (-0.5 + z * (1.0 / 24 + z * (-1.0 / 720)));
+    s = tab[4 * j];
+    c = tab[4 * j + 2];
+    *lo = (tab[4 * j + 1] + s * cr) + c * (r + (sr + yy));
+  }
+  if (neg) {
+    *lo = -*lo;
+    return -s;
+  }
+  return s;
+}
+
+
+/*
+ * cos(y + yy) = result + *lo, |y| <= pi/4
+ */
+double _cos(double y, double yy, double *lo) {
+  double r, z, sr, cr, s, c;
+  int j;
+
+  if (y < 0.0) {
+    y = -y;
+    yy = -yy;
+  }
+  j = (int) (y * 32.0 + 0.5);
+  r = y - j * (1.0 / 32);
+  z = r * r;
+  cr = z * (-0.5 + z * (1.0 / 24 + z * (-1.0 / 720)));
+  if (j == 0) {
+    *lo = cr - r * yy;
+    return 1.0;
+  }
+  sr = r * z * (-1.0 / 6 + z * (1.0 / 120 + z * (-1.0 / 5040)));
+  s = tab[4 * j];
+  c = tab[4 * j + 2];
+  *lo = (tab[4 * j + 3] + c * cr) - s * (r + (sr + yy));
+  return c;
+}
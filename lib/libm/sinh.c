@@ -4,9 +4,67 @@
 
 
 #include "math.h"
+#include "libm.h"
+
+
+/*
+ * Method:
+ *   |x| < 1/8:       sinh(x) = Taylor polynomial
+ *   |x| < 22:        sinh(x) = (t + t / (t + 1)) / 2,
+ *                    t = exp(|x|) - 1 with extra bits,
+ *                    quotient corrected as in tanh()
+ *   |x| < ln(max):   sinh(x) = exp(|x|) / 2
+ *   otherwise        sinh(x) = (exp(|x|/2) / 2) * exp(|x|/2)
+ */
+
+
+#define LNMAX		709.782712893384
+#define OVFL		710.4758600739439
 
 
 double sinh(double x) {
-  /* !!!!! */
-  return 0.0;
+  _FP_DUnion X;
+  double a, h, t, tl, d, dl, q, qh, ql, dh, dhl, z, w;
+  double s, sl;
+
+  X.d = x;
+  if (EXPBITS(X) == 0x7FF) {
+    /* NaN or +-inf */
+    return x + x;
+  }
+  if (EXPBITS(X) < 1023 - 28) {
+    /* |x| < 2^-28, sinh(x) = x */
+    return x;
+  }
+  h = (HI(X) & 0x80000000) ? -0.5 : 0.5;
+  HI(X) &= 0x7FFFFFFF;
+  a = X.d;
+  if (a < 0.125) {
+    z = x * x;
+    return x + x * z * (1.0 / 6 + z * (1.0 / 120 + z * (1.0 / 5040 +
+           z * (1.0 / 362880 + z * (1.0 / 39916800)))));
+  }
+  if (a < 22.0) {
+    t = _expm1(a, &tl);
+    /* d + dl = t + 1 */
+    d = t + 1.0;
+    dl = (1.0 - d) + t + tl;
+    q = t / d;
+    qh = _split(q, &ql);
+    dh = _split(d, &dhl);
+    z = (((t - qh * dh) - qh * dhl) - ql * dh) - ql * dhl;
+    q += ((z + tl) - q * dl) / d;
+    /* s + sl = t + q, scaled before the final rounding */
+    s = t + q;
+    sl = (t - s) + q;
+    return h * s + h * (sl + tl);
+  }
+  if (a < LNMAX) {
+    return h * exp(a);
+  }
+  if (a <= OVFL) {
+    w = exp(0.5 * a);
+    return (h * w) * w;
+  }
+  return _overflow(h < 0.0);
 }
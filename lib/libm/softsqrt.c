@@ -0,0 +1,23 @@
+/*
+ * softsqrt.c -- square root by the soft-float library
+ */
+
+
+#include "math.h"
+#include "libm.h"
+
+
+/* see lib/softfp/double.c */
+double __sqrtdf2(unsigned int xh, unsigned int xl);
+
+
+/*
+ * This replaces fsqrt.s in the soft-float variant of the
+ * library, which must run on machines without an FPU.
+ */
+double _fsqrt(double x) {
+  _FP_DUnion X;
+
+  X.d = x;
+  return __sqrtdf2(HI(X), LO(X));
+}
@@ -0,0 +1,21 @@
+/*
+ * split.c -- split a double into two halves
+ */
+
+
+#include "math.h"
+#include "libm.h"
+
+
+/*
+ * x = result + *lo, where the result has only 26 significant
+ * bits, so that the product of two such halves is exact
+ */
+double _split(double x, double *lo) {
+  _FP_DUnion X;
+
+  X.d = x;
+  LO(X) &= 0xF8000000;
+  *lo = x - X.d;
+  return X.d;
+}
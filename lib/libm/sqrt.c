@@ -4,9 +4,22 @@
 
 
 #include "math.h"
+#include "libm.h"
+
+
+/* the FPU's square root instruction, see fsqrt.s */
+double _fsqrt(double x);
 
 
 double sqrt(double x) {
-  /* !!!!! */
-  return 0.0;
+  _FP_DUnion X;
+
+  X.d = x;
+  if ((HI(X) & 0x80000000) != 0 &&
+      ((HI(X) & 0x7FFFFFFF) != 0 || LO(X) != 0) &&
+      !ISNAN(X)) {
+    /* negative, but not -0 or NaN */
+    return _domain();
+  }
+  return _fsqrt(x);
 }
@@ -4,9 +4,54 @@
 
 
 #include "math.h"
+#include "libm.h"
+
+
+/*
+ * Method:
+ *   tan(x) = sin(y) / cos(y)    (n even)
+ *   tan(x) = -cos(y) / sin(y)   (n odd)
+ * where x = n * pi/2 + y. Both kernels deliver extra bits,
+ * and the quotient q gets a correction from the remainder
+ * s - q * c, which is computed exactly by splitting q and c.
+ */
 
 
 double tan(double x) {
-  /* !!!!! */
-  return 0.0;
+  _FP_DUnion X;
+  double y[2];
+  double s, sl, c, cl, t, q, qh, ql, ch, chl;
+
+  X.d = x;
+  if (EXPBITS(X) == 0x7FF) {
+    if ((HI(X) & 0x000FFFFF) != 0 || LO(X) != 0) {
+      /* NaN */
+      return x + x;
+    }
+    return _domain();
+  }
+  if (EXPBITS(X) < 1023 - 27) {
+    /* |x| < 2^-27, tan(x) = x */
+    return x;
+  }
+  if (_rempio2(x, y) & 1) {
+    s = _cos(y[0], y[1], &sl);
+    c = _sin(y[0], y[1], &cl);
+    c = -c;
+    cl = -cl;
+  } else {
+    s = _sin(y[0], y[1], &sl);
+    c = _cos(y[0], y[1], &cl);
+  }
+  t = s + sl;
+  sl -= t - s;
+  s = t;
+  t = c + cl;
+  cl -= t - c;
+  c = t;
+  q = s / c;
+  qh = _split(q, &ql);
+  ch = _split(c, &chl);
+  t = (((s - qh * ch) - qh * chl) - ql * ch) - ql * chl;
+  return q + ((t + sl) - q * cl) / c;
 }
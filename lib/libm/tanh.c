@@ -4,9 +4,53 @@
 
 
 #include "math.h"
+#include "libm.h"
+
+
+/*
+ * Method:
+ *   |x| < 1/8:   tanh(x) = Taylor polynomial
+ *   |x| < 22:    tanh(x) = t / (t + 2), t = exp(2|x|) - 1
+ *   otherwise    tanh(x) = 1
+ * t comes with extra bits, and the quotient q gets a
+ * correction from the remainder t - q * (t + 2), which is
+ * computed exactly by splitting.
+ */
 
 
 double tanh(double x) {
-  /* !!!!! */
-  return 0.0;
+  _FP_DUnion X;
+  double a, t, tl, d, dl, q, qh, ql, dh, dhl, z;
+
+  X.d = x;
+  if (ISNAN(X)) {
+    /* NaN */
+    return x + x;
+  }
+  if (EXPBITS(X) < 1023 - 28) {
+    /* |x| < 2^-28, tanh(x) = x */
+    return x;
+  }
+  HI(X) &= 0x7FFFFFFF;
+  a = X.d;
+  if (a < 0.125) {
+    z = x * x;
+    return x + x * z * (-1.0 / 3 + z * (2.0 / 15 + z * (-17.0 / 315 +
+           z * (62.0 / 2835 + z * (-1382.0 / 155925 +
+           z * (21844.0 / 6081075 + z * (-929569.0 / 638512875)))))));
+  }
+  if (a < 22.0) {
+    t = _expm1(2.0 * a, &tl);
+    /* d + dl = t + 2 */
+    d = t + 2.0;
+    dl = (2.0 - d) + t + tl;
+    q = t / d;
+    qh = _split(q, &ql);
+    dh = _split(d, &dhl);
+    z = (((t - qh * dh) - qh * dhl) - ql * dh) - ql * dhl;
+    z = q + ((z + tl) - q * dl) / d;
+  } else {
+    z = 1.0;
+  }
+  return x < 0.0 ? -z : z;
 }
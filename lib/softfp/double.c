@@ -0,0 +1,674 @@
+/*
+ * double.c -- double precision arithmetic
+ */
+
+
+#include "softfp.h"
+
+
+/*
+ * 64-bit quantities live in pairs of word variables (h, l).
+ * The following macros shift such a pair to the left; the
+ * count n must lie in the range 1..31 for SHL, and 0..63
+ * for SHLN. JAM shifts to the right and or's all bits which
+ * are shifted out into the least significant bit; n must
+ * not be 0.
+ */
+
+#define SHL(h,l,n)	{ h = (h << (n)) | (l >> (32 - (n))); l <<= (n); }
+
+#define SHLN(h,l,n)	{ if ((n) >= 32) { \
+			    h = l << ((n) - 32); \
+			    l = 0; \
+			  } else \
+			  if ((n) != 0) { \
+			    SHL(h, l, n); \
+			  } }
+
+#define JAM(h,l,n)	{ l = jamLow(h, l, n); \
+			  h = (n) < 32 ? h >> (n) : 0; }
+
+
+static Word jamLow(Word h, Word l, int n) {
+  if (n < 32) {
+    return (l >> n) | (h << (32 - n)) | ((l << (32 - n)) != 0);
+  }
+  if (n == 32) {
+    return h | (l != 0);
+  }
+  if (n < 64) {
+    return (h >> (n - 32)) | ((h << (64 - n)) != 0) | (l != 0);
+  }
+  return (h | l) != 0;
+}
+
+
+static int clzD(Word h, Word l) {
+  if (h != 0) {
+    return __clz(h);
+  }
+  return 32 + __clz(l);
+}
+
+
+static double packD(Word h, Word l) {
+  Double z;
+
+  z.w[0] = h;
+  z.w[1] = l;
+  return z.d;
+}
+
+
+/*
+ * Round and pack a result. The significand has its leading
+ * bit at position 62 and 10 rounding bits, exp is the biased
+ * exponent of the result minus 1.
+ */
+static double roundPackD(int sign, int exp, Word h, Word l) {
+  Word bits;
+
+  if ((unsigned) exp >= 0x7FD) {
+    if (exp < 0) {
+      JAM(h, l, -exp);
+      exp = 0;
+    } else
+    if (exp > 0x7FD || (h == 0x7FFFFFFF && l >= 0xFFFFFE00)) {
+      return packD(PACKD(sign, 0x7FF, 0), 0);
+    }
+  }
+  bits = l & 0x3FF;
+  l += 0x200;
+  h += (l < 0x200);
+  l = (l >> 10) | (h << 22);
+  h >>= 10;
+  if (bits == 0x200) {
+    l &= ~(Word) 1;
+  }
+  if ((h | l) == 0) {
+    exp = 0;
+  }
+  return packD(PACKD(sign, exp, h), l);
+}
+
+
+static double normRoundPackD(int sign, int exp, Word h, Word l) {
+  int dist;
+
+  dist = clzD(h, l) - 1;
+  exp -= dist;
+  if (dist >= 10 && (unsigned) exp < 0x7FD) {
+    if ((h | l) == 0) {
+      exp = 0;
+    }
+    dist -= 10;
+    SHLN(h, l, dist);
+    return packD(PACKD(sign, exp, h), l);
+  }
+  SHLN(h, l, dist);
+  return roundPackD(sign, exp, h, l);
+}
+
+
+static double addMagsD(Word xh, Word xl, Word yh, Word yl) {
+  int expX, expY, expZ, diff;
+  Word zh, zl;
+  int sign;
+
+  expX = EXPD(xh);
+  expY = EXPD(yh);
+  sign = SGN(xh);
+  xh = FRCD(xh);
+  yh = FRCD(yh);
+  diff = expX - expY;
+  if (diff == 0) {
+    zl = xl + yl;
+    zh = xh + yh + (zl < yl);
+    if (expX == 0) {
+      /* a carry into the exponent is just right */
+      return packD(PACKD(sign, 0, zh), zl);
+    }
+    if (expX == 0x7FF) {
+      if (xh | xl | yh | yl) {
+        return packD(DEFAULT_NAND, 0);
+      }
+      return packD(PACKD(sign, 0x7FF, 0), 0);
+    }
+    expZ = expX;
+    zh += 0x00200000;
+    SHL(zh, zl, 9);
+  } else {
+    SHL(xh, xl, 9);
+    SHL(yh, yl, 9);
+    if (diff < 0) {
+      if (expY == 0x7FF) {
+        if (yh | yl) {
+          return packD(DEFAULT_NAND, 0);
+        }
+        return packD(PACKD(sign, 0x7FF, 0), 0);
+      }
+      expZ = expY;
+      if (expX != 0) {
+        xh += 0x20000000;
+      } else {
+        SHL(xh, xl, 1);
+      }
+      diff = -diff;
+      JAM(xh, xl, diff);
+    } else {
+      if (expX == 0x7FF) {
+        if (xh | xl) {
+          return packD(DEFAULT_NAND, 0);
+        }
+        return packD(PACKD(sign, 0x7FF, 0), 0);
+      }
+      expZ = expX;
+      if (expY != 0) {
+        yh += 0x20000000;
+      } else {
+        SHL(yh, yl, 1);
+      }
+      JAM(yh, yl, diff);
+    }
+    zl = xl + yl;
+    zh = xh + yh + (zl < yl) + 0x20000000;
+    if (zh < 0x40000000) {
+      expZ--;
+      SHL(zh, zl, 1);
+    }
+  }
+  return roundPackD(sign, expZ, zh, zl);
+}
+
+
+static double subMagsD(Word xh, Word xl, Word yh, Word yl) {
+  int expX, expY, expZ, diff, dist;
+  Word ah, al, bh, bl;
+  int sign;
+
+  expX = EXPD(xh);
+  expY = EXPD(yh);
+  sign = SGN(xh);
+  xh = FRCD(xh);
+  yh = FRCD(yh);
+  diff = expX - expY;
+  if (diff == 0) {
+    if (expX == 0x7FF) {
+      /* NaN, or infinity minus infinity */
+      return packD(DEFAULT_NAND, 0);
+    }
+    if (xh == yh && xl == yl) {
+      return packD(0, 0);
+    }
+    if (expX != 0) {
+      expX--;
+    }
+    if (xh < yh || (xh == yh && xl < yl)) {
+      sign = !sign;
+      ah = yh - xh - (yl < xl);
+      al = yl - xl;
+    } else {
+      ah = xh - yh - (xl < yl);
+      al = xl - yl;
+    }
+    dist = clzD(ah, al) - 11;
+    expZ = expX - dist;
+    if (expZ < 0) {
+      dist = expX;
+      expZ = 0;
+    }
+    SHLN(ah, al, dist);
+    return packD(PACKD(sign, expZ, ah), al);
+  }
+  SHL(xh, xl, 10);
+  SHL(yh, yl, 10);
+  if (diff < 0) {
+    sign = !sign;
+    if (expY == 0x7FF) {
+      if (yh | yl) {
+        return packD(DEFAULT_NAND, 0);
+      }
+      return packD(PACKD(sign, 0x7FF, 0), 0);
+    }
+    expZ = expY - 1;
+    ah = yh | 0x40000000;
+    al = yl;
+    bh = xh;
+    bl = xl;
+    if (expX != 0) {
+      bh += 0x40000000;
+    } else {
+      SHL(bh, bl, 1);
+    }
+    diff = -diff;
+  } else {
+    if (expX == 0x7FF) {
+      if (xh | xl) {
+        return packD(DEFAULT_NAND, 0);
+      }
+      return packD(PACKD(sign, 0x7FF, 0), 0);
+    }
+    expZ = expX - 1;
+    ah = xh | 0x40000000;
+    al = xl;
+    bh = yh;
+    bl = yl;
+    if (expY != 0) {
+      bh += 0x40000000;
+    } else {
+      SHL(bh, bl, 1);
+    }
+  }
+  JAM(bh, bl, diff);
+  ah = ah - bh - (al < bl);
+  al -= bl;
+  return normRoundPackD(sign, expZ, ah, al);
+}
+
+
+double __adddf3(Word xh, Word xl, Word yh, Word yl) {
+  if (SGN(xh ^ yh) == 0) {
+    return addMagsD(xh, xl, yh, yl);
+  }
+  return subMagsD(xh, xl, yh, yl);
+}
+
+
+double __subdf3(Word xh, Word xl, Word yh, Word yl) {
+  if (SGN(xh ^ yh) != 0) {
+    return addMagsD(xh, xl, yh ^ 0x80000000, yl);
+  }
+  return subMagsD(xh, xl, yh ^ 0x80000000, yl);
+}
+
+
+/*
+ * Classify a double operand of a multiplicative operation:
+ * return 0 for zero, 1 for a finite non-zero value, 2 for
+ * infinity and 3 for NaN.
+ */
+static int classD(Word h, Word l) {
+  int exp;
+
+  exp = EXPD(h);
+  if (exp == 0x7FF) {
+    return (FRCD(h) | l) ? 3 : 2;
+  }
+  return (exp | FRCD(h) | l) ? 1 : 0;
+}
+
+
+/*
+ * The 128-bit product of the significands is assembled from
+ * four 32 x 32 -> 64 bit partial products. Only its upper
+ * half is kept, the lower half contributes a sticky bit.
+ */
+double __muldf3(Word xh, Word xl, Word yh, Word yl) {
+  int expX, expY, expZ, dist;
+  int classX, classY;
+  Word p0, p1, p2, w1, w2, w3, c;
+  int sign;
+
+  sign = SGN(xh ^ yh);
+  classX = classD(xh, xl);
+  classY = classD(yh, yl);
+  if (classX != 1 || classY != 1) {
+    if (classX == 3 || classY == 3 || classX + classY == 2) {
+      /* NaN, or infinity times zero */
+      return packD(DEFAULT_NAND, 0);
+    }
+    if (classX == 0 || classY == 0) {
+      return packD(PACKD(sign, 0, 0), 0);
+    }
+    return packD(PACKD(sign, 0x7FF, 0), 0);
+  }
+  expX = EXPD(xh);
+  expY = EXPD(yh);
+  xh = FRCD(xh);
+  yh = FRCD(yh);
+  if (expX == 0) {
+    dist = clzD(xh, xl) - 11;
+    expX = 1 - dist;
+    SHLN(xh, xl, dist);
+  }
+  if (expY == 0) {
+    dist = clzD(yh, yl) - 11;
+    expY = 1 - dist;
+    SHLN(yh, yl, dist);
+  }
+  expZ = expX + expY - 0x3FF;
+  xh |= 0x00100000;
+  yh |= 0x00100000;
+  SHL(xh, xl, 10);
+  SHL(yh, yl, 11);
+  p0 = xl * yl;
+  w1 = __mulhi(xl, yl);
+  p1 = xl * yh;
+  w1 += p1;
+  c = (w1 < p1);
+  p2 = xh * yl;
+  w1 += p2;
+  c += (w1 < p2);
+  w2 = xh * yh;
+  w2 += c;
+  c = (w2 < c);
+  p1 = __mulhi(xl, yh);
+  w2 += p1;
+  c += (w2 < p1);
+  p2 = __mulhi(xh, yl);
+  w2 += p2;
+  c += (w2 < p2);
+  w3 = __mulhi(xh, yh) + c;
+  w2 |= ((w1 | p0) != 0);
+  if (w3 < 0x40000000) {
+    expZ--;
+    SHL(w3, w2, 1);
+  }
+  return roundPackD(sign, expZ, w3, w2);
+}
+
+
+/*
+ * Restoring division, one quotient bit per step. The 55-bit
+ * quotient (the 53 bits of the result, a rounding bit and
+ * one more bit) is collected in two words: 23 bits in qh
+ * and 32 bits in ql. The remainder is less than twice the
+ * divisor, i.e. it fits in 54 bits.
+ */
+double __divdf3(Word xh, Word xl, Word yh, Word yl) {
+  int expX, expY, expZ, dist;
+  int classX, classY;
+  Word rh, rl, qh, ql;
+  int i;
+  int sign;
+
+  sign = SGN(xh ^ yh);
+  classX = classD(xh, xl);
+  classY = classD(yh, yl);
+  if (classX != 1 || classY != 1) {
+    if (classX == 3 || classY == 3 || classX == classY) {
+      /* NaN, infinity divided by infinity, or zero by zero */
+      return packD(DEFAULT_NAND, 0);
+    }
+    if (classX == 0 || classY == 2) {
+      return packD(PACKD(sign, 0, 0), 0);
+    }
+    return packD(PACKD(sign, 0x7FF, 0), 0);
+  }
+  expX = EXPD(xh);
+  expY = EXPD(yh);
+  xh = FRCD(xh);
+  yh = FRCD(yh);
+  if (expX == 0) {
+    dist = clzD(xh, xl) - 11;
+    expX = 1 - dist;
+    SHLN(xh, xl, dist);
+  }
+  if (expY == 0) {
+    dist = clzD(yh, yl) - 11;
+    expY = 1 - dist;
+    SHLN(yh, yl, dist);
+  }
+  expZ = expX - expY + 0x3FE;
+  xh |= 0x00100000;
+  yh |= 0x00100000;
+  if (xh < yh || (xh == yh && xl < yl)) {
+    expZ--;
+    SHL(xh, xl, 1);
+  }
+  rh = xh - yh - (xl < yl);
+  rl = xl - yl;
+  qh = 1;
+  for (i = 0; i < 22; i++) {
+    SHL(rh, rl, 1);
+    qh <<= 1;
+    if (rh > yh || (rh == yh && rl >= yl)) {
+      rh = rh - yh - (rl < yl);
+      rl -= yl;
+      qh |= 1;
+    }
+  }
+  ql = 0;
+  for (i = 0; i < 32; i++) {
+    SHL(rh, rl, 1);
+    ql <<= 1;
+    if (rh > yh || (rh == yh && rl >= yl)) {
+      rh = rh - yh - (rl < yl);
+      rl -= yl;
+      ql |= 1;
+    }
+  }
+  SHL(qh, ql, 8);
+  return roundPackD(sign, expZ, qh, ql | ((rh | rl) != 0));
+}
+
+
+/*
+ * Square root by the digit-by-digit method, which delivers
+ * 55 bits of root (see division). The radicand is the
+ * significand, shifted such that its two leading bits are
+ * consumed first, followed by as many zeros as necessary.
+ */
+double __sqrtdf2(Word xh, Word xl) {
+  int expX, expZ, dist;
+  Word nh, nl, rh, rl, th, tl, qh, ql;
+  int i;
+
+  expX = EXPD(xh);
+  if (expX == 0x7FF) {
+    if ((FRCD(xh) | xl) || SGN(xh)) {
+      return packD(DEFAULT_NAND, 0);
+    }
+    return packD(xh, xl);
+  }
+  if (SGN(xh)) {
+    if ((expX | FRCD(xh) | xl) == 0) {
+      /* sqrt(-0) = -0 */
+      return packD(xh, xl);
+    }
+    return packD(DEFAULT_NAND, 0);
+  }
+  nh = FRCD(xh);
+  nl = xl;
+  if (expX == 0) {
+    if ((nh | nl) == 0) {
+      return packD(xh, xl);
+    }
+    dist = clzD(nh, nl) - 11;
+    expX = 1 - dist;
+    SHLN(nh, nl, dist);
+  }
+  /* the unbiased exponent must be even for halving it */
+  nh |= 0x00100000;
+  if (((expX - 0x3FF) & 1) != 0) {
+    SHL(nh, nl, 1);
+    expX--;
+  }
+  expZ = (expX - 0x3FF) / 2 + 0x3FE;
+  SHL(nh, nl, 10);
+  rh = rl = 0;
+  qh = ql = 0;
+  for (i = 0; i < 55; i++) {
+    SHL(rh, rl, 2);
+    rl |= nh >> 30;
+    SHL(nh, nl, 2);
+    th = (qh << 2) | (ql >> 30);
+    tl = (ql << 2) | 1;
+    SHL(qh, ql, 1);
+    if (rh > th || (rh == th && rl >= tl)) {
+      rh = rh - th - (rl < tl);
+      rl -= tl;
+      ql |= 1;
+    }
+  }
+  SHL(qh, ql, 8);
+  return roundPackD(0, expZ, qh, ql | ((rh | rl) != 0));
+}
+
+
+double __floatsidf(int x) {
+  int sign;
+  Word absX;
+  int dist;
+
+  if (x == 0) {
+    return packD(0, 0);
+  }
+  sign = x < 0;
+  absX = sign ? -x : x;
+  dist = __clz(absX);
+  absX <<= dist;
+  /* the hidden bit increments the exponent */
+  return packD(PACKD(sign, 0x41D - dist, absX >> 11), absX << 21);
+}
+
+
+/*
+ * Conversion to integer truncates. Out-of-range
+ * values and NaNs deliver 0x80000000.
+ */
+int __fixdfsi(Word xh, Word xl) {
+  int exp, dist;
+  Word sig, absZ;
+
+  exp = EXPD(xh);
+  dist = 0x433 - exp;
+  if (dist >= 53) {
+    return 0;
+  }
+  if (dist < 22) {
+    return (int) 0x80000000U;
+  }
+  sig = FRCD(xh) | 0x00100000;
+  if (dist >= 32) {
+    absZ = sig >> (dist - 32);
+  } else {
+    absZ = (sig << (32 - dist)) | (xl >> dist);
+  }
+  return SGN(xh) ? (int) (0 - absZ) : (int) absZ;
+}
+
+
+double __extendsfdf2(Word x) {
+  int exp, dist;
+  Word frc;
+  int sign;
+
+  exp = EXP(x);
+  frc = FRC(x);
+  sign = SGN(x);
+  if (exp == 0xFF) {
+    if (frc) {
+      return packD(DEFAULT_NAND, 0);
+    }
+    return packD(PACKD(sign, 0x7FF, 0), 0);
+  }
+  if (exp == 0) {
+    if (frc == 0) {
+      return packD(PACKD(sign, 0, 0), 0);
+    }
+    /* normalize, the hidden bit increments the exponent */
+    dist = __clz(frc) - 8;
+    exp = -dist;
+    frc <<= dist;
+  }
+  return packD(PACKD(sign, exp + 0x380, frc >> 3), frc << 29);
+}
+
+
+Word __truncdfsf2(Word xh, Word xl) {
+  int exp;
+  Word sig;
+  int sign;
+
+  exp = EXPD(xh);
+  sign = SGN(xh);
+  if (exp == 0x7FF) {
+    if (FRCD(xh) | xl) {
+      return DEFAULT_NAN;
+    }
+    return PACK(sign, 0xFF, 0);
+  }
+  sig = (FRCD(xh) << 10) | (xl >> 22) | ((xl << 10) != 0);
+  if ((exp | sig) == 0) {
+    return PACK(sign, 0, 0);
+  }
+  /* roundPack is private to single.c, so round here */
+  exp -= 0x381;
+  sig |= 0x40000000;
+  if ((unsigned) exp >= 0xFD) {
+    if (exp < 0) {
+      if (-exp < 31) {
+        sig = (sig >> -exp) | ((sig << (32 + exp)) != 0);
+      } else {
+        sig = 1;
+      }
+      exp = 0;
+    } else
+    if (exp > 0xFD || sig + 0x40 >= 0x80000000) {
+      return PACK(sign, 0xFF, 0);
+    }
+  }
+  if ((sig & 0x7F) == 0x40) {
+    sig = (sig + 0x40) >> 7 & ~(Word) 1;
+  } else {
+    sig = (sig + 0x40) >> 7;
+  }
+  if (sig == 0) {
+    exp = 0;
+  }
+  return PACK(sign, exp, sig);
+}
+
+
+/*
+ * See single.c for the meaning of the result.
+ */
+static int compareD(Word xh, Word xl, Word yh, Word yl, int unordered) {
+  int less;
+
+  if (IS_NAND(xh, xl) || IS_NAND(yh, yl)) {
+    return unordered;
+  }
+  if ((xh == yh && xl == yl) || (((xh | yh) << 1) | xl | yl) == 0) {
+    return 0;
+  }
+  if (SGN(xh ^ yh) != 0) {
+    return SGN(xh) ? -1 : 1;
+  }
+  less = xh < yh || (xh == yh && xl < yl);
+  if (SGN(xh) != 0) {
+    return less ? 1 : -1;
+  }
+  return less ? -1 : 1;
+}
+
+
+int __eqdf2(Word xh, Word xl, Word yh, Word yl) {
+  return compareD(xh, xl, yh, yl, 1);
+}
+
+
+int __nedf2(Word xh, Word xl, Word yh, Word yl) {
+  return compareD(xh, xl, yh, yl, 1);
+}
+
+
+int __ltdf2(Word xh, Word xl, Word yh, Word yl) {
+  return compareD(xh, xl, yh, yl, 1);
+}
+
+
+int __ledf2(Word xh, Word xl, Word yh, Word yl) {
+  return compareD(xh, xl, yh, yl, 1);
+}
+
+
+int __gtdf2(Word xh, Word xl, Word yh, Word yl) {
+  return compareD(xh, xl, yh, yl, -1);
+}
+
+
+int __gedf2(Word xh, Word xl, Word yh, Word yl) {
+  return compareD(xh, xl, yh, yl, -1);
+}
@@ -0,0 +1,35 @@
+;
+; mul.s -- high-order word of a 32 x 32 -> 64 bit product
+;
+
+	.export	__mulhi
+
+	.code
+	.align	4
+
+;
+; Word __mulhi(Word x, Word y)
+; The low-order word is simply x * y, computed by 'mulu'.
+; The four 16 x 16 bit partial products cannot overflow.
+;
+__mulhi:
+	slr	$8,$4,16		; xh
+	and	$9,$4,0xFFFF		; xl
+	slr	$10,$5,16		; yh
+	and	$11,$5,0xFFFF		; yl
+	mulu	$12,$9,$11		; xl * yl
+	mulu	$9,$9,$10		; xl * yh
+	mulu	$11,$8,$11		; xh * yl
+	mulu	$2,$8,$10		; xh * yh
+	add	$9,$9,$11		; middle sum
+	bgeu	$9,$11,mulhi1		; carry out of middle sum?
+	add	$2,$2,0x10000		; yes - worth 2^48
+mulhi1:
+	slr	$10,$9,16		; upper half of middle sum
+	add	$2,$2,$10
+	sll	$9,$9,16		; lower half of middle sum
+	add	$9,$9,$12		; add to xl * yl
+	bgeu	$9,$12,mulhi2		; carry into high word?
+	add	$2,$2,1			; yes
+mulhi2:
+	jr	$31
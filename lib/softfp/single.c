@@ -0,0 +1,470 @@
+/*
+ * single.c -- single precision arithmetic
+ */
+
+
+#include "softfp.h"
+
+
+static Word shiftRightJam(Word x, int dist) {
+  if (dist < 31) {
+    return (x >> dist) | ((x << (32 - dist)) != 0);
+  }
+  return x != 0;
+}
+
+
+/*
+ * Round and pack a result. The significand has its leading
+ * bit at position 30 and 7 rounding bits, exp is the biased
+ * exponent of the result minus 1.
+ */
+static Word roundPack(int sign, int exp, Word sig) {
+  Word bits;
+
+  if ((unsigned) exp >= 0xFD) {
+    if (exp < 0) {
+      sig = shiftRightJam(sig, -exp);
+      exp = 0;
+    } else
+    if (exp > 0xFD || sig + 0x40 >= 0x80000000) {
+      return PACK(sign, 0xFF, 0);
+    }
+  }
+  bits = sig & 0x7F;
+  sig = (sig + 0x40) >> 7;
+  if (bits == 0x40) {
+    sig &= ~(Word) 1;
+  }
+  if (sig == 0) {
+    exp = 0;
+  }
+  return PACK(sign, exp, sig);
+}
+
+
+static Word normRoundPack(int sign, int exp, Word sig) {
+  int dist;
+
+  dist = __clz(sig) - 1;
+  exp -= dist;
+  if (dist >= 7 && (unsigned) exp < 0xFD) {
+    return PACK(sign, sig != 0 ? exp : 0, sig << (dist - 7));
+  }
+  return roundPack(sign, exp, sig << dist);
+}
+
+
+static Word addMags(Word x, Word y) {
+  int expX, expY, expZ, diff;
+  Word sigX, sigY, sigZ;
+  int sign;
+
+  expX = EXP(x);
+  sigX = FRC(x);
+  expY = EXP(y);
+  sigY = FRC(y);
+  sign = SGN(x);
+  diff = expX - expY;
+  if (diff == 0) {
+    if (expX == 0) {
+      return x + sigY;
+    }
+    if (expX == 0xFF) {
+      if (sigX | sigY) {
+        return DEFAULT_NAN;
+      }
+      return x;
+    }
+    expZ = expX;
+    sigZ = 0x01000000 + sigX + sigY;
+    if ((sigZ & 1) == 0 && expZ < 0xFE) {
+      return PACK(sign, expZ, sigZ >> 1);
+    }
+    sigZ <<= 6;
+  } else {
+    sigX <<= 6;
+    sigY <<= 6;
+    if (diff < 0) {
+      if (expY == 0xFF) {
+        if (sigY) {
+          return DEFAULT_NAN;
+        }
+        return PACK(sign, 0xFF, 0);
+      }
+      expZ = expY;
+      sigX += expX ? 0x20000000 : sigX;
+      sigX = shiftRightJam(sigX, -diff);
+    } else {
+      if (expX == 0xFF) {
+        if (sigX) {
+          return DEFAULT_NAN;
+        }
+        return x;
+      }
+      expZ = expX;
+      sigY += expY ? 0x20000000 : sigY;
+      sigY = shiftRightJam(sigY, diff);
+    }
+    sigZ = 0x20000000 + sigX + sigY;
+    if (sigZ < 0x40000000) {
+      expZ--;
+      sigZ <<= 1;
+    }
+  }
+  return roundPack(sign, expZ, sigZ);
+}
+
+
+static Word subMags(Word x, Word y) {
+  int expX, expY, expZ, diff, dist;
+  Word sigX, sigY, sigA, sigB;
+  int sigDiff;
+  int sign;
+
+  expX = EXP(x);
+  sigX = FRC(x);
+  expY = EXP(y);
+  sigY = FRC(y);
+  sign = SGN(x);
+  diff = expX - expY;
+  if (diff == 0) {
+    if (expX == 0xFF) {
+      /* NaN, or infinity minus infinity */
+      return DEFAULT_NAN;
+    }
+    sigDiff = sigX - sigY;
+    if (sigDiff == 0) {
+      return 0;
+    }
+    if (expX != 0) {
+      expX--;
+    }
+    if (sigDiff < 0) {
+      sign = !sign;
+      sigDiff = -sigDiff;
+    }
+    dist = __clz(sigDiff) - 8;
+    expZ = expX - dist;
+    if (expZ < 0) {
+      dist = expX;
+      expZ = 0;
+    }
+    return PACK(sign, expZ, (Word) sigDiff << dist);
+  }
+  sigX <<= 7;
+  sigY <<= 7;
+  if (diff < 0) {
+    sign = !sign;
+    if (expY == 0xFF) {
+      if (sigY) {
+        return DEFAULT_NAN;
+      }
+      return PACK(sign, 0xFF, 0);
+    }
+    expZ = expY - 1;
+    sigA = sigY | 0x40000000;
+    sigB = sigX + (expX ? 0x40000000 : sigX);
+    diff = -diff;
+  } else {
+    if (expX == 0xFF) {
+      if (sigX) {
+        return DEFAULT_NAN;
+      }
+      return x;
+    }
+    expZ = expX - 1;
+    sigA = sigX | 0x40000000;
+    sigB = sigY + (expY ? 0x40000000 : sigY);
+  }
+  return normRoundPack(sign, expZ, sigA - shiftRightJam(sigB, diff));
+}
+
+
+Word __addsf3(Word x, Word y) {
+  if (SGN(x ^ y) == 0) {
+    return addMags(x, y);
+  }
+  return subMags(x, y);
+}
+
+
+Word __subsf3(Word x, Word y) {
+  if (SGN(x ^ y) != 0) {
+    return addMags(x, y ^ 0x80000000);
+  }
+  return subMags(x, y ^ 0x80000000);
+}
+
+
+Word __mulsf3(Word x, Word y) {
+  int expX, expY, expZ, dist;
+  Word sigX, sigY, sigZ;
+  int sign;
+
+  expX = EXP(x);
+  sigX = FRC(x);
+  expY = EXP(y);
+  sigY = FRC(y);
+  sign = SGN(x ^ y);
+  if (expX == 0xFF || expY == 0xFF) {
+    if ((expX == 0xFF && sigX) || (expY == 0xFF && sigY)) {
+      return DEFAULT_NAN;
+    }
+    if ((expX | sigX) == 0 || (expY | sigY) == 0) {
+      /* infinity times zero */
+      return DEFAULT_NAN;
+    }
+    return PACK(sign, 0xFF, 0);
+  }
+  if (expX == 0) {
+    if (sigX == 0) {
+      return PACK(sign, 0, 0);
+    }
+    dist = __clz(sigX) - 8;
+    expX = 1 - dist;
+    sigX <<= dist;
+  }
+  if (expY == 0) {
+    if (sigY == 0) {
+      return PACK(sign, 0, 0);
+    }
+    dist = __clz(sigY) - 8;
+    expY = 1 - dist;
+    sigY <<= dist;
+  }
+  expZ = expX + expY - 0x7F;
+  sigX = (sigX | 0x00800000) << 7;
+  sigY = (sigY | 0x00800000) << 8;
+  sigZ = __mulhi(sigX, sigY) | (sigX * sigY != 0);
+  if (sigZ < 0x40000000) {
+    expZ--;
+    sigZ <<= 1;
+  }
+  return roundPack(sign, expZ, sigZ);
+}
+
+
+/*
+ * The quotient is developed 8 bits at a time by the hardware
+ * divider: the partial remainder is always less than the
+ * 24-bit divisor, so shifting it left by 8 cannot overflow.
+ */
+Word __divsf3(Word x, Word y) {
+  int expX, expY, expZ, dist;
+  Word sigX, sigY, quo, rem;
+  int sign;
+
+  expX = EXP(x);
+  sigX = FRC(x);
+  expY = EXP(y);
+  sigY = FRC(y);
+  sign = SGN(x ^ y);
+  if (expX == 0xFF) {
+    if (sigX || expY == 0xFF) {
+      /* NaN, or infinity divided by infinity */
+      return DEFAULT_NAN;
+    }
+    return PACK(sign, 0xFF, 0);
+  }
+  if (expY == 0xFF) {
+    if (sigY) {
+      return DEFAULT_NAN;
+    }
+    return PACK(sign, 0, 0);
+  }
+  if (expY == 0) {
+    if (sigY == 0) {
+      if ((expX | sigX) == 0) {
+        /* zero divided by zero */
+        return DEFAULT_NAN;
+      }
+      return PACK(sign, 0xFF, 0);
+    }
+    dist = __clz(sigY) - 8;
+    expY = 1 - dist;
+    sigY <<= dist;
+  }
+  if (expX == 0) {
+    if (sigX == 0) {
+      return PACK(sign, 0, 0);
+    }
+    dist = __clz(sigX) - 8;
+    expX = 1 - dist;
+    sigX <<= dist;
+  }
+  expZ = expX - expY + 0x7E;
+  sigX |= 0x00800000;
+  sigY |= 0x00800000;
+  if (sigX < sigY) {
+    expZ--;
+    sigX <<= 1;
+  }
+  /* quo = (sigX << 30) / sigY, a 31-bit quotient */
+  quo = 1;
+  rem = sigX - sigY;
+  rem <<= 8;
+  quo = (quo << 8) | (rem / sigY);
+  rem %= sigY;
+  rem <<= 8;
+  quo = (quo << 8) | (rem / sigY);
+  rem %= sigY;
+  rem <<= 8;
+  quo = (quo << 8) | (rem / sigY);
+  rem %= sigY;
+  rem <<= 6;
+  quo = (quo << 6) | (rem / sigY);
+  rem %= sigY;
+  return roundPack(sign, expZ, quo | (rem != 0));
+}
+
+
+/*
+ * Square root by the digit-by-digit method, which delivers
+ * 26 bits of root: the 24 bits of the result, a rounding bit,
+ * and one more bit which, together with the remainder, makes
+ * the sticky bit. The radicand is sigX << 27.
+ */
+Word __sqrtsf2(Word x) {
+  int expX, expZ, dist;
+  Word sigX, root, trial, rem;
+  Word radHi, radLo;
+  int i;
+
+  expX = EXP(x);
+  sigX = FRC(x);
+  if (expX == 0xFF) {
+    if (sigX || SGN(x)) {
+      return DEFAULT_NAN;
+    }
+    return x;
+  }
+  if (SGN(x)) {
+    if ((expX | sigX) == 0) {
+      /* sqrt(-0) = -0 */
+      return x;
+    }
+    return DEFAULT_NAN;
+  }
+  if (expX == 0) {
+    if (sigX == 0) {
+      return x;
+    }
+    dist = __clz(sigX) - 8;
+    expX = 1 - dist;
+    sigX <<= dist;
+  }
+  /* the unbiased exponent must be even for halving it */
+  sigX |= 0x00800000;
+  if (((expX - 0x7F) & 1) != 0) {
+    sigX <<= 1;
+    expX--;
+  }
+  expZ = (expX - 0x7F) / 2 + 0x7E;
+  /* the 52-bit radicand, left-aligned in (radHi, radLo) */
+  radHi = sigX << 7;
+  radLo = 0;
+  root = 0;
+  rem = 0;
+  for (i = 0; i < 26; i++) {
+    rem = (rem << 2) | (radHi >> 30);
+    radHi = (radHi << 2) | (radLo >> 30);
+    radLo <<= 2;
+    trial = (root << 2) | 1;
+    root <<= 1;
+    if (rem >= trial) {
+      rem -= trial;
+      root |= 1;
+    }
+  }
+  return roundPack(0, expZ, (root << 5) | (rem != 0));
+}
+
+
+Word __floatsisf(int x) {
+  int sign;
+  Word absX;
+
+  if ((x & 0x7FFFFFFF) == 0) {
+    /* 0 or -2^31 */
+    return x == 0 ? 0 : PACK(1, 0x9E, 0);
+  }
+  sign = x < 0;
+  absX = sign ? -x : x;
+  return normRoundPack(sign, 0x9C, absX);
+}
+
+
+/*
+ * Conversion to integer truncates. Out-of-range
+ * values and NaNs deliver 0x80000000.
+ */
+int __fixsfsi(Word x) {
+  int exp, dist;
+  Word absZ;
+
+  exp = EXP(x);
+  dist = 0x9E - exp;
+  if (dist >= 32) {
+    return 0;
+  }
+  if (dist <= 0) {
+    return (int) 0x80000000U;
+  }
+  absZ = ((FRC(x) | 0x00800000) << 8) >> dist;
+  return SGN(x) ? (int) (0 - absZ) : (int) absZ;
+}
+
+
+/*
+ * Compare x with y: return -1, 0, or 1 if x is less than,
+ * equal to, or greater than y, and unordered if either of
+ * them is a NaN. The wrappers below choose the result for
+ * unordered operands so that the test of their return value
+ * against 0 which the compiler emits comes out false.
+ */
+static int compare(Word x, Word y, int unordered) {
+  if (IS_NAN(x) || IS_NAN(y)) {
+    return unordered;
+  }
+  if (x == y || ((x | y) << 1) == 0) {
+    return 0;
+  }
+  if (SGN(x ^ y) != 0) {
+    return SGN(x) ? -1 : 1;
+  }
+  if (SGN(x) != 0) {
+    return x > y ? -1 : 1;
+  }
+  return x < y ? -1 : 1;
+}
+
+
+int __eqsf2(Word x, Word y) {
+  return compare(x, y, 1);
+}
+
+
+int __nesf2(Word x, Word y) {
+  return compare(x, y, 1);
+}
+
+
+int __ltsf2(Word x, Word y) {
+  return compare(x, y, 1);
+}
+
+
+int __lesf2(Word x, Word y) {
+  return compare(x, y, 1);
+}
+
+
+int __gtsf2(Word x, Word y) {
+  return compare(x, y, -1);
+}
+
+
+int __gesf2(Word x, Word y) {
+  return compare(x, y, -1);
+}
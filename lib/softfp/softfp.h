@@ -0,0 +1,45 @@
+/*
+ * softfp.h -- internal definitions of the soft-float library
+ */
+
+
+#ifndef _SOFTFP_H_
+#define _SOFTFP_H_
+
+
+/*
+ * Operands and results are handled as raw words. A double
+ * is a pair of words (hi, lo), hi holding sign, exponent and
+ * the 20 high-order fraction bits. Only round-to-nearest-even
+ * is implemented, and no exception flags are recorded.
+ */
+
+typedef unsigned int Word;
+
+#define SGN(x)		((x) >> 31)
+#define EXP(x)		(((x) >> 23) & 0xFF)
+#define FRC(x)		((x) & 0x007FFFFF)
+#define PACK(s,e,f)	(((Word) (s) << 31) + ((Word) (e) << 23) + (f))
+#define IS_NAN(x)	(((x) & 0x7FFFFFFF) > 0x7F800000)
+#define DEFAULT_NAN	0x7FC00000
+
+#define EXPD(h)		(((h) >> 20) & 0x7FF)
+#define FRCD(h)		((h) & 0x000FFFFF)
+#define PACKD(s,e,f)	(((Word) (s) << 31) + ((Word) (e) << 20) + (f))
+#define IS_NAND(h,l)	(((h) & 0x7FFFFFFF) > 0x7FF00000 || \
+			 (((h) & 0x7FFFFFFF) == 0x7FF00000 && (l) != 0))
+#define DEFAULT_NAND	0x7FF80000	/* high word, low word is 0 */
+
+typedef union {
+  double d;
+  Word w[2];		/* w[0] is the high-order word */
+} Double;
+
+
+extern unsigned char __clzTable[256];
+
+int __clz(Word x);
+Word __mulhi(Word x, Word y);
+
+
+#endif /* _SOFTFP_H_ */
@@ -0,0 +1,133 @@
+/*
+ * malloc.c -- test dynamic memory allocation
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/arena.h>
+
+
+#define NOBJS		200
+#define NROUNDS		5000
+
+
+static char *objs[NOBJS];
+static int sizes[NOBJS];
+static int errors;
+
+
+static unsigned int seed = 4711;
+
+
+static int random(int n) {
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 8) % n;
+}
+
+
+static void fill(char *p, int size, int tag) {
+  int i;
+
+  for (i = 0; i < size; i++) {
+    p[i] = tag + i;
+  }
+}
+
+
+static void check(char *p, int size, int tag) {
+  int i;
+
+  if (((unsigned int) p & 7) != 0) {
+    printf("block 0x%08X not aligned\n", (unsigned int) p);
+    errors++;
+  }
+  for (i = 0; i < size; i++) {
+    if (p[i] != (char) (tag + i)) {
+      printf("block 0x%08X, size %d: byte %d corrupted\n",
+             (unsigned int) p, size, i);
+      errors++;
+      return;
+    }
+  }
+}
+
+
+int main(void) {
+  int i, j, size;
+  char *p;
+  int *q;
+  Arena *a;
+
+  /* random malloc, realloc and free */
+  for (i = 0; i < NROUNDS; i++) {
+    j = random(NOBJS);
+    if (objs[j] == NULL) {
+      size = random(4) == 0 ? 1 + random(10000) : 1 + random(300);
+      objs[j] = malloc(size);
+      sizes[j] = size;
+      fill(objs[j], size, j);
+    } else {
+      check(objs[j], sizes[j], j);
+      switch (random(3)) {
+        case 0:
+          size = 1 + random(12000);
+          p = realloc(objs[j], size);
+          check(p, size < sizes[j] ? size : sizes[j], j);
+          objs[j] = p;
+          sizes[j] = size;
+          fill(objs[j], size, j);
+          break;
+        default:
+          free(objs[j]);
+          objs[j] = NULL;
+          break;
+      }
+    }
+  }
+  for (j = 0; j < NOBJS; j++) {
+    if (objs[j] != NULL) {
+      check(objs[j], sizes[j], j);
+      free(objs[j]);
+    }
+  }
+  /* calloc must zero recycled memory */
+  p = malloc(1000);
+  fill(p, 1000, 1);
+  free(p);
+  q = calloc(250, sizeof(int));
+  for (i = 0; i < 250; i++) {
+    if (q[i] != 0) {
+      printf("calloc: word %d not zero\n", i);
+      errors++;
+      break;
+    }
+  }
+  free(q);
+  if (calloc(0x10000, 0x10000) != NULL) {
+    printf("calloc: overflow not detected\n");
+    errors++;
+  }
+  /* arena */
+  a = arenaCreate(10000);
+  for (i = 0; i < 3; i++) {
+    for (j = 0; j < NOBJS; j++) {
+      objs[j] = arenaAlloc(a, 40);
+      if (objs[j] == NULL) {
+        break;
+      }
+      fill(objs[j], 40, j);
+    }
+    if (j == NOBJS || j < 100) {
+      printf("arena: %d blocks of 40 bytes in 10000 bytes\n", j);
+      errors++;
+    }
+    while (--j >= 0) {
+      check(objs[j], 40, j);
+    }
+    arenaReset(a);
+  }
+  printf("%d rounds of malloc/realloc/free\n", NROUNDS);
+  printf("%d errors\n", errors);
+  return 0;
+}
@@ -5,7 +5,16 @@
 
 #include <stdio.h>
 #include <string.h>
-#include "../include/string.h"
+
+
+#define MAXLEN		80
+#define GUARD		16
+
+
+static unsigned char buf1[GUARD + 4 + MAXLEN + GUARD];
+static unsigned char buf2[GUARD + 4 + MAXLEN + GUARD];
+static unsigned char ref[GUARD + 4 + MAXLEN + GUARD];
+static int errors;
 
 
 void stop(void) {
@@ -16,7 +25,156 @@ void stop(void) {
 }
 
 
+static void error(char *fn, int da, int sa, int n) {
+  if (errors < 20) {
+    printf("%s: dst align %d, src align %d, length %d: wrong\n",
+           fn, da, sa, n);
+  }
+  errors++;
+}
+
+
+static void init(unsigned char *p, int seed) {
+  int i;
+
+  for (i = 0; i < sizeof(buf1); i++) {
+    p[i] = 1 + (i * 7 + seed) % 251;
+  }
+}
+
+
+static int same(unsigned char *p, unsigned char *q) {
+  int i;
+
+  for (i = 0; i < sizeof(buf1); i++) {
+    if (p[i] != q[i]) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+
+static int sign(int x) {
+  return x < 0 ? -1 : x > 0 ? 1 : 0;
+}
+
+
+/*
+ * Every function is checked for all combinations of
+ * alignments and lengths against the obvious byte loop.
+ * Bytes outside of the destination must stay untouched.
+ */
 int main(void) {
+  int da, sa, n, i, k;
+  unsigned char *d, *s, *r;
+
+  for (da = 0; da < 4; da++) {
+    for (sa = 0; sa < 4; sa++) {
+      for (n = 0; n <= MAXLEN; n++) {
+        /* memcpy */
+        init(buf1, 1);
+        init(buf2, 2);
+        init(ref, 1);
+        d = buf1 + GUARD + da;
+        s = buf2 + GUARD + sa;
+        r = ref + GUARD + da;
+        for (i = 0; i < n; i++) {
+          r[i] = s[i];
+        }
+        if (memcpy(d, s, n) != d || !same(buf1, ref)) {
+          error("memcpy", da, sa, n);
+        }
+        /* memmove, both directions */
+        for (k = -1; k <= 1; k += 2) {
+          init(buf1, 3);
+          init(ref, 3);
+          d = buf1 + GUARD + da;
+          s = d + k * sa;
+          r = ref + GUARD + da;
+          if (k > 0) {
+            for (i = 0; i < n; i++) {
+              r[i] = r[i + k * sa];
+            }
+          } else {
+            for (i = n - 1; i >= 0; i--) {
+              r[i] = r[i + k * sa];
+            }
+          }
+          if (memmove(d, s, n) != d || !same(buf1, ref)) {
+            error("memmove", da, k * sa, n);
+          }
+        }
+        /* memcmp */
+        init(buf1, 4);
+        init(buf2, 4);
+        d = buf1 + GUARD + da;
+        s = buf2 + GUARD + sa;
+        for (i = 0; i < n; i++) {
+          s[i] = d[i];
+        }
+        if (memcmp(d, s, n) != 0) {
+          error("memcmp", da, sa, n);
+        }
+        if (n > 0) {
+          s[n - 1] = d[n - 1] + 1;
+          if (memcmp(d, s, n) >= 0) {
+            error("memcmp", da, sa, n);
+          }
+          s[n / 2] = 0xFF;
+          if (sign(memcmp(d, s, n)) != sign(d[n / 2] - 0xFF) &&
+              d[n / 2] != 0xFF) {
+            error("memcmp", da, sa, n);
+          }
+        }
+        /* strcpy, strlen, strcmp */
+        init(buf1, 5);
+        init(buf2, 6);
+        init(ref, 5);
+        d = buf1 + GUARD + da;
+        s = buf2 + GUARD + sa;
+        r = ref + GUARD + da;
+        s[n] = '\0';
+        for (i = 0; i <= n; i++) {
+          r[i] = s[i];
+        }
+        if (strcpy((char *) d, (char *) s) != (char *) d ||
+            !same(buf1, ref)) {
+          error("strcpy", da, sa, n);
+        }
+        if (strlen((char *) d) != n || strlen((char *) s) != n) {
+          error("strlen", da, sa, n);
+        }
+        if (strcmp((char *) d, (char *) s) != 0) {
+          error("strcmp", da, sa, n);
+        }
+        if (n > 0) {
+          d[n - 1] = 0xFF;
+          if (strcmp((char *) d, (char *) s) <= 0) {
+            error("strcmp", da, sa, n);
+          }
+          d[n - 1] = '\0';
+          if (strcmp((char *) d, (char *) s) >= 0) {
+            error("strcmp", da, sa, n);
+          }
+        }
+      }
+    }
+    /* memset */
+    for (n = 0; n <= MAXLEN; n++) {
+      init(buf1, 7);
+      init(ref, 7);
+      d = buf1 + GUARD + da;
+      r = ref + GUARD + da;
+      for (i = 0; i < n; i++) {
+        r[i] = 0xA5;
+      }
+      if (memset(d, 0x1A5, n) != d || !same(buf1, ref)) {
+        error("memset", da, 0, n);
+      }
+    }
+  }
+  printf("%d errors\n", errors);
   stop();
   return 0;
 }
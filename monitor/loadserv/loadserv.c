@@ -10,6 +10,7 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <termios.h>
+#include <sys/select.h>
 
 
 #define SYN		((unsigned char) 's')
@@ -17,6 +18,30 @@
 
 #define LINE_SIZE	520
 
+#define BIN		((unsigned char) 'b')
+#define BIN_OK		((unsigned char) 'B')
+
+/* binary block protocol, see monitor/monitor/common/load.c */
+#define FRM_SOH		0x01		/* start of frame */
+#define FRM_DATA	'D'		/* raw data */
+#define FRM_RLE		'R'		/* run-length encoded data */
+#define FRM_END		'E'		/* start address, end of load */
+#define FRM_ACK		0x80		/* frame received, | seq */
+#define FRM_NAK		0xC0		/* frame missing, | seq */
+#define FRM_SEQ_MASK	0x3F		/* sequence numbers mod 64 */
+#define FRM_MAX_DATA	1024		/* max data bytes in a frame */
+#define FRM_HDR_SIZE	9		/* SOH, seq, type, addr, len */
+#define FRM_SIZE	(FRM_HDR_SIZE + FRM_MAX_DATA + 4)
+
+#define WINDOW		8		/* frames in flight */
+#define TIMEOUT		5		/* seconds until frames are resent */
+
+
+typedef struct {
+  int size;				/* number of bytes in frame */
+  unsigned char bytes[FRM_SIZE];	/* complete frame */
+} Frame;
+
 
 static int debugCmds = 1;
 static int debugData = 0;
@@ -26,8 +51,14 @@ static int sfd = 0;
 static struct termios origOptions;
 static struct termios currOptions;
 
+static Frame *frames = NULL;
+static int numFrames = 0;
+static int maxFrames = 0;
+static unsigned int crcTable[256];
+
 
 void serialClose(void);
+void connect(void);
 
 
 void error(char *fmt, ...) {
@@ -96,6 +127,282 @@ int serialRcv(unsigned char *bp) {
 }
 
 
+int serialRcvTimed(unsigned char *bp, int seconds) {
+  fd_set fds;
+  struct timeval tv;
+
+  FD_ZERO(&fds);
+  FD_SET(sfd, &fds);
+  tv.tv_sec = seconds;
+  tv.tv_usec = 0;
+  if (select(sfd + 1, &fds, NULL, NULL, &tv) <= 0) {
+    return 0;
+  }
+  return serialRcv(bp);
+}
+
+
+void serialSndBuf(unsigned char *buf, int size) {
+  int n;
+
+  while (size > 0) {
+    n = write(sfd, buf, size);
+    if (n > 0) {
+      buf += n;
+      size -= n;
+    }
+  }
+}
+
+
+/**************************************************************/
+
+
+void crcInit(void) {
+  unsigned int c;
+  int i, j;
+
+  for (i = 0; i < 256; i++) {
+    c = i;
+    for (j = 0; j < 8; j++) {
+      if (c & 1) {
+        c = 0xEDB88320 ^ (c >> 1);
+      } else {
+        c = c >> 1;
+      }
+    }
+    crcTable[i] = c;
+  }
+}
+
+
+/*
+ * Run-length encode data into buf, return the encoded size or
+ * -1 if it would not be smaller than the data itself: a control
+ * byte c < 0x80 is followed by c + 1 literal bytes, a control
+ * byte c >= 0x80 by one byte which is repeated c - 0x80 + 3 times.
+ */
+int pack(unsigned char *data, int size, unsigned char *buf) {
+  int i, n, lit, out;
+
+  i = 0;
+  lit = -1;
+  out = 0;
+  while (i < size) {
+    n = 1;
+    while (i + n < size && n < 130 && data[i + n] == data[i]) {
+      n++;
+    }
+    if (n >= 3) {
+      buf[out++] = 0x80 + n - 3;
+      buf[out++] = data[i];
+      lit = -1;
+      i += n;
+    } else {
+      if (lit < 0 || buf[lit] == 0x7F) {
+        lit = out++;
+        buf[lit] = 0xFF;
+      }
+      buf[lit]++;
+      buf[out++] = data[i++];
+    }
+    if (out >= size) {
+      return -1;
+    }
+  }
+  return out;
+}
+
+
+Frame *newFrame(void) {
+  if (numFrames == maxFrames) {
+    maxFrames = maxFrames == 0 ? 256 : 2 * maxFrames;
+    frames = realloc(frames, maxFrames * sizeof(Frame));
+    if (frames == NULL) {
+      error("no memory for frames");
+    }
+  }
+  return &frames[numFrames++];
+}
+
+
+void makeFrame(int type, unsigned int addr,
+               unsigned char *data, int size) {
+  unsigned char rle[FRM_MAX_DATA];
+  unsigned char *p;
+  unsigned int crc;
+  Frame *f;
+  int n, i;
+
+  f = newFrame();
+  if (type == FRM_DATA && (n = pack(data, size, rle)) > 0) {
+    type = FRM_RLE;
+    data = rle;
+    size = n;
+  }
+  p = f->bytes;
+  *p++ = FRM_SOH;
+  *p++ = (numFrames - 1) & FRM_SEQ_MASK;
+  *p++ = type;
+  *p++ = addr >> 24;
+  *p++ = addr >> 16;
+  *p++ = addr >> 8;
+  *p++ = addr;
+  *p++ = size >> 8;
+  *p++ = size;
+  memcpy(p, data, size);
+  p += size;
+  crc = 0xFFFFFFFF;
+  for (i = 1; i < p - f->bytes; i++) {
+    crc = crcTable[(crc ^ f->bytes[i]) & 0xFF] ^ (crc >> 8);
+  }
+  crc = ~crc;
+  *p++ = crc >> 24;
+  *p++ = crc >> 16;
+  *p++ = crc >> 8;
+  *p++ = crc;
+  f->size = p - f->bytes;
+}
+
+
+int hexByte(char *p) {
+  int i, b, c;
+
+  b = 0;
+  for (i = 0; i < 2; i++) {
+    c = p[i];
+    if (c >= '0' && c <= '9') {
+      c -= '0';
+    } else
+    if (c >= 'A' && c <= 'F') {
+      c -= 'A' - 10;
+    } else
+    if (c >= 'a' && c <= 'f') {
+      c -= 'a' - 10;
+    } else {
+      error("malformed S-record");
+    }
+    b = (b << 4) | c;
+  }
+  return b;
+}
+
+
+/*
+ * Convert the S-records of the load file into frames, merging
+ * records with consecutive addresses.
+ */
+void makeFrames(void) {
+  char line[LINE_SIZE];
+  unsigned char data[FRM_MAX_DATA];
+  unsigned char rec[LINE_SIZE / 2];
+  unsigned int blockAddr, addr, start;
+  int size, count, alen, sum, i;
+
+  crcInit();
+  numFrames = 0;
+  size = 0;
+  blockAddr = 0;
+  start = 0;
+  fseek(loadFile, 0, SEEK_SET);
+  while (fgets(line, LINE_SIZE, loadFile) != NULL) {
+    if (line[0] != 'S') {
+      error("malformed S-record");
+    }
+    count = hexByte(line + 2);
+    sum = count;
+    for (i = 0; i < count; i++) {
+      rec[i] = hexByte(line + 4 + 2 * i);
+      sum += rec[i];
+    }
+    if ((sum & 0xFF) != 0xFF) {
+      error("wrong checksum in S-record");
+    }
+    switch (line[1]) {
+      case '1': case '9': alen = 2; break;
+      case '2': case '8': alen = 3; break;
+      case '3': case '7': alen = 4; break;
+      default: continue;
+    }
+    addr = 0;
+    for (i = 0; i < alen; i++) {
+      addr = (addr << 8) | rec[i];
+    }
+    if (line[1] >= '7') {
+      start = addr;
+      break;
+    }
+    for (i = alen; i < count - 1; i++) {
+      if (size == FRM_MAX_DATA || (size > 0 && addr != blockAddr + size)) {
+        makeFrame(FRM_DATA, blockAddr, data, size);
+        size = 0;
+      }
+      if (size == 0) {
+        blockAddr = addr;
+      }
+      data[size++] = rec[i];
+      addr++;
+    }
+  }
+  if (size > 0) {
+    makeFrame(FRM_DATA, blockAddr, data, size);
+  }
+  makeFrame(FRM_END, start, NULL, 0);
+}
+
+
+/*
+ * Send all frames, keeping up to WINDOW of them unacknowledged.
+ */
+void sendFrames(void) {
+  int base, next, i;
+  unsigned char b;
+  int resent;
+
+  base = 0;
+  next = 0;
+  resent = 0;
+  while (base < numFrames) {
+    while (next < numFrames && next < base + WINDOW) {
+      serialSndBuf(frames[next].bytes, frames[next].size);
+      next++;
+    }
+    if (!serialRcvTimed(&b, TIMEOUT)) {
+      if (debugCmds) {
+        printf("timeout, resending from frame %d\n", base);
+      }
+      next = base;
+      resent = base;
+      continue;
+    }
+    if (b == SYN) {
+      /* the client has been reset */
+      connect();
+      return;
+    }
+    for (i = base; i < next; i++) {
+      if ((i & FRM_SEQ_MASK) == (b & FRM_SEQ_MASK)) {
+        break;
+      }
+    }
+    if ((b & 0xC0) == FRM_ACK && i < next) {
+      base = i + 1;
+    } else
+    if ((b & 0xC0) == FRM_NAK && i < next && i >= resent) {
+      if (debugCmds) {
+        printf("NAK, resending from frame %d\n", i);
+      }
+      base = i;
+      next = i;
+      resent = i + 1;
+    }
+  }
+}
+
+
+/**************************************************************/
+
+
 void connect(void) {
   unsigned char b;
 
@@ -158,6 +465,20 @@ int main(int argc, char *argv[]) {
       fseek(loadFile, 0, SEEK_SET);
       continue;
     }
+    if (cmd == BIN) {
+      /* binary block transfer of the whole file */
+      if (debugCmds) {
+        printf("binary transfer... ");
+        fflush(stdout);
+      }
+      makeFrames();
+      while (!serialSnd(BIN_OK)) ;
+      sendFrames();
+      if (debugCmds) {
+        printf("OK, %d frames\n", numFrames);
+      }
+      continue;
+    }
     if (cmd != 'r') {
       /* unknown command */
       if (debugCmds) {
@@ -21,6 +21,12 @@
 
 	.set	USER_CONTEXT_SIZE,38*4	; size of user context
 
+	.set	FPU_REG0,0xFFFFFF00	; FPU register 0
+	.set	FPU_CTRL,0xFFFFFE00	; FPU control register
+	.set	FPU_STAT,0xFFFFFE04	; FPU status register
+	.set	FPU_RES,0xFFFFFE08	; FPU result register
+	.set	FPU_CONTEXT_SIZE,35*4	; size of FPU context
+
 ;***************************************************************
 
 	.import	_bcode
@@ -52,7 +58,7 @@
 
 	.import	dskinitctl
 	.import	dskcapctl
-	.import	dskioctl
+	.import	dskiodma
 
 	.import	dskinitser
 	.import	dskcapser
@@ -331,7 +337,7 @@ dio:
 	add	$5,$6,$0
 	add	$6,$7,$0
 	ldw	$7,$29,16
-	j	dskioctl
+	j	dskiodma
 dio1:
 	sub	$4,$4,1
 	bne	$4,$0,dio2
@@ -403,6 +409,10 @@ monitorReturn:
 userContext:
 	.space	USER_CONTEXT_SIZE
 
+	; the user's FPU registers, control, status, and result
+fpuContext:
+	.space	FPU_CONTEXT_SIZE
+
 ;***************************************************************
 
 	.code
@@ -412,6 +422,21 @@ userContext:
 	; use userContext to load state
 resume:
 	mvts	$0,PSW
+	add	$24,$0,fpuContext	; FPU state
+	add	$9,$0,FPU_REG0
+	add	$10,$9,32*4
+fpurest:
+	ldw	$8,$24,0
+	stw	$8,$9,0
+	add	$9,$9,4
+	add	$24,$24,4
+	bne	$9,$10,fpurest
+	ldw	$8,$24,0
+	stw	$8,$0,FPU_CTRL
+	ldw	$8,$24,4
+	stw	$8,$0,FPU_STAT
+	ldw	$8,$24,8
+	stw	$8,$0,FPU_RES
 	add	$24,$0,userContext
 	.nosyn
 	ldw	$8,$24,33*4		; tlbIndex
@@ -512,4 +537,19 @@ debug:
 	mvfs	$8,BAD_ACCESS
 	stw	$8,$24,37*4		; badAccess
 	.syn
+	add	$24,$0,fpuContext	; FPU state
+	add	$9,$0,FPU_REG0
+	add	$10,$9,32*4
+fpusave:
+	ldw	$8,$9,0
+	stw	$8,$24,0
+	add	$9,$9,4
+	add	$24,$24,4
+	bne	$9,$10,fpusave
+	ldw	$8,$0,FPU_CTRL
+	stw	$8,$24,0
+	ldw	$8,$0,FPU_STAT
+	stw	$8,$24,4
+	ldw	$8,$0,FPU_RES
+	stw	$8,$24,8
 	j	loadState
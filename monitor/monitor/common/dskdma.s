@@ -0,0 +1,81 @@
+;
+; dskdma.s -- disk made available by disk controller, DMA transfers
+;
+
+;***************************************************************
+
+	.set	dskbase,0xF0400000	; disk base address
+	.set	dskctrl,0		; control register
+	.set	dskdsc,16		; descriptor list address register
+	.set	dskndsc,20		; descriptor count register
+
+	.set	ctrlstrt,0x01		; start bit
+	.set	ctrlien,0x02		; interrupt enable bit
+	.set	ctrlwrt,0x04		; write bit
+	.set	ctrlerr,0x08		; error bit
+	.set	ctrldone,0x10		; done bit
+	.set	ctrlrdy,0x20		; ready bit
+	.set	ctrldma,0x40		; DMA bit
+
+	.set	dscsct,0		; descriptor: first sector
+	.set	dsccnt,4		; descriptor: number of sectors
+	.set	dscaddr,8		; descriptor: physical address
+
+	.export	dskiodma		; do disk I/O
+
+;***************************************************************
+
+	.code
+	.align	4
+
+	; The whole request is described by a single descriptor,
+	; the controller moves the data directly into or out of
+	; memory. Initialization and capacity are the same as for
+	; buffered transfers, see dskctl.s.
+
+dskiodma:
+	add	$8,$0,'r'
+	beq	$4,$8,dskdma1
+	add	$8,$0,'w'
+	beq	$4,$8,dskdma2
+	add	$2,$0,0xFF		; illegal command
+	j	dskdmax
+
+dskdma1:
+	add	$10,$0,ctrldma | ctrlstrt
+	j	dskdma3
+
+dskdma2:
+	add	$10,$0,ctrldma | ctrlwrt | ctrlstrt
+
+dskdma3:
+	add	$2,$0,$0		; return ok
+	beq	$7,$0,dskdmax		; if no sectors
+	add	$8,$0,dskdesc		; fill descriptor
+	stw	$5,$8,dscsct		; sector number on disk
+	stw	$7,$8,dsccnt		; number of sectors
+	stw	$6,$8,dscaddr		; physical memory address
+	and	$8,$8,0x3FFFFFFF	; physical address of descriptor
+	add	$9,$0,dskbase
+	stw	$8,$9,dskdsc		; descriptor list
+	add	$8,$0,1
+	stw	$8,$9,dskndsc		; one descriptor
+	stw	$10,$9,dskctrl		; start command
+dskdma4:
+	ldw	$2,$9,dskctrl
+	and	$8,$2,ctrldone		; done?
+	beq	$8,$0,dskdma4		; no - wait
+	and	$8,$2,ctrlerr		; error?
+	bne	$8,$0,dskdmax		; yes - leave
+	add	$2,$0,$0		; return ok
+
+dskdmax:
+	jr	$31
+
+;***************************************************************
+
+	.bss
+	.align	4
+
+dskdesc:
+	.space	12
@@ -29,6 +29,8 @@
 
 
 #define START_BLOCK_TOKEN	0xFE
+#define START_MULTI_TOKEN	0xFC
+#define STOP_MULTI_TOKEN	0xFD
 
 
 Bool debug = false;
@@ -240,6 +242,167 @@ static int sndCmdSndData(unsigned char *cmd,
 }
 
 
+static void stopTransmission(void) {
+  unsigned char cmd[5] = { 0x4C, 0x00, 0x00, 0x00, 0x00 };
+  int i;
+  unsigned char r;
+
+  /* send command */
+  resetCRC7();
+  for (i = 0; i < 5; i++) {
+    (void) sndRcv(cmd[i]);
+  }
+  (void) sndRcv(getCRC7());
+  /* skip stuff byte, receive answer */
+  (void) sndRcv(0xFF);
+  i = 8;
+  do {
+    r = sndRcv(0xFF);
+  } while (r == 0xFF && --i > 0);
+  /* wait while busy */
+  do {
+    r = sndRcv(0xFF);
+  } while (r == 0x00);
+}
+
+
+static int sndCmdRcvBlocks(unsigned char *cmd,
+                           unsigned char *rcv,
+                           unsigned char *ptr, int nblks) {
+  int i, j;
+  unsigned char r;
+  unsigned short crc16;
+  unsigned int *ctrl, *data;
+
+  select();
+  /* send command */
+  resetCRC7();
+  for (i = 0; i < 5; i++) {
+    (void) sndRcv(cmd[i]);
+  }
+  (void) sndRcv(getCRC7());
+  /* receive answer */
+  i = 8;
+  do {
+    r = sndRcv(0xFF);
+  } while (r == 0xFF && --i > 0);
+  if (i == 0) {
+    deselect();
+    return 0;
+  }
+  rcv[0] = r;
+  if (r != 0x00) {
+    /* command rejected */
+    deselect();
+    return 0;
+  }
+  for (j = 0; j < nblks; j++) {
+    /* wait for start block token */
+    i = 2048;
+    do {
+      r = sndRcv(0xFF);
+    } while (r != START_BLOCK_TOKEN && --i > 0);
+    if (i == 0) {
+      break;
+    }
+    /* receive data bytes, sndRcv() expanded in-line */
+    resetCRC16(true);
+    ctrl = SDC_CTRL;
+    data = SDC_DATA;
+    for (i = 0; i < 512; i++) {
+      *data = 0xFF;
+      while ((*ctrl & SDC_READY) == 0) ;
+      *ptr++ = *data;
+    }
+    /* receive CRC */
+    (void) sndRcv(0xFF);
+    (void) sndRcv(0xFF);
+    crc16 = getCRC16();
+    if (crc16 != 0x0000) {
+      /* CRC error */
+      break;
+    }
+  }
+  stopTransmission();
+  deselect();
+  (void) sndRcv(0xFF);
+  return j * 512;
+}
+
+
+static int sndCmdSndBlocks(unsigned char *cmd,
+                           unsigned char *rcv,
+                           unsigned char *ptr, int nblks) {
+  int i, j;
+  unsigned char r;
+  unsigned short crc16;
+  unsigned int *ctrl, *data;
+
+  select();
+  /* send command */
+  resetCRC7();
+  for (i = 0; i < 5; i++) {
+    (void) sndRcv(cmd[i]);
+  }
+  (void) sndRcv(getCRC7());
+  /* receive answer */
+  i = 8;
+  do {
+    r = sndRcv(0xFF);
+  } while (r == 0xFF && --i > 0);
+  if (i == 0) {
+    deselect();
+    return 0;
+  }
+  rcv[0] = r;
+  if (r != 0x00) {
+    /* command rejected */
+    deselect();
+    return 0;
+  }
+  for (j = 0; j < nblks; j++) {
+    /* send start block token */
+    (void) sndRcv(START_MULTI_TOKEN);
+    /* send data bytes, sndRcv() expanded in-line */
+    resetCRC16(false);
+    ctrl = SDC_CTRL;
+    data = SDC_DATA;
+    for (i = 0; i < 512; i++) {
+      *data = *ptr++;
+      while ((*ctrl & SDC_READY) == 0) ;
+      r = *data;
+    }
+    /* send CRC */
+    crc16 = getCRC16();
+    (void) sndRcv((crc16 >> 8) & 0xFF);
+    (void) sndRcv((crc16 >> 0) & 0xFF);
+    /* receive data respose token */
+    do {
+      r = sndRcv(0xFF);
+    } while (r == 0xFF);
+    rcv[1] = r;
+    /* wait while busy */
+    do {
+      r = sndRcv(0xFF);
+    } while (r == 0x00);
+    if ((rcv[1] & 0x1F) != 0x05) {
+      /* rejected */
+      break;
+    }
+  }
+  /* send stop transmission token, skip stuff byte */
+  (void) sndRcv(STOP_MULTI_TOKEN);
+  (void) sndRcv(0xFF);
+  /* wait while busy */
+  do {
+    r = sndRcv(0xFF);
+  } while (r == 0x00);
+  deselect();
+  (void) sndRcv(0xFF);
+  return j * 512;
+}
+
+
 /**************************************************************/
 
 
@@ -446,6 +609,46 @@ static void writeSingleSector(unsigned int sct, unsigned char *ptr) {
 }
 
 
+static Bool readMultipleSectors(unsigned int sct,
+                                unsigned char *ptr, int nscts) {
+  unsigned char cmd[5] = { 0x52, 0x00, 0x00, 0x00, 0x00 };
+  unsigned char rcv[1];
+  int n;
+
+  cmd[1] = (sct >> 24) & 0xFF;
+  cmd[2] = (sct >> 16) & 0xFF;
+  cmd[3] = (sct >>  8) & 0xFF;
+  cmd[4] = (sct >>  0) & 0xFF;
+  n = sndCmdRcvBlocks(cmd, rcv, ptr, nscts);
+  if (debug) {
+    printf("CMD18  (0x%02X%02X%02X%02X) : ",
+           cmd[1], cmd[2], cmd[3], cmd[4]);
+    printf("%d bytes\n", n);
+  }
+  return n == nscts * 512;
+}
+
+
+static Bool writeMultipleSectors(unsigned int sct,
+                                 unsigned char *ptr, int nscts) {
+  unsigned char cmd[5] = { 0x59, 0x00, 0x00, 0x00, 0x00 };
+  unsigned char rcv[2];
+  int n;
+
+  cmd[1] = (sct >> 24) & 0xFF;
+  cmd[2] = (sct >> 16) & 0xFF;
+  cmd[3] = (sct >>  8) & 0xFF;
+  cmd[4] = (sct >>  0) & 0xFF;
+  n = sndCmdSndBlocks(cmd, rcv, ptr, nscts);
+  if (debug) {
+    printf("CMD25  (0x%02X%02X%02X%02X) : ",
+           cmd[1], cmd[2], cmd[3], cmd[4]);
+    printf("%d bytes\n", n);
+  }
+  return n == nscts * 512;
+}
+
+
 /**************************************************************/
 
 
@@ -499,6 +702,20 @@ int dskiosdc(char cmd, int sct, Word addr, int nscts) {
   int i;
   unsigned char *ptr;
 
+  if (nscts > 1) {
+    /* transfer all sectors with a single command */
+    if (sct < 0 || sct + nscts > numSectors) {
+      return -1;
+    }
+    ptr = (unsigned char *) (0xC0000000 | addr);
+    if (cmd == 'r') {
+      return readMultipleSectors(sct, ptr, nscts) ? 0 : -1;
+    }
+    if (cmd == 'w') {
+      return writeMultipleSectors(sct, ptr, nscts) ? 0 : -1;
+    }
+    return -1;
+  }
   if (cmd == 'r') {
     ptr = (unsigned char *) (0xC0000000 | addr);
     for (i = 0; i < nscts; i++) {
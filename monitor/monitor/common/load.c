@@ -1,5 +1,22 @@
 /*
  * load.c -- load S-records from serial line
+ *
+ * If the load server understands it, the program is transferred
+ * by a binary block protocol instead: the client asks for it
+ * with BIN, and the server answers with BIN_OK and then sends
+ * frames of the form
+ *
+ *     FRM_SOH seq type addr[4] len[2] data[len] crc[4]
+ *
+ * (multi-byte fields big-endian, crc is CRC-32 over seq..data).
+ * type is FRM_DATA (data is stored at addr), FRM_RLE (data is
+ * run-length encoded, see unpack), or FRM_END (addr is the start
+ * address). Every frame received in sequence is acknowledged by
+ * FRM_ACK | seq; a damaged or missing frame is reported once by
+ * FRM_NAK | expected seq. The server keeps several frames in
+ * flight and goes back to the first unacknowledged one on a NAK
+ * or a timeout. All answers are single bytes >= 0x80, so they
+ * cannot be mistaken for the commands of the S-record protocol.
  */
 
 
@@ -21,8 +38,22 @@
 
 #define LINE_SIZE	520
 
+#define BIN		((unsigned char) 'b')
+#define BIN_OK		((unsigned char) 'B')
+
+#define FRM_SOH		0x01		/* start of frame */
+#define FRM_DATA	'D'		/* raw data */
+#define FRM_RLE		'R'		/* run-length encoded data */
+#define FRM_END		'E'		/* start address, end of load */
+#define FRM_ACK		0x80		/* frame received, | seq */
+#define FRM_NAK		0xC0		/* frame missing, | seq */
+#define FRM_SEQ_MASK	0x3F		/* sequence numbers mod 64 */
+#define FRM_MAX_DATA	1024		/* max data bytes in a frame */
+
 
 static Byte line[LINE_SIZE];
+static Byte frame[FRM_MAX_DATA];
+static Word crcTable[256];
 
 
 static Word getByte(int index) {
@@ -83,6 +114,180 @@ static Word serialIn(int serno) {
 }
 
 
+/**************************************************************/
+
+
+static void crcInit(void) {
+  Word c;
+  int i, j;
+
+  for (i = 0; i < 256; i++) {
+    c = i;
+    for (j = 0; j < 8; j++) {
+      if (c & 1) {
+        c = 0xEDB88320 ^ (c >> 1);
+      } else {
+        c = c >> 1;
+      }
+    }
+    crcTable[i] = c;
+  }
+}
+
+
+/*
+ * Read a byte, or return -1 if none arrives in time.
+ */
+static int timedIn(int serno) {
+  int i;
+
+  for (i = 0; i < WAIT_DELAY; i++) {
+    if (serialChk(serno) != 0) {
+      return serialIn(serno);
+    }
+  }
+  return -1;
+}
+
+
+/*
+ * Receive the rest of a frame after FRM_SOH.
+ * Return the frame type, or -1 if it is damaged.
+ */
+static int recvFrame(int serno, int *seq, Word *addr, int *len) {
+  Word crc;
+  Byte hdr[8];
+  int i, c;
+
+  crc = 0xFFFFFFFF;
+  for (i = 0; i < 8; i++) {
+    c = timedIn(serno);
+    if (c < 0) {
+      return -1;
+    }
+    hdr[i] = c;
+    crc = crcTable[(crc ^ c) & 0xFF] ^ (crc >> 8);
+  }
+  *seq = hdr[0];
+  *addr = ((Word) hdr[2] << 24) | ((Word) hdr[3] << 16) |
+          ((Word) hdr[4] <<  8) | ((Word) hdr[5] <<  0);
+  *len = (hdr[6] << 8) | hdr[7];
+  if (*len > FRM_MAX_DATA) {
+    return -1;
+  }
+  for (i = 0; i < *len; i++) {
+    c = timedIn(serno);
+    if (c < 0) {
+      return -1;
+    }
+    frame[i] = c;
+    crc = crcTable[(crc ^ c) & 0xFF] ^ (crc >> 8);
+  }
+  crc = ~crc;
+  for (i = 24; i >= 0; i -= 8) {
+    c = timedIn(serno);
+    if (c < 0 || c != ((crc >> i) & 0xFF)) {
+      return -1;
+    }
+  }
+  return hdr[1];
+}
+
+
+/*
+ * Expand run-length encoded data to addr: a control byte c < 0x80
+ * is followed by c + 1 literal bytes, a control byte c >= 0x80 by
+ * one byte which is repeated c - 0x80 + 3 times. Return the
+ * number of bytes stored.
+ */
+static int unpack(Word addr, int len) {
+  Byte *dst;
+  int i, n;
+
+  dst = (Byte *) addr;
+  i = 0;
+  while (i < len) {
+    n = frame[i++];
+    if (n < 0x80) {
+      n++;
+      while (n-- > 0 && i < len) {
+        *dst++ = frame[i++];
+      }
+    } else {
+      n -= 0x80 - 3;
+      while (n-- > 0) {
+        *dst++ = frame[i];
+      }
+      i++;
+    }
+  }
+  return dst - (Byte *) addr;
+}
+
+
+/*
+ * Load by the binary block protocol.
+ * Return false if the server does not support it.
+ */
+static Bool loadBinary(int serno) {
+  int expected, seq, type, len, i;
+  Bool nakSent;
+  Word addr, total;
+  Bool run;
+
+  serialOut(serno, BIN);
+  if (timedIn(serno) != BIN_OK) {
+    return false;
+  }
+  printf("Loading (binary protocol)...\n");
+  crcInit();
+  expected = 0;
+  nakSent = false;
+  total = 0;
+  run = true;
+  while (run) {
+    do {
+      i = timedIn(serno);
+    } while (i >= 0 && i != FRM_SOH);
+    type = (i < 0) ? -1 : recvFrame(serno, &seq, &addr, &len);
+    if (type < 0 || seq != expected) {
+      /* damaged, lost, or repeated frame */
+      if (!nakSent) {
+        serialOut(serno, FRM_NAK | expected);
+        nakSent = true;
+      }
+      continue;
+    }
+    addr |= 0xC0000000;
+    if (type == FRM_DATA) {
+      for (i = 0; i < len; i++) {
+        ((Byte *) addr)[i] = frame[i];
+      }
+      total += len;
+    } else
+    if (type == FRM_RLE) {
+      total += unpack(addr, len);
+    } else
+    if (type != FRM_END) {
+      printf("Error: unknown type of frame!\n");
+      break;
+    }
+    serialOut(serno, FRM_ACK | expected);
+    expected = (expected + 1) & FRM_SEQ_MASK;
+    nakSent = false;
+    if (type == FRM_END) {
+      cpuSetPC(addr);
+      printf("%u bytes loaded.\n", total);
+      run = false;
+    }
+  }
+  return true;
+}
+
+
+/**************************************************************/
+
+
 void load(int serno, Bool start) {
   int i, j;
   Bool run;
@@ -112,7 +317,7 @@ void load(int serno, Bool start) {
   }
   serialOut(serno, ACK);
   printf("Connected to load server.\n");
-  run = true;
+  run = !loadBinary(serno);
   while (run) {
     serialOut(serno, 'r');
     for (i = 0; i < LINE_SIZE; i++) {
@@ -0,0 +1,165 @@
+/*
+ * bprof.c -- branch profile
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+
+#include "common.h"
+#include "console.h"
+#include "error.h"
+#include "bprof.h"
+
+
+/*
+ * Every conditional branch executed is counted under its
+ * virtual address, separately for taken and not taken. When
+ * the simulator exits, the counts are written to the profile
+ * file, one branch per line, sorted by address:
+ *
+ *     <address> <taken> <not taken>
+ *
+ * The compiler relates the addresses to its branches with
+ * the help of the linker's map (see lcc/src/layout.c).
+ */
+
+
+typedef struct branch {
+  Word addr;			/* address of branch instruction */
+  unsigned long taken;		/* number of times taken */
+  unsigned long notTaken;	/* number of times not taken */
+  struct branch *next;		/* next branch in hash bucket */
+} Branch;
+
+
+static FILE *profFile = NULL;
+static Branch *table[BPROF_HASH_SIZE];
+static int numBranches;
+
+
+void bprofBranch(Word addr, Bool taken) {
+  Branch *p;
+  int h;
+
+  if (profFile == NULL) {
+    /* no branch profile requested */
+    return;
+  }
+  h = (addr >> 2) % BPROF_HASH_SIZE;
+  p = table[h];
+  while (p != NULL && p->addr != addr) {
+    p = p->next;
+  }
+  if (p == NULL) {
+    p = malloc(sizeof(Branch));
+    if (p == NULL) {
+      error("cannot allocate branch profile entry");
+    }
+    p->addr = addr;
+    p->taken = 0;
+    p->notTaken = 0;
+    p->next = table[h];
+    table[h] = p;
+    numBranches++;
+  }
+  if (taken) {
+    p->taken++;
+  } else {
+    p->notTaken++;
+  }
+}
+
+
+static int compareBranches(const void *x, const void *y) {
+  Branch *a = *(Branch **) x;
+  Branch *b = *(Branch **) y;
+
+  if (a->addr < b->addr) {
+    return -1;
+  }
+  if (a->addr > b->addr) {
+    return 1;
+  }
+  return 0;
+}
+
+
+static void writeProfile(FILE *f) {
+  Branch **sorted;
+  Branch *p;
+  int i, n;
+
+  sorted = malloc((numBranches + 1) * sizeof(Branch *));
+  if (sorted == NULL) {
+    error("cannot allocate branch profile table");
+  }
+  n = 0;
+  for (i = 0; i < BPROF_HASH_SIZE; i++) {
+    for (p = table[i]; p != NULL; p = p->next) {
+      sorted[n++] = p;
+    }
+  }
+  qsort(sorted, n, sizeof(Branch *), compareBranches);
+  for (i = 0; i < n; i++) {
+    fprintf(f, "0x%08X %lu %lu\n",
+            sorted[i]->addr, sorted[i]->taken, sorted[i]->notTaken);
+  }
+  free(sorted);
+}
+
+
+static void freeTable(void) {
+  Branch *p, *q;
+  int i;
+
+  for (i = 0; i < BPROF_HASH_SIZE; i++) {
+    p = table[i];
+    while (p != NULL) {
+      q = p->next;
+      free(p);
+      p = q;
+    }
+    table[i] = NULL;
+  }
+  numBranches = 0;
+}
+
+
+void bprofReset(void) {
+  if (profFile == NULL) {
+    /* no branch profile requested */
+    return;
+  }
+  cPrintf("Resetting Branch Profile...\n");
+  freeTable();
+}
+
+
+void bprofInit(char *profFileName) {
+  if (profFileName != NULL) {
+    profFile = fopen(profFileName, "w");
+    if (profFile == NULL) {
+      error("cannot open branch profile file '%s'", profFileName);
+    }
+  }
+  bprofReset();
+}
+
+
+void bprofExit(void) {
+  FILE *f;
+
+  if (profFile == NULL) {
+    /* no branch profile requested */
+    return;
+  }
+  /* protect against recursion if writing fails */
+  f = profFile;
+  profFile = NULL;
+  writeProfile(f);
+  fclose(f);
+  freeTable();
+}
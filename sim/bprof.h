@@ -0,0 +1,20 @@
+/*
+ * bprof.h -- branch profile
+ */
+
+
+#ifndef _BPROF_H_
+#define _BPROF_H_
+
+
+#define BPROF_HASH_SIZE	4099	/* buckets in the branch table */
+
+
+void bprofBranch(Word addr, Bool taken);
+
+void bprofReset(void);
+void bprofInit(char *profFileName);
+void bprofExit(void);
+
+
+#endif /* _BPROF_H_ */
@@ -29,9 +29,13 @@
 #include "serial.h"
 #include "disk.h"
 #include "sdcard.h"
+#include "ipi.h"
+#include "fpu.h"
 #include "bio.h"
 #include "output.h"
 #include "shutdown.h"
+#include "stats.h"
+#include "bprof.h"
 #include "graph1.h"
 #include "graph2.h"
 #include "mouse.h"
@@ -913,9 +917,13 @@ static void doInit(char *tokens[], int n) {
     serialReset();
     diskReset();
     sdcardReset();
+    ipiReset();
+    fpuReset();
     bioReset();
     outputReset();
     shutdownReset();
+    statsReset();
+    bprofReset();
     graph1Reset();
     graph2Reset();
     mouseReset();
@@ -33,17 +33,22 @@
 #define MAX_NSERIALS	2		/* max number of serial lines */
 #define DISK_BASE	0x30400000	/* physical disk base address */
 #define SDCARD_BASE	0x30600000	/* physical SD card base address */
+#define IPI_BASE	0x30700000	/* physical IPI device base address */
 #define BIO_BASE	0x31000000	/* physical board I/O base address */
 #define GRAPH1_BASE	0x34000000	/* physical grahics 1 base address */
 #define GRAPH2_BASE	0x35000000	/* physical grahics 2 base address */
 #define OUTPUT_BASE	0x3F000000	/* physical output device address */
 #define SHUTDOWN_BASE	0x3F100000	/* physical shutdown device address */
+#define STATS_BASE	0x3F200000	/* physical statistics device address */
+#define FPU_BASE	0x3FF00000	/* physical FPU base address */
 
 #define PAGE_SIZE	(4 * K)		/* size of a page and a page frame */
 #define OFFSET_MASK	(PAGE_SIZE - 1)	/* mask for offset within a page */
 #define PAGE_MASK	(~OFFSET_MASK)		   /* mask for page number */
 #define FRAME_MASK	(PAGE_MASK & ~0xC0000000)  /* mask for frame number */
 
+#define MAX_NCORES	8		/* max number of CPU cores */
+
 #define CC_PER_USEC	50		/* clock cycles per microsecond */
 #define CC_PER_INSTR	18		/* clock cycles per instruction */
 
@@ -54,6 +59,7 @@ typedef enum { false, true } Bool;	/* truth values */
 typedef unsigned char Byte;		/* 8 bit quantities */
 typedef unsigned short Half;		/* 16 bit quantities */
 typedef unsigned int Word;		/* 32 bit quantities */
+typedef unsigned long long Dword;	/* 64 bit quantities */
 
 
 #endif /* _COMMON_H_ */
@@ -18,7 +18,9 @@
 #include "mmu.h"
 #include "icache.h"
 #include "dcache.h"
+#include "fpu.h"
 #include "timer.h"
+#include "bprof.h"
 
 
 /**************************************************************/
@@ -59,7 +61,83 @@ static Word startAddr;		/* start of ROM (or start of RAM, */
 
 static Bool linked;		/* true means: load-link has been */
 				/* executed, not yet followed by */
-				/* store-cond, without any exception */
+				/* store-cond, without any exception, */
+				/* and no other core has written to */
+static Word linkAddr;		/* this physical address */
+
+/*
+ * Multi-core simulation: the cores are interleaved on the host,
+ * each one executing a time slice of 'quantum' instructions before
+ * the next running core takes over. This keeps runs deterministic.
+ * The state of the current core lives in the variables above, that
+ * of all other cores is parked in the array below. Device interrupts
+ * are routed to core 0, which is also the only core running after
+ * a reset; the others are started through the IPI device. The
+ * timers are ticked only by the instructions of core 0. Each core
+ * has its own TLB, caches and FPU, switched together with it.
+ */
+
+typedef struct {
+  Bool running;			/* core executes instructions */
+  Word pc;
+  Word psw;
+  Word r[32];
+  unsigned irqPending;
+  Bool linked;
+  Word linkAddr;
+} Core;
+
+static int numCores;		/* number of cores */
+static int quantum;		/* length of a time slice */
+static int curCore;		/* number of the current core */
+static int slice;		/* instrs left in current time slice */
+static Core cores[MAX_NCORES];	/* parked state of the cores */
+
+
+/**************************************************************/
+
+
+static void selectCore(int core) {
+  Core *cp;
+
+  if (core == curCore) {
+    return;
+  }
+  cp = &cores[curCore];
+  cp->pc = pc;
+  cp->psw = psw;
+  memcpy(cp->r, r, sizeof(r));
+  cp->irqPending = irqPending;
+  cp->linked = linked;
+  cp->linkAddr = linkAddr;
+  cp = &cores[core];
+  pc = cp->pc;
+  psw = cp->psw;
+  memcpy(r, cp->r, sizeof(r));
+  irqPending = cp->irqPending;
+  linked = cp->linked;
+  linkAddr = cp->linkAddr;
+  curCore = core;
+  mmuSelectCore(core);
+  icacheSelectCore(core);
+  dcacheSelectCore(core);
+  fpuSelectCore(core);
+}
+
+
+static void nextSlice(void) {
+  int core;
+
+  if (--slice > 0) {
+    return;
+  }
+  slice = quantum;
+  core = curCore;
+  do {
+    core = (core + 1) % numCores;
+  } while (core != 0 && !cores[core].running);
+  selectCore(core);
+}
 
 
 /**************************************************************/
@@ -487,6 +565,9 @@ static void execNextInstruction(void) {
         case 5:
           WR(reg2, mmuGetBadAccs());
           break;
+        case 6:
+          WR(reg2, curCore);
+          break;
         default:
           throwException(EXC_ILL_INSTRCT);
           break;
@@ -547,7 +628,7 @@ static void execNextInstruction(void) {
     case OP_LDLW:
       addr = RR(reg1) + SEXT16(immed);
       traceLoadLinkWord(addr);
-      WR(reg2, mmuReadWord(addr, UM));
+      WR(reg2, mmuReadLinkWord(addr, UM, &linkAddr));
       linked = true;
       break;
     case OP_STCW:
@@ -566,6 +647,10 @@ static void execNextInstruction(void) {
       break;
   }
   /* update PC */
+  /* count conditional branches for the branch profile */
+  if (op >= OP_BEQ && op <= OP_BGTU) {
+    bprofBranch(pc, next != pc + 4);
+  }
   pc = next;
 }
 
@@ -642,14 +727,19 @@ void cpuStep(void) {
   if (exception == 0) {
     /* initialization */
     pushEnvironment(&myEnvironment);
-    timerTick();
+    if (curCore == 0) {
+      timerTick();
+    }
     execNextInstruction();
     handleInterrupts();
   } else {
     /* an exception was thrown */
-    cpuSetInterrupt(exception);
+    irqPending |= ((unsigned) 1 << exception);
     handleInterrupts();
   }
+  if (numCores > 1) {
+    nextSlice();
+  }
   popEnvironment();
 }
 
@@ -665,16 +755,24 @@ void cpuRun(void) {
     pushEnvironment(&myEnvironment);
   } else {
     /* an exception was thrown */
-    cpuSetInterrupt(exception);
+    irqPending |= ((unsigned) 1 << exception);
     handleInterrupts();
+    if (numCores > 1) {
+      nextSlice();
+    }
     if (breakSet && pc == breakAddr) {
       run = false;
     }
   }
   while (run) {
-    timerTick();
+    if (curCore == 0) {
+      timerTick();
+    }
     execNextInstruction();
     handleInterrupts();
+    if (numCores > 1) {
+      nextSlice();
+    }
     if (breakSet && pc == breakAddr) {
       run = false;
     }
@@ -688,20 +786,122 @@ void cpuHalt(void) {
 }
 
 
+/*
+ * Device interrupts go to core 0; the IPI device addresses
+ * the cores individually.
+ */
+
+
 void cpuSetInterrupt(int priority) {
-  irqPending |= ((unsigned) 1 << priority);
+  cpuSetCoreInterrupt(0, priority);
 }
 
 
 void cpuResetInterrupt(int priority) {
-  irqPending &= ~((unsigned) 1 << priority);
+  cpuResetCoreInterrupt(0, priority);
+}
+
+
+void cpuSetCoreInterrupt(int core, int priority) {
+  if (core == curCore) {
+    irqPending |= ((unsigned) 1 << priority);
+  } else {
+    cores[core].irqPending |= ((unsigned) 1 << priority);
+  }
+}
+
+
+void cpuResetCoreInterrupt(int core, int priority) {
+  if (core == curCore) {
+    irqPending &= ~((unsigned) 1 << priority);
+  } else {
+    cores[core].irqPending &= ~((unsigned) 1 << priority);
+  }
+}
+
+
+Bool cpuTestCoreInterrupt(int core, int priority) {
+  unsigned irqs;
+
+  irqs = core == curCore ? irqPending : cores[core].irqPending;
+  return (irqs & ((unsigned) 1 << priority)) != 0;
+}
+
+
+/**************************************************************/
+
+
+int cpuGetCore(void) {
+  return curCore;
+}
+
+
+int cpuGetNumCores(void) {
+  return numCores;
 }
 
 
+Bool cpuCoreRunning(int core) {
+  return cores[core].running;
+}
+
+
+void cpuStartCore(int core, Word addr) {
+  Core *cp;
+  int i;
+
+  if (cores[core].running) {
+    /* core is already executing instructions */
+    return;
+  }
+  cp = &cores[core];
+  for (i = 1; i < 32; i++) {
+    cp->r[i] = rand();
+  }
+  cp->r[0] = 0;
+  cp->pc = addr;
+  cp->psw = 0;
+  cp->irqPending = 0;
+  cp->linked = false;
+  cp->running = true;
+}
+
+
+void cpuSnoopWrite(Word pAddr) {
+  int core;
+
+  /* a write breaks the link reservations of all other cores */
+  for (core = 0; core < numCores; core++) {
+    if (core != curCore &&
+        cores[core].linked &&
+        cores[core].linkAddr == (pAddr & ~3)) {
+      cores[core].linked = false;
+    }
+  }
+}
+
+
+/**************************************************************/
+
+
 void cpuReset(void) {
+  int core;
   int i;
 
   cPrintf("Resetting CPU...\n");
+  if (numCores > 1) {
+    cPrintf("%6d cores installed, time slice = %d instructions.\n",
+            numCores, quantum);
+  }
+  selectCore(0);
+  /* all cores but the first are stopped */
+  for (core = 1; core < numCores; core++) {
+    cores[core].running = false;
+    cores[core].irqPending = 0;
+    cores[core].linked = false;
+  }
+  cores[0].running = true;
+  slice = quantum;
   /* most registers are in a random state */
   for (i = 1; i < 32; i++) {
     r[i] = rand();
@@ -717,8 +917,11 @@ void cpuReset(void) {
 }
 
 
-void cpuInit(Word initialPC) {
+void cpuInit(Word initialPC, int nCores, int nQuantum) {
   startAddr = initialPC;
+  numCores = nCores;
+  quantum = nQuantum;
+  curCore = 0;
   cpuReset();
 }
 
@@ -9,6 +9,7 @@
 
 #define IRQ_TIMER_1		15	/* timer 1 interrupt */
 #define IRQ_TIMER_0		14	/* timer 0 interrupt */
+#define IRQ_IPI			13	/* inter-processor interrupt */
 #define IRQ_DISK		8	/* disk interrupt */
 #define IRQ_MOUSE		5	/* mouse interrupt */
 #define IRQ_KEYBOARD		4	/* keyboard interrupt */
@@ -28,6 +29,8 @@
 #define PSW_PRIO_SHFT	16		/* shift count to reach these bits */
 #define PSW_IRQ_MASK	0x0000FFFF	/* IRQ mask bits */
 
+#define QUANTUM_DFL	1000	/* default time slice of a core */
+
 
 Word cpuGetPC(void);
 void cpuSetPC(Word addr);
@@ -53,9 +56,18 @@ void cpuHalt(void);
 
 void cpuSetInterrupt(int priority);
 void cpuResetInterrupt(int priority);
+void cpuSetCoreInterrupt(int core, int priority);
+void cpuResetCoreInterrupt(int core, int priority);
+Bool cpuTestCoreInterrupt(int core, int priority);
+
+int cpuGetCore(void);
+int cpuGetNumCores(void);
+Bool cpuCoreRunning(int core);
+void cpuStartCore(int core, Word addr);
+void cpuSnoopWrite(Word pAddr);
 
 void cpuReset(void);
-void cpuInit(Word initialPC);
+void cpuInit(Word initialPC, int nCores, int nQuantum);
 void cpuExit(void);
 
 
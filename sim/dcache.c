@@ -48,7 +48,9 @@ static unsigned int indexMask;	/* mask for index bits (shifted to 0) */
 static int tagShift;		/* == number of (index + offset) bits */
 static unsigned int tagMask;	/* mask for tag bits (shifted to 0) */
 
-static CacheSet *cache;		/* the cache is an array of cache sets */
+static int numCores;		/* number of cores, each has a cache */
+static CacheSet *caches[MAX_NCORES];	/* the caches of all cores */
+static CacheSet *cache;		/* the cache of the current core */
 
 static long readAccesses;	/* number of read accesses */
 static long readMisses;		/* number of read misses */
@@ -84,6 +86,48 @@ static void writeLineToMemory(Word pAddr, Word *src) {
 }
 
 
+/*
+ * With more than one core, the data caches are kept coherent by
+ * snooping: before a core fetches a line from memory, any dirty
+ * copy in another core's cache is written back, and when a core
+ * writes to a line, the copies in all other caches are discarded.
+ */
+
+
+static void snoop(Word pAddr, Bool write) {
+  unsigned int tag;
+  unsigned int index;
+  CacheSet *other;
+  CacheLine *cacheLine;
+  int core;
+  int i;
+
+  tag = (pAddr >> tagShift) & tagMask;
+  index = (pAddr >> indexShift) & indexMask;
+  for (core = 0; core < numCores; core++) {
+    other = caches[core];
+    if (other == cache) {
+      continue;
+    }
+    for (i = 0; i < assoc; i++) {
+      cacheLine = i == 0 ? &other[index].line_0 : &other[index].line_1;
+      if (!cacheLine->valid || cacheLine->tag != tag) {
+        continue;
+      }
+      if (cacheLine->dirty) {
+        /* handle write-back */
+        writeLineToMemory(pAddr, cacheLine->data);
+        cacheLine->dirty = false;
+        memoryWrites++;
+      }
+      if (write) {
+        cacheLine->valid = false;
+      }
+    }
+  }
+}
+
+
 static Word *getWordPtr(Word pAddr, Bool write) {
   unsigned int tag;
   unsigned int index;
@@ -135,6 +179,9 @@ static Word *getWordPtr(Word pAddr, Bool write) {
       writeLineToMemory(memAddr, cacheLine->data);
       memoryWrites++;
     }
+    if (numCores > 1) {
+      snoop(pAddr, write);
+    }
     readLineFromMemory(pAddr, cacheLine->data);
     cacheLine->valid = true;
     cacheLine->dirty = false;
@@ -147,6 +194,9 @@ static Word *getWordPtr(Word pAddr, Bool write) {
   }
   if (write) {
     /* handle cache write */
+    if (numCores > 1 && (hit0 || hit1)) {
+      snoop(pAddr, true);
+    }
     cacheLine->dirty = true;
     writeAccesses++;
   } else {
@@ -321,6 +371,88 @@ void dcacheFlush(void) {
 }
 
 
+static void syncRange(Word pAddr, Word nBytes, Bool invalidate) {
+  Word addr;
+  unsigned int tag;
+  unsigned int index;
+  CacheLine *cacheLine;
+  int i;
+
+  for (addr = pAddr & ~offsetMask; addr < pAddr + nBytes; addr += lineSize) {
+    tag = (addr >> tagShift) & tagMask;
+    index = (addr >> indexShift) & indexMask;
+    for (i = 0; i < assoc; i++) {
+      cacheLine = i == 0 ? &cache[index].line_0 : &cache[index].line_1;
+      if (!cacheLine->valid || cacheLine->tag != tag) {
+        continue;
+      }
+      if (cacheLine->dirty) {
+        /* handle write-back */
+        writeLineToMemory(addr, cacheLine->data);
+        cacheLine->dirty = false;
+        memoryWrites++;
+      }
+      if (invalidate) {
+        cacheLine->valid = false;
+      }
+    }
+  }
+}
+
+
+/*
+ * The range operations keep the caches coherent with transfers
+ * which bypass them (DMA). Flushing writes dirty lines of the range
+ * back to memory; invalidating does the same and then discards
+ * the lines. Both act on the caches of all cores, and both fall
+ * back to the whole-cache operation if the range is at least as
+ * big as a cache.
+ */
+
+
+void dcacheFlushRange(Word pAddr, Word nBytes) {
+  CacheSet *current;
+  int core;
+
+  if (debug) {
+    cPrintf("**** dcache flush range: pAddr 0x%08X, %u bytes ****\n",
+            pAddr, nBytes);
+  }
+  current = cache;
+  for (core = 0; core < numCores; core++) {
+    cache = caches[core];
+    if (nBytes >= totalSize) {
+      dcacheFlush();
+    } else {
+      syncRange(pAddr, nBytes, false);
+    }
+  }
+  cache = current;
+}
+
+
+void dcacheInvalidateRange(Word pAddr, Word nBytes) {
+  CacheSet *current;
+  int core;
+
+  if (debug) {
+    cPrintf("**** dcache invalidate range: pAddr 0x%08X, %u bytes ****\n",
+            pAddr, nBytes);
+  }
+  current = cache;
+  for (core = 0; core < numCores; core++) {
+    cache = caches[core];
+    if (nBytes >= totalSize) {
+      dcacheFlush();
+      dcacheInvalidate();
+    } else {
+      syncRange(pAddr, nBytes, true);
+    }
+  }
+  cache = current;
+}
+
+
 /**************************************************************/
 
 
@@ -386,11 +518,30 @@ Bool dcacheProbe(Word pAddr, Word *data, Bool *dirty) {
 /**************************************************************/
 
 
+void dcacheSelectCore(int core) {
+  cache = caches[core];
+}
+
+
+/**************************************************************/
+
+
 void dcacheReset(void) {
+  CacheSet *current;
+  int core;
+
   cPrintf("Resetting Data Cache...\n");
   cPrintf("%6d sets * %d lines/set * %d bytes/line = %d bytes installed.\n",
           sets, assoc, lineSize, totalSize);
-  dcacheInvalidate();
+  if (numCores > 1) {
+    cPrintf("%6d caches installed, one per core.\n", numCores);
+  }
+  current = cache;
+  for (core = 0; core < numCores; core++) {
+    cache = caches[core];
+    dcacheInvalidate();
+  }
+  cache = current;
   readAccesses = 0;
   readMisses = 0;
   writeAccesses = 0;
@@ -399,9 +550,33 @@ void dcacheReset(void) {
 }
 
 
-void dcacheInit(int ldTotal, int ldLine, int ldAss) {
+static CacheSet *allocCache(void) {
+  CacheSet *newCache;
   unsigned int index;
 
+  newCache = malloc(sets * sizeof(CacheSet));
+  if (newCache == NULL) {
+    error("cannot allocate dcache");
+  }
+  for (index = 0; index < sets; index++) {
+    newCache[index].line_0.data = malloc(lineSize);
+    if (newCache[index].line_0.data == NULL) {
+      error("cannot allocate dcache data");
+    }
+    if (ldAssoc) {
+      newCache[index].line_1.data = malloc(lineSize);
+      if (newCache[index].line_1.data == NULL) {
+        error("cannot allocate dcache data");
+      }
+    }
+  }
+  return newCache;
+}
+
+
+void dcacheInit(int ldTotal, int ldLine, int ldAss, int nCores) {
+  int core;
+
   ldTotalSize = ldTotal;
   ldLineSize = ldLine;
   ldAssoc = ldAss;
@@ -426,34 +601,26 @@ void dcacheInit(int ldTotal, int ldLine, int ldAss) {
     cPrintf("**** dcache offset : shift = %2d, ", 0);
     cPrintf("bits = %2d, mask = 0x%08X ****\n", ldLineSize, offsetMask);
   }
-  cache = malloc(sets * sizeof(CacheSet));
-  if (cache == NULL) {
-    error("cannot allocate dcache");
-  }
-  for (index = 0; index < sets; index++) {
-    cache[index].line_0.data = malloc(lineSize);
-    if (cache[index].line_0.data == NULL) {
-      error("cannot allocate dcache data");
-    }
-    if (ldAssoc) {
-      cache[index].line_1.data = malloc(lineSize);
-      if (cache[index].line_1.data == NULL) {
-        error("cannot allocate dcache data");
-      }
-    }
+  numCores = nCores;
+  for (core = 0; core < numCores; core++) {
+    caches[core] = allocCache();
   }
+  cache = caches[0];
   dcacheReset();
 }
 
 
 void dcacheExit(void) {
   unsigned int index;
+  int core;
 
-  for (index = 0; index < sets; index++) {
-    free(cache[index].line_0.data);
-    if (ldAssoc) {
-      free(cache[index].line_1.data);
+  for (core = 0; core < numCores; core++) {
+    for (index = 0; index < sets; index++) {
+      free(caches[core][index].line_0.data);
+      if (ldAssoc) {
+        free(caches[core][index].line_1.data);
+      }
     }
+    free(caches[core]);
   }
-  free(cache);
 }
@@ -22,6 +22,8 @@ void dcacheWriteByte(Word pAddr, Byte data);
 
 void dcacheInvalidate(void);
 void dcacheFlush(void);
+void dcacheFlushRange(Word pAddr, Word nBytes);
+void dcacheInvalidateRange(Word pAddr, Word nBytes);
 
 long dcacheGetReadAccesses(void);
 long dcacheGetReadMisses(void);
@@ -31,8 +33,10 @@ long dcacheGetMemoryWrites(void);
 
 Bool dcacheProbe(Word pAddr, Word *data, Bool *dirty);
 
+void dcacheSelectCore(int core);
+
 void dcacheReset(void);
-void dcacheInit(int ldTotal, int ldLine, int ldAss);
+void dcacheInit(int ldTotal, int ldLine, int ldAss, int nCores);
 void dcacheExit(void);
 
 
@@ -0,0 +1,52 @@
+main.o: main.c common.h console.h error.h command.h instr.h cpu.h trace.h \
+ mmu.h icache.h dcache.h ram.h rom.h timer.h dsp.h kbd.h serial.h disk.h \
+ sdcard.h fpu.h bio.h output.h shutdown.h stats.h bprof.h graph1.h \
+ graph2.h mouse.h
+console.o: console.c common.h console.h error.h cpu.h getline/getline.h
+error.o: error.c common.h console.h error.h cpu.h trace.h mmu.h icache.h \
+ dcache.h ram.h rom.h timer.h dsp.h kbd.h serial.h disk.h sdcard.h fpu.h \
+ bio.h output.h shutdown.h graph1.h graph2.h mouse.h
+except.o: except.c error.h except.h
+command.o: command.c common.h console.h error.h except.h command.h asm.h \
+ disasm.h cpu.h trace.h mmu.h icache.h dcache.h ram.h rom.h io.h timer.h \
+ dsp.h kbd.h serial.h disk.h sdcard.h fpu.h bio.h output.h shutdown.h \
+ stats.h bprof.h graph1.h graph2.h mouse.h
+instr.o: instr.c common.h console.h error.h instr.h
+asm.o: asm.c common.h console.h error.h instr.h asm.h
+disasm.o: disasm.c common.h console.h error.h instr.h disasm.h
+cpu.o: cpu.c common.h console.h error.h except.h instr.h cpu.h trace.h \
+ mmu.h icache.h dcache.h timer.h bprof.h
+fpu.o: fpu.c common.h console.h error.h except.h fpu.h
+trace.o: trace.c common.h console.h error.h except.h disasm.h trace.h
+mmu.o: mmu.c common.h console.h error.h except.h cpu.h mmu.h icache.h \
+ dcache.h io.h
+icache.o: icache.c common.h console.h error.h icache.h ram.h rom.h
+dcache.o: dcache.c common.h console.h error.h dcache.h ram.h rom.h
+ram.o: ram.c common.h console.h error.h except.h ram.h
+rom.o: rom.c common.h console.h error.h except.h rom.h
+io.o: io.c common.h console.h error.h except.h io.h timer.h dsp.h kbd.h \
+ serial.h disk.h sdcard.h fpu.h bio.h output.h shutdown.h stats.h \
+ graph1.h graph2.h mouse.h
+timer.o: timer.c common.h console.h error.h except.h cpu.h timer.h
+dsp.o: dsp.c common.h console.h error.h except.h cpu.h timer.h dsp.h \
+ kbd.h font screen
+kbd.o: kbd.c common.h console.h error.h except.h cpu.h timer.h kbd.h
+serial.o: serial.c common.h console.h error.h except.h cpu.h timer.h \
+ serial.h
+disk.o: disk.c common.h console.h error.h except.h cpu.h timer.h disk.h
+sdcard.o: sdcard.c common.h console.h error.h except.h timer.h sdcard.h
+output.o: output.c common.h console.h error.h output.h
+shutdown.o: shutdown.c common.h console.h error.h cpu.h trace.h mmu.h \
+ icache.h dcache.h ram.h rom.h timer.h dsp.h kbd.h serial.h disk.h \
+ sdcard.h fpu.h bio.h output.h shutdown.h stats.h bprof.h graph1.h \
+ graph2.h mouse.h
+graph1.o: graph1.c common.h console.h error.h except.h graph1.h mouse.h \
+ kbd.h gr1splash
+graph2.o: graph2.c common.h console.h error.h except.h graph2.h mouse.h \
+ kbd.h gr2splash
+mouse.o: mouse.c common.h console.h error.h except.h cpu.h timer.h \
+ mouse.h
+bio.o: bio.c common.h console.h error.h bio.h
+stats.o: stats.c common.h console.h error.h cpu.h icache.h dcache.h \
+ stats.h
+bprof.o: bprof.c common.h console.h error.h bprof.h
@@ -13,7 +13,10 @@
 #include "error.h"
 #include "except.h"
 #include "cpu.h"
+#include "ram.h"
+#include "dcache.h"
 #include "timer.h"
+#include "hostio.h"
 #include "disk.h"
 
 
@@ -28,11 +31,26 @@ static Word diskCtrl;
 static Word diskCnt;
 static Word diskSct;
 static Word diskCap;
+static Word diskDsc;
+static Word diskNdsc;
 
 static Byte diskBuffer[8 * SECTOR_SIZE];
 
 static long lastSct;
 
+static Word dscIndex;
+static Word dscSct;
+static Word dscCnt;
+static Word dscAddr;
+static Byte *dscPtr;
+
+static HostIO diskIO;
+static Byte *ioBuffer = NULL;
+static Word ioBufSize = 0;
+static Bool ioValid;
+static Word ioSct;
+static Word ioCnt;
+
 
 static Word readWord(Byte *p) {
   Word data;
@@ -53,9 +71,146 @@ static void writeWord(Byte *p, Word data) {
 }
 
 
-static void diskCallback(int n) {
-  int numScts;
+/*
+ * The transfer to or from the disk image is handed to the
+ * host I/O worker when a command starts, and collected when
+ * the simulated seek is over. Data to be written is copied
+ * at the start of the command.
+ */
+
+
+static void ioStart(Word sct, Word cnt, Bool write, Byte *src) {
+  Word numBytes;
+
+  numBytes = cnt * SECTOR_SIZE;
+  if (numBytes > ioBufSize) {
+    ioBuffer = realloc(ioBuffer, numBytes);
+    if (ioBuffer == NULL) {
+      error("cannot allocate disk I/O buffer");
+    }
+    ioBufSize = numBytes;
+  }
+  if (write) {
+    memcpy(ioBuffer, src, numBytes);
+  }
+  diskIO.file = diskImage;
+  diskIO.offset = (long) sct * SECTOR_SIZE;
+  diskIO.buf = ioBuffer;
+  diskIO.size = numBytes;
+  diskIO.write = write;
+  hostioSubmit(&diskIO);
+}
+
+
+static void ioFinish(Byte *dst) {
+  if (!hostioWait(&diskIO)) {
+    if (diskIO.write) {
+      error("cannot write to disk image");
+    } else {
+      error("cannot read from disk image");
+    }
+  }
+  if (!diskIO.write) {
+    memcpy(dst, ioBuffer, diskIO.size);
+  }
+}
+
+
+/**************************************************************/
+
+
+/*
+ * DMA transfers: the controller works through a list of
+ * descriptors in RAM, each giving a first sector, a sector
+ * count, and a physical memory address. The descriptors are
+ * processed one after another, each one costing a seek just
+ * like a buffered command. DONE is set and the interrupt is
+ * raised only once, after the last descriptor, or after the
+ * first one that fails.
+ */
+
+
+static void diskCallback(int n);
+
+
+static void dmaDone(Bool err) {
+  if (err) {
+    diskCtrl |= DISK_ERR;
+  }
+  diskCtrl |= DISK_DONE;
+  if (diskCtrl & DISK_IEN) {
+    /* raise disk interrupt */
+    cpuSetInterrupt(IRQ_DISK);
+  }
+}
+
 
+static void dmaNext(void) {
+  Word pAddr;
+  Word dsc[DSC_SIZE / 4];
+  long delta;
+
+  if (dscIndex == diskNdsc) {
+    /* all descriptors processed */
+    dmaDone(false);
+    return;
+  }
+  /* fetch descriptor, it may still be in the data cache */
+  pAddr = diskDsc + dscIndex * DSC_SIZE;
+  if ((pAddr & 3) != 0 || ramMap(pAddr, DSC_SIZE) == NULL) {
+    dmaDone(true);
+    return;
+  }
+  dcacheFlushRange(pAddr, DSC_SIZE);
+  ramRead(pAddr, dsc, DSC_SIZE / 4);
+  dscSct = dsc[DSC_SCT / 4];
+  dscCnt = dsc[DSC_CNT / 4];
+  dscAddr = dsc[DSC_ADDR / 4];
+  dscPtr = ramMap(dscAddr, dscCnt * SECTOR_SIZE);
+  ioValid = dscCnt != 0 &&
+            dscSct < diskCap &&
+            dscCnt <= diskCap - dscSct &&
+            dscPtr != NULL;
+  if (ioValid) {
+    if (diskCtrl & DISK_WRT) {
+      /* memory --> disk */
+      dcacheFlushRange(dscAddr, dscCnt * SECTOR_SIZE);
+      ioStart(dscSct, dscCnt, true, dscPtr);
+    } else {
+      /* disk --> memory */
+      ioStart(dscSct, dscCnt, false, NULL);
+    }
+  }
+  delta = labs((long) dscSct - lastSct);
+  if (delta > diskCap) {
+    delta = diskCap;
+  }
+  timerStart(DISK_DELAY_USEC + (delta * DISK_SEEK_USEC) / diskCap,
+             diskCallback, 2);
+}
+
+
+static void dmaTransfer(void) {
+  if (!ioValid) {
+    /* bad descriptor */
+    dmaDone(true);
+    return;
+  }
+  if ((diskCtrl & DISK_WRT) == 0) {
+    /* the data cache must not hide the new memory contents */
+    dcacheInvalidateRange(dscAddr, dscCnt * SECTOR_SIZE);
+  }
+  ioFinish(dscPtr);
+  lastSct = (long) dscSct + (long) dscCnt - 1;
+  dscIndex++;
+  dmaNext();
+}
+
+
+/**************************************************************/
+
+
+static void diskCallback(int n) {
   if (debug) {
     cPrintf("\n**** DISK CALLBACK, n = %d ****\n", n);
   }
@@ -65,27 +220,16 @@ static void diskCallback(int n) {
     diskCtrl |= DISK_READY;
     return;
   }
+  if (n == 2) {
+    /* DMA transfer of one descriptor */
+    dmaTransfer();
+    return;
+  }
   /* disk read or write */
-  numScts = ((diskCnt - 1) & 0x07) + 1;
-  if (diskCap != 0 &&
-      diskSct < diskCap &&
-      diskSct + numScts <= diskCap) {
-    /* do the transfer */
-    if (fseek(diskImage, diskSct * SECTOR_SIZE, SEEK_SET) != 0) {
-      error("cannot position to sector in disk image");
-    }
-    if (diskCtrl & DISK_WRT) {
-      /* buffer --> disk */
-      if (fwrite(diskBuffer, SECTOR_SIZE, numScts, diskImage) != numScts) {
-        error("cannot write to disk image");
-      }
-    } else {
-      /* disk --> buffer */
-      if (fread(diskBuffer, SECTOR_SIZE, numScts, diskImage) != numScts) {
-        error("cannot read from disk image");
-      }
-    }
-    lastSct = (long) diskSct + (long) numScts - 1;
+  if (ioValid) {
+    /* finish the transfer */
+    ioFinish(diskBuffer);
+    lastSct = (long) ioSct + (long) ioCnt - 1;
   } else {
     /* sectors requested exceed disk capacity */
     /* or we have no disk at all */
@@ -121,6 +265,12 @@ Word diskRead(Word addr) {
   if (addr == DISK_CAP) {
     data = diskCap;
   } else
+  if (addr == DISK_DSC) {
+    data = diskDsc;
+  } else
+  if (addr == DISK_NDSC) {
+    data = diskNdsc;
+  } else
   if (addr & 0x80000) {
     /* buffer access */
     data = readWord(diskBuffer + (addr & 0x0FFC));
@@ -157,11 +307,27 @@ void diskWrite(Word addr, Word data) {
     } else {
       diskCtrl &= ~DISK_IEN;
     }
+    if (data & DISK_DMA) {
+      diskCtrl |= DISK_DMA;
+    } else {
+      diskCtrl &= ~DISK_DMA;
+    }
     if (data & DISK_STRT) {
       diskCtrl &= ~DISK_ERR;
       diskCtrl &= ~DISK_DONE;
       /* only start a disk operation if disk is present */
+      if (diskCap != 0 && (diskCtrl & DISK_DMA) != 0) {
+        dscIndex = 0;
+        dmaNext();
+      } else
       if (diskCap != 0) {
+        /* buffered transfer, at most 8 sectors */
+        ioSct = diskSct;
+        ioCnt = ((diskCnt - 1) & 0x07) + 1;
+        ioValid = ioSct < diskCap && ioSct + ioCnt <= diskCap;
+        if (ioValid) {
+          ioStart(ioSct, ioCnt, (diskCtrl & DISK_WRT) != 0, diskBuffer);
+        }
         delta = labs((long) diskSct - lastSct);
         if (delta > diskCap) {
           delta = diskCap;
@@ -189,6 +355,12 @@ void diskWrite(Word addr, Word data) {
     /* this register is read-only */
     throwException(EXC_BUS_TIMEOUT);
   } else
+  if (addr == DISK_DSC) {
+    diskDsc = data;
+  } else
+  if (addr == DISK_NDSC) {
+    diskNdsc = data;
+  } else
   if (addr & 0x80000) {
     /* buffer access */
     writeWord(diskBuffer + (addr & 0x0FFC), data);
@@ -205,10 +377,14 @@ void diskReset(void) {
     return;
   }
   cPrintf("Resetting Disk...\n");
+  /* a transfer may still be in progress */
+  (void) hostioWait(&diskIO);
   diskCtrl = 0;
   diskCnt = 0;
   diskSct = 0;
   diskCap = 0;
+  diskDsc = 0;
+  diskNdsc = 0;
   lastSct = 0;
   if (totalSectors != 0) {
     cPrintf("Disk of size %ld sectors (%ld bytes) installed.\n",
@@ -254,5 +430,7 @@ void diskExit(void) {
     /* disk not installed */
     return;
   }
+  /* let a pending transfer complete */
+  (void) hostioWait(&diskIO);
   fclose(diskImage);
 }
@@ -13,6 +13,8 @@
 #define DISK_CNT	4	/* sector count register */
 #define DISK_SCT	8	/* disk sector register */
 #define DISK_CAP	12	/* disk capacity register */
+#define DISK_DSC	16	/* DMA descriptor list address register */
+#define DISK_NDSC	20	/* DMA descriptor count register */
 
 #define DISK_STRT	0x01	/* a 1 written here starts the disk command */
 #define DISK_IEN	0x02	/* enable disk interrupt */
@@ -20,6 +22,12 @@
 #define DISK_ERR	0x08	/* 0 = ok, 1 = error; valid when DONE = 1 */
 #define DISK_DONE	0x10	/* 1 = disk has finished the command */
 #define DISK_READY	0x20	/* 1 = capacity valid, disk accepts command */
+#define DISK_DMA	0x40	/* transfer: 0 = buffer, 1 = descriptor list */
+
+#define DSC_SCT		0	/* descriptor: first disk sector */
+#define DSC_CNT		4	/* descriptor: number of sectors */
+#define DSC_ADDR	8	/* descriptor: physical memory address */
+#define DSC_SIZE	12	/* size of a descriptor in bytes */
 
 #define DISK_DELAY_USEC	10000	/* seek start/settle + rotational delay */
 #define DISK_SEEK_USEC	50000	/* full disk seek time */
@@ -24,6 +24,7 @@
 #include "serial.h"
 #include "disk.h"
 #include "sdcard.h"
+#include "fpu.h"
 #include "bio.h"
 #include "output.h"
 #include "shutdown.h"
@@ -51,6 +52,7 @@ void error(char *fmt, ...) {
   serialExit();
   diskExit();
   sdcardExit();
+  fpuExit();
   bioExit();
   outputExit();
   shutdownExit();
@@ -6,38 +6,1614 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <setjmp.h>
+#include <float.h>
+#include <fenv.h>
+#include <math.h>
 
 #include "common.h"
 #include "console.h"
 #include "error.h"
+#include "except.h"
 #include "fpu.h"
 
 
+/*
+ * The FPU implements IEEE 754 single and double precision
+ * arithmetic. Tininess is detected after rounding, and every
+ * operation which delivers a NaN delivers the default NaN
+ * (0x7FC00000 and 0x7FF8000000000000, respectively).
+ *
+ * Each operation is computed bit-exactly in software below.
+ * If the host's arithmetic is IEEE single and double precision
+ * with the same four rounding modes, the basic operations
+ * use the host instead, and NaN results are replaced by the
+ * default NaN, so that both paths deliver identical results
+ * and exception flags.
+ */
+
+
+#if defined(FE_TONEAREST) && defined(FE_TOWARDZERO) && \
+    defined(FE_DOWNWARD) && defined(FE_UPWARD) && \
+    defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+#define HOST_FP		1
+#else
+#define HOST_FP		0
+#endif
+
+
+#define SGN(x)		((x) & 0x80000000)
+#define EXP(x)		(((x) << 1) >> 24)
+#define FRC(x)		((x) & 0x7FFFFF)
+#define PACK(s,e,f)	(((Word) (s) << 31) + ((Word) (e) << 23) + (f))
+
+#define DEFAULT_NAN	0x7FC00000
+#define DEFAULT_NAND	0x7FF8000000000000ULL
+#define IS_NAN(x)	((~(x) & 0x7F800000) == 0 && FRC(x) != 0)
+#define IS_SNAN(x)	(((x) & 0x7FC00000) == 0x7F800000 && \
+			 ((x) & 0x003FFFFF) != 0)
+
+#define SGND(x)		((x) >> 63)
+#define EXPD(x)		((int) ((x) >> 52) & 0x7FF)
+#define FRCD(x)		((x) & 0x000FFFFFFFFFFFFFULL)
+#define PACKD(s,e,f)	(((Dword) (s) << 63) + ((Dword) (e) << 52) + (f))
+#define IS_NAND(x)	(EXPD(x) == 0x7FF && FRCD(x) != 0)
+#define IS_SNAND(x)	(IS_NAND(x) && ((x) & 0x0008000000000000ULL) == 0)
+
+
+typedef union {
+  float f;
+  Word w;
+} FP_Word;
+
+typedef union {
+  double d;
+  Dword w;
+} FP_Dword;
+
+
+static int roundMode;		/* one of FPU_RND_xxx */
+static int flags;		/* accumulated FPU_X_xxx bits */
+static Bool hostFP;		/* use host arithmetic if possible */
+
+static Word regs[FPU_NREGS];	/* register file */
+static Word result;		/* integer result register */
+
+/*
+ * Each core has its own FPU. The state of the core which is
+ * currently executing lives in the variables above (hostFP is
+ * a setting of the simulator, not FPU state), the state of all
+ * other cores is parked in the array below.
+ */
+
+typedef struct {
+  Word regs[FPU_NREGS];
+  Word result;
+  int roundMode;
+  int flags;
+} FPU_State;
+
+static int numCores;
+static int curCore;
+static FPU_State cores[MAX_NCORES];
+
+
+/**************************************************************/
+
+/*
+ * software implementation, single precision
+ */
+
+
+static Byte clzTable[128] = {
+  8, 7, 6, 6, 5, 5, 5, 5, 4, 4, 4, 4, 4, 4, 4, 4,
+  3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+  2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+  2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+};
+
+
+static int clz(Word x) {
+  int n;
+
+  n = 0;
+  if (x < 0x10000) {
+    n += 16;
+    x <<= 16;
+  }
+  if (x < 0x1000000) {
+    n += 8;
+    x <<= 8;
+  }
+  x >>= 24;
+  return n + (x < 128 ? clzTable[x] : 0);
+}
+
+
+static Word shiftRightJam(Word x, int dist) {
+  if (dist < 31) {
+    return (x >> dist) | ((x << (-dist & 31)) != 0);
+  }
+  return x != 0;
+}
+
+
+static Word propagateNaN(Word x, Word y) {
+  if (IS_SNAN(x) || IS_SNAN(y)) {
+    flags |= FPU_X_INVALID;
+  }
+  return DEFAULT_NAN;
+}
+
+
+static Word invalid(void) {
+  flags |= FPU_X_INVALID;
+  return DEFAULT_NAN;
+}
+
+
+/*
+ * Round and pack a result. The significand has its leading
+ * bit at position 30 and 7 rounding bits, exp is the biased
+ * exponent of the result minus 1.
+ */
+static Word roundPack(int sign, int exp, Word sig) {
+  int nearEven;
+  Word incr;
+  Word bits;
+  Bool tiny;
+
+  nearEven = (roundMode == FPU_RND_NEAR);
+  incr = 0x40;
+  if (!nearEven) {
+    incr = (roundMode == (sign ? FPU_RND_DOWN : FPU_RND_UP)) ? 0x7F : 0;
+  }
+  bits = sig & 0x7F;
+  if ((unsigned) exp >= 0xFD) {
+    if (exp < 0) {
+      tiny = exp < -1 || sig + incr < 0x80000000;
+      sig = shiftRightJam(sig, -exp);
+      exp = 0;
+      bits = sig & 0x7F;
+      if (tiny && bits != 0) {
+        flags |= FPU_X_UNDER;
+      }
+    } else
+    if (exp > 0xFD || sig + incr >= 0x80000000) {
+      flags |= FPU_X_OVER | FPU_X_INEXACT;
+      return PACK(sign, 0xFF, 0) - (incr == 0);
+    }
+  }
+  sig = (sig + incr) >> 7;
+  if (bits != 0) {
+    flags |= FPU_X_INEXACT;
+  }
+  if (bits == 0x40 && nearEven) {
+    sig &= ~1;
+  }
+  if (sig == 0) {
+    exp = 0;
+  }
+  return PACK(sign, exp, sig);
+}
+
+
+static Word normRoundPack(int sign, int exp, Word sig) {
+  int dist;
+
+  dist = clz(sig) - 1;
+  exp -= dist;
+  if (dist >= 7 && (unsigned) exp < 0xFD) {
+    return PACK(sign, sig != 0 ? exp : 0, sig << (dist - 7));
+  }
+  return roundPack(sign, exp, sig << dist);
+}
+
+
+static void normSubnormal(int *expP, Word *sigP) {
+  int dist;
+
+  dist = clz(*sigP) - 8;
+  *expP = 1 - dist;
+  *sigP <<= dist;
+}
+
+
+static Word addMags(Word x, Word y) {
+  int expX, expY, expZ, diff;
+  Word sigX, sigY, sigZ;
+  int sign;
+
+  expX = EXP(x);
+  sigX = FRC(x);
+  expY = EXP(y);
+  sigY = FRC(y);
+  sign = SGN(x) != 0;
+  diff = expX - expY;
+  if (diff == 0) {
+    if (expX == 0) {
+      return x + sigY;
+    }
+    if (expX == 0xFF) {
+      if (sigX | sigY) {
+        return propagateNaN(x, y);
+      }
+      return x;
+    }
+    expZ = expX;
+    sigZ = 0x01000000 + sigX + sigY;
+    if ((sigZ & 1) == 0 && expZ < 0xFE) {
+      return PACK(sign, expZ, sigZ >> 1);
+    }
+    sigZ <<= 6;
+  } else {
+    sigX <<= 6;
+    sigY <<= 6;
+    if (diff < 0) {
+      if (expY == 0xFF) {
+        if (sigY) {
+          return propagateNaN(x, y);
+        }
+        return PACK(sign, 0xFF, 0);
+      }
+      expZ = expY;
+      sigX += expX ? 0x20000000 : sigX;
+      sigX = shiftRightJam(sigX, -diff);
+    } else {
+      if (expX == 0xFF) {
+        if (sigX) {
+          return propagateNaN(x, y);
+        }
+        return x;
+      }
+      expZ = expX;
+      sigY += expY ? 0x20000000 : sigY;
+      sigY = shiftRightJam(sigY, diff);
+    }
+    sigZ = 0x20000000 + sigX + sigY;
+    if (sigZ < 0x40000000) {
+      expZ--;
+      sigZ <<= 1;
+    }
+  }
+  return roundPack(sign, expZ, sigZ);
+}
+
+
+static Word subMags(Word x, Word y) {
+  int expX, expY, expZ, diff, dist;
+  Word sigX, sigY, sigA, sigB;
+  int sigDiff;
+  int sign;
+
+  expX = EXP(x);
+  sigX = FRC(x);
+  expY = EXP(y);
+  sigY = FRC(y);
+  sign = SGN(x) != 0;
+  diff = expX - expY;
+  if (diff == 0) {
+    if (expX == 0xFF) {
+      if (sigX | sigY) {
+        return propagateNaN(x, y);
+      }
+      return invalid();
+    }
+    sigDiff = sigX - sigY;
+    if (sigDiff == 0) {
+      return PACK(roundMode == FPU_RND_DOWN, 0, 0);
+    }
+    if (expX != 0) {
+      expX--;
+    }
+    if (sigDiff < 0) {
+      sign = !sign;
+      sigDiff = -sigDiff;
+    }
+    dist = clz(sigDiff) - 8;
+    expZ = expX - dist;
+    if (expZ < 0) {
+      dist = expX;
+      expZ = 0;
+    }
+    return PACK(sign, expZ, (Word) sigDiff << dist);
+  }
+  sigX <<= 7;
+  sigY <<= 7;
+  if (diff < 0) {
+    sign = !sign;
+    if (expY == 0xFF) {
+      if (sigY) {
+        return propagateNaN(x, y);
+      }
+      return PACK(sign, 0xFF, 0);
+    }
+    expZ = expY - 1;
+    sigA = sigY | 0x40000000;
+    sigB = sigX + (expX ? 0x40000000 : sigX);
+    diff = -diff;
+  } else {
+    if (expX == 0xFF) {
+      if (sigX) {
+        return propagateNaN(x, y);
+      }
+      return x;
+    }
+    expZ = expX - 1;
+    sigA = sigX | 0x40000000;
+    sigB = sigY + (expY ? 0x40000000 : sigY);
+  }
+  return normRoundPack(sign, expZ, sigA - shiftRightJam(sigB, diff));
+}
+
+
+static Word softAdd(Word x, Word y) {
+  if (SGN(x ^ y) == 0) {
+    return addMags(x, y);
+  }
+  return subMags(x, y);
+}
+
+
+static Word softMul(Word x, Word y) {
+  int expX, expY, expZ;
+  Word sigX, sigY, sigZ;
+  Dword prod;
+  int sign;
+
+  expX = EXP(x);
+  sigX = FRC(x);
+  expY = EXP(y);
+  sigY = FRC(y);
+  sign = SGN(x ^ y) != 0;
+  if (expX == 0xFF || expY == 0xFF) {
+    if ((expX == 0xFF && sigX) || (expY == 0xFF && sigY)) {
+      return propagateNaN(x, y);
+    }
+    if ((expX == 0 && sigX == 0) || (expY == 0 && sigY == 0)) {
+      /* infinity times zero */
+      return invalid();
+    }
+    return PACK(sign, 0xFF, 0);
+  }
+  if (expX == 0) {
+    if (sigX == 0) {
+      return PACK(sign, 0, 0);
+    }
+    normSubnormal(&expX, &sigX);
+  }
+  if (expY == 0) {
+    if (sigY == 0) {
+      return PACK(sign, 0, 0);
+    }
+    normSubnormal(&expY, &sigY);
+  }
+  expZ = expX + expY - 0x7F;
+  sigX = (sigX | 0x00800000) << 7;
+  sigY = (sigY | 0x00800000) << 8;
+  prod = (Dword) sigX * sigY;
+  sigZ = (Word) (prod >> 32) | ((Word) prod != 0);
+  if (sigZ < 0x40000000) {
+    expZ--;
+    sigZ <<= 1;
+  }
+  return roundPack(sign, expZ, sigZ);
+}
+
+
+static Word softDiv(Word x, Word y) {
+  int expX, expY, expZ;
+  Word sigX, sigY, sigZ;
+  Dword dividend;
+  int sign;
+
+  expX = EXP(x);
+  sigX = FRC(x);
+  expY = EXP(y);
+  sigY = FRC(y);
+  sign = SGN(x ^ y) != 0;
+  if (expX == 0xFF) {
+    if (sigX || (expY == 0xFF && sigY)) {
+      return propagateNaN(x, y);
+    }
+    if (expY == 0xFF) {
+      /* infinity divided by infinity */
+      return invalid();
+    }
+    return PACK(sign, 0xFF, 0);
+  }
+  if (expY == 0xFF) {
+    if (sigY) {
+      return propagateNaN(x, y);
+    }
+    return PACK(sign, 0, 0);
+  }
+  if (expY == 0) {
+    if (sigY == 0) {
+      if (expX == 0 && sigX == 0) {
+        /* zero divided by zero */
+        return invalid();
+      }
+      flags |= FPU_X_DIVZERO;
+      return PACK(sign, 0xFF, 0);
+    }
+    normSubnormal(&expY, &sigY);
+  }
+  if (expX == 0) {
+    if (sigX == 0) {
+      return PACK(sign, 0, 0);
+    }
+    normSubnormal(&expX, &sigX);
+  }
+  expZ = expX - expY + 0x7E;
+  sigX |= 0x00800000;
+  sigY |= 0x00800000;
+  if (sigX < sigY) {
+    expZ--;
+    dividend = (Dword) sigX << 31;
+  } else {
+    dividend = (Dword) sigX << 30;
+  }
+  sigZ = dividend / sigY;
+  if ((sigZ & 0x3F) == 0) {
+    sigZ |= ((Dword) sigY * sigZ != dividend);
+  }
+  return roundPack(sign, expZ, sigZ);
+}
+
+
+static Word softSqrt(Word x) {
+  int expX, expZ;
+  Word sigX, sigZ;
+  Dword n, r;
+
+  expX = EXP(x);
+  sigX = FRC(x);
+  if (expX == 0xFF) {
+    if (sigX) {
+      return propagateNaN(x, 0);
+    }
+    if (SGN(x) == 0) {
+      return x;
+    }
+    return invalid();
+  }
+  if (SGN(x) != 0) {
+    if (expX == 0 && sigX == 0) {
+      /* sqrt(-0) = -0 */
+      return x;
+    }
+    return invalid();
+  }
+  if (expX == 0) {
+    if (sigX == 0) {
+      return x;
+    }
+    normSubnormal(&expX, &sigX);
+  }
+  /* the unbiased exponent must be even for halving it */
+  sigX |= 0x00800000;
+  if (((expX - 0x7F) & 1) != 0) {
+    sigX <<= 1;
+    expX--;
+  }
+  expZ = (expX - 0x7F) / 2 + 0x7E;
+  /* integer square root of the significand, scaled to 31 bits */
+  n = (Dword) sigX << 37;
+  r = (Dword) sqrt((double) n);
+  while (r * r > n) {
+    r--;
+  }
+  while ((r + 1) * (r + 1) <= n) {
+    r++;
+  }
+  sigZ = (Word) r | (r * r != n);
+  return roundPack(0, expZ, sigZ);
+}
+
+
+static Word softItoF(Word x) {
+  int sign;
+  Word absX;
+
+  if ((x & 0x7FFFFFFF) == 0) {
+    /* 0 or -2^31 */
+    return x == 0 ? 0 : PACK(1, 0x9E, 0);
+  }
+  sign = SGN(x) != 0;
+  absX = sign ? -x : x;
+  return normRoundPack(sign, 0x9C, absX);
+}
+
+
+/**************************************************************/
+
+/*
+ * software implementation, double precision
+ */
+
+
+static int clzD(Dword x) {
+  if ((x >> 32) != 0) {
+    return clz(x >> 32);
+  }
+  return 32 + clz(x);
+}
+
+
+static Dword shiftRightJamD(Dword x, int dist) {
+  if (dist < 63) {
+    return (x >> dist) | ((x << (-dist & 63)) != 0);
+  }
+  return x != 0;
+}
+
+
+static Dword propagateNaND(Dword x, Dword y) {
+  if (IS_SNAND(x) || IS_SNAND(y)) {
+    flags |= FPU_X_INVALID;
+  }
+  return DEFAULT_NAND;
+}
+
+
+static Dword invalidD(void) {
+  flags |= FPU_X_INVALID;
+  return DEFAULT_NAND;
+}
+
+
+/*
+ * Round and pack a result. The significand has its leading
+ * bit at position 62 and 10 rounding bits, exp is the biased
+ * exponent of the result minus 1.
+ */
+static Dword roundPackD(int sign, int exp, Dword sig) {
+  int nearEven;
+  Dword incr;
+  Dword bits;
+  Bool tiny;
+
+  nearEven = (roundMode == FPU_RND_NEAR);
+  incr = 0x200;
+  if (!nearEven) {
+    incr = (roundMode == (sign ? FPU_RND_DOWN : FPU_RND_UP)) ? 0x3FF : 0;
+  }
+  bits = sig & 0x3FF;
+  if ((unsigned) exp >= 0x7FD) {
+    if (exp < 0) {
+      tiny = exp < -1 || sig + incr < 0x8000000000000000ULL;
+      sig = shiftRightJamD(sig, -exp);
+      exp = 0;
+      bits = sig & 0x3FF;
+      if (tiny && bits != 0) {
+        flags |= FPU_X_UNDER;
+      }
+    } else
+    if (exp > 0x7FD || sig + incr >= 0x8000000000000000ULL) {
+      flags |= FPU_X_OVER | FPU_X_INEXACT;
+      return PACKD(sign, 0x7FF, 0) - (incr == 0);
+    }
+  }
+  sig = (sig + incr) >> 10;
+  if (bits != 0) {
+    flags |= FPU_X_INEXACT;
+  }
+  if (bits == 0x200 && nearEven) {
+    sig &= ~1ULL;
+  }
+  if (sig == 0) {
+    exp = 0;
+  }
+  return PACKD(sign, exp, sig);
+}
+
+
+static Dword normRoundPackD(int sign, int exp, Dword sig) {
+  int dist;
+
+  dist = clzD(sig) - 1;
+  exp -= dist;
+  if (dist >= 10 && (unsigned) exp < 0x7FD) {
+    return PACKD(sign, sig != 0 ? exp : 0, sig << (dist - 10));
+  }
+  return roundPackD(sign, exp, sig << dist);
+}
+
+
+static void normSubnormalD(int *expP, Dword *sigP) {
+  int dist;
+
+  dist = clzD(*sigP) - 11;
+  *expP = 1 - dist;
+  *sigP <<= dist;
+}
+
+
+static Dword addMagsD(Dword x, Dword y) {
+  int expX, expY, expZ, diff;
+  Dword sigX, sigY, sigZ;
+  int sign;
+
+  expX = EXPD(x);
+  sigX = FRCD(x);
+  expY = EXPD(y);
+  sigY = FRCD(y);
+  sign = SGND(x);
+  diff = expX - expY;
+  if (diff == 0) {
+    if (expX == 0) {
+      return x + sigY;
+    }
+    if (expX == 0x7FF) {
+      if (sigX | sigY) {
+        return propagateNaND(x, y);
+      }
+      return x;
+    }
+    expZ = expX;
+    sigZ = (0x0020000000000000ULL + sigX + sigY) << 9;
+  } else {
+    sigX <<= 9;
+    sigY <<= 9;
+    if (diff < 0) {
+      if (expY == 0x7FF) {
+        if (sigY) {
+          return propagateNaND(x, y);
+        }
+        return PACKD(sign, 0x7FF, 0);
+      }
+      expZ = expY;
+      sigX += expX ? 0x2000000000000000ULL : sigX;
+      sigX = shiftRightJamD(sigX, -diff);
+    } else {
+      if (expX == 0x7FF) {
+        if (sigX) {
+          return propagateNaND(x, y);
+        }
+        return x;
+      }
+      expZ = expX;
+      sigY += expY ? 0x2000000000000000ULL : sigY;
+      sigY = shiftRightJamD(sigY, diff);
+    }
+    sigZ = 0x2000000000000000ULL + sigX + sigY;
+    if (sigZ < 0x4000000000000000ULL) {
+      expZ--;
+      sigZ <<= 1;
+    }
+  }
+  return roundPackD(sign, expZ, sigZ);
+}
+
+
+static Dword subMagsD(Dword x, Dword y) {
+  int expX, expY, expZ, diff, dist;
+  Dword sigX, sigY, sigZ;
+  long long sigDiff;
+  int sign;
+
+  expX = EXPD(x);
+  sigX = FRCD(x);
+  expY = EXPD(y);
+  sigY = FRCD(y);
+  sign = SGND(x);
+  diff = expX - expY;
+  if (diff == 0) {
+    if (expX == 0x7FF) {
+      if (sigX | sigY) {
+        return propagateNaND(x, y);
+      }
+      return invalidD();
+    }
+    sigDiff = sigX - sigY;
+    if (sigDiff == 0) {
+      return PACKD(roundMode == FPU_RND_DOWN, 0, 0);
+    }
+    if (expX != 0) {
+      expX--;
+    }
+    if (sigDiff < 0) {
+      sign = !sign;
+      sigDiff = -sigDiff;
+    }
+    dist = clzD(sigDiff) - 11;
+    expZ = expX - dist;
+    if (expZ < 0) {
+      dist = expX;
+      expZ = 0;
+    }
+    return PACKD(sign, expZ, (Dword) sigDiff << dist);
+  }
+  sigX <<= 10;
+  sigY <<= 10;
+  if (diff < 0) {
+    sign = !sign;
+    if (expY == 0x7FF) {
+      if (sigY) {
+        return propagateNaND(x, y);
+      }
+      return PACKD(sign, 0x7FF, 0);
+    }
+    sigX += expX ? 0x4000000000000000ULL : sigX;
+    sigX = shiftRightJamD(sigX, -diff);
+    expZ = expY;
+    sigZ = (sigY | 0x4000000000000000ULL) - sigX;
+  } else {
+    if (expX == 0x7FF) {
+      if (sigX) {
+        return propagateNaND(x, y);
+      }
+      return x;
+    }
+    sigY += expY ? 0x4000000000000000ULL : sigY;
+    sigY = shiftRightJamD(sigY, diff);
+    expZ = expX;
+    sigZ = (sigX | 0x4000000000000000ULL) - sigY;
+  }
+  return normRoundPackD(sign, expZ - 1, sigZ);
+}
+
+
+static Dword softAddD(Dword x, Dword y) {
+  if (SGND(x ^ y) == 0) {
+    return addMagsD(x, y);
+  }
+  return subMagsD(x, y);
+}
+
+
+/*
+ * Multiply two 64-bit numbers, deliver the high-order
+ * 64 bits of the product, and jam the low-order bits.
+ */
+static Dword mulJamD(Dword x, Dword y) {
+  Dword x0, x1, y0, y1;
+  Dword p00, p01, p10, p11;
+  Dword mid, lo, hi;
+
+  x0 = x & 0xFFFFFFFF;
+  x1 = x >> 32;
+  y0 = y & 0xFFFFFFFF;
+  y1 = y >> 32;
+  p00 = x0 * y0;
+  p01 = x0 * y1;
+  p10 = x1 * y0;
+  p11 = x1 * y1;
+  mid = (p00 >> 32) + (p01 & 0xFFFFFFFF) + (p10 & 0xFFFFFFFF);
+  lo = (mid << 32) | (p00 & 0xFFFFFFFF);
+  hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+  return hi | (lo != 0);
+}
+
+
+static Dword softMulD(Dword x, Dword y) {
+  int expX, expY, expZ;
+  Dword sigX, sigY, sigZ;
+  int sign;
+
+  expX = EXPD(x);
+  sigX = FRCD(x);
+  expY = EXPD(y);
+  sigY = FRCD(y);
+  sign = SGND(x ^ y);
+  if (expX == 0x7FF || expY == 0x7FF) {
+    if ((expX == 0x7FF && sigX) || (expY == 0x7FF && sigY)) {
+      return propagateNaND(x, y);
+    }
+    if ((expX == 0 && sigX == 0) || (expY == 0 && sigY == 0)) {
+      /* infinity times zero */
+      return invalidD();
+    }
+    return PACKD(sign, 0x7FF, 0);
+  }
+  if (expX == 0) {
+    if (sigX == 0) {
+      return PACKD(sign, 0, 0);
+    }
+    normSubnormalD(&expX, &sigX);
+  }
+  if (expY == 0) {
+    if (sigY == 0) {
+      return PACKD(sign, 0, 0);
+    }
+    normSubnormalD(&expY, &sigY);
+  }
+  expZ = expX + expY - 0x3FF;
+  sigX = (sigX | 0x0010000000000000ULL) << 10;
+  sigY = (sigY | 0x0010000000000000ULL) << 11;
+  sigZ = mulJamD(sigX, sigY);
+  if (sigZ < 0x4000000000000000ULL) {
+    expZ--;
+    sigZ <<= 1;
+  }
+  return roundPackD(sign, expZ, sigZ);
+}
+
+
+static Dword softDivD(Dword x, Dword y) {
+  int expX, expY, expZ;
+  Dword sigX, sigY, sigZ;
+  int sign;
+  int i, n;
+
+  expX = EXPD(x);
+  sigX = FRCD(x);
+  expY = EXPD(y);
+  sigY = FRCD(y);
+  sign = SGND(x ^ y);
+  if (expX == 0x7FF) {
+    if (sigX || (expY == 0x7FF && sigY)) {
+      return propagateNaND(x, y);
+    }
+    if (expY == 0x7FF) {
+      /* infinity divided by infinity */
+      return invalidD();
+    }
+    return PACKD(sign, 0x7FF, 0);
+  }
+  if (expY == 0x7FF) {
+    if (sigY) {
+      return propagateNaND(x, y);
+    }
+    return PACKD(sign, 0, 0);
+  }
+  if (expY == 0) {
+    if (sigY == 0) {
+      if (expX == 0 && sigX == 0) {
+        /* zero divided by zero */
+        return invalidD();
+      }
+      flags |= FPU_X_DIVZERO;
+      return PACKD(sign, 0x7FF, 0);
+    }
+    normSubnormalD(&expY, &sigY);
+  }
+  if (expX == 0) {
+    if (sigX == 0) {
+      return PACKD(sign, 0, 0);
+    }
+    normSubnormalD(&expX, &sigX);
+  }
+  expZ = expX - expY + 0x3FE;
+  sigX |= 0x0010000000000000ULL;
+  sigY |= 0x0010000000000000ULL;
+  /* long division, quotient gets its leading bit at 62 */
+  sigZ = 0;
+  n = 62;
+  if (sigX < sigY) {
+    expZ--;
+    n = 63;
+  } else {
+    sigZ = 1;
+    sigX -= sigY;
+  }
+  for (i = 0; i < n; i++) {
+    sigX <<= 1;
+    sigZ <<= 1;
+    if (sigX >= sigY) {
+      sigX -= sigY;
+      sigZ |= 1;
+    }
+  }
+  return roundPackD(sign, expZ, sigZ | (sigX != 0));
+}
+
+
+static Dword softSqrtD(Dword x) {
+  int expX, expZ;
+  Dword sigX, hi, lo;
+  Dword rem, root, trial;
+  int pos;
+
+  expX = EXPD(x);
+  sigX = FRCD(x);
+  if (expX == 0x7FF) {
+    if (sigX) {
+      return propagateNaND(x, 0);
+    }
+    if (SGND(x) == 0) {
+      return x;
+    }
+    return invalidD();
+  }
+  if (SGND(x) != 0) {
+    if (expX == 0 && sigX == 0) {
+      /* sqrt(-0) = -0 */
+      return x;
+    }
+    return invalidD();
+  }
+  if (expX == 0) {
+    if (sigX == 0) {
+      return x;
+    }
+    normSubnormalD(&expX, &sigX);
+  }
+  /* the unbiased exponent must be even for halving it */
+  sigX |= 0x0010000000000000ULL;
+  if (((expX - 0x3FF) & 1) != 0) {
+    sigX <<= 1;
+    expX--;
+  }
+  expZ = (expX - 0x3FF) / 2 + 0x3FE;
+  /* digit-by-digit square root of sigX * 2^56, 55 bits */
+  hi = sigX >> 8;
+  lo = sigX << 56;
+  rem = 0;
+  root = 0;
+  for (pos = 108; pos >= 0; pos -= 2) {
+    rem <<= 2;
+    rem |= (pos >= 64 ? hi >> (pos - 64) : lo >> pos) & 3;
+    trial = (root << 2) | 1;
+    root <<= 1;
+    if (rem >= trial) {
+      rem -= trial;
+      root |= 1;
+    }
+  }
+  return roundPackD(0, expZ, (root << 8) | (rem != 0));
+}
+
+
+static Dword softItoD(Word x) {
+  int sign;
+  Word absX;
+  int dist;
+
+  if (x == 0) {
+    return 0;
+  }
+  sign = SGN(x) != 0;
+  absX = sign ? -x : x;
+  dist = clz(absX) + 21;
+  return PACKD(sign, 0x432 - dist, (Dword) absX << dist);
+}
+
+
+static Dword softFtoD(Word x) {
+  int exp;
+  Word frc;
+  int sign;
+
+  exp = EXP(x);
+  frc = FRC(x);
+  sign = SGN(x) != 0;
+  if (exp == 0xFF) {
+    if (frc) {
+      if (IS_SNAN(x)) {
+        flags |= FPU_X_INVALID;
+      }
+      return DEFAULT_NAND;
+    }
+    return PACKD(sign, 0x7FF, 0);
+  }
+  if (exp == 0) {
+    if (frc == 0) {
+      return PACKD(sign, 0, 0);
+    }
+    normSubnormal(&exp, &frc);
+    exp--;
+  }
+  return PACKD(sign, exp + 0x380, (Dword) frc << 29);
+}
+
+
+static Word softDtoF(Dword x) {
+  int exp;
+  Dword frc;
+  Word sig;
+  int sign;
+
+  exp = EXPD(x);
+  frc = FRCD(x);
+  sign = SGND(x);
+  if (exp == 0x7FF) {
+    if (frc) {
+      if (IS_SNAND(x)) {
+        flags |= FPU_X_INVALID;
+      }
+      return DEFAULT_NAN;
+    }
+    return PACK(sign, 0xFF, 0);
+  }
+  sig = (frc >> 22) | ((frc & 0x3FFFFF) != 0);
+  if ((exp | sig) == 0) {
+    return PACK(sign, 0, 0);
+  }
+  return roundPack(sign, exp - 0x381, sig | 0x40000000);
+}
+
+
+/**************************************************************/
+
+/*
+ * host implementation
+ */
+
+
+#if HOST_FP
+
+static int hostRound[4] = {
+  FE_TONEAREST,
+  FE_TOWARDZERO,
+  FE_DOWNWARD,
+  FE_UPWARD,
+};
+
+
+static void hostBegin(void) {
+  if (roundMode != FPU_RND_NEAR) {
+    fesetround(hostRound[roundMode]);
+  }
+  feclearexcept(FE_ALL_EXCEPT);
+}
+
+
+static void hostEnd(void) {
+  int exc;
+
+  exc = fetestexcept(FE_ALL_EXCEPT);
+  if (roundMode != FPU_RND_NEAR) {
+    fesetround(FE_TONEAREST);
+  }
+  if (exc & FE_INEXACT) {
+    flags |= FPU_X_INEXACT;
+  }
+  if (exc & FE_UNDERFLOW) {
+    flags |= FPU_X_UNDER;
+  }
+  if (exc & FE_OVERFLOW) {
+    flags |= FPU_X_OVER;
+  }
+  if (exc & FE_DIVBYZERO) {
+    flags |= FPU_X_DIVZERO;
+  }
+  if (exc & FE_INVALID) {
+    flags |= FPU_X_INVALID;
+  }
+}
+
+
+static Word hostOp(int op, Word x, Word y) {
+  FP_Word a, b;
+  volatile FP_Word z;
+
+  a.w = x;
+  b.w = y;
+  hostBegin();
+  switch (op) {
+    case FPU_OP_ADD:
+      z.f = a.f + b.f;
+      break;
+    case FPU_OP_SUB:
+      z.f = a.f - b.f;
+      break;
+    case FPU_OP_MUL:
+      z.f = a.f * b.f;
+      break;
+    case FPU_OP_DIV:
+      z.f = a.f / b.f;
+      break;
+    case FPU_OP_SQRT:
+      z.f = sqrtf(a.f);
+      break;
+    case FPU_OP_ITOF:
+      z.f = (float) (int) x;
+      break;
+  }
+  hostEnd();
+  if (IS_NAN(z.w)) {
+    return DEFAULT_NAN;
+  }
+  return z.w;
+}
+
+
+static Dword hostOpD(int op, Dword x, Dword y) {
+  FP_Dword a, b;
+  volatile FP_Dword z;
+
+  a.w = x;
+  b.w = y;
+  hostBegin();
+  switch (op) {
+    case FPU_OP_ADD:
+      z.d = a.d + b.d;
+      break;
+    case FPU_OP_SUB:
+      z.d = a.d - b.d;
+      break;
+    case FPU_OP_MUL:
+      z.d = a.d * b.d;
+      break;
+    case FPU_OP_DIV:
+      z.d = a.d / b.d;
+      break;
+    case FPU_OP_SQRT:
+      z.d = sqrt(a.d);
+      break;
+  }
+  hostEnd();
+  if (IS_NAND(z.w)) {
+    return DEFAULT_NAND;
+  }
+  return z.w;
+}
+
+#define HOST(op, x, y)	if (hostFP) return hostOp(op, x, y)
+#define HOSTD(op, x, y)	if (hostFP) return hostOpD(op, x, y)
+
+#else
+
+#define HOST(op, x, y)
+#define HOSTD(op, x, y)
+
+#endif
+
+
+/**************************************************************/
+
+/*
+ * arithmetic
+ */
+
+
 Word fpAdd(Word x, Word y) {
-  /* !!!!! FIXME !!!!! */
-  return 0;
+  HOST(FPU_OP_ADD, x, y);
+  return softAdd(x, y);
 }
 
 
 Word fpSub(Word x, Word y) {
-  /* !!!!! FIXME !!!!! */
-  return 0;
+  HOST(FPU_OP_SUB, x, y);
+  return softAdd(x, y ^ 0x80000000);
 }
 
 
 Word fpMul(Word x, Word y) {
-  /* !!!!! FIXME !!!!! */
-  return 0;
+  HOST(FPU_OP_MUL, x, y);
+  return softMul(x, y);
 }
 
 
 Word fpDiv(Word x, Word y) {
-  /* !!!!! FIXME !!!!! */
-  return 0;
+  HOST(FPU_OP_DIV, x, y);
+  return softDiv(x, y);
 }
 
 
 Word fpSqrt(Word x) {
-  /* !!!!! FIXME !!!!! */
+  HOST(FPU_OP_SQRT, x, 0);
+  return softSqrt(x);
+}
+
+
+/*
+ * Compare x with y, return one of FPU_CMP_xxx. A quiet
+ * comparison raises "invalid" only for signaling NaNs,
+ * a signaling comparison does so for every NaN.
+ */
+Word fpCmp(Word x, Word y, Bool signaling) {
+  int signX, signY;
+
+  if (IS_NAN(x) || IS_NAN(y)) {
+    if (signaling || IS_SNAN(x) || IS_SNAN(y)) {
+      flags |= FPU_X_INVALID;
+    }
+    return FPU_CMP_UN;
+  }
+  if (x == y || ((x | y) & 0x7FFFFFFF) == 0) {
+    return FPU_CMP_EQ;
+  }
+  signX = SGN(x) != 0;
+  signY = SGN(y) != 0;
+  if (signX != signY) {
+    return signX ? FPU_CMP_LT : FPU_CMP_GT;
+  }
+  return (signX ^ (x < y)) ? FPU_CMP_LT : FPU_CMP_GT;
+}
+
+
+Word fpItoF(Word x) {
+  HOST(FPU_OP_ITOF, x, 0);
+  return softItoF(x);
+}
+
+
+/*
+ * Convert to a signed integer, rounding toward zero. NaNs and
+ * values out of range raise "invalid" and deliver 0x80000000.
+ */
+Word fpFtoI(Word x) {
+  int exp, dist;
+  Word sig, absZ;
+
+  exp = EXP(x);
+  sig = FRC(x);
+  dist = 0x9E - exp;
+  if (dist >= 32) {
+    if (exp | sig) {
+      flags |= FPU_X_INEXACT;
+    }
+    return 0;
+  }
+  if (dist <= 0) {
+    if (x != PACK(1, 0x9E, 0)) {
+      flags |= FPU_X_INVALID;
+    }
+    return 0x80000000;
+  }
+  sig = (sig | 0x00800000) << 8;
+  absZ = sig >> dist;
+  if ((absZ << dist) != sig) {
+    flags |= FPU_X_INEXACT;
+  }
+  return SGN(x) ? -absZ : absZ;
+}
+
+
+Dword fpFtoD(Word x) {
+  return softFtoD(x);
+}
+
+
+Dword fpAddD(Dword x, Dword y) {
+  HOSTD(FPU_OP_ADD, x, y);
+  return softAddD(x, y);
+}
+
+
+Dword fpSubD(Dword x, Dword y) {
+  HOSTD(FPU_OP_SUB, x, y);
+  return softAddD(x, y ^ 0x8000000000000000ULL);
+}
+
+
+Dword fpMulD(Dword x, Dword y) {
+  HOSTD(FPU_OP_MUL, x, y);
+  return softMulD(x, y);
+}
+
+
+Dword fpDivD(Dword x, Dword y) {
+  HOSTD(FPU_OP_DIV, x, y);
+  return softDivD(x, y);
+}
+
+
+Dword fpSqrtD(Dword x) {
+  HOSTD(FPU_OP_SQRT, x, 0);
+  return softSqrtD(x);
+}
+
+
+Word fpCmpD(Dword x, Dword y, Bool signaling) {
+  int signX, signY;
+
+  if (IS_NAND(x) || IS_NAND(y)) {
+    if (signaling || IS_SNAND(x) || IS_SNAND(y)) {
+      flags |= FPU_X_INVALID;
+    }
+    return FPU_CMP_UN;
+  }
+  if (x == y || ((x | y) & 0x7FFFFFFFFFFFFFFFULL) == 0) {
+    return FPU_CMP_EQ;
+  }
+  signX = SGND(x);
+  signY = SGND(y);
+  if (signX != signY) {
+    return signX ? FPU_CMP_LT : FPU_CMP_GT;
+  }
+  return (signX ^ (x < y)) ? FPU_CMP_LT : FPU_CMP_GT;
+}
+
+
+Dword fpItoD(Word x) {
+  return softItoD(x);
+}
+
+
+/*
+ * Convert to a signed integer, rounding toward zero. NaNs and
+ * values out of range raise "invalid" and deliver 0x80000000.
+ */
+Word fpDtoI(Dword x) {
+  int exp, dist;
+  Dword sig;
+  Word absZ;
+
+  exp = EXPD(x);
+  sig = FRCD(x);
+  dist = 0x433 - exp;
+  if (dist >= 53) {
+    if (exp | sig) {
+      flags |= FPU_X_INEXACT;
+    }
+    return 0;
+  }
+  if (dist < 22) {
+    if (SGND(x) && exp == 0x41E && sig < 0x0000000000200000ULL) {
+      /* -2^31 < x <= -2^31 - 1 */
+      if (sig != 0) {
+        flags |= FPU_X_INEXACT;
+      }
+      return 0x80000000;
+    }
+    flags |= FPU_X_INVALID;
+    return 0x80000000;
+  }
+  sig |= 0x0010000000000000ULL;
+  absZ = sig >> dist;
+  if (((Dword) absZ << dist) != sig) {
+    flags |= FPU_X_INEXACT;
+  }
+  return SGND(x) ? -absZ : absZ;
+}
+
+
+Word fpDtoF(Dword x) {
+  return softDtoF(x);
+}
+
+
+void fpSetRound(int mode) {
+  roundMode = mode & FPU_RND_MASK;
+}
+
+
+int fpGetFlags(void) {
+  return flags;
+}
+
+
+void fpSetFlags(int newFlags) {
+  flags = newFlags & 0x1F;
+}
+
+
+void fpUseHost(Bool useHost) {
+  hostFP = useHost && HOST_FP;
+}
+
+
+/**************************************************************/
+
+/*
+ * device interface
+ */
+
+
+static Dword getD(int n) {
+  n &= ~1;
+  return ((Dword) regs[n] << 32) | regs[n + 1];
+}
+
+
+static void putD(int n, Dword x) {
+  n &= ~1;
+  regs[n] = x >> 32;
+  regs[n + 1] = x;
+}
+
+
+static void execute(int op, Word data) {
+  int z, a, b;
+  Word x, y;
+  Dword xd, yd;
+
+  z = (data >> 10) & 0x1F;
+  a = (data >> 5) & 0x1F;
+  b = (data >> 0) & 0x1F;
+  if (op & FPU_OP_DBL) {
+    xd = getD(a);
+    yd = getD(b);
+    switch (op & ~FPU_OP_DBL) {
+      case FPU_OP_ADD:
+        putD(z, fpAddD(xd, yd));
+        break;
+      case FPU_OP_SUB:
+        putD(z, fpSubD(xd, yd));
+        break;
+      case FPU_OP_MUL:
+        putD(z, fpMulD(xd, yd));
+        break;
+      case FPU_OP_DIV:
+        putD(z, fpDivD(xd, yd));
+        break;
+      case FPU_OP_SQRT:
+        putD(z, fpSqrtD(xd));
+        break;
+      case FPU_OP_NEG:
+        putD(z, xd ^ 0x8000000000000000ULL);
+        break;
+      case FPU_OP_ABS:
+        putD(z, xd & 0x7FFFFFFFFFFFFFFFULL);
+        break;
+      case FPU_OP_MOV:
+        putD(z, xd);
+        break;
+      case FPU_OP_CMP:
+        result = fpCmpD(xd, yd, false);
+        break;
+      case FPU_OP_CMPS:
+        result = fpCmpD(xd, yd, true);
+        break;
+      case FPU_OP_ITOF:
+        putD(z, fpItoD(regs[a]));
+        break;
+      case FPU_OP_FTOI:
+        result = fpDtoI(xd);
+        break;
+      case FPU_OP_CVT:
+        regs[z] = fpDtoF(xd);
+        break;
+      default:
+        /* unknown operation */
+        flags |= FPU_X_INVALID;
+        break;
+    }
+    return;
+  }
+  x = regs[a];
+  y = regs[b];
+  switch (op) {
+    case FPU_OP_ADD:
+      regs[z] = fpAdd(x, y);
+      break;
+    case FPU_OP_SUB:
+      regs[z] = fpSub(x, y);
+      break;
+    case FPU_OP_MUL:
+      regs[z] = fpMul(x, y);
+      break;
+    case FPU_OP_DIV:
+      regs[z] = fpDiv(x, y);
+      break;
+    case FPU_OP_SQRT:
+      regs[z] = fpSqrt(x);
+      break;
+    case FPU_OP_NEG:
+      regs[z] = x ^ 0x80000000;
+      break;
+    case FPU_OP_ABS:
+      regs[z] = x & 0x7FFFFFFF;
+      break;
+    case FPU_OP_MOV:
+      regs[z] = x;
+      break;
+    case FPU_OP_CMP:
+      result = fpCmp(x, y, false);
+      break;
+    case FPU_OP_CMPS:
+      result = fpCmp(x, y, true);
+      break;
+    case FPU_OP_ITOF:
+      regs[z] = fpItoF(x);
+      break;
+    case FPU_OP_FTOI:
+      result = fpFtoI(x);
+      break;
+    case FPU_OP_CVT:
+      putD(z, fpFtoD(x));
+      break;
+    default:
+      /* unknown operation */
+      flags |= FPU_X_INVALID;
+      break;
+  }
+}
+
+
+Word fpuRead(Word addr) {
+  if ((addr & 3) == 0) {
+    if (addr >= FPU_REG(0) && addr < FPU_REG(FPU_NREGS)) {
+      return regs[(addr - FPU_REG(0)) >> 2];
+    }
+    if (addr == FPU_CTRL) {
+      return roundMode;
+    }
+    if (addr == FPU_STAT) {
+      return flags;
+    }
+    if (addr == FPU_RES) {
+      return result;
+    }
+    if (addr >= FPU_CMD(0) && addr < FPU_CMD(0x40)) {
+      /* command registers always read as 0 */
+      return 0;
+    }
+  }
+  /* throw bus timeout exception */
+  throwException(EXC_BUS_TIMEOUT);
+  /* not reached */
   return 0;
 }
+
+
+void fpuWrite(Word addr, Word data) {
+  if ((addr & 3) == 0) {
+    if (addr >= FPU_REG(0) && addr < FPU_REG(FPU_NREGS)) {
+      regs[(addr - FPU_REG(0)) >> 2] = data;
+      return;
+    }
+    if (addr == FPU_CTRL) {
+      fpSetRound(data);
+      return;
+    }
+    if (addr == FPU_STAT) {
+      fpSetFlags(data);
+      return;
+    }
+    if (addr == FPU_RES) {
+      result = data;
+      return;
+    }
+    if (addr >= FPU_CMD(0) && addr < FPU_CMD(0x40)) {
+      execute((addr - FPU_CMD(0)) >> 2, data);
+      return;
+    }
+  }
+  /* throw bus timeout exception */
+  throwException(EXC_BUS_TIMEOUT);
+}
+
+
+static void saveState(FPU_State *state) {
+  memcpy(state->regs, regs, sizeof(regs));
+  state->result = result;
+  state->roundMode = roundMode;
+  state->flags = flags;
+}
+
+
+static void loadState(FPU_State *state) {
+  memcpy(regs, state->regs, sizeof(regs));
+  result = state->result;
+  roundMode = state->roundMode;
+  flags = state->flags;
+}
+
+
+void fpuSelectCore(int core) {
+  if (core == curCore) {
+    return;
+  }
+  saveState(&cores[curCore]);
+  loadState(&cores[core]);
+  curCore = core;
+}
+
+
+void fpuReset(void) {
+  int core;
+  int i;
+
+  cPrintf("Resetting FPU...\n");
+  for (core = 0; core < numCores; core++) {
+    for (i = 0; i < FPU_NREGS; i++) {
+      regs[i] = 0;
+    }
+    roundMode = FPU_RND_NEAR;
+    flags = 0;
+    result = 0;
+    saveState(&cores[core]);
+  }
+  loadState(&cores[curCore]);
+}
+
+
+void fpuInit(int nCores) {
+  numCores = nCores;
+  curCore = 0;
+  fpUseHost(true);
+  fpuReset();
+}
+
+
+void fpuExit(void) {
+}
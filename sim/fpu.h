@@ -7,11 +7,92 @@
 #define _FPU_H_
 
 
+/*
+ * The FPU occupies the topmost I/O slot, so that all of its
+ * registers lie in the last 4 KB of the virtual address space.
+ * Kernel mode programs can access each of them with a single
+ * load or store relative to register $0 (negative offsets).
+ */
+
+#define FPU_NREGS	32	/* number of floating-point registers */
+
+#define FPU_REG(n)	(0xFFF00 + ((n) << 2))	/* register n */
+#define FPU_CTRL	0xFFE00		/* control register */
+#define FPU_STAT	0xFFE04		/* status register */
+#define FPU_RES		0xFFE08		/* integer result register */
+#define FPU_CMD(op)	(0xFF000 + ((op) << 2))	/* command op */
+
+#define FPU_RND_MASK	0x03	/* rounding mode (in control register) */
+#define FPU_RND_NEAR	0x00	/* round to nearest, ties to even */
+#define FPU_RND_ZERO	0x01	/* round toward zero */
+#define FPU_RND_DOWN	0x02	/* round toward minus infinity */
+#define FPU_RND_UP	0x03	/* round toward plus infinity */
+
+#define FPU_X_INEXACT	0x01	/* inexact result (sticky status bit) */
+#define FPU_X_UNDER	0x02	/* underflow (sticky status bit) */
+#define FPU_X_OVER	0x04	/* overflow (sticky status bit) */
+#define FPU_X_DIVZERO	0x08	/* division by zero (sticky status bit) */
+#define FPU_X_INVALID	0x10	/* invalid operation (sticky status bit) */
+
+/*
+ * Writing (dst << 10) | (src1 << 5) | src2 to FPU_CMD(op)
+ * executes op. Double precision operands live in register
+ * pairs (n, n+1) with n even, the high-order word in n.
+ */
+#define FPU_OP_ADD	0x00	/* dst = src1 + src2 */
+#define FPU_OP_SUB	0x01	/* dst = src1 - src2 */
+#define FPU_OP_MUL	0x02	/* dst = src1 * src2 */
+#define FPU_OP_DIV	0x03	/* dst = src1 / src2 */
+#define FPU_OP_SQRT	0x04	/* dst = sqrt(src1) */
+#define FPU_OP_NEG	0x05	/* dst = -src1 */
+#define FPU_OP_ABS	0x06	/* dst = |src1| */
+#define FPU_OP_MOV	0x07	/* dst = src1 */
+#define FPU_OP_CMP	0x08	/* res = relation of src1 to src2 */
+#define FPU_OP_CMPS	0x09	/* same, but any NaN is invalid */
+#define FPU_OP_ITOF	0x0A	/* dst = (float) (int) src1 */
+#define FPU_OP_FTOI	0x0B	/* res = (int) src1, truncated */
+#define FPU_OP_CVT	0x0C	/* dst = src1, converted to other size */
+#define FPU_OP_DBL	0x20	/* flag: double precision operation */
+
+#define FPU_CMP_LT	0x01	/* src1 < src2 */
+#define FPU_CMP_EQ	0x02	/* src1 == src2 */
+#define FPU_CMP_GT	0x04	/* src1 > src2 */
+#define FPU_CMP_UN	0x08	/* unordered (at least one NaN) */
+
+
 Word fpAdd(Word x, Word y);
 Word fpSub(Word x, Word y);
 Word fpMul(Word x, Word y);
 Word fpDiv(Word x, Word y);
 Word fpSqrt(Word x);
+Word fpCmp(Word x, Word y, Bool signaling);
+Word fpItoF(Word x);
+Word fpFtoI(Word x);
+Dword fpFtoD(Word x);
+
+Dword fpAddD(Dword x, Dword y);
+Dword fpSubD(Dword x, Dword y);
+Dword fpMulD(Dword x, Dword y);
+Dword fpDivD(Dword x, Dword y);
+Dword fpSqrtD(Dword x);
+Word fpCmpD(Dword x, Dword y, Bool signaling);
+Dword fpItoD(Word x);
+Word fpDtoI(Dword x);
+Word fpDtoF(Dword x);
+
+void fpSetRound(int mode);
+int fpGetFlags(void);
+void fpSetFlags(int flags);
+void fpUseHost(Bool useHost);
+
+Word fpuRead(Word addr);
+void fpuWrite(Word addr, Word data);
+
+void fpuSelectCore(int core);
+
+void fpuReset(void);
+void fpuInit(int nCores);
+void fpuExit(void);
 
 
 #endif /* _FPU_H_ */
@@ -0,0 +1,111 @@
+/*
+ * hostio.c -- host I/O worker for disk image transfers
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "common.h"
+#include "console.h"
+#include "error.h"
+#include "hostio.h"
+
+
+/*
+ * Devices hand their image file transfers to a worker thread,
+ * so that the host's I/O latency overlaps with the simulation
+ * of the device's own delay. A device submits a request when
+ * the guest starts a command, and waits for it when the timer
+ * signals the simulated completion; the guest sees the same
+ * timing as before. Requests are served in submission order,
+ * so a read never overtakes an earlier write. Only the worker
+ * touches the image files once requests have been submitted.
+ * The worker is started with the first request. There is no
+ * explicit shutdown: devices wait for their own requests in
+ * their exit functions, so nothing is lost on exit.
+ */
+
+
+static Bool started = false;
+static pthread_t worker;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queued = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t finished = PTHREAD_COND_INITIALIZER;
+static HostIO *head = NULL;
+static HostIO *tail = NULL;
+
+
+static void *serve(void *ignore) {
+  HostIO *req;
+  Bool ok;
+
+  while (1) {
+    pthread_mutex_lock(&lock);
+    while (head == NULL) {
+      pthread_cond_wait(&queued, &lock);
+    }
+    req = head;
+    head = req->next;
+    if (head == NULL) {
+      tail = NULL;
+    }
+    pthread_mutex_unlock(&lock);
+    ok = fseek(req->file, req->offset, SEEK_SET) == 0;
+    if (ok && req->write) {
+      ok = fwrite(req->buf, 1, req->size, req->file) == req->size;
+    } else
+    if (ok) {
+      ok = fread(req->buf, 1, req->size, req->file) == req->size;
+    }
+    pthread_mutex_lock(&lock);
+    req->ok = ok;
+    req->done = true;
+    pthread_cond_broadcast(&finished);
+    pthread_mutex_unlock(&lock);
+  }
+  return NULL;
+}
+
+
+void hostioSubmit(HostIO *req) {
+  if (!started) {
+    if (pthread_create(&worker, NULL, serve, NULL) != 0) {
+      error("cannot start host I/O worker");
+    }
+    started = true;
+  }
+  req->busy = true;
+  req->done = false;
+  req->next = NULL;
+  pthread_mutex_lock(&lock);
+  if (tail == NULL) {
+    head = req;
+  } else {
+    tail->next = req;
+  }
+  tail = req;
+  pthread_cond_signal(&queued);
+  pthread_mutex_unlock(&lock);
+}
+
+
+/*
+ * Wait until the request is finished. Returns true if the
+ * transfer was successful, or if the request was never
+ * submitted (or has already been waited for).
+ */
+Bool hostioWait(HostIO *req) {
+  if (!req->busy) {
+    return true;
+  }
+  pthread_mutex_lock(&lock);
+  while (!req->done) {
+    pthread_cond_wait(&finished, &lock);
+  }
+  pthread_mutex_unlock(&lock);
+  req->busy = false;
+  return req->ok;
+}
@@ -0,0 +1,27 @@
+/*
+ * hostio.h -- host I/O worker for disk image transfers
+ */
+
+
+#ifndef _HOSTIO_H_
+#define _HOSTIO_H_
+
+
+typedef struct hostio {
+  FILE *file;			/* image file */
+  long offset;			/* byte offset in file */
+  Byte *buf;			/* data buffer */
+  int size;			/* number of bytes to transfer */
+  Bool write;			/* buffer --> file if set */
+  Bool busy;			/* submitted, not yet waited for */
+  Bool done;			/* transfer finished (set by worker) */
+  Bool ok;			/* transfer was successful */
+  struct hostio *next;		/* queue link */
+} HostIO;
+
+
+void hostioSubmit(HostIO *req);
+Bool hostioWait(HostIO *req);
+
+
+#endif /* _HOSTIO_H_ */
@@ -47,7 +47,9 @@ static unsigned int indexMask;	/* mask for index bits (shifted to 0) */
 static int tagShift;		/* == number of (index + offset) bits */
 static unsigned int tagMask;	/* mask for tag bits (shifted to 0) */
 
-static CacheSet *cache;		/* the cache is an array of cache sets */
+static int numCores;		/* number of cores, each has a cache */
+static CacheSet *caches[MAX_NCORES];	/* the caches of all cores */
+static CacheSet *cache;		/* the cache of the current core */
 
 static long readAccesses;	/* number of read accesses */
 static long readMisses;		/* number of read misses */
@@ -202,19 +204,62 @@ Bool icacheProbe(Word pAddr, Word *data) {
 /**************************************************************/
 
 
+void icacheSelectCore(int core) {
+  cache = caches[core];
+}
+
+
+/**************************************************************/
+
+
 void icacheReset(void) {
+  CacheSet *current;
+  int core;
+
   cPrintf("Resetting Instruction Cache...\n");
   cPrintf("%6d sets * %d lines/set * %d bytes/line = %d bytes installed.\n",
           sets, assoc, lineSize, totalSize);
-  icacheInvalidate();
+  if (numCores > 1) {
+    cPrintf("%6d caches installed, one per core.\n", numCores);
+  }
+  current = cache;
+  for (core = 0; core < numCores; core++) {
+    cache = caches[core];
+    icacheInvalidate();
+  }
+  cache = current;
   readAccesses = 0;
   readMisses = 0;
 }
 
 
-void icacheInit(int ldTotal, int ldLine, int ldAss) {
+static CacheSet *allocCache(void) {
+  CacheSet *newCache;
   unsigned int index;
 
+  newCache = malloc(sets * sizeof(CacheSet));
+  if (newCache == NULL) {
+    error("cannot allocate icache");
+  }
+  for (index = 0; index < sets; index++) {
+    newCache[index].line_0.data = malloc(lineSize);
+    if (newCache[index].line_0.data == NULL) {
+      error("cannot allocate icache data");
+    }
+    if (ldAssoc) {
+      newCache[index].line_1.data = malloc(lineSize);
+      if (newCache[index].line_1.data == NULL) {
+        error("cannot allocate icache data");
+      }
+    }
+  }
+  return newCache;
+}
+
+
+void icacheInit(int ldTotal, int ldLine, int ldAss, int nCores) {
+  int core;
+
   ldTotalSize = ldTotal;
   ldLineSize = ldLine;
   ldAssoc = ldAss;
@@ -239,34 +284,26 @@ void icacheInit(int ldTotal, int ldLine, int ldAss) {
     cPrintf("**** icache offset : shift = %2d, ", 0);
     cPrintf("bits = %2d, mask = 0x%08X ****\n", ldLineSize, offsetMask);
   }
-  cache = malloc(sets * sizeof(CacheSet));
-  if (cache == NULL) {
-    error("cannot allocate icache");
-  }
-  for (index = 0; index < sets; index++) {
-    cache[index].line_0.data = malloc(lineSize);
-    if (cache[index].line_0.data == NULL) {
-      error("cannot allocate icache data");
-    }
-    if (ldAssoc) {
-      cache[index].line_1.data = malloc(lineSize);
-      if (cache[index].line_1.data == NULL) {
-        error("cannot allocate icache data");
-      }
-    }
+  numCores = nCores;
+  for (core = 0; core < numCores; core++) {
+    caches[core] = allocCache();
   }
+  cache = caches[0];
   icacheReset();
 }
 
 
 void icacheExit(void) {
   unsigned int index;
+  int core;
 
-  for (index = 0; index < sets; index++) {
-    free(cache[index].line_0.data);
-    if (ldAssoc) {
-      free(cache[index].line_1.data);
+  for (core = 0; core < numCores; core++) {
+    for (index = 0; index < sets; index++) {
+      free(caches[core][index].line_0.data);
+      if (ldAssoc) {
+        free(caches[core][index].line_1.data);
+      }
     }
+    free(caches[core]);
   }
-  free(cache);
 }
@@ -22,8 +22,10 @@ long icacheGetReadMisses(void);
 
 Bool icacheProbe(Word pAddr, Word *data);
 
+void icacheSelectCore(int core);
+
 void icacheReset(void);
-void icacheInit(int ldTotal, int ldLine, int ldAss);
+void icacheInit(int ldTotal, int ldLine, int ldAss, int nCores);
 void icacheExit(void);
 
 
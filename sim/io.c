@@ -19,9 +19,12 @@
 #include "serial.h"
 #include "disk.h"
 #include "sdcard.h"
+#include "ipi.h"
+#include "fpu.h"
 #include "bio.h"
 #include "output.h"
 #include "shutdown.h"
+#include "stats.h"
 #include "graph1.h"
 #include "graph2.h"
 #include "mouse.h"
@@ -65,6 +68,14 @@ Word ioReadWord(Word pAddr) {
     data = sdcardRead(pAddr & IO_REG_MASK);
     return data;
   }
+  if ((pAddr & IO_DEV_MASK) == IPI_BASE) {
+    data = ipiRead(pAddr & IO_REG_MASK);
+    return data;
+  }
+  if ((pAddr & IO_DEV_MASK) == FPU_BASE) {
+    data = fpuRead(pAddr & IO_REG_MASK);
+    return data;
+  }
   if ((pAddr & IO_DEV_MASK) == BIO_BASE) {
     data = bioRead(pAddr & IO_REG_MASK);
     return data;
@@ -85,6 +96,10 @@ Word ioReadWord(Word pAddr) {
     data = shutdownRead(pAddr & IO_REG_MASK);
     return data;
   }
+  if ((pAddr & IO_DEV_MASK) == STATS_BASE) {
+    data = statsRead(pAddr & IO_REG_MASK);
+    return data;
+  }
   /* throw bus timeout exception */
   throwException(EXC_BUS_TIMEOUT);
   /* not reached */
@@ -130,6 +145,14 @@ void ioWriteWord(Word pAddr, Word data) {
     sdcardWrite(pAddr & IO_REG_MASK, data);
     return;
   }
+  if ((pAddr & IO_DEV_MASK) == IPI_BASE) {
+    ipiWrite(pAddr & IO_REG_MASK, data);
+    return;
+  }
+  if ((pAddr & IO_DEV_MASK) == FPU_BASE) {
+    fpuWrite(pAddr & IO_REG_MASK, data);
+    return;
+  }
   if ((pAddr & IO_DEV_MASK) == BIO_BASE) {
     bioWrite(pAddr & IO_REG_MASK, data);
     return;
@@ -150,6 +173,10 @@ void ioWriteWord(Word pAddr, Word data) {
     shutdownWrite(pAddr & IO_REG_MASK, data);
     return;
   }
+  if ((pAddr & IO_DEV_MASK) == STATS_BASE) {
+    statsWrite(pAddr & IO_REG_MASK, data);
+    return;
+  }
   /* throw bus timeout exception */
   throwException(EXC_BUS_TIMEOUT);
   /* not reached */
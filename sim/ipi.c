@@ -0,0 +1,114 @@
+/*
+ * ipi.c -- inter-processor interrupt device
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+
+#include "common.h"
+#include "console.h"
+#include "error.h"
+#include "except.h"
+#include "cpu.h"
+#include "ipi.h"
+
+
+/*
+ * The device is installed if the simulator runs more than one
+ * core. Core k has an interrupt register at IPI_IRQ + 4 * k:
+ * writing a non-zero value raises IRQ_IPI at that core, writing
+ * zero withdraws it again (the interrupt is level-sensitive, so
+ * the receiving core must do this in its service routine);
+ * reading returns 1 while the interrupt is pending. The start
+ * register at IPI_START + 4 * k sets the PC of a stopped core to
+ * the value written and lets it run; reading returns 1 while the
+ * core is running. Core 0 always runs.
+ */
+
+
+static Bool debug = false;
+static Bool installed = false;
+
+static int numCores;
+
+
+Word ipiRead(Word addr) {
+  Word data;
+  int core;
+
+  if (debug) {
+    cPrintf("\n**** IPI READ from 0x%08X", addr);
+  }
+  if (!installed) {
+    /* IPI device not installed */
+    throwException(EXC_BUS_TIMEOUT);
+  }
+  core = (addr & 0xFF) >> 2;
+  if (addr == IPI_CORES) {
+    data = numCores;
+  } else
+  if ((addr & ~0xFF) == IPI_IRQ && core < numCores) {
+    data = cpuTestCoreInterrupt(core, IRQ_IPI) ? 1 : 0;
+  } else
+  if ((addr & ~0xFF) == IPI_START && core < numCores) {
+    data = cpuCoreRunning(core) ? 1 : 0;
+  } else {
+    /* illegal register */
+    throwException(EXC_BUS_TIMEOUT);
+  }
+  if (debug) {
+    cPrintf(", data = 0x%08X ****\n", data);
+  }
+  return data;
+}
+
+
+void ipiWrite(Word addr, Word data) {
+  int core;
+
+  if (debug) {
+    cPrintf("\n**** IPI WRITE to 0x%08X, data = 0x%08X ****\n",
+            addr, data);
+  }
+  if (!installed) {
+    /* IPI device not installed */
+    throwException(EXC_BUS_TIMEOUT);
+  }
+  core = (addr & 0xFF) >> 2;
+  if ((addr & ~0xFF) == IPI_IRQ && core < numCores) {
+    if (data != 0) {
+      cpuSetCoreInterrupt(core, IRQ_IPI);
+    } else {
+      cpuResetCoreInterrupt(core, IRQ_IPI);
+    }
+  } else
+  if ((addr & ~0xFF) == IPI_START && core < numCores) {
+    cpuStartCore(core, data);
+  } else {
+    /* illegal register */
+    throwException(EXC_BUS_TIMEOUT);
+  }
+}
+
+
+void ipiReset(void) {
+  if (!installed) {
+    /* IPI device not installed */
+    return;
+  }
+  cPrintf("Resetting IPI Device...\n");
+}
+
+
+void ipiInit(int nCores) {
+  numCores = nCores;
+  installed = numCores > 1;
+  ipiReset();
+}
+
+
+void ipiExit(void) {
+}
@@ -0,0 +1,23 @@
+/*
+ * ipi.h -- inter-processor interrupt device
+ */
+
+
+#ifndef _IPI_H_
+#define _IPI_H_
+
+
+#define IPI_CORES	0x000	/* number of cores (read-only) */
+#define IPI_IRQ		0x100	/* interrupt registers, one per core */
+#define IPI_START	0x200	/* start registers, one per core */
+
+
+Word ipiRead(Word addr);
+void ipiWrite(Word addr, Word data);
+
+void ipiReset(void);
+void ipiInit(int nCores);
+void ipiExit(void);
+
+
+#endif /* _IPI_H_ */
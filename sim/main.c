@@ -25,12 +25,17 @@
 #include "serial.h"
 #include "disk.h"
 #include "sdcard.h"
+#include "ipi.h"
+#include "fpu.h"
 #include "bio.h"
 #include "output.h"
 #include "shutdown.h"
+#include "stats.h"
+#include "bprof.h"
 #include "graph1.h"
 #include "graph2.h"
 #include "mouse.h"
+#include "server.h"
 
 
 static void usage(char *myself) {
@@ -38,6 +43,7 @@ static void usage(char *myself) {
   fprintf(stderr, "    [-i]           set interactive mode\n");
   fprintf(stderr, "    [-m <n>]       install n MB of RAM (1-%d)\n",
           RAM_SIZE_MAX / M);
+  fprintf(stderr, "    [-z]           zero RAM instead of random fill\n");
   fprintf(stderr, "    [-l <prog>]    set program file name\n");
   fprintf(stderr, "    [-a <addr>]    set program load address\n");
   fprintf(stderr, "    [-r <rom>]     set ROM image file name\n");
@@ -62,6 +68,18 @@ static void usage(char *myself) {
   fprintf(stderr, "    [-dcl <n>]     dcache ld line size in bytes (2-10)\n");
   fprintf(stderr, "    [-dca <n>]     dcache ld associativity (0-1)\n");
   fprintf(stderr, "    [-sb <3 hex>]  set board buttons(1)/switches(2)\n");
+  fprintf(stderr, "    [-bp <file>]   write branch profile to file\n");
+  fprintf(stderr, "    [-n <n>]       simulate n CPU cores (1-%d)\n",
+          MAX_NCORES);
+  fprintf(stderr, "    [-q <n>]       time slice of a core in instrs\n");
+  fprintf(stderr, "   or: %s -S <socket> [-j <n>] <options>\n", myself);
+  fprintf(stderr, "         serve jobs on socket, n at a time, on a\n");
+  fprintf(stderr, "         machine set up once by the options (no -i,\n");
+  fprintf(stderr, "         -l, -a, -r, -o, -bp, -x, -c, -g, -G, -s, -t,\n");
+  fprintf(stderr, "         -u, and only NONE with -d and -D)\n");
+  fprintf(stderr, "   or: %s -C <socket> <job options>\n", myself);
+  fprintf(stderr, "         run a job on a server, the job options\n");
+  fprintf(stderr, "         are -l, -a, -r, -o and -bp\n");
   fprintf(stderr, "The options -l and -r are mutually exclusive.\n");
   fprintf(stderr, "If both are omitted, interactive mode is assumed.\n");
   fprintf(stderr, "Unconnected serial lines can be accessed by opening\n");
@@ -70,12 +88,61 @@ static void usage(char *myself) {
 }
 
 
+/*
+ * Process the options of a job of a simulation server. The
+ * machine is already set up, only these options may differ
+ * from job to job.
+ */
+static void jobOptions(int argc, char *argv[],
+                       char **progNamep, unsigned int *loadAddrp,
+                       char **romNamep, char **outputNamep,
+                       char **bprofNamep) {
+  int i;
+  char *argp;
+  char *endp;
+
+  for (i = 1; i < argc; i += 2) {
+    argp = argv[i];
+    if (i == argc - 1) {
+      error("job option '%s' needs an argument", argp);
+    }
+    if (strcmp(argp, "-l") == 0 &&
+        *progNamep == NULL && *romNamep == NULL) {
+      *progNamep = argv[i + 1];
+    } else
+    if (strcmp(argp, "-a") == 0) {
+      *loadAddrp = strtoul(argv[i + 1], &endp, 0);
+      if (*endp != '\0') {
+        error("job option '-a' needs a number");
+      }
+    } else
+    if (strcmp(argp, "-r") == 0 &&
+        *romNamep == NULL && *progNamep == NULL) {
+      *romNamep = argv[i + 1];
+    } else
+    if (strcmp(argp, "-o") == 0 && *outputNamep == NULL) {
+      *outputNamep = argv[i + 1];
+    } else
+    if (strcmp(argp, "-bp") == 0 && *bprofNamep == NULL) {
+      *bprofNamep = argv[i + 1];
+    } else {
+      error("job option '%s' not allowed here "
+            "(only -l or -r, -a, -o, -bp)", argp);
+    }
+  }
+  if (*progNamep == NULL && *romNamep == NULL) {
+    error("job needs a program (-l) or a ROM image (-r)");
+  }
+}
+
+
 int main(int argc, char *argv[]) {
   int i, j;
   char *argp;
   char *endp;
   Bool interactive;
   int memSize;
+  Bool zeroMem;
   char *progName;
   unsigned int loadAddr;
   char *romName;
@@ -98,12 +165,38 @@ int main(int argc, char *argv[]) {
   int dcacheLineSize;
   int dcacheAssoc;
   Word initialSwitches;
+  char *bprofName;
+  int numCores;
+  int quantum;
   Word initialPC;
   char command[20];
   char *line;
+  char *serverName;
+  int serverJobs;
+  int first;
 
+  if (argc > 1 && strcmp(argv[1], "-C") == 0) {
+    /* submit a job to a simulation server, never returns */
+    serverClient(argc, argv);
+  }
+  serverName = NULL;
+  serverJobs = 0;
+  first = 1;
+  if (argc > 2 && strcmp(argv[1], "-S") == 0) {
+    /* run as simulation server, the other options set up the machine */
+    serverName = argv[2];
+    first = 3;
+    if (argc > 4 && strcmp(argv[3], "-j") == 0) {
+      serverJobs = strtol(argv[4], &endp, 10);
+      if (*endp != '\0' || serverJobs <= 0) {
+        usage(argv[0]);
+      }
+      first = 5;
+    }
+  }
   interactive = false;
   memSize = RAM_SIZE_DFL / M;
+  zeroMem = false;
   progName = NULL;
   loadAddr = 0;
   romName = NULL;
@@ -128,7 +221,10 @@ int main(int argc, char *argv[]) {
   dcacheLineSize = DC_LD_LINE_SIZE;
   dcacheAssoc = DC_LD_ASSOC;
   initialSwitches = 0;
-  for (i = 1; i < argc; i++) {
+  bprofName = NULL;
+  numCores = 1;
+  quantum = QUANTUM_DFL;
+  for (i = first; i < argc; i++) {
     argp = argv[i];
     if (strcmp(argp, "-i") == 0) {
       interactive = true;
@@ -144,6 +240,9 @@ int main(int argc, char *argv[]) {
         usage(argv[0]);
       }
     } else
+    if (strcmp(argp, "-z") == 0) {
+      zeroMem = true;
+    } else
     if (strcmp(argp, "-l") == 0) {
       if (i == argc - 1 || progName != NULL || romName != NULL) {
         usage(argv[0]);
@@ -307,13 +406,57 @@ int main(int argc, char *argv[]) {
           (initialSwitches & ~0xFFF) != 0) {
         usage(argv[0]);
       }
+    } else
+    if (strcmp(argp, "-bp") == 0) {
+      if (i == argc - 1 || bprofName != NULL) {
+        usage(argv[0]);
+      }
+      bprofName = argv[++i];
+    } else
+    if (strcmp(argp, "-n") == 0) {
+      if (i == argc - 1) {
+        usage(argv[0]);
+      }
+      numCores = strtol(argv[++i], &endp, 10);
+      if (*endp != '\0' ||
+          numCores < 1 ||
+          numCores > MAX_NCORES) {
+        usage(argv[0]);
+      }
+    } else
+    if (strcmp(argp, "-q") == 0) {
+      if (i == argc - 1) {
+        usage(argv[0]);
+      }
+      quantum = strtol(argv[++i], &endp, 10);
+      if (*endp != '\0' ||
+          quantum < 1) {
+        usage(argv[0]);
+      }
     } else {
       usage(argv[0]);
     }
   }
-  cInit(expect);
+  if (serverName != NULL) {
+    /* all jobs share this setup: no per-job files, no host threads */
+    for (j = 0; j < MAX_NSERIALS; j++) {
+      if (connectTerminals[j]) {
+        usage(argv[0]);
+      }
+    }
+    if (interactive || progName != NULL || loadAddr != 0 ||
+        romName != NULL || outputName != NULL || bprofName != NULL ||
+        expect || console || graphics1 || graphics2 ||
+        numSerials != 0 || danglingLinesName != NULL ||
+        diskName != NULL || sdcardName != NULL) {
+      usage(argv[0]);
+    }
+  } else {
+    cInit(expect);
+  }
   cPrintf("ECO32 Simulator started\n");
-  if (progName == NULL && romName == NULL && !interactive) {
+  if (serverName == NULL &&
+      progName == NULL && romName == NULL && !interactive) {
     cPrintf("Neither a program to load nor a system ROM was\n");
     cPrintf("specified, so interactive mode is assumed.\n");
     interactive = true;
@@ -350,21 +493,40 @@ int main(int argc, char *argv[]) {
   if (sdcard) {
     sdcardInit(sdcardName);
   }
+  ipiInit(numCores);
+  fpuInit(numCores);
   bioInit(initialSwitches);
   outputInit(outputName);
   shutdownInit();
-  ramInit(memSize * M, progName, loadAddr);
+  statsInit();
+  bprofInit(bprofName);
+  ramInit(memSize * M, zeroMem, progName, loadAddr);
   romInit(romName);
-  icacheInit(icacheTotalSize, icacheLineSize, icacheAssoc);
-  dcacheInit(dcacheTotalSize, dcacheLineSize, dcacheAssoc);
-  mmuInit();
+  icacheInit(icacheTotalSize, icacheLineSize, icacheAssoc, numCores);
+  dcacheInit(dcacheTotalSize, dcacheLineSize, dcacheAssoc, numCores);
+  mmuInit(numCores);
   traceInit();
+  if (serverName != NULL) {
+    /* the machine is set up, every job runs in a copy of it */
+    serverRun(serverName, serverJobs, &argc, &argv);
+    cInit(false);
+    jobOptions(argc, argv, &progName, &loadAddr,
+               &romName, &outputName, &bprofName);
+    outputInit(outputName);
+    bprofInit(bprofName);
+    if (progName != NULL) {
+      ramLoad(progName, loadAddr);
+    }
+    if (romName != NULL) {
+      romLoad(romName);
+    }
+  }
   if (progName != NULL) {
     initialPC = 0xC0000000 | loadAddr;
   } else {
     initialPC = 0xC0000000 | ROM_BASE;
   }
-  cpuInit(initialPC);
+  cpuInit(initialPC, numCores, quantum);
   if (!interactive) {
     cPrintf("Start executing...\n");
     strcpy(command, "c\n");
@@ -397,9 +559,13 @@ int main(int argc, char *argv[]) {
   serialExit();
   diskExit();
   sdcardExit();
+  ipiExit();
+  fpuExit();
   bioExit();
   outputExit();
   shutdownExit();
+  statsExit();
+  bprofExit();
   cPrintf("ECO32 Simulator finished\n");
   cExit();
   return 0;
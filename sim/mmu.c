@@ -32,6 +32,26 @@ static Word mmuBadAccs;
 
 static int randomIndex;
 
+/*
+ * Each core has its own TLB and MMU registers. The state of the
+ * core which is currently executing lives in the variables above,
+ * the state of all other cores is parked in the array below.
+ */
+
+typedef struct {
+  TLB_Entry tlb[TLB_SIZE];
+  Word tlbIndex;
+  Word tlbEntryHi;
+  Word tlbEntryLo;
+  Word mmuBadAddr;
+  Word mmuBadAccs;
+  int randomIndex;
+} MMU_State;
+
+static int numCores;
+static int curCore;
+static MMU_State cores[MAX_NCORES];
+
 
 static void updateRandomIndex(void) {
   if (randomIndex == TLB_FIXED) {
@@ -149,6 +169,25 @@ Word mmuReadWord(Word vAddr, Bool userMode) {
 }
 
 
+Word mmuReadLinkWord(Word vAddr, Bool userMode, Word *pAddrp) {
+  Word pAddr;
+
+  if ((vAddr & 3) != 0) {
+    /* throw illegal address exception */
+    mmuBadAccs = MMU_ACCS_READ | MMU_ACCS_WORD;
+    mmuBadAddr = vAddr;
+    throwException(EXC_ILL_ADDRESS);
+  }
+  pAddr = v2p(vAddr, userMode, false, MMU_ACCS_WORD);
+  *pAddrp = pAddr;
+  if ((pAddr & 0x30000000) == IO_BASE) {
+    return ioReadWord(pAddr & ~3);
+  } else {
+    return dcacheReadWord(pAddr);
+  }
+}
+
+
 Half mmuReadHalf(Word vAddr, Bool userMode) {
   Word pAddr;
 
@@ -192,6 +231,7 @@ void mmuWriteWord(Word vAddr, Word data, Bool userMode) {
   if ((pAddr & 0x30000000) == IO_BASE) {
     ioWriteWord(pAddr & ~3, data);
   } else {
+    cpuSnoopWrite(pAddr);
     dcacheWriteWord(pAddr, data);
   }
 }
@@ -210,6 +250,7 @@ void mmuWriteHalf(Word vAddr, Half data, Bool userMode) {
   if ((pAddr & 0x30000000) == IO_BASE) {
     ioWriteWord(pAddr & ~3, data);
   } else {
+    cpuSnoopWrite(pAddr);
     dcacheWriteHalf(pAddr, data);
   }
 }
@@ -222,6 +263,7 @@ void mmuWriteByte(Word vAddr, Byte data, Bool userMode) {
   if ((pAddr & 0x30000000) == IO_BASE) {
     ioWriteWord(pAddr & ~3, data);
   } else {
+    cpuSnoopWrite(pAddr);
     dcacheWriteByte(pAddr, data);
   }
 }
@@ -356,32 +398,71 @@ void mmuSetTLB(int index, TLB_Entry tlbEntry) {
 }
 
 
+static void saveState(MMU_State *state) {
+  memcpy(state->tlb, tlb, sizeof(tlb));
+  state->tlbIndex = tlbIndex;
+  state->tlbEntryHi = tlbEntryHi;
+  state->tlbEntryLo = tlbEntryLo;
+  state->mmuBadAddr = mmuBadAddr;
+  state->mmuBadAccs = mmuBadAccs;
+  state->randomIndex = randomIndex;
+}
+
+
+static void loadState(MMU_State *state) {
+  memcpy(tlb, state->tlb, sizeof(tlb));
+  tlbIndex = state->tlbIndex;
+  tlbEntryHi = state->tlbEntryHi;
+  tlbEntryLo = state->tlbEntryLo;
+  mmuBadAddr = state->mmuBadAddr;
+  mmuBadAccs = state->mmuBadAccs;
+  randomIndex = state->randomIndex;
+}
+
+
+void mmuSelectCore(int core) {
+  if (core == curCore) {
+    return;
+  }
+  saveState(&cores[curCore]);
+  loadState(&cores[core]);
+  curCore = core;
+}
+
+
 void mmuReset(void) {
+  int core;
   int i;
 
   cPrintf("Resetting MMU...\n");
-  for (i = 0; i < TLB_SIZE; i++) {
-    tlb[i].page = rand() & PAGE_MASK;
-    tlb[i].frame = rand() & FRAME_MASK;
-    tlb[i].write = rand() & 0x1000 ? true : false;
-    tlb[i].valid = rand() & 0x1000 ? true : false;
-    if (debugWrite) {
-      cPrintf("**** TLB[%02d] <- 0x%08X 0x%08X %c %c ****\n",
-              i, tlb[i].page, tlb[i].frame,
-              tlb[i].write ? 'w' : '-',
-              tlb[i].valid ? 'v' : '-');
+  for (core = 0; core < numCores; core++) {
+    for (i = 0; i < TLB_SIZE; i++) {
+      tlb[i].page = rand() & PAGE_MASK;
+      tlb[i].frame = rand() & FRAME_MASK;
+      tlb[i].write = rand() & 0x1000 ? true : false;
+      tlb[i].valid = rand() & 0x1000 ? true : false;
+      if (debugWrite) {
+        cPrintf("**** TLB[%02d] <- 0x%08X 0x%08X %c %c ****\n",
+                i, tlb[i].page, tlb[i].frame,
+                tlb[i].write ? 'w' : '-',
+                tlb[i].valid ? 'v' : '-');
+      }
     }
+    tlbIndex = rand() & TLB_MASK;
+    tlbEntryHi = rand() & PAGE_MASK;
+    tlbEntryLo = rand() & (FRAME_MASK | TLB_WRITE | TLB_VALID);
+    mmuBadAddr = rand();
+    mmuBadAccs = rand() & MMU_ACCS_MASK;
+    randomIndex = TLB_MASK;
+    saveState(&cores[core]);
   }
-  tlbIndex = rand() & TLB_MASK;
-  tlbEntryHi = rand() & PAGE_MASK;
-  tlbEntryLo = rand() & (FRAME_MASK | TLB_WRITE | TLB_VALID);
-  mmuBadAddr = rand();
-  mmuBadAccs = rand() & MMU_ACCS_MASK;
-  randomIndex = TLB_MASK;
+  loadState(&cores[curCore]);
 }
 
 
-void mmuInit(void) {
+void mmuInit(int nCores) {
+  numCores = nCores;
+  curCore = 0;
   mmuReset();
 }
 
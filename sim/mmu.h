@@ -33,6 +33,7 @@ typedef struct {
 
 Word mmuFetchInstr(Word vAddr, Bool userMode);
 Word mmuReadWord(Word vAddr, Bool userMode);
+Word mmuReadLinkWord(Word vAddr, Bool userMode, Word *pAddrp);
 Half mmuReadHalf(Word vAddr, Bool userMode);
 Byte mmuReadByte(Word vAddr, Bool userMode);
 void mmuWriteWord(Word vAddr, Word data, Bool userMode);
@@ -58,8 +59,10 @@ void mmuTbwi(void);
 TLB_Entry mmuGetTLB(int index);
 void mmuSetTLB(int index, TLB_Entry tlbEntry);
 
+void mmuSelectCore(int core);
+
 void mmuReset(void);
-void mmuInit(void);
+void mmuInit(int nCores);
 void mmuExit(void);
 
 
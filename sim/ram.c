@@ -7,6 +7,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <setjmp.h>
+#include <sys/mman.h>
 
 #include "common.h"
 #include "console.h"
@@ -15,9 +16,19 @@
 #include "ram.h"
 
 
+/*
+ * RAM is anonymous memory from mmap: it reads as zero, and the
+ * host commits pages only when they are touched. Unless zeroed
+ * RAM is requested, a reset fills it with a pseudo-random pattern
+ * to mimic uninitialized DRAM, which touches every page. The
+ * program image is read once when it is loaded (so changing the
+ * file later has no effect), and copied into RAM at every reset.
+ */
+
 static Byte *ram;
 static unsigned int ramSize;
-static FILE *progImage;
+static Bool ramZero;
+static Byte *progImage;
 static unsigned int progSize;
 static unsigned int progAddr;
 
@@ -58,56 +69,139 @@ void ramWrite(Word pAddr, Word *src, int nWords) {
 }
 
 
-void ramReset(void) {
-  unsigned int i;
+/*
+ * Give a device direct access to nBytes of RAM starting at
+ * pAddr, e.g. for DMA. Returns NULL if the area is not fully
+ * inside of RAM. The bytes are stored big-endian, i.e. in the
+ * same order as in a disk sector.
+ */
+Byte *ramMap(Word pAddr, Word nBytes) {
+  if (pAddr - RAM_BASE > ramSize ||
+      nBytes > ramSize - (pAddr - RAM_BASE)) {
+    return NULL;
+  }
+  return ram + (pAddr - RAM_BASE);
+}
+
+
+static void mapRAM(void) {
+  void *p;
+
+  p = mmap(ram, ramSize, PROT_READ | PROT_WRITE,
+           MAP_PRIVATE | MAP_ANONYMOUS | (ram != NULL ? MAP_FIXED : 0),
+           -1, 0);
+  if (p == MAP_FAILED) {
+    error("cannot allocate RAM");
+  }
+  ram = p;
+}
 
+
+static void fillRAM(void) {
+  Dword *p;
+  Dword *q;
+  Dword x;
+
+  /* xorshift generator, 8 bytes per step, seeded by rand() */
+  x = ((Dword) rand() << 32) | (Dword) rand() | 1;
+  p = (Dword *) ram;
+  q = (Dword *) (ram + ramSize);
+  while (p < q) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *p++ = x;
+  }
+}
+
+
+void ramReset(void) {
   cPrintf("Resetting RAM...\n");
-  for (i = 0; i < ramSize; i++) {
-    ram[i] = rand();
+  if (ramZero) {
+    /* drop all pages, they read as zero again */
+    mapRAM();
+  } else {
+    fillRAM();
   }
   cPrintf("%6d MB RAM installed", ramSize / M);
+  if (ramZero) {
+    cPrintf(" (zeroed)");
+  }
   if (progImage != NULL) {
-    fseek(progImage, 0, SEEK_SET);
-    if (fread(ram + progAddr, progSize, 1, progImage) != 1) {
-      error("cannot read program image file");
-    }
+    memcpy(ram + progAddr, progImage, progSize);
     cPrintf(", %d bytes loaded", progSize);
   }
   cPrintf(".\n");
 }
 
 
+static void openImage(char *progImageName, unsigned int progLoadAddr) {
+  FILE *file;
+
+  file = fopen(progImageName, "rb");
+  if (file == NULL) {
+    error("cannot open program file '%s'", progImageName);
+  }
+  fseek(file, 0, SEEK_END);
+  progSize = ftell(file);
+  progAddr = progLoadAddr;
+  if (progAddr + progSize > ramSize) {
+    error("program file or load address too big");
+  }
+  if (progSize > 0) {
+    progImage = malloc(progSize);
+    if (progImage == NULL) {
+      error("cannot allocate program image");
+    }
+    fseek(file, 0, SEEK_SET);
+    if (fread(progImage, progSize, 1, file) != 1) {
+      error("cannot read program image file");
+    }
+  }
+  fclose(file);
+}
+
+
+/*
+ * Load a program into RAM which is already set up, without
+ * resetting it (for the jobs of a simulation server). The
+ * image is copied again at every later reset.
+ */
+void ramLoad(char *progImageName, unsigned int progLoadAddr) {
+  openImage(progImageName, progLoadAddr);
+  if (progImage != NULL) {
+    memcpy(ram + progAddr, progImage, progSize);
+  }
+  cPrintf("%6d bytes loaded into RAM.\n", progSize);
+}
+
+
 void ramInit(unsigned int mainMemorySize,
+             Bool zeroMemory,
              char *progImageName,
              unsigned int progLoadAddr) {
   /* allocate RAM */
   ramSize = mainMemorySize;
-  ram = malloc(ramSize);
-  if (ram == NULL) {
-    error("cannot allocate RAM");
-  }
+  ramZero = zeroMemory;
+  ram = NULL;
+  mapRAM();
   /* possibly load program image */
-  if (progImageName == NULL) {
-    /* no program to load */
-    progImage = NULL;
-  } else {
-    /* load program */
-    progImage = fopen(progImageName, "rb");
-    if (progImage == NULL) {
-      error("cannot open program file '%s'", progImageName);
-    }
-    fseek(progImage, 0, SEEK_END);
-    progSize = ftell(progImage);
-    progAddr = progLoadAddr;
-    if (progAddr + progSize > ramSize) {
-      error("program file or load address too big");
-    }
-    /* do actual loading of image in ramReset() */
+  progImage = NULL;
+  if (progImageName != NULL) {
+    /* do actual copying of image in ramReset() */
+    openImage(progImageName, progLoadAddr);
   }
   ramReset();
 }
 
 
 void ramExit(void) {
-  free(ram);
+  if (progImage != NULL) {
+    free(progImage);
+    progImage = NULL;
+  }
+  if (ram != NULL) {
+    munmap(ram, ramSize);
+    ram = NULL;
+  }
 }
@@ -9,9 +9,12 @@
 
 void ramRead(Word pAddr, Word *dst, int nWords);
 void ramWrite(Word pAddr, Word *src, int nWords);
+Byte *ramMap(Word pAddr, Word nBytes);
 
 void ramReset(void);
+void ramLoad(char *progImageName, unsigned int progLoadAddr);
 void ramInit(unsigned int mainMemorySize,
+             Bool zeroMemory,
              char *progImageName,
              unsigned int progLoadAddr);
 void ramExit(void);
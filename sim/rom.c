@@ -62,6 +62,29 @@ void romReset(void) {
 }
 
 
+static void openImage(char *progImageName) {
+  progImage = fopen(progImageName, "rb");
+  if (progImage == NULL) {
+    error("cannot open ROM image '%s'", progImageName);
+  }
+  fseek(progImage, 0, SEEK_END);
+  progSize = ftell(progImage);
+  if (progSize > ROM_SIZE) {
+    error("ROM image too big");
+  }
+}
+
+
+/*
+ * Plug a ROM image into the ROM which is already set up (for
+ * the jobs of a simulation server).
+ */
+void romLoad(char *progImageName) {
+  openImage(progImageName);
+  romReset();
+}
+
+
 void romInit(char *progImageName) {
   /* allocate ROM */
   rom = malloc(ROM_SIZE);
@@ -73,17 +96,8 @@ void romInit(char *progImageName) {
     /* no ROM to plug in */
     progImage = NULL;
   } else {
-    /* plug in ROM */
-    progImage = fopen(progImageName, "rb");
-    if (progImage == NULL) {
-      error("cannot open ROM image '%s'", progImageName);
-    }
-    fseek(progImage, 0, SEEK_END);
-    progSize = ftell(progImage);
-    if (progSize > ROM_SIZE) {
-      error("ROM image too big");
-    }
-    /* do actual loading of image in romReset() */
+    /* plug in ROM, do actual loading of image in romReset() */
+    openImage(progImageName);
   }
   romReset();
 }
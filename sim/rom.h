@@ -11,6 +11,7 @@ void romRead(Word pAddr, Word *dst, int nWords);
 void romWrite(Word pAddr, Word *src, int nWords);
 
 void romReset(void);
+void romLoad(char *progImageName);
 void romInit(char *progImageName);
 void romExit(void);
 
@@ -13,6 +13,7 @@
 #include "error.h"
 #include "except.h"
 #include "timer.h"
+#include "hostio.h"
 #include "sdcard.h"
 
 
@@ -41,22 +42,61 @@ static unsigned short crc16;
 static unsigned char dataBuf[SDC_SECTOR_SIZE];
 
 
-static void sectorRead(unsigned int sctno) {
-  fseek(sdcardImage, sctno * SDC_SECTOR_SIZE, SEEK_SET);
-  if (fread(dataBuf, SDC_SECTOR_SIZE, 1, sdcardImage) != 1) {
-    error("cannot read from SD card image");
-  }
+/*
+ * Image file transfers go through the host I/O worker. Writes
+ * are not waited for. During a multiple block read the next
+ * sector is read ahead while the current one is sent.
+ */
+
+
+static HostIO sdcardIO;
+static unsigned char ioBuf[SDC_SECTOR_SIZE];
+static long aheadSct = -1;
+
+
+static void ioStart(unsigned int sctno, Bool write) {
+  sdcardIO.file = sdcardImage;
+  sdcardIO.offset = (long) sctno * SDC_SECTOR_SIZE;
+  sdcardIO.buf = ioBuf;
+  sdcardIO.size = SDC_SECTOR_SIZE;
+  sdcardIO.write = write;
+  hostioSubmit(&sdcardIO);
 }
 
 
-static void sectorWrite(unsigned int sctno) {
-  fseek(sdcardImage, sctno * SDC_SECTOR_SIZE, SEEK_SET);
-  if (fwrite(dataBuf, SDC_SECTOR_SIZE, 1, sdcardImage) != 1) {
+static void ioWait(void) {
+  /* only a failed write matters, not a failed read ahead */
+  if (!hostioWait(&sdcardIO) && sdcardIO.write) {
     error("cannot write to SD card image");
   }
 }
 
 
+static void sectorRead(unsigned int sctno, Bool readAhead) {
+  ioWait();
+  if (aheadSct != sctno || !sdcardIO.ok) {
+    ioStart(sctno, false);
+    if (!hostioWait(&sdcardIO)) {
+      error("cannot read from SD card image");
+    }
+  }
+  aheadSct = -1;
+  memcpy(dataBuf, ioBuf, SDC_SECTOR_SIZE);
+  if (readAhead && sctno + 1 < totalSectors) {
+    ioStart(sctno + 1, false);
+    aheadSct = sctno + 1;
+  }
+}
+
+
+static void sectorWrite(unsigned int sctno) {
+  ioWait();
+  aheadSct = -1;
+  memcpy(ioBuf, dataBuf, SDC_SECTOR_SIZE);
+  ioStart(sctno, true);
+}
+
+
 /**************************************************************/
 
 
@@ -184,6 +224,7 @@ static unsigned char cid[16] = {
 #define ST_WR_CRC	8
 #define ST_WR_RSP	9
 #define ST_WR_BUSY	10
+#define ST_RD_WAIT	11
 
 
 #define PRM_INIT_COUNT	10	/* realistic value: 389 */
@@ -191,6 +232,7 @@ static unsigned char cid[16] = {
 #define CSD_DELAY_COUNT	2	/* realistic value: ?? */
 #define RD_DELAY_COUNT	5	/* realistic value: 150 */
 #define WR_BUSY_COUNT	7	/* realistic value: 170 */
+#define STOP_BUSY_COUNT	2	/* realistic value: ?? */
 
 
 static int state;
@@ -204,6 +246,7 @@ static Bool crcChecked;
 static Bool appCmdSeen;
 static int initCnt;
 static unsigned int sctno;
+static Bool multiBlock;
 
 
 static void sdcardCallback(int n) {
@@ -217,6 +260,19 @@ static void sdcardCallback(int n) {
     status |= SDC_STAT_READY;
     return;
   }
+  if (multiBlock &&
+      (state == ST_RD_DELAY || state == ST_RD_DATA ||
+       state == ST_RD_CRC || state == ST_RD_WAIT) &&
+      dataReg == 0x4C) {
+    /* CMD12 arrives while sending sectors, start accumulating it */
+    cmd[0] = dataReg;
+    currCnt = 1;
+    crc7 = crc7_update(crc7, dataReg);
+    dataReg = 0xFF;
+    status |= SDC_STAT_READY;
+    state = ST_ACCUM_CMD;
+    return;
+  }
   switch (state) {
     case ST_ACCUM_CMD:
       if (currCnt < 6) {
@@ -311,15 +367,40 @@ static void sdcardCallback(int n) {
                 ((unsigned int) cmd[4] <<  0);
         if (sctno < totalSectors) {
           /* valid address */
-          sectorRead(sctno);
+          sectorRead(sctno, false);
+          xpctCnt = RD_DELAY_COUNT;
+          dataCnt = SDC_SECTOR_SIZE;
+          state = ST_RD_DELAY;
+        } else {
+          /* address out of range */
+          dataReg |= SDC_ANS_PARAM_ERR;
+        }
+      } else
+      if (!appCmdSeen && cmd[0] == 0x52) {
+        /* CMD18: read multiple sectors */
+        sctno = ((unsigned int) cmd[1] << 24) |
+                ((unsigned int) cmd[2] << 16) |
+                ((unsigned int) cmd[3] <<  8) |
+                ((unsigned int) cmd[4] <<  0);
+        if (sctno < totalSectors) {
+          /* valid address */
+          sectorRead(sctno, true);
           xpctCnt = RD_DELAY_COUNT;
           dataCnt = SDC_SECTOR_SIZE;
+          multiBlock = true;
           state = ST_RD_DELAY;
         } else {
           /* address out of range */
           dataReg |= SDC_ANS_PARAM_ERR;
         }
       } else
+      if (!appCmdSeen && cmd[0] == 0x4C) {
+        /* CMD12: stop transmission */
+        /* response R1b */
+        multiBlock = false;
+        xpctCnt = STOP_BUSY_COUNT;
+        state = ST_WR_BUSY;
+      } else
       if (!appCmdSeen && cmd[0] == 0x58) {
         /* CMD24: write single sector */
         sctno = ((unsigned int) cmd[1] << 24) |
@@ -333,6 +414,21 @@ static void sdcardCallback(int n) {
           /* address out of range */
           dataReg |= SDC_ANS_PARAM_ERR;
         }
+      } else
+      if (!appCmdSeen && cmd[0] == 0x59) {
+        /* CMD25: write multiple sectors */
+        sctno = ((unsigned int) cmd[1] << 24) |
+                ((unsigned int) cmd[2] << 16) |
+                ((unsigned int) cmd[3] <<  8) |
+                ((unsigned int) cmd[4] <<  0);
+        if (sctno < totalSectors) {
+          /* valid address */
+          multiBlock = true;
+          state = ST_WR_WAIT;
+        } else {
+          /* address out of range */
+          dataReg |= SDC_ANS_PARAM_ERR;
+        }
       } else {
         /* illegal command */
         dataReg |= SDC_ANS_ILLEGAL_CMD;
@@ -393,14 +489,40 @@ static void sdcardCallback(int n) {
       currCnt++;
       if (currCnt == xpctCnt) {
         currCnt = 0;
-        state = ST_ACCUM_CMD;
+        if (!multiBlock) {
+          state = ST_ACCUM_CMD;
+        } else {
+          /* go on with the next sector until CMD12 arrives */
+          sctno++;
+          if (sctno < totalSectors) {
+            sectorRead(sctno, true);
+            xpctCnt = RD_DELAY_COUNT;
+            dataCnt = SDC_SECTOR_SIZE;
+            state = ST_RD_DELAY;
+          } else {
+            state = ST_RD_WAIT;
+          }
+        }
       }
       break;
+    case ST_RD_WAIT:
+      dataReg = 0xFF;
+      status |= SDC_STAT_READY;
+      break;
     case ST_WR_WAIT:
-      if (dataReg == 0xFE) {
+      if (dataReg == 0xFE ||
+          (multiBlock && dataReg == 0xFC)) {
+        /* start block token */
         currCnt = 0;
         xpctCnt = SDC_SECTOR_SIZE;
         state = ST_WR_DATA;
+      } else
+      if (multiBlock && dataReg == 0xFD) {
+        /* stop transmission token */
+        multiBlock = false;
+        currCnt = 0;
+        xpctCnt = STOP_BUSY_COUNT;
+        state = ST_WR_BUSY;
       }
       dataReg = 0xFF;
       status |= SDC_STAT_READY;
@@ -440,12 +562,18 @@ static void sdcardCallback(int n) {
       break;
     case ST_WR_RSP:
       dataReg = 0xE0;
-      if (crc16 == 0x0000) {
+      if (crc16 != 0x0000) {
+        /* CRC error */
+        dataReg |= 0x0B;
+      } else
+      if (sctno >= totalSectors) {
+        /* write error */
+        dataReg |= 0x0D;
+      } else {
         sectorWrite(sctno);
         dataReg |= 0x05;
-      } else {
-        dataReg |= 0x0B;
       }
+      sctno++;
       status |= SDC_STAT_READY;
       currCnt = 0;
       xpctCnt = WR_BUSY_COUNT;
@@ -458,7 +586,7 @@ static void sdcardCallback(int n) {
       if (currCnt == xpctCnt) {
         dataReg = 0xFF;
         currCnt = 0;
-        state = ST_ACCUM_CMD;
+        state = multiBlock ? ST_WR_WAIT : ST_ACCUM_CMD;
       }
       break;
     default:
@@ -528,7 +656,12 @@ void sdcardWrite(Word addr, Word data) {
     case 1:
       /* write xmt data */
       dataReg = data & 0xFF;
-      timerStart(1, sdcardCallback, 0);
+      if (state == ST_RD_DATA || state == ST_WR_DATA) {
+        /* within a sector: no need to go through the timer */
+        sdcardCallback(0);
+      } else {
+        timerStart(1, sdcardCallback, 0);
+      }
       break;
     case 2:
       /* write CRC7 */
@@ -550,6 +683,9 @@ void sdcardReset(void) {
     return;
   }
   cPrintf("Resetting SD card...\n");
+  /* a transfer may still be in progress */
+  (void) hostioWait(&sdcardIO);
+  aheadSct = -1;
   status = 0;
   control = 0;
   dataReg = 0;
@@ -562,6 +698,7 @@ void sdcardReset(void) {
   idle = true;
   crcChecked = false;
   appCmdSeen = false;
+  multiBlock = false;
   initCnt = PRM_INIT_COUNT;
   if (totalSectors != 0) {
     cPrintf("SD card of size %ld sectors (%ld bytes) installed.\n",
@@ -611,5 +748,9 @@ void sdcardExit(void) {
     /* SD card not installed */
     return;
   }
+  /* let a pending write complete */
+  if (!hostioWait(&sdcardIO) && sdcardIO.write) {
+    cPrintf("Warning: cannot write to SD card image\n");
+  }
   fclose(sdcardImage);
 }
@@ -61,13 +61,19 @@ static void rcvrCallback(int dev) {
   if (debug) {
     cPrintf("\n**** SERIAL RCVR CALLBACK ****\n");
   }
-  timerStart(SERIAL_RCVR_USEC, rcvrCallback, dev);
+  if (serials[dev].rcvrCtrl & SERIAL_RCVR_RDY) {
+    /* last character not yet read, leave this one on the line */
+    timerStart(SERIAL_CHAR_USEC, rcvrCallback, dev);
+    return;
+  }
   c = fgetc(serials[dev].in);
   if (c == EOF) {
     /* no character typed */
+    timerStart(SERIAL_RCVR_USEC, rcvrCallback, dev);
     return;
   }
-  /* any character typed */
+  /* any character typed, the next one may follow immediately */
+  timerStart(SERIAL_CHAR_USEC, rcvrCallback, dev);
   serials[dev].rcvrData = c & 0xFF;
   serials[dev].rcvrCtrl |= SERIAL_RCVR_RDY;
   if (serials[dev].rcvrCtrl & SERIAL_RCVR_IEN) {
@@ -15,6 +15,7 @@
 #define SERIAL_RCVR_RDY		0x01	/* receiver has a character */
 #define SERIAL_RCVR_IEN		0x02	/* enable receiver interrupt */
 #define SERIAL_RCVR_USEC	2000	/* input checking interval */
+#define SERIAL_CHAR_USEC	260	/* character time at 38400 baud */
 
 #define SERIAL_XMTR_RDY		0x01	/* transmitter accepts a character */
 #define SERIAL_XMTR_IEN		0x02	/* enable transmitter interrupt */
@@ -0,0 +1,466 @@
+/*
+ * server.c -- simulation server for batch jobs
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <signal.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#include "common.h"
+#include "console.h"
+#include "error.h"
+#include "server.h"
+
+
+/*
+ * The server accepts jobs on a local (Unix domain) socket and
+ * runs up to a fixed number of them at the same time. The server
+ * sets up the simulated machine once (RAM, devices, caches), then
+ * every job runs in a process of its own, forked from the set-up
+ * server; it only loads its program or ROM and opens its output
+ * files. So the jobs are completely isolated from each other,
+ * share the set-up memory copy-on-write and are spread over all
+ * processors of the host. A job whose client goes away (closes
+ * the connection) is killed.
+ *
+ * A client sends its working directory and the arguments of the
+ * job, one per line, followed by an empty line. The server sends
+ * back the job's output in frames, each consisting of a type
+ * byte, a 4-byte length (big-endian), and the payload. The last
+ * frame (FRAME_EXIT) carries the exit status of the job in one
+ * byte; a job killed by a signal reports 128 + signal number.
+ */
+
+
+#define MAX_LINE	1024	/* max length of a request line */
+#define MAX_ARGS	100	/* max number of job arguments */
+
+
+typedef struct {
+  pid_t pid;			/* process running the job, 0 if free */
+  int conn;			/* connection to the client */
+  int out;			/* reading end of job's output pipe */
+  Bool killed;			/* client has gone away, job killed */
+} Job;
+
+
+static Job *jobs;		/* job table */
+static int maxJobs;		/* size of job table */
+static int numJobs;		/* number of jobs running */
+
+
+/**************************************************************/
+
+
+static Bool writeAll(int fd, Byte *buf, int size) {
+  int n;
+
+  while (size > 0) {
+    n = write(fd, buf, size);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    buf += n;
+    size -= n;
+  }
+  return true;
+}
+
+
+static Bool readAll(int fd, Byte *buf, int size) {
+  int n;
+
+  while (size > 0) {
+    n = read(fd, buf, size);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    buf += n;
+    size -= n;
+  }
+  return true;
+}
+
+
+static Bool sendFrame(int fd, int type, Byte *data, int size) {
+  Byte hdr[FRAME_HDR_SIZE];
+
+  hdr[0] = type;
+  hdr[1] = size >> 24;
+  hdr[2] = size >> 16;
+  hdr[3] = size >> 8;
+  hdr[4] = size;
+  return writeAll(fd, hdr, FRAME_HDR_SIZE) && writeAll(fd, data, size);
+}
+
+
+static int openSocket(char *path, struct sockaddr_un *addr) {
+  int sock;
+
+  if (strlen(path) >= sizeof(addr->sun_path)) {
+    error("socket path '%s' too long", path);
+  }
+  memset(addr, 0, sizeof(struct sockaddr_un));
+  addr->sun_family = AF_UNIX;
+  strcpy(addr->sun_path, path);
+  sock = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (sock < 0) {
+    error("cannot create socket");
+  }
+  return sock;
+}
+
+
+/**************************************************************/
+
+
+/*
+ * Read one line from the connection, byte by byte, so that
+ * nothing beyond the request is consumed.
+ */
+static char *readLine(int conn) {
+  char line[MAX_LINE];
+  int n;
+
+  n = 0;
+  while (1) {
+    if (!readAll(conn, (Byte *) &line[n], 1)) {
+      return NULL;
+    }
+    if (line[n] == '\n') {
+      break;
+    }
+    if (++n == MAX_LINE) {
+      return NULL;
+    }
+  }
+  line[n] = '\0';
+  return strdup(line);
+}
+
+
+/*
+ * Runs in the freshly forked job process: read the request
+ * and turn it into the argument vector of the simulation.
+ */
+static void setupJob(int conn, int out, int *argcp, char ***argvp) {
+  static char *args[MAX_ARGS + 2];
+  char *dir;
+  char *arg;
+  int n;
+  int fd;
+
+  dir = readLine(conn);
+  if (dir == NULL || chdir(dir) < 0) {
+    fprintf(stderr, "Error: bad working directory in job request\n");
+    exit(1);
+  }
+  args[0] = "sim";
+  n = 1;
+  while (1) {
+    arg = readLine(conn);
+    if (arg == NULL || n > MAX_ARGS) {
+      fprintf(stderr, "Error: bad argument list in job request\n");
+      exit(1);
+    }
+    if (*arg == '\0') {
+      break;
+    }
+    args[n++] = arg;
+  }
+  args[n] = NULL;
+  close(conn);
+  /* the job has no input, and its output goes to the server */
+  fd = open("/dev/null", O_RDONLY);
+  if (fd >= 0) {
+    dup2(fd, 0);
+    close(fd);
+  }
+  dup2(out, 1);
+  dup2(out, 2);
+  close(out);
+  setvbuf(stdout, NULL, _IOLBF, 0);
+  signal(SIGPIPE, SIG_DFL);
+  *argcp = n;
+  *argvp = args;
+}
+
+
+/*
+ * Start a job on a new connection. Returns true in the job
+ * process, false in the server.
+ */
+static Bool startJob(Job *job, int sock, int conn,
+                     int *argcp, char ***argvp) {
+  int pipeFds[2];
+  pid_t pid;
+  int i;
+
+  if (pipe(pipeFds) < 0) {
+    close(conn);
+    return false;
+  }
+  fflush(stdout);
+  fflush(stderr);
+  pid = fork();
+  if (pid < 0) {
+    close(pipeFds[0]);
+    close(pipeFds[1]);
+    close(conn);
+    return false;
+  }
+  if (pid == 0) {
+    /* job process: drop everything belonging to the server */
+    close(sock);
+    close(pipeFds[0]);
+    for (i = 0; i < maxJobs; i++) {
+      if (jobs[i].pid != 0) {
+        close(jobs[i].conn);
+        close(jobs[i].out);
+      }
+    }
+    setupJob(conn, pipeFds[1], argcp, argvp);
+    return true;
+  }
+  /* server process */
+  close(pipeFds[1]);
+  job->pid = pid;
+  job->conn = conn;
+  job->out = pipeFds[0];
+  job->killed = false;
+  numJobs++;
+  return false;
+}
+
+
+static void finishJob(Job *job) {
+  int status;
+  Byte code;
+
+  close(job->out);
+  while (waitpid(job->pid, &status, 0) < 0 && errno == EINTR) ;
+  if (WIFEXITED(status)) {
+    code = WEXITSTATUS(status);
+  } else {
+    code = 128 + WTERMSIG(status);
+  }
+  (void) sendFrame(job->conn, FRAME_EXIT, &code, 1);
+  close(job->conn);
+  job->pid = 0;
+  numJobs--;
+}
+
+
+static void killJob(Job *job) {
+  if (!job->killed) {
+    kill(job->pid, SIGKILL);
+    job->killed = true;
+  }
+}
+
+
+static void relayOutput(Job *job) {
+  Byte buf[4096];
+  int n;
+
+  n = read(job->out, buf, sizeof(buf));
+  if (n < 0 && errno == EINTR) {
+    return;
+  }
+  if (n <= 0) {
+    /* the job has terminated */
+    finishJob(job);
+    return;
+  }
+  if (!sendFrame(job->conn, FRAME_OUTPUT, buf, n)) {
+    /* the client has gone away, so does the job */
+    killJob(job);
+  }
+}
+
+
+/*
+ * Run the server loop on socket sockName with at most nJobs
+ * jobs at a time (0: one per host processor). Returns only in a
+ * job process, with the argument count and vector replaced by
+ * those of the job.
+ */
+void serverRun(char *sockName, int nJobs,
+               int *argcp, char ***argvp) {
+  struct sockaddr_un addr;
+  int sock;
+  int conn;
+  struct pollfd *fds;
+  int nfds;
+  int i, j;
+
+  maxJobs = nJobs;
+  if (maxJobs <= 0) {
+    maxJobs = sysconf(_SC_NPROCESSORS_ONLN);
+  }
+  if (maxJobs <= 0) {
+    maxJobs = 1;
+  }
+  jobs = calloc(maxJobs, sizeof(Job));
+  fds = malloc((2 * maxJobs + 1) * sizeof(struct pollfd));
+  if (jobs == NULL || fds == NULL) {
+    error("cannot allocate job table");
+  }
+  sock = openSocket(sockName, &addr);
+  unlink(sockName);
+  if (bind(sock, (struct sockaddr *) &addr, sizeof(addr)) < 0 ||
+      listen(sock, 64) < 0) {
+    error("cannot listen on socket '%s'", sockName);
+  }
+  /* a client which goes away must not kill the server */
+  signal(SIGPIPE, SIG_IGN);
+  printf("ECO32 Simulator serving on '%s', %d jobs at a time\n",
+         sockName, maxJobs);
+  fflush(stdout);
+  while (1) {
+    nfds = 0;
+    if (numJobs < maxJobs) {
+      /* only accept new jobs if they can be started */
+      fds[nfds].fd = sock;
+      fds[nfds].events = POLLIN;
+      nfds++;
+    }
+    for (i = 0; i < maxJobs; i++) {
+      if (jobs[i].pid != 0) {
+        fds[nfds].fd = jobs[i].out;
+        fds[nfds].events = POLLIN;
+        nfds++;
+        if (!jobs[i].killed) {
+          /* no events: only a hangup of the client is reported */
+          fds[nfds].fd = jobs[i].conn;
+          fds[nfds].events = 0;
+          nfds++;
+        }
+      }
+    }
+    if (poll(fds, nfds, -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      error("poll failed in simulation server");
+    }
+    for (j = 0; j < nfds; j++) {
+      if (fds[j].revents == 0 || fds[j].fd == sock) {
+        continue;
+      }
+      for (i = 0; i < maxJobs; i++) {
+        if (jobs[i].pid == 0) {
+          continue;
+        }
+        if (jobs[i].out == fds[j].fd) {
+          relayOutput(&jobs[i]);
+          break;
+        }
+        if (jobs[i].conn == fds[j].fd) {
+          killJob(&jobs[i]);
+          break;
+        }
+      }
+    }
+    if (numJobs < maxJobs && nfds > 0 &&
+        fds[0].fd == sock && fds[0].revents != 0) {
+      conn = accept(sock, NULL, NULL);
+      if (conn < 0) {
+        continue;
+      }
+      for (i = 0; i < maxJobs; i++) {
+        if (jobs[i].pid == 0) {
+          break;
+        }
+      }
+      if (startJob(&jobs[i], sock, conn, argcp, argvp)) {
+        /* this is the job process */
+        free(fds);
+        free(jobs);
+        return;
+      }
+    }
+  }
+}
+
+
+/**************************************************************/
+
+
+/*
+ * Submit a job to a server and wait for it; the job's output
+ * is copied to stdout, and its exit status becomes ours.
+ */
+void serverClient(int argc, char *argv[]) {
+  struct sockaddr_un addr;
+  int sock;
+  char dir[MAX_LINE];
+  Byte hdr[FRAME_HDR_SIZE];
+  Byte buf[4096];
+  int size, n;
+  int i;
+
+  /* argv[1] is "-C" */
+  if (argc < 3) {
+    fprintf(stderr, "Usage: %s -C <socket> <job arguments>\n", argv[0]);
+    exit(1);
+  }
+  sock = openSocket(argv[2], &addr);
+  if (connect(sock, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+    error("cannot connect to simulation server at '%s'", argv[2]);
+  }
+  if (getcwd(dir, MAX_LINE - 1) == NULL) {
+    error("cannot determine working directory");
+  }
+  strcat(dir, "\n");
+  if (!writeAll(sock, (Byte *) dir, strlen(dir))) {
+    error("cannot send job to simulation server");
+  }
+  for (i = 3; i < argc; i++) {
+    if (strchr(argv[i], '\n') != NULL || strlen(argv[i]) >= MAX_LINE) {
+      error("job argument %d cannot be transmitted", i - 2);
+    }
+    if (!writeAll(sock, (Byte *) argv[i], strlen(argv[i])) ||
+        !writeAll(sock, (Byte *) "\n", 1)) {
+      error("cannot send job to simulation server");
+    }
+  }
+  if (!writeAll(sock, (Byte *) "\n", 1)) {
+    error("cannot send job to simulation server");
+  }
+  while (readAll(sock, hdr, FRAME_HDR_SIZE)) {
+    size = (hdr[1] << 24) | (hdr[2] << 16) | (hdr[3] << 8) | hdr[4];
+    if (hdr[0] == FRAME_EXIT && size == 1) {
+      if (!readAll(sock, buf, 1)) {
+        break;
+      }
+      fflush(stdout);
+      exit(buf[0]);
+    }
+    while (size > 0) {
+      n = size < sizeof(buf) ? size : sizeof(buf);
+      if (!readAll(sock, buf, n)) {
+        error("connection to simulation server lost");
+      }
+      fwrite(buf, 1, n, stdout);
+      size -= n;
+    }
+  }
+  error("connection to simulation server lost");
+}
@@ -0,0 +1,20 @@
+/*
+ * server.h -- simulation server for batch jobs
+ */
+
+
+#ifndef _SERVER_H_
+#define _SERVER_H_
+
+
+#define FRAME_OUTPUT	'o'	/* frame carries job output */
+#define FRAME_EXIT	'x'	/* frame carries job exit status */
+#define FRAME_HDR_SIZE	5	/* type byte + 4 bytes length */
+
+
+void serverRun(char *sockName, int nJobs,
+               int *argcp, char ***argvp);
+void serverClient(int argc, char *argv[]);
+
+
+#endif /* _SERVER_H_ */
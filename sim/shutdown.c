@@ -23,9 +23,13 @@
 #include "serial.h"
 #include "disk.h"
 #include "sdcard.h"
+#include "ipi.h"
+#include "fpu.h"
 #include "bio.h"
 #include "output.h"
 #include "shutdown.h"
+#include "stats.h"
+#include "bprof.h"
 #include "graph1.h"
 #include "graph2.h"
 #include "mouse.h"
@@ -55,9 +59,13 @@ void shutdownWrite(Word addr, Word data) {
   serialExit();
   diskExit();
   sdcardExit();
+  ipiExit();
+  fpuExit();
   bioExit();
   outputExit();
   shutdownExit();
+  statsExit();
+  bprofExit();
   cPrintf("ECO32 Simulator shutdown\n");
   cExit();
   exit(data & 0xFF);
@@ -0,0 +1,71 @@
+/*
+ * stats.c -- statistics device
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "console.h"
+#include "error.h"
+#include "cpu.h"
+#include "icache.h"
+#include "dcache.h"
+#include "stats.h"
+
+
+/*
+ * The device lets a program read the simulator's counters,
+ * so that it can measure parts of itself. The counters are
+ * free-running; take the difference of two readings. They
+ * are truncated to 32 bits.
+ */
+Word statsRead(Word addr) {
+  Word data;
+
+  switch (addr) {
+    case STATS_INSTRS:
+      data = cpuGetTotal();
+      break;
+    case STATS_IC_MISS:
+      data = icacheGetReadMisses();
+      break;
+    case STATS_DC_READ:
+      data = dcacheGetReadAccesses();
+      break;
+    case STATS_DC_RMISS:
+      data = dcacheGetReadMisses();
+      break;
+    case STATS_DC_WRITE:
+      data = dcacheGetWriteAccesses();
+      break;
+    case STATS_DC_WMISS:
+      data = dcacheGetWriteMisses();
+      break;
+    default:
+      data = 0;
+      break;
+  }
+  return data;
+}
+
+
+void statsWrite(Word addr, Word data) {
+  /* the counters cannot be written */
+}
+
+
+void statsReset(void) {
+  cPrintf("Resetting Statistics Device...\n");
+}
+
+
+void statsInit(void) {
+  statsReset();
+}
+
+
+void statsExit(void) {
+}
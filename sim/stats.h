@@ -0,0 +1,26 @@
+/*
+ * stats.h -- statistics device
+ */
+
+
+#ifndef _STATS_H_
+#define _STATS_H_
+
+
+#define STATS_INSTRS	0x00	/* instructions executed */
+#define STATS_IC_MISS	0x04	/* icache read misses */
+#define STATS_DC_READ	0x08	/* dcache read accesses */
+#define STATS_DC_RMISS	0x0C	/* dcache read misses */
+#define STATS_DC_WRITE	0x10	/* dcache write accesses */
+#define STATS_DC_WMISS	0x14	/* dcache write misses */
+
+
+Word statsRead(Word addr);
+void statsWrite(Word addr, Word data);
+
+void statsReset(void);
+void statsInit(void);
+void statsExit(void);
+
+
+#endif /* _STATS_H_ */
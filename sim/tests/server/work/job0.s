@@ -0,0 +1,40 @@
+;
+; job.s -- a job for the simulation server test
+;
+; 0 is set by the test: a job with 0 > 0 writes "job 0"
+; to the output device and exits with status 0, the job with
+; 0 = 0 runs forever
+;
+
+	.export	start
+
+	.set	output,0xFF000000
+	.set	shutdown,0xFF100000
+
+	.code
+
+start:
+	add	$4,$0,0
+	beq	$4,$0,spin
+	add	$8,$0,output
+	add	$9,$0,msg
+loop:
+	ldbu	$10,$9,0
+	beq	$10,$0,done
+	stw	$10,$8,0
+	add	$9,$9,1
+	j	loop
+done:
+	add	$10,$4,'0'
+	stw	$10,$8,0
+	add	$10,$0,0x0A
+	stw	$10,$8,0
+	add	$8,$0,shutdown
+	stw	$4,$8,0
+spin:
+	j	spin
+
+	.data
+
+msg:
+	.byte	"job ", 0
@@ -0,0 +1,239 @@
+/*
+ * main.c -- instruction and cache miss counts of the allocator
+ */
+
+
+#include "types.h"
+#include "stdarg.h"
+#include "iolib.h"
+#include "stdlib.h"
+#include "sys/arena.h"
+
+
+#define HEAP_END	0xC0300000	/* the heap may grow up to here */
+
+#define NSMALL		1000	/* live small objects at most */
+#define NLARGE		64	/* live large objects at most */
+#define NBUFS		16	/* buffers grown by realloc */
+
+
+/**************************************************************/
+
+/* memory for the allocator */
+
+
+extern char _ebss[];
+
+static char *curBrk;
+
+
+void *sbrk(int n) {
+  char *old;
+
+  if (curBrk == 0) {
+    curBrk = (char *) (((unsigned int) _ebss + 7) & ~7U);
+  }
+  n = (n + 7) & ~7;
+  if (curBrk + n > (char *) HEAP_END) {
+    return (void *) (unsigned int) -1;
+  }
+  old = curBrk;
+  curBrk += n;
+  return old;
+}
+
+
+/**************************************************************/
+
+/* simulator statistics */
+
+
+typedef struct {
+  unsigned int instrs;
+  unsigned int dcReadMisses;
+  unsigned int dcWriteMisses;
+} Counts;
+
+
+void readCounts(Counts *cp) {
+  volatile unsigned int *base;
+
+  base = (unsigned int *) 0xFF200000;
+  cp->instrs = *(base + 0);
+  cp->dcReadMisses = *(base + 3);
+  cp->dcWriteMisses = *(base + 5);
+}
+
+
+/**************************************************************/
+
+/* workloads */
+
+
+static unsigned int seed = 12345;
+
+
+unsigned int random(unsigned int n) {
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 8) % n;
+}
+
+
+/*
+ * Random allocations and frees of small objects,
+ * with 500 of them alive on the average.
+ */
+int smallObjects(void) {
+  static char *objs[NSMALL];
+  int i, j;
+
+  for (i = 0; i < 20000; i++) {
+    j = random(NSMALL);
+    if (objs[j] == NULL) {
+      objs[j] = malloc(4 + random(200));
+      *objs[j] = j;
+    } else {
+      free(objs[j]);
+      objs[j] = NULL;
+    }
+  }
+  for (j = 0; j < NSMALL; j++) {
+    free(objs[j]);
+    objs[j] = NULL;
+  }
+  return i + NSMALL;
+}
+
+
+/*
+ * The same for objects between 300 bytes and 8 KB,
+ * which exercises best fit and coalescing.
+ */
+int largeObjects(void) {
+  static char *objs[NLARGE];
+  int i, j;
+
+  for (i = 0; i < 5000; i++) {
+    j = random(NLARGE);
+    if (objs[j] == NULL) {
+      objs[j] = malloc(300 + random(8000));
+      *objs[j] = j;
+    } else {
+      free(objs[j]);
+      objs[j] = NULL;
+    }
+  }
+  for (j = 0; j < NLARGE; j++) {
+    free(objs[j]);
+    objs[j] = NULL;
+  }
+  return i + NLARGE;
+}
+
+
+/*
+ * Buffers growing in steps of 64 bytes up to 8 KB,
+ * interleaved, as when reading several files into memory.
+ */
+int growBuffers(void) {
+  static char *bufs[NBUFS];
+  int size, j, n;
+
+  n = 0;
+  for (size = 64; size <= 8192; size += 64) {
+    for (j = 0; j < NBUFS; j++) {
+      bufs[j] = realloc(bufs[j], size);
+      bufs[j][size - 1] = j;
+      n++;
+    }
+  }
+  for (j = 0; j < NBUFS; j++) {
+    free(bufs[j]);
+    bufs[j] = NULL;
+  }
+  return n + NBUFS;
+}
+
+
+/*
+ * Zeroed allocations of 1 KB.
+ */
+int zeroedObjects(void) {
+  char *p;
+  int i;
+
+  for (i = 0; i < 500; i++) {
+    p = calloc(256, 4);
+    free(p);
+  }
+  return 2 * i;
+}
+
+
+/*
+ * Many short-lived objects of mixed sizes in an arena,
+ * which is reset in one go instead of freeing them.
+ */
+int arenaObjects(void) {
+  static Arena *arena;
+  char *p;
+  int i, j;
+
+  if (arena == NULL) {
+    arena = arenaCreate(65536);
+  }
+  for (i = 0; i < 50; i++) {
+    for (j = 0; j < 200; j++) {
+      p = arenaAlloc(arena, 4 + random(j < 180 ? 60 : 600));
+      *p = j;
+    }
+    arenaReset(arena);
+  }
+  return i * (j + 1);
+}
+
+
+typedef struct {
+  char *name;
+  int (*run)(void);
+} Workload;
+
+
+Workload workloads[] = {
+  { "small",   smallObjects  },
+  { "large",   largeObjects  },
+  { "realloc", growBuffers   },
+  { "calloc",  zeroedObjects },
+  { "arena",   arenaObjects  },
+};
+
+
+/**************************************************************/
+
+
+void main(void) {
+  Counts before, after;
+  Workload *wp;
+  unsigned int instrs, rmiss, wmiss;
+  int i, n;
+
+  printf("\nAllocator benchmark: counts per operation\n");
+  printf("(an operation is one malloc, calloc, realloc, "
+         "free or reset)\n\n");
+  printf("%-10s %8s %12s %10s %10s %10s\n",
+         "workload", "ops", "instrs", "instr/op",
+         "rd miss", "wr miss");
+  for (i = 0; i < sizeof(workloads) / sizeof(workloads[0]); i++) {
+    wp = &workloads[i];
+    readCounts(&before);
+    n = (*wp->run)();
+    readCounts(&after);
+    instrs = after.instrs - before.instrs;
+    rmiss = after.dcReadMisses - before.dcReadMisses;
+    wmiss = after.dcWriteMisses - before.dcWriteMisses;
+    printf("%-10s %8d %12u %10u %10u %10u\n",
+           wp->name, n, instrs, instrs / n, rmiss, wmiss);
+  }
+  printf("\nheap: %u bytes\n", curBrk - _ebss);
+  printf("\nDone.\n");
+}
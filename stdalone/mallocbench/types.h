@@ -0,0 +1,16 @@
+/*
+ * types.h -- additional types
+ */
+
+
+#ifndef _TYPES_H_
+#define _TYPES_H_
+
+
+typedef int Bool;
+
+#define FALSE	0
+#define TRUE	1
+
+
+#endif /* _TYPES_H_ */
@@ -0,0 +1,14 @@
+/*
+ * biolib.h -- basic I/O library
+ */
+
+
+#ifndef _BIOLIB_H_
+#define _BIOLIB_H_
+
+
+char getc(void);
+void putc(char c);
+
+
+#endif /* _BIOLIB_H_ */
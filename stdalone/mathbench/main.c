@@ -0,0 +1,209 @@
+/*
+ * main.c -- cycle counts of the math library functions
+ */
+
+
+#include "types.h"
+#include "stdarg.h"
+#include "iolib.h"
+#include "math.h"
+
+
+#define NARGS		16	/* arguments per function */
+#define NREPS		8	/* timed passes over the arguments */
+
+
+int errno;
+
+
+/**************************************************************/
+
+/* timer */
+
+
+static unsigned int startTicks;
+
+
+void startTimer(void) {
+  volatile unsigned int *base;
+
+  base = (unsigned int *) 0xF0000000;
+  *(base + 0) = 0x00000000;
+  *(base + 1) = 0xFFFFFFFF;
+  startTicks = *(base + 2);
+}
+
+
+unsigned int stopTimer(void) {
+  volatile unsigned int *base;
+
+  base = (unsigned int *) 0xF0000000;
+  return startTicks - *(base + 2);
+}
+
+
+/**************************************************************/
+
+/* functions under test */
+
+
+double nop1(double x) {
+  return x;
+}
+
+
+double nop2(double x, double y) {
+  return x;
+}
+
+
+/*
+ * The functions with integer or pointer arguments
+ * are called through a wrapper; the extra call is
+ * included in their counts.
+ */
+
+
+double frexp1(double x) {
+  int e;
+
+  return frexp(x, &e);
+}
+
+
+double ldexp1(double x) {
+  return ldexp(x, 7);
+}
+
+
+double modf1(double x) {
+  double i;
+
+  return modf(x, &i);
+}
+
+
+typedef struct {
+  char *name;
+  double (*f1)(double x);
+  double (*f2)(double x, double y);
+  double xlo, xhi;		/* range of x */
+  double ylo, yhi;		/* range of y, if any */
+} Function;
+
+
+Function functions[] = {
+  { "sqrt",    sqrt,   0,     0.0,    100.0,  0.0,  0.0 },
+  { "exp",     exp,    0,     -20.0,  20.0,   0.0,  0.0 },
+  { "log",     log,    0,     0.01,   100.0,  0.0,  0.0 },
+  { "log10",   log10,  0,     0.01,   100.0,  0.0,  0.0 },
+  { "pow",     0,      pow,   0.1,    10.0,   -8.0, 8.0 },
+  { "sin",     sin,    0,     -10.0,  10.0,   0.0,  0.0 },
+  { "cos",     cos,    0,     -10.0,  10.0,   0.0,  0.0 },
+  { "tan",     tan,    0,     -10.0,  10.0,   0.0,  0.0 },
+  { "sin big", sin,    0,     1.0e6,  1.0e22, 0.0,  0.0 },
+  { "asin",    asin,   0,     -1.0,   1.0,    0.0,  0.0 },
+  { "acos",    acos,   0,     -1.0,   1.0,    0.0,  0.0 },
+  { "atan",    atan,   0,     -10.0,  10.0,   0.0,  0.0 },
+  { "atan2",   0,      atan2, -10.0,  10.0,   -1.0, 1.0 },
+  { "sinh",    sinh,   0,     -10.0,  10.0,   0.0,  0.0 },
+  { "cosh",    cosh,   0,     -10.0,  10.0,   0.0,  0.0 },
+  { "tanh",    tanh,   0,     -10.0,  10.0,   0.0,  0.0 },
+  { "fmod",    0,      fmod,  -1.0e3, 1.0e3,  0.5,  7.0 },
+  { "frexp",   frexp1, 0,     -1.0e3, 1.0e3,  0.0,  0.0 },
+  { "ldexp",   ldexp1, 0,     -1.0e3, 1.0e3,  0.0,  0.0 },
+  { "modf",    modf1,  0,     -1.0e3, 1.0e3,  0.0,  0.0 },
+  { "floor",   floor,  0,     -1.0e3, 1.0e3,  0.0,  0.0 },
+  { "ceil",    ceil,   0,     -1.0e3, 1.0e3,  0.0,  0.0 },
+  { "fabs",    fabs,   0,     -1.0e3, 1.0e3,  0.0,  0.0 },
+};
+
+
+/**************************************************************/
+
+/* measurement */
+
+
+double xargs[NARGS];
+double yargs[NARGS];
+volatile double sink;
+
+
+/*
+ * Spread the arguments evenly over the ranges; the y
+ * arguments run backwards, so that the pairs vary.
+ */
+void makeArgs(Function *fp) {
+  int i;
+  double t;
+
+  for (i = 0; i < NARGS; i++) {
+    t = (i + 0.5) / NARGS;
+    xargs[i] = fp->xlo + t * (fp->xhi - fp->xlo);
+    yargs[i] = fp->yhi - t * (fp->yhi - fp->ylo);
+  }
+}
+
+
+/*
+ * Clock cycles for NREPS passes over the arguments,
+ * after one untimed pass to warm up the caches.
+ */
+unsigned int run1(double (*f)(double x)) {
+  int i, j;
+  unsigned int ticks;
+
+  for (i = 0; i < NARGS; i++) {
+    sink = (*f)(xargs[i]);
+  }
+  startTimer();
+  for (j = 0; j < NREPS; j++) {
+    for (i = 0; i < NARGS; i++) {
+      sink = (*f)(xargs[i]);
+    }
+  }
+  ticks = stopTimer();
+  return ticks;
+}
+
+
+unsigned int run2(double (*f)(double x, double y)) {
+  int i, j;
+  unsigned int ticks;
+
+  for (i = 0; i < NARGS; i++) {
+    sink = (*f)(xargs[i], yargs[i]);
+  }
+  startTimer();
+  for (j = 0; j < NREPS; j++) {
+    for (i = 0; i < NARGS; i++) {
+      sink = (*f)(xargs[i], yargs[i]);
+    }
+  }
+  ticks = stopTimer();
+  return ticks;
+}
+
+
+void main(void) {
+  unsigned int base1, base2, ticks;
+  int i;
+  Function *fp;
+
+  printf("\nMath library benchmark: clock cycles per call\n");
+  printf("(average of %d calls, loop overhead subtracted)\n\n",
+         NARGS * NREPS);
+  base1 = run1(nop1);
+  base2 = run2(nop2);
+  for (i = 0; i < sizeof(functions) / sizeof(functions[0]); i++) {
+    fp = &functions[i];
+    makeArgs(fp);
+    if (fp->f1 != 0) {
+      ticks = run1(fp->f1) - base1;
+    } else {
+      ticks = run2(fp->f2) - base2;
+    }
+    printf("%-10s %8u\n", fp->name, ticks / (NARGS * NREPS));
+  }
+  printf("\nDone.\n");
+}
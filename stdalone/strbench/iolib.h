@@ -0,0 +1,18 @@
+/*
+ * iolib.h -- I/O library
+ */
+
+
+#ifndef _IOLIB_H_
+#define _IOLIB_H_
+
+
+char getchar(void);
+void putchar(char c);
+void putString(char *s);
+void getLine(char *prompt, char *line, int max);
+void vprintf(char *fmt, va_list ap);
+void printf(char *fmt, ...);
+
+
+#endif /* _IOLIB_H_ */
@@ -0,0 +1,296 @@
+/*
+ * main.c -- instruction counts of the string functions
+ */
+
+
+#include "types.h"
+#include "stdarg.h"
+#include "iolib.h"
+#include "string.h"
+
+
+#define MAXLEN		4096	/* longest operand */
+#define NREPS		4	/* calls per measurement */
+
+
+/*
+ * The C versions of the library functions are compiled
+ * with their names prefixed by 'c'; the plain names refer
+ * to the library as built by default, i.e. to the hand-coded
+ * routines where there are any.
+ */
+void *cmemcpy(void *s, const void *ct, size_t n);
+void *cmemmove(void *s, const void *ct, size_t n);
+void *cmemset(void *s, int c, size_t n);
+int cmemcmp(const void *cs, const void *ct, size_t n);
+size_t cstrlen(const char *cs);
+int cstrcmp(const char *cs, const char *ct);
+char *cstrcpy(char *s, const char *ct);
+
+
+/**************************************************************/
+
+/* byte at a time, as the library used to be */
+
+
+void *bmemcpy(void *s, const void *ct, size_t n) {
+  unsigned char *dst;
+  unsigned char *src;
+
+  dst = (unsigned char *) s;
+  src = (unsigned char *) ct;
+  while (n-- != 0) {
+    *dst++ = *src++;
+  }
+  return s;
+}
+
+
+void *bmemmove(void *s, const void *ct, size_t n) {
+  unsigned char *dst;
+  unsigned char *src;
+
+  dst = (unsigned char *) s;
+  src = (unsigned char *) ct;
+  if (dst < src) {
+    while (n-- != 0) {
+      *dst++ = *src++;
+    }
+  } else {
+    dst += n;
+    src += n;
+    while (n-- != 0) {
+      *--dst = *--src;
+    }
+  }
+  return s;
+}
+
+
+void *bmemset(void *s, int c, size_t n) {
+  unsigned char *dst;
+
+  dst = (unsigned char *) s;
+  while (n-- != 0) {
+    *dst++ = c;
+  }
+  return s;
+}
+
+
+int bmemcmp(const void *cs, const void *ct, size_t n) {
+  unsigned char *dst;
+  unsigned char *src;
+
+  dst = (unsigned char *) cs;
+  src = (unsigned char *) ct;
+  while (n-- != 0) {
+    if (*dst != *src) {
+      return (int) *dst - (int) *src;
+    }
+    dst++;
+    src++;
+  }
+  return 0;
+}
+
+
+size_t bstrlen(const char *cs) {
+  size_t len;
+
+  len = 0;
+  while (*cs++ != '\0') {
+    len++;
+  }
+  return len;
+}
+
+
+int bstrcmp(const char *cs, const char *ct) {
+  while (*cs != '\0' && *cs == *ct) {
+    cs++;
+    ct++;
+  }
+  return (int) (unsigned char) *cs - (int) (unsigned char) *ct;
+}
+
+
+char *bstrcpy(char *s, const char *ct) {
+  char *dst;
+
+  dst = s;
+  while ((*dst++ = *ct++) != '\0') ;
+  return s;
+}
+
+
+/**************************************************************/
+
+/* simulator statistics */
+
+
+typedef struct {
+  unsigned int instrs;
+  unsigned int dcAccesses;
+} Counts;
+
+
+void readCounts(Counts *cp) {
+  volatile unsigned int *base;
+
+  base = (unsigned int *) 0xFF200000;
+  cp->instrs = *(base + 0);
+  cp->dcAccesses = *(base + 2) + *(base + 4);
+}
+
+
+/**************************************************************/
+
+/* measurement */
+
+
+#define COPY		0	/* memcpy, strcpy */
+#define MOVE		1	/* memmove */
+#define SET		2	/* memset */
+#define CMP		3	/* memcmp, strcmp */
+#define LEN		4	/* strlen */
+
+
+typedef void (*Func)(void);
+
+#define F(f)		((Func) f)
+
+
+typedef struct {
+  char *name;
+  int kind;
+  int isStr;
+  Func f[3];			/* bytes, C, library */
+} Routine;
+
+
+Routine routines[] = {
+  { "memcpy",  COPY, 0, { F(bmemcpy),  F(cmemcpy),  F(memcpy)  } },
+  { "memmove", MOVE, 0, { F(bmemmove), F(cmemmove), F(memmove) } },
+  { "memset",  SET,  0, { F(bmemset),  F(cmemset),  F(memset)  } },
+  { "memcmp",  CMP,  0, { F(bmemcmp),  F(cmemcmp),  F(memcmp)  } },
+  { "strlen",  LEN,  1, { F(bstrlen),  F(cstrlen),  F(strlen)  } },
+  { "strcmp",  CMP,  1, { F(bstrcmp),  F(cstrcmp),  F(strcmp)  } },
+  { "strcpy",  COPY, 1, { F(bstrcpy),  F(cstrcpy),  F(strcpy)  } },
+};
+
+
+int lengths[] = { 8, 64, 4096 };
+
+
+char area1[MAXLEN + 8];
+char area2[MAXLEN + 8];
+
+
+/*
+ * Fill both areas with the same non-zero bytes. For the
+ * string functions, terminate the operands after n bytes.
+ */
+void setup(char *a, char *b, int n, int isStr) {
+  int i;
+
+  for (i = 0; i < n; i++) {
+    a[i] = 'a' + i % 26;
+    b[i] = 'a' + i % 26;
+  }
+  if (isStr) {
+    a[n] = '\0';
+    b[n] = '\0';
+  }
+}
+
+
+void call(Routine *r, Func f, char *a, char *b, int n) {
+  switch (r->kind) {
+    case COPY:
+      if (r->isStr) {
+        (*(char *(*)(char *, const char *)) f)(a, b);
+      } else {
+        (*(void *(*)(void *, const void *, size_t)) f)(a, b, n);
+      }
+      break;
+    case MOVE:
+      (*(void *(*)(void *, const void *, size_t)) f)(a, b, n);
+      break;
+    case SET:
+      (*(void *(*)(void *, int, size_t)) f)(a, 'x', n);
+      break;
+    case CMP:
+      if (r->isStr) {
+        (*(int (*)(const char *, const char *)) f)(a, b);
+      } else {
+        (*(int (*)(const void *, const void *, size_t)) f)(a, b, n);
+      }
+      break;
+    case LEN:
+      (*(size_t (*)(const char *)) f)(a);
+      break;
+  }
+}
+
+
+/*
+ * Instructions and dcache accesses per call, with the
+ * first operand at offset 'o1' and the second at 'o2'
+ * from a word boundary. Copies go from the second area
+ * into the first; memmove moves within the first area,
+ * overlapping upwards.
+ */
+void measure(Routine *r, Func f, int n, int o1, int o2, Counts *cp) {
+  Counts before, after;
+  char *a, *b;
+  int i;
+
+  if (r->kind == MOVE) {
+    a = area1 + 4 + o1;
+    b = area1 + o2;
+  } else {
+    a = area1 + o1;
+    b = area2 + o2;
+  }
+  setup(a, b, n, r->isStr);
+  readCounts(&before);
+  for (i = 0; i < NREPS; i++) {
+    call(r, f, a, b, n);
+  }
+  readCounts(&after);
+  cp->instrs = (after.instrs - before.instrs) / NREPS;
+  cp->dcAccesses = (after.dcAccesses - before.dcAccesses) / NREPS;
+}
+
+
+void main(void) {
+  Routine *r;
+  Counts c[3];
+  int i, j, k, m;
+  int n, o1, o2;
+
+  printf("\nString function benchmark: instructions (dcache accesses)"
+         " per call\n\n");
+  printf("%-8s %5s %5s %18s %18s %18s\n",
+         "function", "len", "align", "bytes", "words (C)", "library");
+  for (i = 0; i < sizeof(routines) / sizeof(routines[0]); i++) {
+    r = &routines[i];
+    for (j = 0; j < sizeof(lengths) / sizeof(lengths[0]); j++) {
+      n = lengths[j];
+      for (m = 0; m < 2; m++) {
+        o1 = m;
+        o2 = 2 * m;
+        for (k = 0; k < 3; k++) {
+          measure(r, r->f[k], n, o1, o2, &c[k]);
+        }
+        printf("%-8s %5d %3d/%d %9u (%6u) %9u (%6u) %9u (%6u)\n",
+               r->name, n, o1, o2,
+               c[0].instrs, c[0].dcAccesses,
+               c[1].instrs, c[1].dcAccesses,
+               c[2].instrs, c[2].dcAccesses);
+      }
+    }
+  }
+  printf("\nDone.\n");
+}